@@ -0,0 +1,36 @@
+#version 450 core
+
+in vec2 v_Local;
+flat in vec2  v_HalfSize;
+flat in vec4  v_CornerRadii;
+flat in vec4  v_Fill;
+flat in vec4  v_Border;
+flat in float v_BorderWidth;
+flat in float v_PixelSize;
+
+layout(location = 0) out vec4 o_Colour;
+
+// Signed distance from p to the edge of a box centred on the origin, with a radius per corner (top-left, top-right,
+// bottom-right, bottom-left, y down). Negative inside.
+float RoundedBoxDistance(vec2 p, vec2 halfSize, vec4 radii)
+{
+    float radius = p.x < 0.0 ? (p.y < 0.0 ? radii.x : radii.w) : (p.y < 0.0 ? radii.y : radii.z);
+    radius       = min(radius, min(halfSize.x, halfSize.y));
+    vec2 q       = abs(p) - halfSize + radius;
+    return min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - radius;
+}
+
+void main()
+{
+    // Distances are in canvas units, so dividing by the size of a pixel gives a one pixel wide edge at any zoom.
+    float distance = RoundedBoxDistance(v_Local, v_HalfSize, v_CornerRadii);
+    float coverage = clamp(0.5 - distance / v_PixelSize, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+
+    vec4 colour = v_Fill;
+    if (v_BorderWidth > 0.0)
+        colour = mix(v_Fill, v_Border, clamp(0.5 + (distance + v_BorderWidth) / v_PixelSize, 0.0, 1.0));
+
+    o_Colour = vec4(colour.rgb, colour.a * coverage);
+}
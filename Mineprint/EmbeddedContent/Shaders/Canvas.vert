@@ -0,0 +1,39 @@
+#version 450 core
+
+// One instance per shape (see CanvasInstance). Canvas units, y down.
+layout(location = 0) in vec4  a_Rect; // Min.xy, Max.xy
+layout(location = 1) in vec4  a_CornerRadii; // Top-left, top-right, bottom-right, bottom-left.
+layout(location = 2) in vec4  a_Fill;
+layout(location = 3) in vec4  a_Border;
+layout(location = 4) in float a_BorderWidth;
+
+// [0]: canvas to clip space scale (xy) and offset (zw). [1].x: the size of a pixel, in canvas units.
+layout(location = 0) uniform vec4 u_DrawParams[2];
+
+out vec2 v_Local; // Relative to the shape's centre.
+flat out vec2  v_HalfSize;
+flat out vec4  v_CornerRadii;
+flat out vec4  v_Fill;
+flat out vec4  v_Border;
+flat out float v_BorderWidth;
+flat out float v_PixelSize;
+
+void main()
+{
+    // Drawn as a 4 vertex triangle strip, so the corner comes from the vertex ID: (0,0), (1,0), (0,1), (1,1).
+    vec2  corner    = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    float pixelSize = u_DrawParams[1].x;
+    vec2  halfSize  = (a_Rect.zw - a_Rect.xy) * 0.5;
+    vec2  centre    = (a_Rect.xy + a_Rect.zw) * 0.5;
+
+    // Grown by a pixel, so the antialiased edge isn't cut off.
+    v_Local     = (corner * 2.0 - 1.0) * (halfSize + pixelSize);
+    gl_Position = vec4((centre + v_Local) * u_DrawParams[0].xy + u_DrawParams[0].zw, 0.0, 1.0);
+
+    v_HalfSize    = halfSize;
+    v_CornerRadii = a_CornerRadii;
+    v_Fill        = a_Fill;
+    v_Border      = a_Border;
+    v_BorderWidth = a_BorderWidth;
+    v_PixelSize   = pixelSize;
+}
@@ -0,0 +1,8 @@
+#version 450 core
+
+layout(location = 0) out vec4 o_Colour;
+
+void main()
+{
+    o_Colour = vec4(0.0);
+}
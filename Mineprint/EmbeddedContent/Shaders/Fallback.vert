@@ -0,0 +1,14 @@
+#version 450 core
+
+// Stands in for shaders that are still being built (see ShaderCompiler). Draws using it can have any vertex layout,
+// so it reads no attributes, and puts every vertex outside the clip volume: the draw goes through, but nothing is
+// rasterised.
+
+// Declared (and used, so it isn't optimised out) so draws can still upload their parameters to it.
+layout(location = 0) uniform vec4 u_DrawParams[5];
+
+void main()
+{
+    // x is at least 2 with w at 1, so always clipped.
+    gl_Position = vec4(2.0 + abs(u_DrawParams[0].x) + abs(u_DrawParams[1].x), 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 450 core
+
+in vec3 v_Normal;
+in vec2 v_UV;
+
+// [4].x: the layer of the texture array to sample (a submesh's MaterialIndex, for models with an atlas).
+layout(location = 0) uniform vec4 u_DrawParams[5];
+layout(binding = 0) uniform sampler2DArray u_Texture;
+
+layout(location = 0) out vec4 o_Colour;
+
+void main()
+{
+    vec4 colour = texture(u_Texture, vec3(v_UV, u_DrawParams[4].x));
+    if (colour.a < 0.5)
+        discard;
+
+    // Fixed light from above and to the side, so shapes read without a lighting setup.
+    float light = 0.6 + 0.4 * max(dot(normalize(v_Normal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+    o_Colour    = vec4(colour.rgb * light, 1.0);
+}
@@ -0,0 +1,38 @@
+#version 450 core
+
+// See GPUMesh. With QUANTIZED defined, the attributes are a QuantizedMeshVertex's: the position is normalised to the
+// mesh's bounds (the matrix takes it back), and the normal is octahedral.
+layout(location = 0) in vec3 a_Position;
+#ifdef QUANTIZED
+layout(location = 1) in vec2 a_Normal;
+#else
+layout(location = 1) in vec3 a_Normal;
+#endif
+layout(location = 2) in vec2 a_UV;
+
+// [0..3]: object to clip space matrix (see GPUMesh::SetTransform()). [4].x: the texture layer, for the fragment shader.
+layout(location = 0) uniform vec4 u_DrawParams[5];
+
+out vec3 v_Normal;
+out vec2 v_UV;
+
+// The inverse of MeshOptimizer::EncodeOctahedral(): unfold the square back onto the octahedron, then normalise.
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3  normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold   = max(-normal.z, 0.0);
+    normal.xy   += mix(vec2(fold), vec2(-fold), greaterThanEqual(normal.xy, vec2(0.0)));
+    return normalize(normal);
+}
+
+void main()
+{
+    mat4 objectToClip = mat4(u_DrawParams[0], u_DrawParams[1], u_DrawParams[2], u_DrawParams[3]);
+    gl_Position       = objectToClip * vec4(a_Position, 1.0);
+#ifdef QUANTIZED
+    v_Normal = DecodeOctahedral(a_Normal);
+#else
+    v_Normal = a_Normal;
+#endif
+    v_UV = a_UV;
+}
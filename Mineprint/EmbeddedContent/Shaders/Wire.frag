@@ -0,0 +1,18 @@
+#version 450 core
+
+in vec4  v_Colour;
+in float v_Edge;
+
+layout(location = 0) out vec4 o_Colour;
+
+void main()
+{
+    // Distance to the edge of the geometry, in pixels. The geometry is a pixel wider than the line on each side (see
+    // WireBatch::Expand()), so the line's real edge is at 1 and gets half coverage.
+    float distance = (1.0 - abs(v_Edge)) / max(fwidth(v_Edge), 1e-6);
+    float coverage = clamp(distance - 0.5, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+
+    o_Colour = vec4(v_Colour.rgb, v_Colour.a * coverage);
+}
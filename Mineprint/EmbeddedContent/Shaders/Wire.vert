@@ -0,0 +1,19 @@
+#version 450 core
+
+// See WireVertex. Canvas units, y down.
+layout(location = 0) in vec2  a_Position;
+layout(location = 1) in vec4  a_Colour;
+layout(location = 2) in float a_Edge;
+
+// [0]: canvas to clip space scale (xy) and offset (zw).
+layout(location = 0) uniform vec4 u_DrawParams[1];
+
+out vec4  v_Colour;
+out float v_Edge;
+
+void main()
+{
+    gl_Position = vec4(a_Position * u_DrawParams[0].xy + u_DrawParams[0].zw, 0.0, 1.0);
+    v_Colour    = a_Colour;
+    v_Edge      = a_Edge;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Render/Mesh.h"
+
+class MeshFile;
+
+// A mesh on the CPU, in one vertex and index buffer, as the mesh benchmarks build and check them.
+struct TestMesh
+{
+    std::string             Name;
+    std::vector<MeshVertex> Vertices;
+    std::vector<u32>        Indices;
+    std::vector<SubMesh>    SubMeshes;
+    f32                     SphereRadius = 0.0f; // If it's a sphere around the origin, to measure against.
+};
+
+// Meshes shared between the mesh benchmarks.
+class BenchmarkMeshes
+{
+public:
+    // A UV sphere, with a UV seam down one side and at the poles, in two submeshes (so the equator is a border), with
+    // its vertices in rings, the way modelling tools tend to export.
+    static TestMesh MakeSphere(u32 rings, u32 segments);
+    // A loaded mesh file's submeshes, one after another.
+    static TestMesh CopyMeshFile(const MeshFile& file, const std::string& name);
+};
@@ -2,12 +2,106 @@
 
 #include "Render/Renderer.h"
 #include "Render/Window.h"
+#include "Render/RenderThread.h"
+#include "Core/Utility/FrameLimiter.h"
+#include "Core/Utility/CommandLine.h"
+#include "Core/Jobs/JobSystem.h"
+
+enum class LoopMode : u8
+{
+    Continuous, // Render every iteration, as fast as VSync/the frame cap allows.
+    Adaptive    // Block on events, and only render when something has requested a redraw.
+};
+
+inline const char* LoopModeToString(const LoopMode mode)
+{
+    switch (mode)
+    {
+    case LoopMode::Continuous:
+        return "Continuous";
+    case LoopMode::Adaptive:
+        return "Adaptive";
+    default:
+        return "Unknown";
+    }
+}
+
+// What the continuous loop does on frames where nothing has invalidated the UI: no input, no redraw timers and no
+// RequestRedraw()/InvalidateUI() calls since the last frame settled.
+enum class IdleFrameMode : u8
+{
+    Rebuild, // Build and render the UI every frame anyway.
+    Reuse,   // Render the last frame's draw data again and present it, without rebuilding the UI.
+    Skip     // Don't render or present; just wait out the frame. The window keeps showing the last frame.
+};
+
+inline const char* IdleFrameModeToString(const IdleFrameMode mode)
+{
+    switch (mode)
+    {
+    case IdleFrameMode::Rebuild:
+        return "Rebuild";
+    case IdleFrameMode::Reuse:
+        return "Reuse";
+    case IdleFrameMode::Skip:
+        return "Skip";
+    default:
+        return "Unknown";
+    }
+}
+
+enum class RestartMode : u8
+{
+    None,
+    Soft, // Reload editor state only; the window, GL context, GPU resources and ImGui context are kept.
+    Full  // Shut down and re-create the whole application, including SDL.
+};
+
+inline const char* RestartModeToString(const RestartMode mode)
+{
+    switch (mode)
+    {
+    case RestartMode::None:
+        return "None";
+    case RestartMode::Soft:
+        return "Soft";
+    case RestartMode::Full:
+        return "Full";
+    default:
+        return "Unknown";
+    }
+}
 
 struct ApplicationSpecification
 {
-    std::string Name    = "Application";
-    std::string Author  = "Super Cool Game Corp";
-    SemVer      Version = SemVer(1, 0, 0);
+    std::string Name         = "Application";
+    std::string Author       = "Super Cool Game Corp";
+    SemVer      Version      = SemVer(1, 0, 0);
+    LoopMode    Loop         = LoopMode::Adaptive;
+    u16         FrameRateCap = 0; // 0 = uncapped.
+    // Only used by the continuous loop; the adaptive loop doesn't run idle frames at all. Set with --idle-frames.
+    IdleFrameMode IdleFrames = IdleFrameMode::Rebuild;
+    CommandLine Args;
+    s32         WorkerCount = -1; // Job system worker threads; -1 = one per logical core minus one. Set with --workers.
+
+    // Submit GL on a render thread, one frame behind the main thread, so a heavy UI frame doesn't delay the swap.
+    // While it's on, the main thread must not make GL calls. Set with --pipelined-rendering.
+    bool PipelinedRendering = false;
+
+    // Headless applications don't create a window, GL context or ImGui context. They run queued commands
+    // (exports, benchmarks, etc) and exit once the command queue is empty. Set with --headless.
+    bool Headless = false;
+    // Headless, but with an offscreen GL context (see HeadlessContext), for rendering to offscreen targets and
+    // reading them back. Set with --headless-gl.
+    bool HeadlessGL = false;
+};
+
+// A named unit of batch work (an export, a benchmark...). Step() is called once per loop iteration until it
+// returns true, so long-running commands can be split up without blocking the loop.
+struct ApplicationCommand
+{
+    std::string           Name;
+    std::function<bool()> Step;
 };
 
 class Application
@@ -26,42 +120,151 @@ public:
     void Close();
     void ShowError(const std::string& message, const std::string& title = "Error") const;
 
+    // Ask the main loop to render at least the given number of frames. Safe to call from any thread; if the main
+    // loop is blocked waiting for events, it will be woken up.
+    void RequestRedraw(u32 frames = 1);
+    // Ask the main loop to render a frame after the given delay, e.g. for animations or blinking carets.
+    void ScheduleRedraw(u32 delayMS);
+    // For panels: call when something you draw has changed without any input (a job finished, a file reloaded...),
+    // so the UI is rebuilt even if idle frames are being reused or skipped. Safe to call from any thread.
+    void InvalidateUI(u32 frames = 1);
+
+    void SetLoopMode(LoopMode mode);
+    void SetFrameRateCap(u16 fps);
+    void SetVSync(VSyncMode vsync);
+    void SetPipelinedRendering(bool pipelined);
+    void SetIdleFrameMode(IdleFrameMode mode);
+
+    // Queue a command to be run by the main loop. In headless mode, the application exits once all commands are done.
+    void QueueCommand(ApplicationCommand command);
+    FORCEINLINE void SetExitCode(s32 exitCode) { m_ExitCode = exitCode; }
+
     NODISCARD FORCEINLINE const ApplicationSpecification& GetSpecification() const { return m_Specification; }
     NODISCARD FORCEINLINE Window&                         GetWindow() { return m_Window; }
     NODISCARD FORCEINLINE const Window&                   GetWindow() const { return m_Window; }
+    NODISCARD FORCEINLINE JobSystem&                      GetJobSystem() { return m_JobSystem; }
+    NODISCARD FORCEINLINE Renderer&                       GetRenderer() { return m_Renderer; }
     NODISCARD FORCEINLINE bool                            IsRunning() const { return m_Running; }
+    NODISCARD FORCEINLINE bool                            IsHeadless() const { return m_Specification.Headless; }
+    NODISCARD FORCEINLINE s32                             GetExitCode() const { return m_ExitCode; }
+    NODISCARD FORCEINLINE LoopMode                        GetLoopMode() const { return m_Specification.Loop; }
+    NODISCARD FORCEINLINE IdleFrameMode                   GetIdleFrameMode() const
+    {
+        return m_Specification.IdleFrames;
+    }
+    NODISCARD FORCEINLINE u64                             GetUIInvalidationCount() const { return m_UIInvalidations; }
+    NODISCARD FORCEINLINE const FrameLoopStats&           GetLoopStats() const { return m_LoopStats; }
+    NODISCARD FORCEINLINE bool                            IsPipelinedRendering() const
+    {
+        return m_RenderThread.IsRunning();
+    }
 
-    NODISCARD FORCEINLINE static bool ShouldRestart() { return s_ShouldRestart; }
-    FORCEINLINE static void RequestRestart(bool restart = true)
+    // True if the application should be re-created once it's shut down (a full restart).
+    NODISCARD FORCEINLINE static bool ShouldRestart() { return s_RestartMode == RestartMode::Full; }
+    // A full restart takes effect when the application closes. A soft restart happens at the start of the next frame.
+    FORCEINLINE static void RequestRestart(RestartMode mode = RestartMode::Full)
     {
-        s_ShouldRestart = restart;
+        s_RestartMode = mode;
     }
 
+    NODISCARD FORCEINLINE static RestartMode GetRequestedRestart() { return s_RestartMode; }
+    // How long the last restart took, from teardown to the first frame afterwards. 0 if we haven't restarted.
+    NODISCARD FORCEINLINE static f64 GetLastRestartMS() { return s_LastRestartMS; }
+
     NODISCARD FORCEINLINE static Application* Get() { return s_Instance; }
 
     // TODO(mware): Move font management to some other dedicated class that will handle ImGui themeing.
     NODISCARD FORCEINLINE static ImFont* GetOpenSansRegular() { return s_OpenSansRegular; }
     NODISCARD FORCEINLINE static ImFont* GetOpenSansBold() { return s_OpenSansBold; }
 
+    // Project/editor state lives between these two. They run when the main loop (headless or not) starts and ends,
+    // and around a soft restart, so anything bound here is reloaded without re-creating the window, GL context or
+    // ImGui context. Unload must also cancel any jobs or tasks that reference the state.
+    MulticastDelegate<> OnLoadEditorState;
+    MulticastDelegate<> OnUnloadEditorState;
+
+    MulticastDelegate<>               OnUpdate; // Executed every loop iteration that does work, headless or not.
     MulticastDelegate<>               OnDrawIMGui;
     CascadingMulticastDelegate<false> OnApplicationCloseRequested;
 
 protected:
     bool InitSDL() const;
     bool InitImGUI();
+    void LoadFontAtlas();
+    void WaitForShaderCachePrefetch();
+    void BindWindowEvents();
+    RendererSpecification MakeRendererSpecification();
 
     void ShutdownImGUI();
 
+    // Polls (or, in adaptive mode, waits for) events. Returns true if the UI should be rebuilt this iteration.
+    bool PumpEvents();
+    bool ConsumeRedrawRequest();
+    void PumpHeadlessEvents();
+    void RunHeadless();
+    void StepCommands();
+    bool IsRedrawPending() const;
+    s32  GetIdleWaitTimeoutMS() const;
+    f64  GetReferenceFrameTimeMS() const;
+    void RecordIdleTime(f64 idleMS);
+    // reuseDrawData renders the last frame's draw data again, without the ImGui frame that normally comes before it.
+    void RenderFrame(u64 frameStartNS, bool reuseDrawData = false);
+    void RenderIdleFrame(u64 frameStartNS);
+    void RecordFrameCPUTime(u64 frameStartNS, bool idleFrame);
+    void UpdateRenderThread();
+    void SoftRestart();
+    static void FinishRestartMeasurement();
+    void DrawAppSettings();
+
+    // Number of frames we render after an event, so ImGui has time to settle (hover states, layout changes, etc).
+    static constexpr u32 ImGuiSettleFrames = 3;
+    // Upper bound on how long we'll block waiting for events, so we never sleep forever if a wake-up is missed.
+    static constexpr s32 MaxIdleWaitMS = 1000;
+
     // Application runtime data.
     ApplicationSpecification m_Specification;
     Window                   m_Window;
     Renderer                 m_Renderer;
+    RenderThread             m_RenderThread;
+    JobSystem                m_JobSystem;
     bool                     m_Running          = false;
     bool                     m_ImGUIInitialized = false;
+    s32                      m_ExitCode         = 0;
+
+    // The font atlas is loaded on a worker while SDL, the window and GL start up, then handed to ImGui.
+    ImFontAtlas* m_FontAtlas     = nullptr;
+    JobCounter   m_FontAtlasJob;
+    u32          m_FontAtlasSpan = StartupTimeline::InvalidSpan;
+
+    // The shader cache is read on a worker at the same time, and the renderer is initialised once it's in memory.
+    JobCounter m_ShaderCachePrefetchJob;
+    u32        m_ShaderCachePrefetchSpan = StartupTimeline::InvalidSpan;
+
+    // Queued batch commands. Only touched from the main thread.
+    std::deque<ApplicationCommand> m_Commands;
+    Stopwatch                      m_CommandTimer;
+    bool                           m_CommandStarted = false;
+
+    // Main loop pacing.
+    FrameLimiter      m_FrameLimiter;
+    FrameLoopStats    m_LoopStats;
+    f64               m_SkippedFrameRemainder = 0.0;
+    std::atomic<u32>  m_RedrawFramesRequested = 0;
+    std::atomic<u64>  m_ScheduledRedrawNS     = 0; // SDL_GetTicksNS() deadline, 0 if nothing is scheduled.
+    std::atomic<bool> m_WaitingForEvents      = false;
+    std::atomic<u64>  m_UIInvalidations       = 0;
+    bool              m_RenderedFirstFrame    = false;
 
     // Static instance and variables.
     static Application* s_Instance;
-    static bool         s_ShouldRestart;
+    static RestartMode  s_RestartMode;
+
+    // Restart timing. Static, so it survives a full restart.
+    static Stopwatch   s_RestartTimer;
+    static RestartMode s_MeasuringRestart;
+    static f64         s_LastRestartMS;
+
+    static u32 s_WakeEventType;
 
     static ImFont* s_OpenSansRegular;
     static ImFont* s_OpenSansBold;
@@ -96,6 +96,9 @@ inline std::string WrapString(const char* str, const int maxLineLength = 150, co
 // We define this in a separate CPP file, as otherwise we would have a circular dependency.
 SDL_Window* GetAppWindow();
 
+// Returns true if the current application is running headless, in which case there's nobody to answer a message box.
+bool IsAppHeadless();
+
 // This function does all the heavy lifting for assertions.
 // It's pretty heavy, with lots of string operations and formatting, but we shouldn't be doing this often!
 template <typename... Args>
@@ -147,6 +150,10 @@ AssertState ReportAssertion(AssertionData* data, const char* message = "Assertio
     if (data->Silent)
         return AssertState::Silence;
 
+    // Headless runs (CI, batch exports) can't answer a message box, so we just log and carry on.
+    if (IsAppHeadless())
+        return AssertState::Ignore;
+
     // Now, let's construct a message box.
     SDL_MessageBoxData messageBoxData;
     messageBoxData.flags   = SDL_MESSAGEBOX_ERROR;
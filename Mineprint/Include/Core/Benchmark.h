@@ -0,0 +1,75 @@
+#pragma once
+
+class Application;
+class CommandLine;
+
+struct BenchmarkContext
+{
+    Application&       App;
+    const CommandLine& Args;
+};
+
+using BenchmarkFunction = void (*)(const BenchmarkContext& context);
+
+struct BenchmarkInfo
+{
+    const char*       Name;
+    const char*       Description;
+    BenchmarkFunction Function;
+};
+
+struct BenchmarkResult
+{
+    u32 Iterations = 0;
+    f64 MinMS      = 0;
+    f64 AverageMS  = 0;
+    f64 MaxMS      = 0;
+};
+
+// Registry of benchmarks that can be run with --benchmark=<name>[,<name>...] (or --benchmark=all).
+// Benchmarks are queued as application commands, so they're usually run with --headless to measure pure CPU cost.
+// They all run headless unless their comment says they need a GL context (--headless-gl), and those check for one.
+// Random inputs come from a fixed seed, so runs are comparable.
+// Register benchmarks with MP_REGISTER_BENCHMARK in the file that defines them.
+class Benchmarks
+{
+public:
+    static void                              Register(const BenchmarkInfo& info);
+    static const std::vector<BenchmarkInfo>& GetAll();
+    static void                              QueueFromCommandLine(Application& app);
+
+    // Runs the function once to warm up, then the given number of times, and returns the timings.
+    template <typename Function>
+    static BenchmarkResult Measure(u32 iterations, Function&& function)
+    {
+        function();
+
+        BenchmarkResult result;
+        result.Iterations = iterations;
+        result.MinMS      = std::numeric_limits<f64>::max();
+        f64 totalMS       = 0;
+        for (u32 i = 0; i < iterations; i++)
+        {
+            Stopwatch stopwatch;
+            function();
+            const f64 elapsed = stopwatch.GetElapsedMilliseconds();
+            totalMS           += elapsed;
+            result.MinMS      = std::min(result.MinMS, elapsed);
+            result.MaxMS      = std::max(result.MaxMS, elapsed);
+        }
+        result.AverageMS = iterations > 0 ? totalMS / iterations : 0;
+
+        return result;
+    }
+};
+
+struct BenchmarkRegistrar
+{
+    explicit BenchmarkRegistrar(const BenchmarkInfo& info)
+    {
+        Benchmarks::Register(info);
+    }
+};
+
+#define MP_REGISTER_BENCHMARK(function, name, description) \
+    static BenchmarkRegistrar CAT(s_BenchmarkRegistrar, __LINE__)({name, description, &function})
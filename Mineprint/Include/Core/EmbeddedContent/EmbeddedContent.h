@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mutex>
+#include <span>
+
+#include "Core/Utility/Hash.h"
+
+enum class EmbeddedCompression : u32
+{
+    None, // Stored as-is; used in place, straight out of the executable.
+    Zlib
+};
+
+inline const char* EmbeddedCompressionToString(const EmbeddedCompression compression)
+{
+    switch (compression)
+    {
+    case EmbeddedCompression::None:
+        return "None";
+    case EmbeddedCompression::Zlib:
+        return "Zlib";
+    default:
+        return "Unknown";
+    }
+}
+
+struct EmbeddedFileInfo
+{
+    std::string_view    Path;
+    u32                 Size       = 0;
+    u32                 StoredSize = 0; // Size in the executable.
+    EmbeddedCompression Compression = EmbeddedCompression::None;
+    bool                Loaded      = false;
+};
+
+struct EmbeddedContentStats
+{
+    u32 FileCount     = 0;
+    u64 PackSize      = 0; // Size of the blob in the executable.
+    u64 TotalSize     = 0; // Size of every file once decompressed.
+    u32 LoadedFiles   = 0;
+    u64 ResidentBytes = 0; // Heap memory used by decompressed files.
+    f64 DecompressMS  = 0.0;
+};
+
+// Files that are built into the executable, rather than loaded from the content directory (fonts, fallbacks...).
+// The preprocessor packs Mineprint/EmbeddedContent/ into one compressed blob (see EmbeddedContentPacker.cs), which is
+// linked in as read-only data. Nothing is decompressed at startup; each file is inflated on first use and cached.
+//
+// Thread-safe. Different files can be decompressed on different threads at once.
+class EmbeddedContent
+{
+public:
+    // Finds and validates the blob. Cheap; no files are decompressed.
+    static bool Init();
+    // Frees decompressed files. Anything returned by Get() is invalid afterwards.
+    static void Shutdown();
+
+    // Returns the file's data, decompressing it the first time. Empty if the file doesn't exist.
+    // The data is valid until Shutdown().
+    NODISCARD static std::span<const u8> Get(std::string_view path);
+    NODISCARD static bool                Exists(std::string_view path);
+
+    NODISCARD static std::vector<EmbeddedFileInfo> List();
+    NODISCARD static EmbeddedContentStats          GetStats();
+
+    NODISCARD FORCEINLINE static bool IsAvailable() { return s_EntryCount > 0; }
+
+    // Must match EmbeddedContentPacker.HashPath().
+    NODISCARD static constexpr u64 HashPath(const std::string_view path) { return Hash::String(Hash::Offset, path); }
+
+private:
+    struct PackHeader
+    {
+        u32 Magic;
+        u16 Version;
+        u16 Flags;
+        u32 EntryCount;
+        u32 NamesOffset;
+        u32 NamesSize;
+        u32 DataOffset;
+    };
+
+    struct PackEntry
+    {
+        u64 NameHash;
+        u32 NameOffset;
+        u32 NameLength;
+        u32 DataOffset;
+        u32 StoredSize;
+        u32 Size;
+        u32 Compression;
+    };
+
+    // Decompressed data for a compressed entry, filled in on first use.
+    struct LoadedFile
+    {
+        std::once_flag    Once;
+        std::atomic<bool> Loaded = false;
+        Buffer            Data;
+    };
+
+    static constexpr u32 PackMagic   = 0x4345504D; // "MPEC"
+    static constexpr u16 PackVersion = 1;
+
+    static std::span<const u8> GetPack();
+    static const PackEntry*     FindEntry(std::string_view path);
+    static std::span<const u8>  Load(u32 index);
+
+    static const u8*                     s_Pack;
+    static const PackEntry*              s_Entries;
+    static u32                           s_EntryCount;
+    static u64                           s_PackSize;
+    static std::unique_ptr<LoadedFile[]> s_Loaded;
+    static std::atomic<u32>              s_LoadedFiles;
+    static std::atomic<u64>              s_ResidentBytes;
+    static std::atomic<u64>              s_DecompressUS;
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+
+#include "Core/Jobs/WorkStealingDeque.h"
+
+class JobSystem;
+
+using JobFunction = std::function<void()>;
+
+// Tracks a group of in-flight jobs. Scheduling a job with a counter increments it, and it's decremented once the
+// job finishes. Wait on a counter with JobSystem::Wait(), or use JobSystem::ScheduleAfter() to chain work on it.
+//
+// Counters must outlive the jobs they track - usually they live on the stack of whoever waits on them.
+class JobCounter
+{
+public:
+    JobCounter() = default;
+
+    // The last job to finish releases the counter while holding the continuation lock, so taking it here guarantees
+    // that job is done touching us before we're destroyed.
+    ~JobCounter()
+    {
+        std::lock_guard lock(m_ContinuationMutex);
+    }
+
+    JobCounter(const JobCounter& other)                = delete;
+    JobCounter(JobCounter&& other) noexcept            = delete;
+    JobCounter& operator=(const JobCounter& other)     = delete;
+    JobCounter& operator=(JobCounter&& other) noexcept = delete;
+
+    NODISCARD FORCEINLINE u32  GetValue() const { return m_Value.load(std::memory_order_acquire); }
+    NODISCARD FORCEINLINE bool IsDone() const { return GetValue() == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        JobSystem*  System;
+        JobFunction Function;
+        JobCounter* Counter;
+        bool        MainThread;
+    };
+
+    std::atomic<u32>          m_Value = 0;
+    std::mutex                m_ContinuationMutex;
+    std::vector<Continuation> m_Continuations;
+};
+
+struct JobSystemSpecification
+{
+    // Number of worker threads. -1 = one per logical core, minus one for the main thread. 0 = no workers; everything
+    // runs on the main thread inside Wait()/ParallelFor().
+    s32 WorkerCount = -1;
+
+    // Called (from any thread) when a main-thread job is queued, so the main loop can wake up and run it.
+    std::function<void()> OnMainThreadJobQueued;
+};
+
+// Work-stealing job system.
+// Every worker (and the main thread) owns a Chase-Lev deque. Jobs scheduled from a worker go onto its own deque, and
+// idle workers steal from the others. Jobs scheduled from threads the system doesn't own go onto a shared
+// injection queue. Main-thread jobs go onto a separate queue that's drained by ProcessMainThreadJobs().
+//
+// Waiting on a counter never blocks a thread outright - the waiter runs other jobs until the counter hits zero,
+// so it's safe to wait from inside a job.
+class JobSystem
+{
+public:
+    JobSystem() = default;
+    ~JobSystem();
+
+    JobSystem(const JobSystem& other)                = delete;
+    JobSystem(JobSystem&& other) noexcept            = delete;
+    JobSystem& operator=(const JobSystem& other)     = delete;
+    JobSystem& operator=(JobSystem&& other) noexcept = delete;
+
+    // Must be called from the thread that will be treated as the main thread.
+    bool Init(const JobSystemSpecification& spec);
+    void Shutdown();
+
+    void Schedule(JobFunction function, JobCounter* counter = nullptr);
+    // Schedules a job that will only start once the dependency counter reaches zero.
+    void ScheduleAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+    // Schedules a job that will run on the main thread, in ProcessMainThreadJobs().
+    void ScheduleOnMainThread(JobFunction function, JobCounter* counter = nullptr);
+    // Main-thread job that will only be queued once the dependency counter reaches zero.
+    void ScheduleOnMainThreadAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+
+    // Resumes a suspended coroutine on a worker (or on the main thread). Unlike Schedule(), these don't allocate -
+    // the handle is queued directly - so awaiting a thread switch in a Task is cheap.
+    void ScheduleResume(std::coroutine_handle<> handle);
+    void ScheduleResumeOnMainThread(std::coroutine_handle<> handle);
+
+    // Spawned tasks (see Async::Spawn()) own themselves, so the system keeps track of the ones that haven't finished,
+    // to destroy them at shutdown.
+    void TrackSpawned(std::coroutine_handle<> handle);
+    void ForgetSpawned(std::coroutine_handle<> handle);
+
+    // Runs other jobs until the counter reaches zero.
+    void Wait(const JobCounter& counter);
+    // Runs other jobs until the predicate returns true.
+    template <typename Predicate>
+    void WaitUntil(Predicate&& predicate);
+
+    // Runs all queued main-thread jobs. Returns the number of jobs run.
+    u32 ProcessMainThreadJobs();
+
+    // Calls function(rangeBegin, rangeEnd) over sub-ranges of [begin, end) in parallel, and waits for them all.
+    // The range is split in half recursively, with the right half pushed as a stealable job, until chunks reach the
+    // grain size. Idle workers steal the biggest remaining halves first, so the chunking adapts to however many workers
+    // are actually free, and to uneven per-item costs.
+    template <typename Function>
+    void ParallelFor(u32 begin, u32 end, Function&& function, u32 minGrainSize = 1);
+
+    NODISCARD FORCEINLINE bool IsInitialised() const { return m_Initialised; }
+    NODISCARD FORCEINLINE u32  GetWorkerCount() const { return static_cast<u32>(m_Workers.size()); }
+    // Workers plus the main thread.
+    NODISCARD FORCEINLINE u32 GetThreadCount() const { return GetWorkerCount() + 1; }
+    NODISCARD bool            IsMainThread() const;
+    // Returns true if the calling thread is one of this system's workers (or the main thread).
+    NODISCARD bool IsOwnedThread() const;
+
+    NODISCARD FORCEINLINE u64 GetJobsExecuted() const { return m_JobsExecuted.load(std::memory_order_relaxed); }
+    NODISCARD FORCEINLINE u64 GetJobsStolen() const { return m_JobsStolen.load(std::memory_order_relaxed); }
+
+private:
+    struct Job
+    {
+        JobFunction Function;
+        JobCounter* Counter = nullptr;
+    };
+
+    // Coroutine resumptions share the job queues, tagged in the low bit so they can be told apart from real jobs.
+    // Coroutine frames are always at least pointer-aligned, so the bit is free.
+    static FORCEINLINE Job* TagCoroutine(std::coroutine_handle<> handle)
+    {
+        return reinterpret_cast<Job*>(reinterpret_cast<uintptr_t>(handle.address()) | 1);
+    }
+
+    static FORCEINLINE bool IsCoroutine(const Job* job) { return (reinterpret_cast<uintptr_t>(job) & 1) != 0; }
+
+    static FORCEINLINE std::coroutine_handle<> UntagCoroutine(const Job* job)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(job) & ~static_cast<uintptr_t>(1);
+        return std::coroutine_handle<>::from_address(reinterpret_cast<void*>(address));
+    }
+
+    void WorkerLoop(u32 index);
+    void Enqueue(Job* job);
+    void EnqueueMainThread(Job* job);
+    Job* FindJob();
+    void Execute(Job* job);
+    // Frees a job that will never run. Returns false for coroutines, which we don't own.
+    static bool DiscardJob(Job* job);
+    void FinishJob(JobCounter* counter);
+    void WakeWorkers();
+    void AddContinuation(JobCounter& dependency, JobFunction function, JobCounter* counter, bool mainThread);
+
+    template <typename Function>
+    void ParallelForSplit(u32 begin, u32 end, u32 grainSize, Function& function, JobCounter& counter);
+
+    static constexpr u32 InvalidIndex     = ~0u;
+    static constexpr u32 SpinsBeforeSleep = 64;
+
+    JobSystemSpecification m_Spec;
+    bool                   m_Initialised = false;
+    std::atomic<bool>      m_Running     = false;
+
+    // Index 0 is the main thread, 1..N are the workers.
+    std::vector<Scope<WorkStealingDeque<Job*>>> m_Queues;
+    std::vector<std::thread>                    m_Workers;
+    std::thread::id                             m_MainThreadID;
+
+    // Jobs scheduled from threads we don't own.
+    std::mutex       m_InjectionMutex;
+    std::deque<Job*> m_InjectionQueue;
+    std::atomic<u32> m_InjectedJobs = 0;
+
+    std::mutex       m_MainThreadMutex;
+    std::deque<Job*> m_MainThreadQueue;
+
+    std::mutex                m_SpawnedMutex;
+    std::unordered_set<void*> m_Spawned; // Coroutine frame addresses.
+
+    // Sleeping. m_QueuedJobs counts jobs that are sitting in a queue, waiting to be picked up.
+    std::mutex              m_SleepMutex;
+    std::condition_variable m_SleepCondition;
+    std::atomic<u32>        m_SleepingWorkers = 0;
+    std::atomic<s64>        m_QueuedJobs      = 0;
+
+    std::atomic<u64> m_JobsExecuted = 0;
+    std::atomic<u64> m_JobsStolen   = 0;
+
+    // Which system (and which queue) the current thread belongs to.
+    static thread_local JobSystem* t_System;
+    static thread_local u32        t_QueueIndex;
+    static thread_local u32        t_StealSeed;
+
+    // Restored on shutdown, in case another system (e.g. a benchmark's) was initialised on the main thread.
+    JobSystem* m_PreviousSystem     = nullptr;
+    u32        m_PreviousQueueIndex = InvalidIndex;
+};
+
+template <typename Predicate>
+void JobSystem::WaitUntil(Predicate&& predicate)
+{
+    const bool onMainThread = IsMainThread();
+    u32        spins        = 0;
+
+    while (!predicate())
+    {
+        // We might be waiting on a main-thread job, so the main thread must keep servicing those.
+        if (onMainThread)
+            ProcessMainThreadJobs();
+
+        if (Job* job = FindJob())
+        {
+            Execute(job);
+            spins = 0;
+            continue;
+        }
+
+        if (++spins > SpinsBeforeSleep)
+            std::this_thread::yield();
+    }
+}
+
+template <typename Function>
+void JobSystem::ParallelFor(u32 begin, u32 end, Function&& function, u32 minGrainSize)
+{
+    if (end <= begin)
+        return;
+
+    const u32 count = end - begin;
+    // Aim for ~8 chunks per thread, which gives thieves enough to balance uneven work without drowning in overhead.
+    const u32 grainSize = std::max({minGrainSize, count / (GetThreadCount() * 8), 1u});
+
+    if (!m_Initialised || GetWorkerCount() == 0 || count <= grainSize)
+    {
+        function(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    ParallelForSplit(begin, end, grainSize, function, counter);
+    Wait(counter);
+}
+
+template <typename Function>
+void JobSystem::ParallelForSplit(u32 begin, u32 end, u32 grainSize, Function& function, JobCounter& counter)
+{
+    while (end - begin > grainSize)
+    {
+        const u32 middle = begin + (end - begin) / 2;
+        Schedule([this, middle, end, grainSize, &function, &counter]
+        {
+            ParallelForSplit(middle, end, grainSize, function, counter);
+        }, &counter);
+        end = middle;
+    }
+
+    function(begin, end);
+}
@@ -0,0 +1,591 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+#include "Core/Jobs/JobSystem.h"
+
+// Coroutine tasks, for chaining I/O, decoding and main-thread work without nesting callbacks:
+//
+//     Task<Ref<Texture>> LoadTexture(std::filesystem::path path)
+//     {
+//         Buffer file = *co_await Async::ReadFile(path);       // Read on a worker
+//         Image  image = DecodeImage(file);                     // Still on the worker
+//         co_await Async::SwitchToMainThread();                 // Resumed from Application::Run
+//         co_return CreateTexture(image);                       // GL calls are fine here
+//     }
+//
+// Tasks are lazy - nothing runs until they're awaited, or handed to Async::Spawn() (fire and forget) or
+// Async::SyncWait() (block, helping the job system, until done). A task resumes its awaiter on whichever thread it
+// finished on.
+//
+// Thread switches queue the coroutine handle straight onto the job system, so awaiting them doesn't allocate. The
+// only allocation is each task's own coroutine frame.
+//
+// Tasks don't throw. A task that can fail says so in its result, as any other function would (a bool, an empty
+// Buffer...), and logs why.
+//
+// Cancelling stops a task where it is. Awaitables given a CancellationToken check it before suspending, and if it's
+// been cancelled the task finishes there, without running the rest of its body. Awaiting a task gives a std::optional
+// of its result (a bool for Task<>), which is empty if it was cancelled; the awaiter can carry on, or stop too with
+// Async::Cancel(). A stopped task's frame is destroyed along with its Task, so its locals are still cleaned up.
+
+template <typename T = void>
+class Task;
+
+class CancellationToken
+{
+public:
+    CancellationToken() = default;
+
+    // A default-constructed token can never be cancelled.
+    NODISCARD FORCEINLINE bool IsCancelled() const
+    {
+        return m_Cancelled && m_Cancelled->load(std::memory_order_acquire);
+    }
+
+private:
+    friend class CancellationSource;
+
+    explicit CancellationToken(Ref<std::atomic<bool>> cancelled)
+        : m_Cancelled(std::move(cancelled))
+    {
+    }
+
+    Ref<std::atomic<bool>> m_Cancelled;
+};
+
+// Owns the cancellation flag that its tokens observe. Cancelling is thread-safe, and can't be undone.
+class CancellationSource
+{
+public:
+    CancellationSource()
+        : m_Cancelled(CreateRef<std::atomic<bool>>(false))
+    {
+    }
+
+    void Cancel() { m_Cancelled->store(true, std::memory_order_release); }
+
+    NODISCARD FORCEINLINE bool              IsCancelled() const { return m_Cancelled->load(std::memory_order_acquire); }
+    NODISCARD FORCEINLINE CancellationToken GetToken() const { return CancellationToken(m_Cancelled); }
+
+private:
+    Ref<std::atomic<bool>> m_Cancelled;
+};
+
+namespace TaskDetail
+{
+    // When a task finishes, jump straight to whoever awaited it (symmetric transfer), so long chains of tasks
+    // don't grow the stack.
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            Promise& promise = handle.promise();
+            promise.Finished = true;
+            return promise.Continuation ? promise.Continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct PromiseBase
+    {
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter        final_suspend() const noexcept { return {}; }
+        [[noreturn]] void   unhandled_exception() const { std::terminate(); }
+
+        std::coroutine_handle<> Continuation;
+        // Finished is set once the task has returned, or stopped because it was cancelled. A cancelled task never
+        // reaches its final suspend point, so its handle is never done().
+        bool Finished  = false;
+        bool Cancelled = false;
+    };
+
+    template <typename T>
+    struct Promise : PromiseBase
+    {
+        using ResultType = std::optional<T>;
+
+        Task<T> get_return_object();
+
+        template <typename Value>
+        void return_value(Value&& value)
+        {
+            Result.emplace(std::forward<Value>(value));
+        }
+
+        // Empty if the task was cancelled.
+        ResultType TakeResult() { return std::move(Result); }
+
+        std::optional<T> Result;
+    };
+
+    template <>
+    struct Promise<void> : PromiseBase
+    {
+        // False if the task was cancelled.
+        using ResultType = bool;
+
+        Task<void> get_return_object();
+
+        void       return_void() const {}
+        ResultType TakeResult() const { return !Cancelled; }
+    };
+
+    // Stops a task at its current suspension point, finishing it as cancelled, and carries on with its awaiter.
+    template <typename Promise>
+        requires std::derived_from<Promise, PromiseBase>
+    std::coroutine_handle<> StopCancelled(std::coroutine_handle<Promise> handle) noexcept
+    {
+        PromiseBase& promise = handle.promise();
+        promise.Cancelled    = true;
+        promise.Finished     = true;
+        return promise.Continuation ? promise.Continuation : std::noop_coroutine();
+    }
+
+    // Fire-and-forget coroutine that cleans itself up when it finishes. Only used internally, by Async::SyncWait().
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            DetachedTask        get_return_object() const { return {}; }
+            std::suspend_never  initial_suspend() const noexcept { return {}; }
+            std::suspend_never  final_suspend() const noexcept { return {}; }
+            void                return_void() const {}
+            [[noreturn]] void   unhandled_exception() const { std::terminate(); }
+        };
+    };
+
+    // Root of a spawned task (see Async::Spawn()). It owns the task, and destroys itself once the task finishes. Until
+    // then the job system keeps track of it, to destroy it (and the task with it) if it's still queued at shutdown.
+    struct SpawnedTask
+    {
+        struct promise_type
+        {
+            SpawnedTask get_return_object()
+            {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() const noexcept
+            {
+                struct ReleaseAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                    {
+                        handle.promise().System->ForgetSpawned(handle);
+                        handle.destroy();
+                    }
+
+                    void await_resume() const noexcept {}
+                };
+                return ReleaseAwaiter{};
+            }
+
+            void              return_void() const {}
+            [[noreturn]] void unhandled_exception() const { std::terminate(); }
+
+            JobSystem* System = nullptr;
+        };
+
+        std::coroutine_handle<promise_type> Handle;
+    };
+
+    // Counts down as each task in an Async::WhenAll() finishes; the last one resumes the awaiter.
+    struct WhenAllLatch
+    {
+        explicit WhenAllLatch(u32 count)
+            : Remaining(count + 1)
+        {
+        }
+
+        // Returns true if this was the last one.
+        bool CountDown() { return Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+        std::atomic<u32>        Remaining;
+        std::coroutine_handle<> Awaiter;
+    };
+
+    // Awaits one task of a WhenAll(), then counts down the latch. The task's result is left for WhenAll() to collect.
+    class WhenAllEntry
+    {
+    public:
+        struct promise_type
+        {
+            WhenAllEntry get_return_object()
+            {
+                return WhenAllEntry(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() const noexcept
+            {
+                struct CountDownAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                    {
+                        WhenAllLatch* latch = handle.promise().Latch;
+                        return latch->CountDown() ? latch->Awaiter : std::noop_coroutine();
+                    }
+
+                    void await_resume() const noexcept {}
+                };
+                return CountDownAwaiter{};
+            }
+
+            void              return_void() const {}
+            [[noreturn]] void unhandled_exception() const { std::terminate(); }
+
+            WhenAllLatch* Latch = nullptr;
+        };
+
+        explicit WhenAllEntry(std::coroutine_handle<promise_type> handle)
+            : m_Handle(handle)
+        {
+        }
+
+        ~WhenAllEntry()
+        {
+            if (m_Handle)
+                m_Handle.destroy();
+        }
+
+        WhenAllEntry(const WhenAllEntry& other)            = delete;
+        WhenAllEntry& operator=(const WhenAllEntry& other) = delete;
+
+        WhenAllEntry(WhenAllEntry&& other) noexcept
+            : m_Handle(std::exchange(other.m_Handle, nullptr))
+        {
+        }
+
+        WhenAllEntry& operator=(WhenAllEntry&& other) noexcept = delete;
+
+        void Start(WhenAllLatch& latch, JobSystem& jobSystem)
+        {
+            m_Handle.promise().Latch = &latch;
+            jobSystem.ScheduleResume(m_Handle);
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_Handle;
+    };
+}
+
+template <typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = TaskDetail::Promise<T>;
+    using Handle       = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+
+    explicit Task(Handle handle)
+        : m_Handle(handle)
+    {
+    }
+
+    ~Task()
+    {
+        if (m_Handle)
+            m_Handle.destroy();
+    }
+
+    Task(const Task& other)            = delete;
+    Task& operator=(const Task& other) = delete;
+
+    Task(Task&& other) noexcept
+        : m_Handle(std::exchange(other.m_Handle, nullptr))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_Handle)
+                m_Handle.destroy();
+            m_Handle = std::exchange(other.m_Handle, nullptr);
+        }
+        return *this;
+    }
+
+    // Empty (or false, for Task<>) if the task was cancelled.
+    using Result = typename promise_type::ResultType;
+
+    // Starts the task (if it hasn't finished already) and suspends until it's done, then returns its result.
+    auto operator co_await() const noexcept
+    {
+        struct Awaiter
+        {
+            Handle TaskHandle;
+
+            bool await_ready() const noexcept { return !TaskHandle || TaskHandle.promise().Finished; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+            {
+                TaskHandle.promise().Continuation = awaiter;
+                return TaskHandle;
+            }
+
+            Result await_resume() { return TaskHandle.promise().TakeResult(); }
+        };
+        return Awaiter{m_Handle};
+    }
+
+    // Like co_await, but only waits for the task to finish, leaving the result in place.
+    NODISCARD auto WhenReady() const noexcept
+    {
+        struct Awaiter
+        {
+            Handle TaskHandle;
+
+            bool await_ready() const noexcept { return !TaskHandle || TaskHandle.promise().Finished; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+            {
+                TaskHandle.promise().Continuation = awaiter;
+                return TaskHandle;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{m_Handle};
+    }
+
+    // Only valid once the task is done.
+    Result TakeResult()
+    {
+        MP_ASSERT(IsDone(), "Tried to take the result of an unfinished task");
+        return m_Handle.promise().TakeResult();
+    }
+
+    NODISCARD FORCEINLINE bool IsValid() const { return static_cast<bool>(m_Handle); }
+    NODISCARD FORCEINLINE bool IsDone() const { return m_Handle && m_Handle.promise().Finished; }
+    NODISCARD FORCEINLINE bool IsCancelled() const { return IsDone() && m_Handle.promise().Cancelled; }
+
+private:
+    Handle m_Handle;
+};
+
+template <typename T>
+Task<T> TaskDetail::Promise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+inline Task<void> TaskDetail::Promise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+// Awaitables and helpers for tasks. Unless a job system is given, these use the application's.
+class Async
+{
+public:
+    // Continues the awaiting task on a worker thread, or stops it if the token has been cancelled.
+    struct SwitchToWorkerAwaiter
+    {
+        JobSystem*        System;
+        CancellationToken Token;
+
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const
+        {
+            if (Token.IsCancelled())
+                return TaskDetail::StopCancelled(handle);
+
+            System->ScheduleResume(handle);
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // Continues the awaiting task on the main thread, next time the application processes main-thread jobs, or stops
+    // it if the token has been cancelled. Doesn't suspend at all if we're already on the main thread.
+    struct SwitchToMainThreadAwaiter
+    {
+        JobSystem*        System;
+        CancellationToken Token;
+
+        bool await_ready() const { return System->IsMainThread() && !Token.IsCancelled(); }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const
+        {
+            if (Token.IsCancelled())
+                return TaskDetail::StopCancelled(handle);
+
+            System->ScheduleResumeOnMainThread(handle);
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // Stops the awaiting task if Cancelled is set, and otherwise carries on without suspending.
+    struct CancelAwaiter
+    {
+        bool Cancelled;
+
+        bool await_ready() const noexcept { return !Cancelled; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            return TaskDetail::StopCancelled(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // Stops the awaiting task here, as cancelled. For passing on a cancelled task's result.
+    static CancelAwaiter Cancel() { return {true}; }
+    // Stops the awaiting task here if the token has been cancelled.
+    static CancelAwaiter StopIfCancelled(const CancellationToken& token) { return {token.IsCancelled()}; }
+
+    static SwitchToWorkerAwaiter SwitchToWorker(const CancellationToken& token = {})
+    {
+        return {&GetDefaultJobSystem(), token};
+    }
+
+    static SwitchToWorkerAwaiter SwitchToWorker(JobSystem& jobSystem, const CancellationToken& token = {})
+    {
+        return {&jobSystem, token};
+    }
+
+    static SwitchToMainThreadAwaiter SwitchToMainThread(const CancellationToken& token = {})
+    {
+        return {&GetDefaultJobSystem(), token};
+    }
+
+    static SwitchToMainThreadAwaiter SwitchToMainThread(JobSystem& jobSystem, const CancellationToken& token = {})
+    {
+        return {&jobSystem, token};
+    }
+
+    // Reads a whole file on a worker thread. Resumes on that worker; the caller owns (and must Release()) the buffer,
+    // which is empty if the file couldn't be read. Nothing is read if the token is cancelled before it gets there.
+    static Task<Buffer> ReadFile(std::filesystem::path path, CancellationToken token = {});
+    static Task<Buffer> ReadFile(JobSystem& jobSystem, std::filesystem::path path, CancellationToken token = {});
+
+    // Runs every task in parallel on the workers, and resumes once they've all finished. If any of them was
+    // cancelled, so is the whole; it still waits for the rest, so no task is left running.
+    static Task<> WhenAll(std::vector<Task<>> tasks) { return WhenAll(GetDefaultJobSystem(), std::move(tasks)); }
+
+    static Task<> WhenAll(JobSystem& jobSystem, std::vector<Task<>> tasks)
+    {
+        co_await WhenAllAwaiter<void>(jobSystem, tasks);
+        if (std::ranges::any_of(tasks, &Task<>::IsCancelled))
+            co_await Cancel();
+    }
+
+    template <typename T>
+    static Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks)
+    {
+        return WhenAll(GetDefaultJobSystem(), std::move(tasks));
+    }
+
+    template <typename T>
+    static Task<std::vector<T>> WhenAll(JobSystem& jobSystem, std::vector<Task<T>> tasks)
+    {
+        co_await WhenAllAwaiter<T>(jobSystem, tasks);
+        if (std::ranges::any_of(tasks, &Task<T>::IsCancelled))
+            co_await Cancel();
+
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for (Task<T>& task : tasks)
+            results.push_back(std::move(*task.TakeResult()));
+        co_return results;
+    }
+
+    // Starts a task and lets it run to completion on its own. If the job system shuts down first, whatever the task
+    // was waiting on is destroyed, along with the task.
+    static void Spawn(Task<> task) { Spawn(GetDefaultJobSystem(), std::move(task)); }
+    static void Spawn(JobSystem& jobSystem, Task<> task);
+
+    // Starts a task and blocks until it's finished, running other jobs (and main-thread jobs, if called from the main
+    // thread) in the meantime. Returns the task's result.
+    template <typename T>
+    static typename Task<T>::Result SyncWait(Task<T> task)
+    {
+        return SyncWait(GetDefaultJobSystem(), std::move(task));
+    }
+
+    template <typename T>
+    static typename Task<T>::Result SyncWait(JobSystem& jobSystem, Task<T> task)
+    {
+        std::atomic<bool> done = false;
+        SignalWhenReady(task, done);
+        jobSystem.WaitUntil([&done] { return done.load(std::memory_order_acquire); });
+        return task.TakeResult();
+    }
+
+    static JobSystem& GetDefaultJobSystem();
+
+private:
+    template <typename T>
+    class WhenAllAwaiter
+    {
+    public:
+        WhenAllAwaiter(JobSystem& jobSystem, std::vector<Task<T>>& tasks)
+            : m_JobSystem(jobSystem), m_Tasks(tasks), m_Latch(static_cast<u32>(tasks.size()))
+        {
+        }
+
+        bool await_ready() const noexcept { return m_Tasks.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> awaiter)
+        {
+            m_Latch.Awaiter = awaiter;
+
+            m_Entries.reserve(m_Tasks.size());
+            for (Task<T>& task : m_Tasks)
+                m_Entries.push_back(AwaitEntry(task));
+            for (TaskDetail::WhenAllEntry& entry : m_Entries)
+                entry.Start(m_Latch, m_JobSystem);
+
+            // Our own count - if every task has already finished, carry on without suspending.
+            return !m_Latch.CountDown();
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+        static TaskDetail::WhenAllEntry AwaitEntry(Task<T>& task)
+        {
+            co_await task.WhenReady();
+        }
+
+        JobSystem&                            m_JobSystem;
+        std::vector<Task<T>>&                 m_Tasks;
+        TaskDetail::WhenAllLatch              m_Latch;
+        std::vector<TaskDetail::WhenAllEntry> m_Entries;
+    };
+
+    static TaskDetail::SpawnedTask RunSpawned(Task<> task);
+
+    template <typename T>
+    static TaskDetail::DetachedTask SignalWhenReady(Task<T>& task, std::atomic<bool>& done)
+    {
+        co_await task.WhenReady();
+        done.store(true, std::memory_order_release);
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+// Chase-Lev work-stealing deque.
+// The owning thread pushes and pops at the bottom (LIFO, which keeps its working set hot in cache), while any other
+// thread can steal from the top (FIFO, so thieves take the oldest - and usually biggest - pieces of work).
+//
+// Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, 2013).
+// T must be trivially copyable, as elements are stored in atomics; in practice, it's a pointer.
+//
+// When the buffer fills up, it grows. Thieves may still be reading from the old buffer, so we keep retired buffers
+// alive until the deque is destroyed - they're tiny compared to the work they hold.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque elements must be trivially copyable");
+
+    explicit WorkStealingDeque(s64 initialCapacity = 256)
+    {
+        MP_ASSERT(initialCapacity > 0 && (initialCapacity & (initialCapacity - 1)) == 0,
+                  "Deque capacity must be a power of two");
+        m_Array.store(new RingArray(initialCapacity), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingDeque()
+    {
+        delete m_Array.load(std::memory_order_relaxed);
+        for (const RingArray* array : m_Retired)
+            delete array;
+    }
+
+    WorkStealingDeque(const WorkStealingDeque& other)                = delete;
+    WorkStealingDeque(WorkStealingDeque&& other) noexcept            = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque& other)     = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&& other) noexcept = delete;
+
+    // Owner thread only.
+    void Push(T item)
+    {
+        const s64  bottom = m_Bottom.load(std::memory_order_relaxed);
+        const s64  top    = m_Top.load(std::memory_order_acquire);
+        RingArray* array  = m_Array.load(std::memory_order_relaxed);
+
+        if (bottom - top > array->Capacity - 1)
+            array = Grow(array, bottom, top);
+
+        array->Put(bottom, item);
+        // The paper uses a release fence and a relaxed store here; a release store is equivalent, and sanitizers
+        // understand it.
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner thread only.
+    bool Pop(T& outItem)
+    {
+        const s64  bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        RingArray* array  = m_Array.load(std::memory_order_relaxed);
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s64 top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Empty.
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        outItem = array->Get(bottom);
+        if (top == bottom)
+        {
+            // Last item - race any thieves for it.
+            const bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                           std::memory_order_relaxed);
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    // Any thread.
+    bool Steal(T& outItem)
+    {
+        s64 top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const s64 bottom = m_Bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return false;
+
+        const RingArray* array = m_Array.load(std::memory_order_acquire);
+        T                item  = array->Get(top);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false; // Lost the race to another thief or the owner.
+
+        outItem = item;
+        return true;
+    }
+
+    // Approximate; only useful as a heuristic.
+    NODISCARD s64 Size() const
+    {
+        const s64 bottom = m_Bottom.load(std::memory_order_relaxed);
+        const s64 top    = m_Top.load(std::memory_order_relaxed);
+        return bottom > top ? bottom - top : 0;
+    }
+
+    NODISCARD bool IsEmpty() const { return Size() == 0; }
+
+private:
+    struct RingArray
+    {
+        explicit RingArray(s64 capacity)
+            : Capacity(capacity), Mask(capacity - 1), Items(new std::atomic<T>[capacity])
+        {
+        }
+
+        ~RingArray() { delete[] Items; }
+
+        FORCEINLINE T Get(s64 index) const { return Items[index & Mask].load(std::memory_order_relaxed); }
+        FORCEINLINE void Put(s64 index, T item) { Items[index & Mask].store(item, std::memory_order_relaxed); }
+
+        s64             Capacity;
+        s64             Mask;
+        std::atomic<T>* Items;
+    };
+
+    RingArray* Grow(RingArray* array, s64 bottom, s64 top)
+    {
+        RingArray* grown = new RingArray(array->Capacity * 2);
+        for (s64 i = top; i < bottom; i++)
+            grown->Put(i, array->Get(i));
+
+        m_Retired.push_back(array);
+        m_Array.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    // Top and bottom are written by different threads, so keep them on separate cache lines.
+    alignas(64) std::atomic<s64> m_Top    = 0;
+    alignas(64) std::atomic<s64> m_Bottom = 0;
+    alignas(64) std::atomic<RingArray*> m_Array;
+    std::vector<RingArray*> m_Retired; // Owner thread only.
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define MP_SSE 1
+#else
+#define MP_SSE 0
+#endif
+
+// Four floats, one per lane: an item from structure-of-arrays data, four at a time. SSE on x64 (where it's always
+// available), plain arrays elsewhere. Comparisons give masks with every bit of a lane set where true, for Select()
+// and the bitwise operators.
+struct Float4
+{
+#if MP_SSE
+    __m128 V;
+
+    static Float4 Load(const f32* data) { return {_mm_loadu_ps(data)}; }
+    static Float4 Splat(const f32 value) { return {_mm_set1_ps(value)}; }
+    static Float4 Set(const f32 a, const f32 b, const f32 c, const f32 d) { return {_mm_setr_ps(a, b, c, d)}; }
+    void          Store(f32* data) const { _mm_storeu_ps(data, V); }
+    // A bit per lane, set where the mask is.
+    NODISCARD u32 MoveMask() const { return static_cast<u32>(_mm_movemask_ps(V)); }
+
+    friend Float4 operator+(const Float4 a, const Float4 b) { return {_mm_add_ps(a.V, b.V)}; }
+    friend Float4 operator-(const Float4 a, const Float4 b) { return {_mm_sub_ps(a.V, b.V)}; }
+    friend Float4 operator*(const Float4 a, const Float4 b) { return {_mm_mul_ps(a.V, b.V)}; }
+    friend Float4 operator/(const Float4 a, const Float4 b) { return {_mm_div_ps(a.V, b.V)}; }
+    friend Float4 operator<(const Float4 a, const Float4 b) { return {_mm_cmplt_ps(a.V, b.V)}; }
+    friend Float4 operator>(const Float4 a, const Float4 b) { return {_mm_cmpgt_ps(a.V, b.V)}; }
+    friend Float4 operator>=(const Float4 a, const Float4 b) { return {_mm_cmpge_ps(a.V, b.V)}; }
+    friend Float4 operator&(const Float4 a, const Float4 b) { return {_mm_and_ps(a.V, b.V)}; }
+    friend Float4 operator|(const Float4 a, const Float4 b) { return {_mm_or_ps(a.V, b.V)}; }
+    friend Float4 Min(const Float4 a, const Float4 b) { return {_mm_min_ps(a.V, b.V)}; }
+    friend Float4 Max(const Float4 a, const Float4 b) { return {_mm_max_ps(a.V, b.V)}; }
+    friend Float4 Sqrt(const Float4 a) { return {_mm_sqrt_ps(a.V)}; }
+    // a where the mask is set, b elsewhere.
+    friend Float4 Select(const Float4 mask, const Float4 a, const Float4 b)
+    {
+        return {_mm_or_ps(_mm_and_ps(mask.V, a.V), _mm_andnot_ps(mask.V, b.V))};
+    }
+#else
+    std::array<f32, 4> V;
+
+    static Float4 Load(const f32* data) { return {{data[0], data[1], data[2], data[3]}}; }
+    static Float4 Splat(const f32 value) { return {{value, value, value, value}}; }
+    static Float4 Set(const f32 a, const f32 b, const f32 c, const f32 d) { return {{a, b, c, d}}; }
+    void          Store(f32* data) const { std::copy(V.begin(), V.end(), data); }
+
+    NODISCARD u32 MoveMask() const
+    {
+        u32 mask = 0;
+        for (u32 i = 0; i < 4; i++)
+            mask |= (std::bit_cast<u32>(V[i]) >> 31) << i;
+        return mask;
+    }
+
+    template <typename Operation>
+    static Float4 Apply(const Float4 a, const Float4 b, Operation operation)
+    {
+        Float4 result;
+        for (u32 i = 0; i < 4; i++)
+            result.V[i] = operation(a.V[i], b.V[i]);
+        return result;
+    }
+
+    static f32 ToMask(const bool value) { return std::bit_cast<f32>(value ? ~0u : 0u); }
+
+    friend Float4 operator+(const Float4 a, const Float4 b) { return Apply(a, b, std::plus()); }
+    friend Float4 operator-(const Float4 a, const Float4 b) { return Apply(a, b, std::minus()); }
+    friend Float4 operator*(const Float4 a, const Float4 b) { return Apply(a, b, std::multiplies()); }
+    friend Float4 operator/(const Float4 a, const Float4 b) { return Apply(a, b, std::divides()); }
+    friend Float4 operator<(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y) { return ToMask(x < y); });
+    }
+    friend Float4 operator>(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y) { return ToMask(x > y); });
+    }
+    friend Float4 operator>=(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y) { return ToMask(x >= y); });
+    }
+    friend Float4 operator&(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y)
+        {
+            return std::bit_cast<f32>(std::bit_cast<u32>(x) & std::bit_cast<u32>(y));
+        });
+    }
+    friend Float4 operator|(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y)
+        {
+            return std::bit_cast<f32>(std::bit_cast<u32>(x) | std::bit_cast<u32>(y));
+        });
+    }
+    friend Float4 Min(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y) { return std::min(x, y); });
+    }
+    friend Float4 Max(const Float4 a, const Float4 b)
+    {
+        return Apply(a, b, [](const f32 x, const f32 y) { return std::max(x, y); });
+    }
+    friend Float4 Sqrt(const Float4 a)
+    {
+        return Apply(a, a, [](const f32 x, f32) { return std::sqrt(x); });
+    }
+    friend Float4 Select(const Float4 mask, const Float4 a, const Float4 b)
+    {
+        Float4 result;
+        for (u32 i = 0; i < 4; i++)
+            result.V[i] = std::bit_cast<u32>(mask.V[i]) ? a.V[i] : b.V[i];
+        return result;
+    }
+#endif
+};
+
+// Four u32s, one per lane, for bit masks four at a time. Like Float4, SSE where it's available.
+struct UInt4
+{
+#if MP_SSE
+    __m128i V;
+
+    static UInt4 Load(const u32* data) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))}; }
+    static UInt4 Splat(const u32 value) { return {_mm_set1_epi32(static_cast<s32>(value))}; }
+    void         Store(u32* data) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), V); }
+
+    friend UInt4 operator&(const UInt4 a, const UInt4 b) { return {_mm_and_si128(a.V, b.V)}; }
+    friend UInt4 operator|(const UInt4 a, const UInt4 b) { return {_mm_or_si128(a.V, b.V)}; }
+    friend UInt4 operator<<(const UInt4 a, const s32 count) { return {_mm_slli_epi32(a.V, count)}; }
+    friend UInt4 operator>>(const UInt4 a, const s32 count) { return {_mm_srli_epi32(a.V, count)}; }
+    // a & ~b, in one instruction.
+    friend UInt4 AndNot(const UInt4 a, const UInt4 b) { return {_mm_andnot_si128(b.V, a.V)}; }
+#else
+    std::array<u32, 4> V;
+
+    static UInt4 Load(const u32* data) { return {{data[0], data[1], data[2], data[3]}}; }
+    static UInt4 Splat(const u32 value) { return {{value, value, value, value}}; }
+    void         Store(u32* data) const { std::copy(V.begin(), V.end(), data); }
+
+    template <typename Operation>
+    static UInt4 Apply(const UInt4 a, Operation operation)
+    {
+        UInt4 result;
+        for (u32 i = 0; i < 4; i++)
+            result.V[i] = operation(a.V[i], i);
+        return result;
+    }
+
+    friend UInt4 operator&(const UInt4 a, const UInt4 b)
+    {
+        return Apply(a, [&b](const u32 x, const u32 i) { return x & b.V[i]; });
+    }
+    friend UInt4 operator|(const UInt4 a, const UInt4 b)
+    {
+        return Apply(a, [&b](const u32 x, const u32 i) { return x | b.V[i]; });
+    }
+    friend UInt4 operator<<(const UInt4 a, const s32 count)
+    {
+        return Apply(a, [count](const u32 x, u32) { return x << count; });
+    }
+    friend UInt4 operator>>(const UInt4 a, const s32 count)
+    {
+        return Apply(a, [count](const u32 x, u32) { return x >> count; });
+    }
+    friend UInt4 AndNot(const UInt4 a, const UInt4 b)
+    {
+        return Apply(a, [&b](const u32 x, const u32 i) { return x & ~b.V[i]; });
+    }
+#endif
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+class Base64
+{
+public:
+    // Standard alphabet; '=' padding is optional, and whitespace (e.g. line breaks every 76 characters) is skipped.
+    // Returns false on any other character, or a stray '=' before the end.
+    static bool Decode(const std::string_view text, std::vector<u8>& bytes)
+    {
+        static constexpr std::array<u8, 256> table = []
+        {
+            std::array<u8, 256> result = {};
+            result.fill(Invalid);
+            constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (size_t i = 0; i < alphabet.size(); i++)
+                result[static_cast<u8>(alphabet[i])] = static_cast<u8>(i);
+            for (const char space : std::string_view(" \t\r\n"))
+                result[static_cast<u8>(space)] = Skip;
+            result['='] = Padding;
+            return result;
+        }();
+
+        bytes.clear();
+        bytes.reserve(text.size() / 4 * 3);
+
+        u32    bits     = 0;
+        u32    count    = 0;
+        size_t position = 0;
+        for (; position < text.size(); position++)
+        {
+            const u8 value = table[static_cast<u8>(text[position])];
+            if (value == Skip)
+                continue;
+            if (value == Padding)
+                break;
+            if (value == Invalid)
+                return false;
+
+            bits = bits << 6 | value;
+            if (++count == 4)
+            {
+                bytes.push_back(static_cast<u8>(bits >> 16));
+                bytes.push_back(static_cast<u8>(bits >> 8));
+                bytes.push_back(static_cast<u8>(bits));
+                bits  = 0;
+                count = 0;
+            }
+        }
+
+        // Nothing but padding and whitespace may follow the padding.
+        for (; position < text.size(); position++)
+        {
+            const u8 value = table[static_cast<u8>(text[position])];
+            if (value != Padding && value != Skip)
+                return false;
+        }
+
+        // A lone character left over can't make a whole byte.
+        if (count == 1)
+            return false;
+        if (count == 2)
+            bytes.push_back(static_cast<u8>(bits >> 4));
+        if (count == 3)
+        {
+            bytes.push_back(static_cast<u8>(bits >> 10));
+            bytes.push_back(static_cast<u8>(bits >> 2));
+        }
+        return true;
+    }
+
+private:
+    static constexpr u8 Invalid = 0xFF;
+    static constexpr u8 Skip    = 0xFE;
+    static constexpr u8 Padding = 0xFD;
+};
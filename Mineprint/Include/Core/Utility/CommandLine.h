@@ -0,0 +1,75 @@
+#pragma once
+
+#include <charconv>
+
+// Very small command line parser. Accepts "--flag", "--key=value" and "--key value" style arguments;
+// anything that doesn't start with "--" is stored as a positional argument.
+class CommandLine
+{
+public:
+    CommandLine() = default;
+
+    CommandLine(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string_view arg = argv[i];
+            if (!arg.starts_with("--"))
+            {
+                m_Positional.emplace_back(arg);
+                continue;
+            }
+
+            arg.remove_prefix(2);
+            const size_t equals = arg.find('=');
+            if (equals != std::string_view::npos)
+            {
+                m_Options[std::string(arg.substr(0, equals))] = std::string(arg.substr(equals + 1));
+            }
+            else if (i + 1 < argc && !std::string_view(argv[i + 1]).starts_with("--"))
+            {
+                // "--key value". Flags followed by a positional argument are ambiguous; use "--key=value" if that matters.
+                m_Options[std::string(arg)] = argv[++i];
+            }
+            else
+            {
+                m_Options[std::string(arg)] = "";
+            }
+        }
+    }
+
+    NODISCARD bool HasFlag(const std::string& name) const
+    {
+        return m_Options.contains(name);
+    }
+
+    NODISCARD std::string GetValue(const std::string& name, const std::string& defaultValue = "") const
+    {
+        const auto it = m_Options.find(name);
+        return it != m_Options.end() && !it->second.empty() ? it->second : defaultValue;
+    }
+
+    NODISCARD s64 GetInt(const std::string& name, s64 defaultValue = 0) const
+    {
+        const auto it = m_Options.find(name);
+        if (it == m_Options.end() || it->second.empty())
+            return defaultValue;
+
+        s64         value  = 0;
+        const char* end    = it->second.data() + it->second.size();
+        const auto  result = std::from_chars(it->second.data(), end, value);
+        if (result.ec != std::errc() || result.ptr != end)
+        {
+            MP_WARN("Invalid integer for command line option --{}: \"{}\"", name, it->second);
+            return defaultValue;
+        }
+
+        return value;
+    }
+
+    NODISCARD FORCEINLINE const std::vector<std::string>& GetPositional() const { return m_Positional; }
+
+private:
+    std::unordered_map<std::string, std::string> m_Options;
+    std::vector<std::string>                     m_Positional;
+};
@@ -69,4 +69,37 @@ public:
     {
         return ReadFileToAsciiString(path, false);
     }
+
+    // Writes a file under another name, then renames it over the path, so another instance (or a crash part way
+    // through) never leaves half of it there. write is given the open stream; the file is only kept if every write
+    // to it succeeded.
+    template <typename Writer>
+    static bool WriteFileAtomically(const std::filesystem::path &path, Writer &&write)
+    {
+        std::filesystem::path tempPath = path;
+        tempPath += fmt::format(".{}.tmp", SDL_GetTicksNS());
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (file.is_open())
+                write(file);
+            if (!file)
+            {
+                MP_WARN("Failed to write {}", tempPath.string());
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            MP_WARN("Failed to replace {}: {}", path.string(), error.message());
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
 };
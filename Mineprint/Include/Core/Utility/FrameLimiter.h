@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SDL3/SDL_timer.h>
+
+// Statistics gathered by the main loop, so we can see how much work the adaptive loop mode is saving us.
+struct FrameLoopStats
+{
+    u64 FramesRendered    = 0;
+    u64 FramesSkipped     = 0; // Frames we would have rendered (at the reference frame rate) while waiting for events.
+    f64 IdleMS            = 0; // Total time spent blocked waiting for events or sleeping for the frame cap.
+    f64 CPUTimeSavedMS    = 0; // Estimate: skipped frames multiplied by the average CPU cost of a rendered frame.
+    f64 AverageFrameCPUMS = 0; // Exponential moving average of the CPU time of a rendered frame (excluding sleeps).
+    f64 AverageLatencyMS  = 0; // Frame start to swap, when rendering serially. See RenderThreadStats for pipelined.
+
+    // Continuous mode frames where nothing invalidated the UI, so it wasn't rebuilt (see IdleFrameMode).
+    u64 IdleFrames            = 0;
+    f64 AverageIdleFrameCPUMS = 0; // Exponential moving average, like AverageFrameCPUMS.
+
+    void Reset() { *this = FrameLoopStats(); }
+};
+
+// Caps the frame rate by sleeping until the next frame deadline.
+// SDL_DelayPrecise sleeps for most of the remaining time and busy-waits the last fraction of a millisecond,
+// so we hit the deadline without the jitter of a plain SDL_Delay.
+class FrameLimiter
+{
+public:
+    FrameLimiter() = default;
+
+    void SetFrameRateCap(u16 fps);
+
+    // Marks the start of a frame, used as the reference point for the next deadline.
+    void BeginFrame();
+
+    // Sleeps until the frame deadline (if capped). Returns the time slept in milliseconds.
+    f64 WaitForNextFrame();
+    // Sleeps until the given time has passed since BeginFrame(), whether or not we're capped.
+    f64 WaitForFrameTime(u64 frameTimeNS);
+
+    NODISCARD FORCEINLINE u16 GetFrameRateCap() const { return m_FrameRateCap; }
+    NODISCARD FORCEINLINE bool IsCapped() const { return m_FrameRateCap > 0; }
+    NODISCARD FORCEINLINE u64 GetTargetFrameTimeNS() const { return m_TargetFrameTimeNS; }
+
+private:
+    u16 m_FrameRateCap      = 0;
+    u64 m_TargetFrameTimeNS = 0;
+    u64 m_FrameStartNS      = 0;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <optional>
+
+// A reference to an item in a HandlePool. Each slot's generation changes whenever its item is removed, so a handle
+// to something that's gone never finds whatever took its slot. Tag keeps handles to different pools apart.
+template <typename Tag>
+struct Handle
+{
+    u32 Index      = 0;
+    u32 Generation = 0; // Slots never use 0, so a default handle is always null.
+
+    NODISCARD FORCEINLINE bool IsNull() const { return Generation == 0; }
+
+    bool operator==(const Handle& other) const = default;
+};
+
+// Items stored by value in slots, looked up by Handle in O(1): an index and a generation check, no hashing. Removed
+// slots are reused (most recently freed first), so the storage only grows to the most items alive at once.
+//
+// Not thread-safe. Pointers from Get() are invalidated by Add().
+template <typename T, typename Tag>
+class HandlePool
+{
+public:
+    using HandleType = Handle<Tag>;
+
+    HandleType Add(T value)
+    {
+        u32 index;
+        if (!m_FreeSlots.empty())
+        {
+            index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<u32>(m_Slots.size());
+            m_Slots.emplace_back();
+        }
+
+        Slot& slot = m_Slots[index];
+        slot.Value = std::move(value);
+        slot.Alive = true;
+        m_Count++;
+        return {index, slot.Generation};
+    }
+
+    // Null if the handle is stale, or was never valid.
+    NODISCARD FORCEINLINE T* Get(const HandleType handle)
+    {
+        return Contains(handle) ? &m_Slots[handle.Index].Value : nullptr;
+    }
+
+    NODISCARD FORCEINLINE const T* Get(const HandleType handle) const
+    {
+        return Contains(handle) ? &m_Slots[handle.Index].Value : nullptr;
+    }
+
+    NODISCARD FORCEINLINE bool Contains(const HandleType handle) const
+    {
+        return handle.Index < m_Slots.size() && m_Slots[handle.Index].Alive &&
+               m_Slots[handle.Index].Generation == handle.Generation;
+    }
+
+    // Takes the item out, invalidating every handle to it. Nothing if the handle is stale.
+    std::optional<T> Remove(const HandleType handle)
+    {
+        if (!Contains(handle))
+            return std::nullopt;
+
+        Slot& slot = m_Slots[handle.Index];
+        T     value = std::move(slot.Value);
+        slot.Value  = T();
+        slot.Alive  = false;
+        // Skip 0 when it wraps, so old handles can't come back to life as null ones.
+        slot.Generation = slot.Generation == UINT32_MAX ? 1 : slot.Generation + 1;
+        m_FreeSlots.push_back(handle.Index);
+        m_Count--;
+        return value;
+    }
+
+    // Calls function(handle, item) for every item, in slot order.
+    template <typename Function>
+    void ForEach(Function&& function)
+    {
+        for (u32 i = 0; i < static_cast<u32>(m_Slots.size()); i++)
+        {
+            if (m_Slots[i].Alive)
+                function(HandleType{i, m_Slots[i].Generation}, m_Slots[i].Value);
+        }
+    }
+
+    // Removes everything. Outstanding handles stay invalid, even once their slots are reused.
+    void Clear()
+    {
+        for (u32 i = 0; i < static_cast<u32>(m_Slots.size()); i++)
+        {
+            if (m_Slots[i].Alive)
+                Remove({i, m_Slots[i].Generation});
+        }
+    }
+
+    void Reserve(const u32 count)
+    {
+        m_Slots.reserve(count);
+        m_FreeSlots.reserve(count);
+    }
+
+    NODISCARD FORCEINLINE u32 GetCount() const { return m_Count; }
+    NODISCARD FORCEINLINE u32 GetCapacity() const { return static_cast<u32>(m_Slots.size()); }
+
+private:
+    struct Slot
+    {
+        T    Value      = T();
+        u32  Generation = 1;
+        bool Alive      = false;
+    };
+
+    std::vector<Slot> m_Slots;
+    std::vector<u32>  m_FreeSlots;
+    u32               m_Count = 0;
+};
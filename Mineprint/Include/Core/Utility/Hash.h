@@ -0,0 +1,38 @@
+#pragma once
+
+// 64-bit FNV-1a, for cache keys and lookups: quick, and spreads similar inputs well, but not meant to stand up to
+// anyone trying to collide it. Each function continues from the hash it's given; start from Hash::Offset.
+class Hash
+{
+public:
+    static constexpr u64 Offset = 0xCBF29CE484222325ull;
+    static constexpr u64 Prime  = 0x100000001B3ull;
+
+    NODISCARD static u64 Bytes(u64 hash, const void* data, const size_t size)
+    {
+        const u8* bytes = static_cast<const u8*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= Prime;
+        }
+        return hash;
+    }
+
+    NODISCARD static constexpr u64 String(u64 hash, const std::string_view text)
+    {
+        for (const char c : text)
+        {
+            hash ^= static_cast<u8>(c);
+            hash *= Prime;
+        }
+        return hash;
+    }
+
+    // A string and its terminating zero, for keys made of several: moving text from the end of one string to the
+    // start of the next changes the hash.
+    NODISCARD static constexpr u64 Field(const u64 hash, const std::string_view text)
+    {
+        return String(hash, text) * Prime;
+    }
+};
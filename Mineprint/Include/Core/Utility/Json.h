@@ -0,0 +1,103 @@
+#pragma once
+
+#include <span>
+
+enum class JsonType : u8
+{
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+inline const char* JsonTypeToString(const JsonType type)
+{
+    switch (type)
+    {
+    case JsonType::Null:
+        return "Null";
+    case JsonType::Bool:
+        return "Bool";
+    case JsonType::Number:
+        return "Number";
+    case JsonType::String:
+        return "String";
+    case JsonType::Array:
+        return "Array";
+    case JsonType::Object:
+        return "Object";
+    default:
+        return "Unknown";
+    }
+}
+
+// A parsed JSON document, or any value within one. Read-only once parsed: it's for loading files, not writing them.
+//
+// Lookups never fail: a missing key, an index past the end, or asking a value for the wrong type gives null (or the
+// fallback), so reading optional fields deep in a document doesn't need a check at every level. Objects keep their
+// members in file order, and finding a key is a linear search, which is quick for the handful of keys most have.
+class JsonValue
+{
+public:
+    // Deeper than this, and parsing fails rather than risking the stack.
+    static constexpr u32 MaxDepth = 256;
+
+    JsonValue() = default;
+
+    // Parses a whole document (anything but whitespace after the value is an error). On failure, error says what was
+    // wrong, and the line and column it was found at.
+    static bool Parse(std::string_view text, JsonValue& value, std::string& error);
+
+    // Null if the key isn't there, or this isn't an object. With duplicate keys, the first wins.
+    NODISCARD const JsonValue& operator[](std::string_view key) const;
+    // Null if the index is out of range, or this isn't an array.
+    NODISCARD const JsonValue& operator[](size_t index) const;
+    // Null if the key isn't there.
+    NODISCARD const JsonValue* Find(std::string_view key) const;
+
+    // The value, or the fallback if it's of another type.
+    NODISCARD FORCEINLINE bool AsBool(const bool fallback = false) const
+    {
+        return m_Type == JsonType::Bool ? m_Bool : fallback;
+    }
+
+    NODISCARD FORCEINLINE f64 AsNumber(const f64 fallback = 0.0) const
+    {
+        return m_Type == JsonType::Number ? m_Number : fallback;
+    }
+
+    NODISCARD FORCEINLINE f32 AsFloat(const f32 fallback = 0.0f) const
+    {
+        return m_Type == JsonType::Number ? static_cast<f32>(m_Number) : fallback;
+    }
+
+    NODISCARD FORCEINLINE std::string_view AsString(const std::string_view fallback = {}) const
+    {
+        return m_Type == JsonType::String ? std::string_view(m_String) : fallback;
+    }
+
+    NODISCARD FORCEINLINE JsonType GetType() const { return m_Type; }
+    NODISCARD FORCEINLINE bool     IsNull() const { return m_Type == JsonType::Null; }
+    NODISCARD FORCEINLINE bool     IsBool() const { return m_Type == JsonType::Bool; }
+    NODISCARD FORCEINLINE bool     IsNumber() const { return m_Type == JsonType::Number; }
+    NODISCARD FORCEINLINE bool     IsString() const { return m_Type == JsonType::String; }
+    NODISCARD FORCEINLINE bool     IsArray() const { return m_Type == JsonType::Array; }
+    NODISCARD FORCEINLINE bool     IsObject() const { return m_Type == JsonType::Object; }
+
+    // An array's elements, or an object's values (in the same order as GetKeys()). Empty for anything else.
+    NODISCARD FORCEINLINE std::span<const JsonValue>   GetElements() const { return m_Elements; }
+    NODISCARD FORCEINLINE std::span<const std::string> GetKeys() const { return m_Keys; }
+    NODISCARD FORCEINLINE size_t                       GetSize() const { return m_Elements.size(); }
+
+private:
+    struct Parser;
+
+    JsonType                 m_Type   = JsonType::Null;
+    bool                     m_Bool   = false;
+    f64                      m_Number = 0.0;
+    std::string              m_String;
+    std::vector<JsonValue>   m_Elements;
+    std::vector<std::string> m_Keys; // Objects only, one per element.
+};
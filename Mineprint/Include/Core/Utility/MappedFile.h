@@ -0,0 +1,36 @@
+#pragma once
+
+#include <span>
+
+// A read-only view of a whole file, mapped into memory. Pages are read in by the OS as they're touched, and shared
+// with its file cache, so reading a file this way never copies it into a buffer of our own. The data stays valid
+// until the file is closed (or this is destroyed); it's mapped page-aligned, so offsets into it keep their alignment.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Closes anything already open. Empty files open fine, with no data.
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    NODISCARD FORCEINLINE bool                IsOpen() const { return m_Open; }
+    NODISCARD FORCEINLINE const u8*           GetData() const { return m_Data; }
+    NODISCARD FORCEINLINE size_t              GetSize() const { return m_Size; }
+    NODISCARD FORCEINLINE std::span<const u8> GetBytes() const { return {m_Data, m_Size}; }
+
+private:
+    const u8* m_Data = nullptr;
+    size_t    m_Size = 0;
+    bool      m_Open = false;
+#ifdef MP_PLATFORM_WINDOWS
+    void* m_File    = nullptr; // HANDLEs, kept as void* so Windows.h stays out of the header.
+    void* m_Mapping = nullptr;
+#endif
+};
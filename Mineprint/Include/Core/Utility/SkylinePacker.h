@@ -0,0 +1,133 @@
+#pragma once
+
+// Packs rectangles into a fixed-size area with the skyline bottom-left heuristic: it tracks the top edge of what's
+// been placed so far as a list of horizontal segments, and puts each rectangle where its bottom lands lowest (then on
+// the narrowest segment, to keep the skyline flat). Space left under an overhang is lost, which is a few percent for
+// similar-sized rectangles fed in tallest first, and packing is O(segments) per rectangle.
+//
+// Coordinates are in whatever units the caller likes (TextureAtlas packs in alignment-sized cells).
+class SkylinePacker
+{
+public:
+    SkylinePacker() = default;
+
+    SkylinePacker(const u32 width, const u32 height)
+    {
+        Init(width, height);
+    }
+
+    void Init(const u32 width, const u32 height)
+    {
+        m_Width    = width;
+        m_Height   = height;
+        m_UsedArea = 0;
+        m_Skyline.clear();
+        m_Skyline.push_back({0, 0, width});
+    }
+
+    // Finds room for a width x height rectangle, and returns its top-left corner. Returns false if it doesn't fit.
+    bool Pack(const u32 width, const u32 height, glm::uvec2& position)
+    {
+        if (width == 0 || height == 0 || width > m_Width || height > m_Height)
+            return false;
+
+        size_t bestIndex = m_Skyline.size();
+        u32    bestY     = UINT32_MAX;
+        u32    bestWidth = UINT32_MAX;
+        for (size_t i = 0; i < m_Skyline.size(); i++)
+        {
+            u32 y;
+            if (!Fits(i, width, height, y))
+                continue;
+            if (y < bestY || (y == bestY && m_Skyline[i].Width < bestWidth))
+            {
+                bestIndex = i;
+                bestY     = y;
+                bestWidth = m_Skyline[i].Width;
+            }
+        }
+
+        if (bestIndex == m_Skyline.size())
+            return false;
+
+        position = {m_Skyline[bestIndex].X, bestY};
+        Place(bestIndex, position, width, height);
+        m_UsedArea += static_cast<u64>(width) * height;
+        return true;
+    }
+
+    NODISCARD FORCEINLINE u32 GetWidth() const { return m_Width; }
+    NODISCARD FORCEINLINE u32 GetHeight() const { return m_Height; }
+    // Fraction of the area covered by packed rectangles.
+    NODISCARD FORCEINLINE f32 GetOccupancy() const
+    {
+        const u64 area = static_cast<u64>(m_Width) * m_Height;
+        return area > 0 ? static_cast<f32>(static_cast<f64>(m_UsedArea) / static_cast<f64>(area)) : 0.0f;
+    }
+
+private:
+    struct Segment
+    {
+        u32 X;
+        u32 Y; // Top of everything placed under this segment, growing downwards.
+        u32 Width;
+    };
+
+    // Whether the rectangle fits with its left edge on segment index, and if so, at which y.
+    NODISCARD bool Fits(size_t index, const u32 width, const u32 height, u32& y) const
+    {
+        if (m_Skyline[index].X + width > m_Width)
+            return false;
+
+        y             = 0;
+        u32 widthLeft = width;
+        while (widthLeft > 0)
+        {
+            y = std::max(y, m_Skyline[index].Y);
+            if (y + height > m_Height)
+                return false;
+            widthLeft -= std::min(widthLeft, m_Skyline[index].Width);
+            index++;
+        }
+        return true;
+    }
+
+    void Place(const size_t index, const glm::uvec2& position, const u32 width, const u32 height)
+    {
+        m_Skyline.insert(m_Skyline.begin() + static_cast<ptrdiff_t>(index), {position.x, position.y + height, width});
+
+        // Trim the segments the new one covers.
+        const u32 right = position.x + width;
+        size_t    next  = index + 1;
+        while (next < m_Skyline.size() && m_Skyline[next].X < right)
+        {
+            Segment&  segment    = m_Skyline[next];
+            const u32 segmentEnd = segment.X + segment.Width;
+            if (segmentEnd <= right)
+            {
+                m_Skyline.erase(m_Skyline.begin() + static_cast<ptrdiff_t>(next));
+                continue;
+            }
+            segment.Width = segmentEnd - right;
+            segment.X     = right;
+            break;
+        }
+
+        // Merge neighbours at the same height, so the list stays short.
+        for (size_t i = 0; i + 1 < m_Skyline.size();)
+        {
+            if (m_Skyline[i].Y == m_Skyline[i + 1].Y)
+            {
+                m_Skyline[i].Width += m_Skyline[i + 1].Width;
+                m_Skyline.erase(m_Skyline.begin() + static_cast<ptrdiff_t>(i + 1));
+            }
+            else
+                i++;
+        }
+    }
+
+    u32                  m_Width    = 0;
+    u32                  m_Height   = 0;
+    u64                  m_UsedArea = 0;
+    std::vector<Segment> m_Skyline;
+};
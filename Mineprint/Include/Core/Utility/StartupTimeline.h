@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+
+// Records what happens during startup, on which thread, and when, so we can see where a cold start goes.
+// Spans can be nested, and can run on any thread. When one thread has to wait for work on another (e.g. the main
+// thread waiting for the font atlas), record it with AddDependency(), so the critical path report can follow it.
+//
+// Finish() prints the timeline and the critical path: the chain of spans that actually determined how long startup
+// took. Anything off that path could get slower without startup getting any slower.
+class StartupTimeline
+{
+public:
+    static constexpr u32 InvalidSpan = ~0u;
+
+    // Starts a new timeline, with times measured from now. Safe to call again (e.g. after a full restart).
+    static void Start();
+    // Prints the report and stops recording. Only the first call after Start() does anything.
+    static void Finish();
+
+    static u32  BeginSpan(std::string_view name);
+    static void EndSpan(u32 span);
+    // Records that span had to wait for dependency to finish before it could carry on.
+    static void AddDependency(u32 span, u32 dependency);
+
+    NODISCARD static bool IsRecording();
+
+    // Ends the span when it goes out of scope.
+    class Scope
+    {
+    public:
+        explicit Scope(std::string_view name)
+            : m_Span(BeginSpan(name))
+        {
+        }
+
+        ~Scope() { EndSpan(m_Span); }
+
+        Scope(const Scope& other)                = delete;
+        Scope(Scope&& other) noexcept            = delete;
+        Scope& operator=(const Scope& other)     = delete;
+        Scope& operator=(Scope&& other) noexcept = delete;
+
+        NODISCARD FORCEINLINE u32 GetSpan() const { return m_Span; }
+
+    private:
+        u32 m_Span;
+    };
+
+private:
+    struct Span
+    {
+        std::string      Name;
+        u32              Thread  = 0; // 0 is the thread that called Start().
+        u64              StartNS = 0;
+        u64              EndNS   = 0;
+        std::vector<u32> Dependencies;
+    };
+
+    static void PrintReport();
+    static u32  GetThreadIndex();
+    // Spans that aren't nested inside another span on the same thread.
+    static u32 GetTopLevelSpan(u32 span);
+
+    static std::mutex                   s_Mutex;
+    static std::vector<Span>            s_Spans;
+    static std::vector<std::thread::id> s_Threads;
+    static u64                          s_StartNS;
+    static bool                         s_Recording;
+};
+
+#define STARTUP_SCOPE(name) StartupTimeline::Scope CAT(startupScope, __LINE__)(name)
@@ -87,7 +87,8 @@ struct LoggingScopedTimer
     }
 
 private:
-    static s32 m_TimerDepth;
+    // Per thread, as timers on different threads don't nest.
+    inline static thread_local s32 m_TimerDepth = 0;
 
     std::string_view m_Name;
     u64 m_Start;
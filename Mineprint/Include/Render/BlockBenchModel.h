@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Render/Mesh.h"
+#include "Render/MeshOptimizer.h"
+#include "Render/MeshSimplifier.h"
+#include "Render/TextureAtlas.h"
+
+class JobSystem;
+class JsonValue;
+
+struct BlockBenchModelSpecification
+{
+    // Where baked models are kept, named by a hash of the .bbmodel's contents (empty to always bake them).
+    std::filesystem::path CacheDirectory;
+    // From BlockBench's units (16 to a block) to the baked mesh's. The default makes a block one unit across.
+    f32 Scale = 1.0f / 16.0f;
+    // Leave out elements and groups that are hidden, or not exported, in BlockBench.
+    bool SkipHidden = true;
+    // The model's textures are packed into an atlas of their own. Models have few textures, so pages start small.
+    TextureAtlasSpecification Atlas = {.MinPageSize = 64, .Folders = {}};
+    // Reorder the baked mesh for the GPU's vertex caches (see MeshOptimizer) before it's cached.
+    bool Optimize = true;
+    // Simplified LODs to bake after the full mesh (see MeshSimplifier). None by default: models built only from cubes
+    // are all seams, so trying takes most of the bake and rarely finds a LOD worth keeping.
+    MeshSimplifierSpecification LODs = {.MaxLODs = 0};
+    // Upload quantised vertices, at half the size; draw them with Mesh.vert built with QUANTIZED. The CPU copy keeps
+    // full vertices.
+    bool Quantize = false;
+};
+
+struct BlockBenchModelStats
+{
+    u32  Cubes     = 0;
+    u32  Meshes    = 0; // BlockBench's free-form mesh elements.
+    u32  Skipped   = 0; // Elements that were hidden, or of a type that has no geometry (locators and the like).
+    u32  Faces     = 0;
+    u32  Vertices  = 0;
+    u32  Indices   = 0;
+    u32  Textures  = 0;
+    bool FromCache = false;
+    f64  ReadMS    = 0; // Reading and hashing the file.
+    f64  ParseMS   = 0;
+    f64  DecodeMS  = 0; // The embedded textures.
+    f64  BakeMS    = 0; // Geometry and the texture atlas.
+    f64  CacheMS   = 0; // Loading the baked model, or saving a new one.
+
+    // Filled in when the model is baked (not when it's loaded from the cache), and by Upload() if it quantises.
+    MeshOptimizationStats   Optimization;
+    MeshSimplificationStats Simplification; // Only when baked.
+
+    void Reset() { *this = BlockBenchModelStats(); }
+};
+
+// A model from BlockBench (a .bbmodel: JSON, with its textures embedded as base64 PNGs), baked into one vertex and
+// index buffer plus a texture atlas, ready to draw.
+//
+// Cubes are baked with BlockBench's face UVs and UV rotations, and free-form mesh elements are triangulated. Element
+// and group rotations are applied around their pivots, Z then Y then X as BlockBench does. UVs are remapped into the
+// atlas, and indices are grouped into a submesh per atlas layer, whose MaterialIndex is the layer. Faces without a
+// texture are left out, as they are from BlockBench's own exports.
+//
+// Baking is on the CPU, with the textures decoded in parallel over the job system. With a cache directory, the baked
+// result is saved under a hash of the file's contents, so opening an unchanged model again only reads the file to
+// hash it - the JSON isn't parsed. Nothing touches GL until Upload(), which must be called on the thread that owns
+// the GL context.
+//
+// LODs, if any, are baked and cached along with it. Their indices follow the full mesh's in the same index buffer, so
+// drawing one is only a matter of drawing GetLODSubMeshes() instead of GetSubMeshes().
+class BlockBenchModel
+{
+public:
+    // Bump when baking changes, to ignore older cached models.
+    static constexpr u16 Version = 4;
+
+    BlockBenchModel() = default;
+    ~BlockBenchModel();
+
+    BlockBenchModel(const BlockBenchModel& other)                = delete;
+    BlockBenchModel(BlockBenchModel&& other) noexcept            = delete;
+    BlockBenchModel& operator=(const BlockBenchModel& other)     = delete;
+    BlockBenchModel& operator=(BlockBenchModel&& other) noexcept = delete;
+
+    // Loads a .bbmodel, from the cache if it's been baked before. Textures stored as paths rather than embedded are
+    // looked for relative to the model's folder.
+    bool Load(const BlockBenchModelSpecification& spec, const std::filesystem::path& path, JobSystem& jobs);
+    // Bakes a model from its JSON. Replaces anything already baked (but not what's on the GPU; call Upload() again).
+    bool Bake(const BlockBenchModelSpecification& spec, std::string_view json, JobSystem& jobs,
+              const std::filesystem::path& folder = {});
+
+    // The baked model, and the key it must be loaded with. Load() fails if the files are missing, corrupt, or were
+    // saved with a different key or version. The atlas is saved next to it, with ".atlas" on the end.
+    bool SaveBaked(const std::filesystem::path& path, u64 key) const;
+    bool LoadBaked(const std::filesystem::path& path, u64 key);
+
+    // Creates (or replaces) the buffers and the texture array, which the resources must outlive. Quantises the
+    // vertices on the way, if the model was loaded with Quantize set.
+    bool Upload(GPUResources& resources);
+    // Frees the CPU copies of the vertices, indices and texture pixels, once uploaded. Submeshes and bounds are kept.
+    void ReleaseCPUData();
+    // GL objects are deleted once the frames in flight are done with them.
+    void Shutdown();
+
+    // The key a .bbmodel's baked result is cached under, from its contents and the settings that affect baking.
+    NODISCARD static u64 GetCacheKey(const BlockBenchModelSpecification& spec, std::span<const u8> contents);
+
+    // The submeshes of a LOD: 0 for the full mesh, and 1 onwards for GetLODs()[lod - 1]. The full mesh if there's no
+    // such LOD.
+    NODISCARD const std::vector<SubMesh>& GetLODSubMeshes(u32 lod) const;
+    // The coarsest LOD that stays within maxPixelError pixels of the full mesh on screen (see MeshSimplifier).
+    NODISCARD u32 SelectLOD(const f32 pixelsPerUnit, const f32 maxPixelError = 1.0f) const
+    {
+        return MeshSimplifier::SelectLOD(m_LODs, pixelsPerUnit, maxPixelError);
+    }
+
+    NODISCARD FORCEINLINE bool                           IsBaked() const { return !m_SubMeshes.empty(); }
+    NODISCARD FORCEINLINE const std::string&             GetName() const { return m_Name; }
+    NODISCARD FORCEINLINE const std::vector<MeshVertex>& GetVertices() const { return m_Vertices; }
+    NODISCARD FORCEINLINE const std::vector<u32>&        GetIndices() const { return m_Indices; }
+    NODISCARD FORCEINLINE const std::vector<SubMesh>&    GetSubMeshes() const { return m_SubMeshes; }
+    NODISCARD FORCEINLINE const std::vector<MeshLOD>&    GetLODs() const { return m_LODs; }
+    NODISCARD FORCEINLINE const glm::vec3&               GetBoundsMin() const { return m_BoundsMin; }
+    NODISCARD FORCEINLINE const glm::vec3&               GetBoundsMax() const { return m_BoundsMax; }
+    NODISCARD FORCEINLINE const TextureAtlas&            GetAtlas() const { return m_Atlas; }
+    NODISCARD FORCEINLINE const GPUMesh&                 GetMesh() const { return m_Mesh; }
+    NODISCARD FORCEINLINE const BlockBenchModelStats&    GetStats() const { return m_Stats; }
+
+private:
+    struct CacheHeader
+    {
+        u32       Magic;
+        u16       Version;
+        u16       LODCount;
+        u64       Key;
+        u32       VertexCount;
+        u32       IndexCount;
+        u32       SubMeshCount;
+        u32       NameBytes;
+        glm::vec3 BoundsMin;
+        glm::vec3 BoundsMax;
+    };
+
+    // A texture as the faces see it: its atlas region, and the size its UVs are given in.
+    struct FaceTexture
+    {
+        const AtlasRegion* Region = nullptr; // Null if it couldn't be loaded; faces using it are left out.
+        glm::vec2          UVSize = {16.0f, 16.0f};
+    };
+
+    static constexpr u32 Magic = 0x4242504D; // "MPBB"
+
+    bool LoadTextures(const BlockBenchModelSpecification& spec, const JsonValue& root,
+                      const std::filesystem::path& folder, JobSystem& jobs, std::vector<FaceTexture>& textures);
+    void Clear();
+
+    std::string             m_Name;
+    std::vector<MeshVertex> m_Vertices;
+    std::vector<u32>        m_Indices;
+    std::vector<SubMesh>    m_SubMeshes;
+    std::vector<MeshLOD>    m_LODs;
+    glm::vec3               m_BoundsMin = glm::vec3(0.0f);
+    glm::vec3               m_BoundsMax = glm::vec3(0.0f);
+    bool                    m_Quantize  = false;
+
+    TextureAtlas         m_Atlas;
+    GPUMesh              m_Mesh;
+    BlockBenchModelStats m_Stats;
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <span>
+
+#include "Render/RenderQueue.h"
+#include "Render/Shader.h"
+#include "Render/WireGeometry.h"
+
+// Draw order on the canvas. Each non-empty layer is one instanced draw, and Overlay is drawn after every node (for
+// selection boxes and the like). Within a layer, shapes are drawn in the order they were added.
+enum class CanvasLayer : u8
+{
+    Nodes,
+    Overlay,
+    Count
+};
+
+inline const char* CanvasLayerToString(const CanvasLayer layer)
+{
+    switch (layer)
+    {
+    case CanvasLayer::Nodes:
+        return "Nodes";
+    case CanvasLayer::Overlay:
+        return "Overlay";
+    default:
+        return "Unknown";
+    }
+}
+
+// One shape, as uploaded to the GPU: a rounded rectangle, drawn as a quad and shaded with a signed distance function,
+// so corners and borders stay crisp at any zoom. A circle is a square with every corner radius at half its size.
+struct CanvasInstance
+{
+    glm::vec2 Min; // Canvas units, y down.
+    glm::vec2 Max;
+    u32       CornerRadii  = 0; // A byte each (see PackCornerRadii()), in canvas units.
+    u32       FillColour   = 0; // IM_COL32 layout.
+    u32       BorderColour = 0;
+    f32       BorderWidth  = 0;
+
+    // Radii are clamped to 255 canvas units; the shader also clamps them to half the shape's size.
+    NODISCARD static u32 PackCornerRadii(f32 topLeft, f32 topRight, f32 bottomRight, f32 bottomLeft);
+    NODISCARD static u32 PackCornerRadii(const f32 radius) { return PackCornerRadii(radius, radius, radius, radius); }
+};
+
+static_assert(sizeof(CanvasInstance) == 32, "CanvasInstance must match the vertex layout in CanvasRenderer");
+
+// A node as the canvas draws it: a body with a border, a header strip, and pins down each side below the header.
+struct CanvasNode
+{
+    FRect Bounds       = {0.0f, 0.0f, 0.0f, 0.0f};
+    f32   HeaderHeight = 24.0f;
+    f32   CornerRadius = 6.0f;
+    u32   BodyColour   = 0xFF303030;
+    u32   HeaderColour = 0xFF7A4A2A;
+    u32   BorderColour = 0xFF5A5A5A;
+    u32   PinColour    = 0xFFC8C8C8;
+    u8    InputPins    = 0;
+    u8    OutputPins   = 0;
+};
+
+struct CanvasStats
+{
+    u32 Nodes        = 0;
+    u32 CulledNodes  = 0;
+    u32 LODNodes     = 0; // Drawn as a single flat rectangle, as they were too small on screen for any detail.
+    u32 Shapes       = 0; // Shapes added directly, rather than as part of a node.
+    u32 CulledShapes = 0;
+    u32 Instances    = 0;
+
+    void Reset() { *this = CanvasStats(); }
+};
+
+// Builds a frame's worth of canvas instances on the CPU, culled against the visible area. Doesn't touch GL, so it can
+// be filled on any thread (and benchmarked headless); hand it to CanvasRenderer::Submit() to draw it.
+//
+// The batch keeps its allocations between frames, so once it's warmed up Begin() and adding shapes don't allocate.
+class CanvasBatch
+{
+public:
+    static constexpr f32 PinRadius  = 5.0f;
+    static constexpr f32 PinSpacing = 22.0f;
+    // Nodes shorter than this many pixels on screen are drawn as a flat rectangle with no header, border or pins.
+    static constexpr f32 LODNodePixels = 12.0f;
+
+    // Starts a new frame. view is the area of the canvas that fills the viewport, in canvas units.
+    void Begin(const FRect& view, const glm::vec2& viewportSize);
+
+    // Shapes that are entirely outside the view are dropped here, so they never reach the GPU.
+    void DrawShape(const CanvasInstance& shape, CanvasLayer layer = CanvasLayer::Nodes);
+    void DrawRect(const FRect& rect, u32 fillColour, f32 cornerRadius = 0.0f, CanvasLayer layer = CanvasLayer::Nodes);
+    void DrawCircle(const glm::vec2& centre, f32 radius, u32 fillColour, CanvasLayer layer = CanvasLayer::Nodes);
+    void DrawNode(const CanvasNode& node);
+    void DrawNodes(std::span<const CanvasNode> nodes);
+
+    NODISCARD FORCEINLINE std::span<const CanvasInstance> GetInstances(const CanvasLayer layer) const
+    {
+        return m_Instances[static_cast<size_t>(layer)];
+    }
+
+    NODISCARD FORCEINLINE const FRect&       GetView() const { return m_View; }
+    NODISCARD FORCEINLINE f32                GetPixelsPerUnit() const { return m_PixelsPerUnit; }
+    NODISCARD FORCEINLINE const CanvasStats& GetStats() const { return m_Stats; }
+
+private:
+    NODISCARD FORCEINLINE bool IsVisible(const glm::vec2& min, const glm::vec2& max) const
+    {
+        return min.x < m_ViewMax.x && max.x > m_ViewMin.x && min.y < m_ViewMax.y && max.y > m_ViewMin.y;
+    }
+
+    FORCEINLINE void Add(const CanvasInstance& instance, const CanvasLayer layer)
+    {
+        m_Instances[static_cast<size_t>(layer)].push_back(instance);
+    }
+
+    FRect     m_View          = {0.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec2 m_ViewMin       = {};
+    glm::vec2 m_ViewMax       = {};
+    f32       m_PixelsPerUnit = 1.0f;
+
+    std::array<std::vector<CanvasInstance>, static_cast<size_t>(CanvasLayer::Count)> m_Instances;
+    CanvasStats                                                                     m_Stats;
+};
+
+// Draws CanvasBatches with one instanced draw call per layer, and WireBatches with one indexed draw, through the
+// renderer's queue. The geometry is streamed through the queue (see RenderQueue::AllocateStream()), so the Submit
+// functions can be called on the main thread.
+//
+// Init() and Shutdown() must be called on the thread that owns the GL context.
+class CanvasRenderer
+{
+public:
+    // Arbitrary, but fixed, so canvas draws sort together. Wires sort first, so they're drawn under the nodes.
+    static constexpr u16 SortShaderID     = 0x100;
+    static constexpr u16 WireSortShaderID = SortShaderID - 1;
+
+    CanvasRenderer() = default;
+    ~CanvasRenderer();
+
+    CanvasRenderer(const CanvasRenderer& other)                = delete;
+    CanvasRenderer(CanvasRenderer&& other) noexcept            = delete;
+    CanvasRenderer& operator=(const CanvasRenderer& other)     = delete;
+    CanvasRenderer& operator=(CanvasRenderer&& other) noexcept = delete;
+
+    // Shaders are loaded through the cache, if there is one. With a compiler, they're built in the background, and
+    // draws use the fallback until they're ready. GL objects are created in the resources, which must outlive this.
+    bool Init(GPUResources& resources, ShaderCache* shaderCache = nullptr, ShaderCompiler* compiler = nullptr,
+              const Shader* fallback = nullptr);
+    void Shutdown();
+
+    // The batch's view is stretched over the whole viewport. Does nothing if Init() failed.
+    void Submit(const CanvasBatch& batch, RenderQueue& queue) const;
+    // As above, for a batch that's been built.
+    void SubmitWires(const WireBatch& wires, RenderQueue& queue) const;
+
+    NODISCARD FORCEINLINE bool IsValid() const { return m_Shader.IsUsable() && m_VertexArrayName != 0; }
+
+private:
+    // Maps the view onto clip space, for u_DrawParams[0].
+    NODISCARD static glm::vec4 GetClipTransform(const FRect& view);
+
+    // Builds the shader synchronously without a compiler.
+    static bool InitShader(GPUResources& resources, Shader& shader, const ShaderSpecification& spec,
+                           ShaderCompiler* compiler, const Shader* fallback);
+    bool        InitWires(ShaderCache* shaderCache, ShaderCompiler* compiler, const Shader* fallback);
+
+    GPUResources*     m_Resources = nullptr;
+    Shader            m_Shader;
+    VertexArrayHandle m_VertexArray;
+    Shader            m_WireShader;
+    VertexArrayHandle m_WireVertexArray;
+    // The arrays' names, for the Submit functions, as the main thread can't look them up in the pools.
+    GLuint m_VertexArrayName     = 0;
+    GLuint m_WireVertexArrayName = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <span>
+
+#include "World/BlockVolume.h"
+
+class JobSystem;
+
+// A corner of a chunk quad, packed into 8 bytes. Positions are relative to the section's minimum corner, in blocks;
+// UVs are in blocks too, so a merged quad repeats its texture once per block (sample with fract(uv)).
+struct ChunkVertex
+{
+    u32 Position = 0; // x, y, z: 5 bits each (0-16). Then the face (3 bits), and AO (2 bits, 0 darkest to 3).
+    u32 Texture  = 0; // Texture index (16 bits), then u and v (5 bits each, 0-16).
+
+    NODISCARD static FORCEINLINE ChunkVertex Pack(const glm::uvec3& position, const BlockFace face, const u32 ao,
+                                                  const u32 texture, const glm::uvec2& uv)
+    {
+        return {
+            position.x | position.y << 5 | position.z << 10 | static_cast<u32>(face) << 15 | ao << 18,
+            texture | uv.x << 16 | uv.y << 21
+        };
+    }
+
+    NODISCARD FORCEINLINE glm::uvec3 GetPosition() const
+    {
+        return {Position & 31, Position >> 5 & 31, Position >> 10 & 31};
+    }
+
+    NODISCARD FORCEINLINE BlockFace  GetFace() const { return static_cast<BlockFace>(Position >> 15 & 7); }
+    NODISCARD FORCEINLINE u32        GetAO() const { return Position >> 18 & 3; }
+    NODISCARD FORCEINLINE u32        GetTextureIndex() const { return Texture & 0xFFFF; }
+    NODISCARD FORCEINLINE glm::uvec2 GetUV() const { return {Texture >> 16 & 31, Texture >> 21 & 31}; }
+};
+
+static_assert(sizeof(ChunkVertex) == 8, "ChunkVertex is meant to be 8 bytes");
+
+// One section's quads, four vertices each. Every quad is two triangles, (0, 1, 2) and (0, 2, 3), wound
+// counter-clockwise seen from outside, so one shared index buffer does for every mesh (see BuildQuadIndices()).
+struct ChunkMesh
+{
+    glm::ivec3               Section = {};
+    std::vector<ChunkVertex> Vertices;
+    u32                      Faces = 0; // Visible block faces, before they were merged into quads.
+
+    NODISCARD FORCEINLINE u32 GetQuadCount() const { return static_cast<u32>(Vertices.size() / 4); }
+};
+
+struct ChunkMeshStats
+{
+    u32 Sections = 0;
+    u32 Faces    = 0;
+    u32 Quads    = 0;
+    f64 MeshMS   = 0;
+
+    void Reset() { *this = ChunkMeshStats(); }
+};
+
+// Turns sections of blocks into quads: only faces that can be seen (next to air, or a different see-through block),
+// with coplanar faces of the same texture and lighting merged into as few rectangles as possible (greedy meshing).
+//
+// Visibility is worked out with bitmasks, a column of 16 blocks at a time: a block's face along an axis shows where
+// the column's solid bits aren't matched by the opaque bits shifted one along. Four columns go through each SSE
+// operation (with a scalar fallback). Each vertex is given ambient occlusion from the three blocks around its corner,
+// and quads are split along whichever diagonal keeps the AO gradient from looking creased.
+//
+// Doesn't touch GL. MeshSection() only reads the volume, so sections can be meshed on any number of threads at once.
+class ChunkMesher
+{
+public:
+    // Faces at the section's edges are culled (and shaded) against its neighbours in the volume. Blocks beyond the
+    // palette are drawn opaque, with texture 0.
+    static void MeshSection(const BlockVolume& volume, const glm::ivec3& section, std::span<const BlockType> palette,
+                            ChunkMesh& mesh);
+    // Every non-empty section, in parallel. Meshes are in GetSectionPositions() order; sections with nothing visible
+    // get an empty mesh.
+    static ChunkMeshStats MeshVolume(const BlockVolume& volume, std::span<const BlockType> palette, JobSystem& jobs,
+                                     std::vector<ChunkMesh>& meshes);
+
+    // Indices for quadCount quads of four vertices.
+    static void BuildQuadIndices(u32 quadCount, std::vector<u32>& indices);
+};
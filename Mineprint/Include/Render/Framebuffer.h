@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include "Render/GPUResources.h"
+
+struct FramebufferSpecification
+{
+    glm::ivec2 Size         = {256, 256};
+    u32        Samples      = 1; // More than one for MSAA; clamped to what the driver supports.
+    GLenum     ColourFormat = GL_RGBA8;
+    bool       DepthStencil = true; // A 24-bit depth, 8-bit stencil attachment.
+
+    bool operator==(const FramebufferSpecification& other) const = default;
+};
+
+// An offscreen render target. With MSAA, drawing goes to multisampled renderbuffers, and Resolve() blits them into
+// a plain texture; without it, drawing goes straight to the texture. Either way, GetColourTexture() and
+// GetReadFramebuffer() are what you read from (sample it, show it in ImGui, read it back...).
+//
+// Must only be used on the thread that owns the GL context.
+class Framebuffer
+{
+public:
+    Framebuffer() = default;
+    ~Framebuffer();
+
+    Framebuffer(const Framebuffer& other)                = delete;
+    Framebuffer(Framebuffer&& other) noexcept            = delete;
+    Framebuffer& operator=(const Framebuffer& other)     = delete;
+    Framebuffer& operator=(Framebuffer&& other) noexcept = delete;
+
+    // The attachments are created in the resources, which must outlive the framebuffer.
+    bool Init(GPUResources& resources, const FramebufferSpecification& spec);
+    // The GL objects are deleted once the frames in flight are done with them, as a target that's replaced may still
+    // be being read from.
+    void Shutdown();
+    // Recreates the attachments at the new size. Does nothing if the size hasn't changed.
+    bool Resize(const glm::ivec2& size);
+
+    // Binds for drawing, and sets the viewport to cover the whole target.
+    void Bind() const;
+    // Makes what's been drawn readable. A no-op without MSAA.
+    void Resolve() const;
+
+    NODISCARD FORCEINLINE bool                            IsValid() const { return !m_Framebuffer.IsNull(); }
+    NODISCARD FORCEINLINE bool                            IsMultisampled() const { return m_Spec.Samples > 1; }
+    NODISCARD FORCEINLINE const FramebufferSpecification& GetSpecification() const { return m_Spec; }
+    NODISCARD FORCEINLINE const glm::ivec2&               GetSize() const { return m_Spec.Size; }
+    NODISCARD FORCEINLINE GLuint                          GetColourTexture() const
+    {
+        return IsValid() ? m_Resources->Get(m_ColourTexture) : 0;
+    }
+    NODISCARD FORCEINLINE GLuint                          GetReadFramebuffer() const
+    {
+        return IsValid() ? m_Resources->Get(IsMultisampled() ? m_ResolveFramebuffer : m_Framebuffer) : 0;
+    }
+
+private:
+    FramebufferSpecification m_Spec;
+    GPUResources*            m_Resources = nullptr;
+    FramebufferHandle        m_Framebuffer;
+    TextureHandle            m_ColourTexture;
+    RenderbufferHandle       m_ColourRenderbuffer; // MSAA only.
+    RenderbufferHandle       m_DepthRenderbuffer;
+    FramebufferHandle        m_ResolveFramebuffer; // MSAA only.
+};
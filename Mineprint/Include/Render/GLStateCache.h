@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glad/gl.h>
+
+enum class BlendMode : u8
+{
+    None,
+    Alpha,         // src * a + dst * (1 - a)
+    Premultiplied, // src + dst * (1 - a)
+    Additive       // src * a + dst
+};
+
+inline const char* BlendModeToString(const BlendMode mode)
+{
+    switch (mode)
+    {
+    case BlendMode::None:
+        return "None";
+    case BlendMode::Alpha:
+        return "Alpha";
+    case BlendMode::Premultiplied:
+        return "Premultiplied";
+    case BlendMode::Additive:
+        return "Additive";
+    default:
+        return "Unknown";
+    }
+}
+
+// Fixed-function state a draw needs. Compared as a whole, so keep it small.
+struct RenderState
+{
+    BlendMode Blend      = BlendMode::None;
+    bool      DepthTest  = false;
+    bool      DepthWrite = false;
+    bool      CullFaces  = false;
+
+    bool operator==(const RenderState& other) const = default;
+};
+
+// Counts for one frame. "Elided" calls are ones the cache skipped because the state was already set.
+struct GLStateCacheStats
+{
+    u32 ProgramChanges     = 0;
+    u32 TextureChanges     = 0;
+    u32 VertexArrayChanges = 0;
+    u32 RenderStateChanges = 0;
+    u32 ElidedStateChanges = 0;
+
+    NODISCARD FORCEINLINE u32 GetTotalChanges() const
+    {
+        return ProgramChanges + TextureChanges + VertexArrayChanges + RenderStateChanges;
+    }
+
+    void Reset() { *this = GLStateCacheStats(); }
+};
+
+// Shadows the GL bindings we change most, so redundant glUseProgram/glBindTextureUnit/glBindVertexArray calls (and
+// blend/depth/cull toggles) never reach the driver. Only valid while nothing else changes that state behind its back:
+// call Invalidate() after handing GL to code that doesn't go through the cache.
+//
+// Must only be used on the thread that owns the GL context.
+class GLStateCache
+{
+public:
+    static constexpr u32 MaxTextureUnits = 8;
+
+    GLStateCache() { Invalidate(); }
+
+    // Forgets everything, so the next call of each kind goes through to GL.
+    void Invalidate();
+
+    void UseProgram(GLuint program);
+    // Uses DSA (glBindTextureUnit), so there's no active texture unit to track.
+    void BindTexture(u32 unit, GLuint texture);
+    void BindVertexArray(GLuint vertexArray);
+    void SetRenderState(const RenderState& state);
+
+    NODISCARD FORCEINLINE const GLStateCacheStats& GetStats() const { return m_Stats; }
+    FORCEINLINE void                               ResetStats() { m_Stats.Reset(); }
+
+private:
+    // ~0u means "unknown", so the first bind after Invalidate() always goes through.
+    static constexpr GLuint Unknown = ~0u;
+
+    void ApplyBlend(BlendMode blend);
+    static void SetCapability(GLenum capability, bool enabled);
+
+    GLuint                              m_Program     = Unknown;
+    GLuint                              m_VertexArray = Unknown;
+    std::array<GLuint, MaxTextureUnits> m_Textures    = {};
+    RenderState                         m_State;
+    bool                                m_StateKnown = false;
+    GLStateCacheStats                   m_Stats;
+};
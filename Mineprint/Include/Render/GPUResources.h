@@ -0,0 +1,205 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include "Core/Utility/HandlePool.h"
+
+enum class GPUResourceType : u8
+{
+    Texture,
+    Buffer,
+    Program,
+    Framebuffer,
+    Renderbuffer,
+    VertexArray,
+    Count
+};
+
+inline const char* GPUResourceTypeToString(const GPUResourceType type)
+{
+    switch (type)
+    {
+    case GPUResourceType::Texture:
+        return "Texture";
+    case GPUResourceType::Buffer:
+        return "Buffer";
+    case GPUResourceType::Program:
+        return "Program";
+    case GPUResourceType::Framebuffer:
+        return "Framebuffer";
+    case GPUResourceType::Renderbuffer:
+        return "Renderbuffer";
+    case GPUResourceType::VertexArray:
+        return "VertexArray";
+    default:
+        return "Unknown";
+    }
+}
+
+template <GPUResourceType Type>
+using GPUHandle = Handle<std::integral_constant<GPUResourceType, Type>>;
+
+using TextureHandle      = GPUHandle<GPUResourceType::Texture>;
+using BufferHandle       = GPUHandle<GPUResourceType::Buffer>;
+using ProgramHandle      = GPUHandle<GPUResourceType::Program>;
+using FramebufferHandle  = GPUHandle<GPUResourceType::Framebuffer>;
+using RenderbufferHandle = GPUHandle<GPUResourceType::Renderbuffer>;
+using VertexArrayHandle  = GPUHandle<GPUResourceType::VertexArray>;
+
+struct GPUDeletionStats
+{
+    u64 Deferred  = 0;
+    u64 Released  = 0;
+    u32 Pending   = 0;
+    u32 Overflows = 0; // Times the ring filled up, and we had to wait on the GPU to make room.
+    f64 StallMS   = 0;
+
+    void Reset() { *this = GPUDeletionStats(); }
+};
+
+// GL objects to delete once the GPU has finished with them. Objects deferred during a frame are fenced together at
+// EndFrame(), and Collect() deletes them once that fence has signalled, usually a frame or two later. Without this,
+// deleting something a frame in flight still uses leaves it to the driver, which may stall on it.
+//
+// The queue is a fixed-size ring of (type, name) pairs, so deferring never allocates. Runs of the same type are
+// deleted with one glDelete* call. If the ring fills up, Defer() waits for the oldest fenced frame to free some room.
+//
+// Must only be used on the thread that owns the GL context.
+class GPUDeletionQueue
+{
+public:
+    // More frames than this outstanding, and EndFrame() waits for the oldest.
+    static constexpr u32 MaxFrames = 8;
+
+    GPUDeletionQueue() = default;
+    ~GPUDeletionQueue();
+
+    GPUDeletionQueue(const GPUDeletionQueue& other)                = delete;
+    GPUDeletionQueue(GPUDeletionQueue&& other) noexcept            = delete;
+    GPUDeletionQueue& operator=(const GPUDeletionQueue& other)     = delete;
+    GPUDeletionQueue& operator=(GPUDeletionQueue&& other) noexcept = delete;
+
+    // capacity is the most objects that can be waiting to be deleted at once.
+    void Init(u32 capacity = 4096);
+    // Waits for the GPU, then deletes everything.
+    void Shutdown();
+
+    // Zero names are ignored, as glDelete* would.
+    void Defer(GPUResourceType type, GLuint name);
+    // Fences everything deferred since the last call. Call once the frame's commands have been issued.
+    void EndFrame();
+    // Deletes everything from frames the GPU has finished, without waiting. Returns how many objects were deleted.
+    u32 Collect();
+
+    NODISCARD FORCEINLINE u32 GetPendingCount() const { return static_cast<u32>(m_Written - m_Released); }
+    NODISCARD FORCEINLINE u32 GetCapacity() const { return static_cast<u32>(m_Names.size()); }
+    NODISCARD GPUDeletionStats GetStats() const;
+
+private:
+    struct Frame
+    {
+        GLsync Fence = nullptr;
+        u64    End   = 0; // Entries before this (by write count) belong to this frame or an earlier one.
+    };
+
+    // Deletes entries up to end (by write count).
+    void ReleaseUntil(u64 end);
+    // Waits for the oldest fenced frame, and deletes its entries.
+    void WaitForOldestFrame();
+
+    // Parallel rings, so runs of names can be passed straight to glDelete*. Indexed by write count % capacity.
+    std::vector<GLuint>          m_Names;
+    std::vector<GPUResourceType> m_Types;
+    u64                          m_Written  = 0;
+    u64                          m_Released = 0;
+    u64                          m_Fenced   = 0; // Entries before this are in a fenced frame.
+
+    std::array<Frame, MaxFrames> m_Frames; // A ring too, oldest at m_FirstFrame.
+    u32                          m_FirstFrame = 0;
+    u32                          m_FrameCount = 0;
+
+    GPUDeletionStats m_Stats;
+};
+
+struct GPUResourceStats
+{
+    std::array<u32, static_cast<size_t>(GPUResourceType::Count)> Live = {};
+    GPUDeletionStats                                             Deletions;
+};
+
+// Generation-checked handles to GL objects, in a pool per type. Looking a handle up is an index and a compare, and a
+// stale handle gets 0 back rather than whatever object took its slot (or its GL name) since.
+//
+// Destroy() invalidates the handle straight away, but the object is only deleted once the GPU has finished the frames
+// that might still be using it (see GPUDeletionQueue). The renderer calls BeginFrame() and EndFrame().
+//
+// Everything that owns a GL object creates it here (or Add()s it, for programs linked elsewhere) and destroys it here,
+// so it has to outlive them. Names that other threads read (a shader's program, the canvas's vertex arrays) are
+// copied out by their owners, as the pools can't be shared.
+//
+// Must only be used on the thread that owns the GL context.
+class GPUResources
+{
+public:
+    GPUResources() = default;
+    ~GPUResources();
+
+    GPUResources(const GPUResources& other)                = delete;
+    GPUResources(GPUResources&& other) noexcept            = delete;
+    GPUResources& operator=(const GPUResources& other)     = delete;
+    GPUResources& operator=(GPUResources&& other) noexcept = delete;
+
+    void Init(u32 deletionCapacity = 4096);
+    // Deletes everything, warning about objects that are still alive (they should have been destroyed by now).
+    void Shutdown();
+
+    NODISCARD TextureHandle      CreateTexture(GLenum target);
+    NODISCARD BufferHandle       CreateBuffer();
+    NODISCARD FramebufferHandle  CreateFramebuffer();
+    NODISCARD RenderbufferHandle CreateRenderbuffer();
+    NODISCARD VertexArrayHandle  CreateVertexArray();
+
+    // Takes ownership of an object created elsewhere (e.g. a program from the shader compiler).
+    template <GPUResourceType Type>
+    NODISCARD GPUHandle<Type> Add(const GLuint name)
+    {
+        const PoolHandle handle = GetPool(Type).Add(name);
+        return {handle.Index, handle.Generation};
+    }
+
+    // 0 if the handle is null or stale.
+    template <GPUResourceType Type>
+    NODISCARD FORCEINLINE GLuint Get(const GPUHandle<Type> handle) const
+    {
+        const GLuint* name = GetPool(Type).Get({handle.Index, handle.Generation});
+        return name ? *name : 0;
+    }
+
+    // Null and stale handles are ignored.
+    template <GPUResourceType Type>
+    void Destroy(const GPUHandle<Type> handle)
+    {
+        if (const std::optional<GLuint> name = GetPool(Type).Remove({handle.Index, handle.Generation}))
+            m_Deletions.Defer(Type, *name);
+    }
+
+    // Deletes objects from frames the GPU has finished with.
+    void BeginFrame() { m_Deletions.Collect(); }
+    // Fences the objects destroyed this frame.
+    void EndFrame() { m_Deletions.EndFrame(); }
+
+    NODISCARD GPUResourceStats GetStats() const;
+
+private:
+    using Pool       = HandlePool<GLuint, GPUResources>;
+    using PoolHandle = Pool::HandleType;
+
+    NODISCARD FORCEINLINE Pool&       GetPool(const GPUResourceType type) { return m_Pools[static_cast<size_t>(type)]; }
+    NODISCARD FORCEINLINE const Pool& GetPool(const GPUResourceType type) const
+    {
+        return m_Pools[static_cast<size_t>(type)];
+    }
+
+    std::array<Pool, static_cast<size_t>(GPUResourceType::Count)> m_Pools;
+    GPUDeletionQueue                                              m_Deletions;
+};
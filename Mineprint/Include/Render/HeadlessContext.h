@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// An OpenGL 4.5 core context with no window or surface, for rendering headless (offscreen targets only - there's no
+// default framebuffer). On Linux it's an EGL context on Mesa's surfaceless platform, so it works without a display
+// server, and with the llvmpipe software rasteriser (LIBGL_ALWAYS_SOFTWARE=1) without a GPU. Not supported elsewhere
+// yet; Init() fails.
+//
+// libEGL is loaded at runtime, so it's only needed when a headless context is actually created.
+class HeadlessContext
+{
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext& other)                = delete;
+    HeadlessContext(HeadlessContext&& other) noexcept            = delete;
+    HeadlessContext& operator=(const HeadlessContext& other)     = delete;
+    HeadlessContext& operator=(HeadlessContext&& other) noexcept = delete;
+
+    // Creates the context and makes it current on the calling thread.
+    bool Init();
+    // Creates a context that shares objects with other (which must outlive it), for another thread to make current
+    // with MakeCurrent(). Its display is other's.
+    bool InitShared(const HeadlessContext& other);
+    void Shutdown();
+
+    // On the calling thread. A context can only be current on one thread at a time.
+    bool MakeCurrent() const;
+    void Release() const;
+
+    NODISCARD FORCEINLINE bool IsValid() const { return m_Context != nullptr; }
+
+    // For gladLoadGL(). Only valid after Init().
+    static GLADapiproc GetProcAddress(const char* name);
+
+private:
+    // Init() without the cleanup on failure.
+    bool Create();
+
+    void* m_Library     = nullptr;
+    void* m_Display     = nullptr;
+    void* m_Context     = nullptr;
+    bool  m_OwnsDisplay = false; // Not for shared contexts.
+};
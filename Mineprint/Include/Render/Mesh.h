@@ -0,0 +1,156 @@
+#pragma once
+
+#include <span>
+
+#include <glad/gl.h>
+#include <glm/gtc/type_precision.hpp>
+
+#include "Render/GPUResources.h"
+
+struct DrawPacket;
+
+// The vertex every static mesh uses: what the preprocessor writes to .mesh files (MeshVertex in
+// Tools/Preprocessor/Processors/Mesh.cs, so the layout must match it), and what BlockBench models bake to.
+struct MeshVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 UV;
+};
+
+static_assert(sizeof(MeshVertex) == 32, "MeshVertex must match the preprocessor's layout");
+
+// A MeshVertex in half the space, from MeshOptimizer::Quantize(), decoded by Mesh.vert with QUANTIZED defined.
+struct QuantizedMeshVertex
+{
+    glm::u16vec4 Position; // Unsigned normalised, within the mesh's bounds (see MeshQuantization). W is padding.
+    glm::i16vec2 Normal;   // Octahedral, signed normalised.
+    glm::u16vec2 UV;       // Half floats.
+};
+
+static_assert(sizeof(QuantizedMeshVertex) == 16, "QuantizedMeshVertex should be half a MeshVertex");
+
+// Takes a quantised position (0 to 1 on each axis, as the vertex shader reads it) back to the mesh's space.
+struct MeshQuantization
+{
+    glm::vec3 Offset = glm::vec3(0.0f);
+    glm::vec3 Scale  = glm::vec3(1.0f);
+
+    // The same, as a matrix to put in front of the object's transform.
+    NODISCARD glm::mat4 GetMatrix() const
+    {
+        glm::mat4 matrix(1.0f);
+        matrix[0][0] = Scale.x;
+        matrix[1][1] = Scale.y;
+        matrix[2][2] = Scale.z;
+        matrix[3]    = glm::vec4(Offset, 1.0f);
+        return matrix;
+    }
+};
+
+enum class MeshVertexFormat : u8
+{
+    Full,      // MeshVertex.
+    Quantized, // QuantizedMeshVertex.
+};
+
+inline const char* MeshVertexFormatToString(const MeshVertexFormat format)
+{
+    switch (format)
+    {
+    case MeshVertexFormat::Full:
+        return "Full";
+    case MeshVertexFormat::Quantized:
+        return "Quantized";
+    default:
+        return "Unknown";
+    }
+}
+
+// A run of a mesh's indices drawn with one material. Indices are relative to BaseVertex.
+struct SubMesh
+{
+    u32 FirstIndex    = 0;
+    u32 IndexCount    = 0;
+    u32 BaseVertex    = 0;
+    u32 MaterialIndex = 0;
+};
+
+// A simplified level of detail of a mesh: the same vertices, drawn with fewer triangles. Its submeshes match the full
+// mesh's one for one (so materials line up, though some may be left empty), and index into the same index buffer.
+struct MeshLOD
+{
+    // Roughly how far its surface strays from the full mesh's, in the mesh's units.
+    f32                  Error = 0.0f;
+    std::vector<SubMesh> SubMeshes;
+};
+
+// A mesh's vertex and index buffers on the GPU, and a vertex array reading them: position, normal and UV at attribute
+// locations 0, 1 and 2, in either vertex format. Indices are 16 or 32-bit. The buffers are immutable in size; upload
+// again to resize them. They're created in the resources passed to Upload() or Allocate(), which must outlive the mesh.
+//
+// Must only be used on the thread that owns the GL context.
+class GPUMesh
+{
+public:
+    GPUMesh() = default;
+    ~GPUMesh();
+
+    GPUMesh(const GPUMesh& other)                = delete;
+    GPUMesh(GPUMesh&& other) noexcept            = delete;
+    GPUMesh& operator=(const GPUMesh& other)     = delete;
+    GPUMesh& operator=(GPUMesh&& other) noexcept = delete;
+
+    // Replaces anything already uploaded. indexType is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    bool Upload(GPUResources& resources, std::span<const MeshVertex> vertices, std::span<const u8> indices,
+                GLenum indexType);
+    bool Upload(GPUResources& resources, const std::span<const MeshVertex> vertices, const std::span<const u32> indices)
+    {
+        return Upload(resources, vertices, {reinterpret_cast<const u8*>(indices.data()), indices.size_bytes()},
+                      GL_UNSIGNED_INT);
+    }
+    // Quantised vertices need Mesh.vert built with QUANTIZED, and SetTransform() to decode their positions.
+    bool Upload(GPUResources& resources, std::span<const QuantizedMeshVertex> vertices, std::span<const u32> indices,
+                const MeshQuantization& quantization);
+
+    // Allocates buffers without filling them, for data that arrives in pieces: fill them with WriteVertices() and
+    // WriteIndices() (offsets are in vertices and indices).
+    bool Allocate(GPUResources& resources, u32 vertexCount, u32 indexCount, GLenum indexType);
+    void WriteVertices(u32 first, std::span<const MeshVertex> vertices) const;
+    void WriteIndices(u32 first, std::span<const u8> indices) const;
+
+    // The buffers are deleted once the frames in flight are done with them.
+    void Shutdown();
+
+    // Points a packet at one of the mesh's submeshes. Leaves the program, textures and sort key to the caller.
+    void SetupDrawPacket(DrawPacket& packet, const SubMesh& subMesh) const;
+    // Sets the packet's params to what Mesh.vert and Mesh.frag take: the object to clip space matrix, with the
+    // quantisation (if any) folded in, and the texture array layer to sample.
+    void SetTransform(DrawPacket& packet, const glm::mat4& objectToClip, u32 layer = 0) const;
+
+    NODISCARD FORCEINLINE bool   IsUploaded() const { return !m_VertexArray.IsNull(); }
+    NODISCARD FORCEINLINE GLuint GetVertexArray() const { return IsUploaded() ? m_Resources->Get(m_VertexArray) : 0; }
+    NODISCARD FORCEINLINE u32    GetVertexCount() const { return m_VertexCount; }
+    NODISCARD FORCEINLINE u32    GetIndexCount() const { return m_IndexCount; }
+    NODISCARD FORCEINLINE GLenum GetIndexType() const { return m_IndexType; }
+    NODISCARD FORCEINLINE u32    GetIndexSize() const { return m_IndexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+    NODISCARD FORCEINLINE MeshVertexFormat        GetVertexFormat() const { return m_VertexFormat; }
+    NODISCARD FORCEINLINE const MeshQuantization& GetQuantization() const { return m_Quantization; }
+
+private:
+    // Creates the buffers (filled from the data, if it isn't null) and the vertex array.
+    bool Create(GPUResources& resources, MeshVertexFormat format, u32 vertexCount, u32 indexCount, GLenum indexType,
+                const void* vertices, const void* indices, GLbitfield flags);
+
+    GPUResources*     m_Resources = nullptr;
+    VertexArrayHandle m_VertexArray;
+    BufferHandle      m_VertexBuffer;
+    BufferHandle      m_IndexBuffer;
+    u32               m_VertexCount = 0;
+    u32               m_IndexCount  = 0;
+    GLenum            m_IndexType   = GL_UNSIGNED_INT;
+
+    MeshVertexFormat m_VertexFormat = MeshVertexFormat::Full;
+    MeshQuantization m_Quantization;
+};
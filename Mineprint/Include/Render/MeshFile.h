@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Core/Utility/MappedFile.h"
+#include "Render/Mesh.h"
+
+// One submesh's data, pointing into the mapped file. Only one of the index spans is filled, depending on the file's
+// index size. Indices are relative to the submesh's own vertices.
+struct MeshFileSubMesh
+{
+    std::span<const MeshVertex> Vertices;
+    std::span<const u16>        Indices16;
+    std::span<const u32>        Indices32;
+    u32                         MaterialIndex = 0;
+};
+
+// A .mesh file from the preprocessor (Tools/Preprocessor/Processors/Mesh.cs), mapped into memory rather than read.
+// Opening one only validates it: the submeshes' vertices and indices are spans straight into the mapping, so nothing
+// is copied until Upload() hands them to GL.
+//
+// Two layouts are read. The original one is a submesh count, then each submesh's counts, vertices and 16-bit indices
+// in turn. Version 2 starts with a marker where the count was (so older loaders reject it), then has a header with
+// the index size (16 or 32-bit) and a table of submeshes, then all the vertices and all the indices, each contiguous
+// and aligned, so Upload() creates each buffer from the mapping in one call. In the original layout a submesh after
+// an odd number of indices has its vertices off 4-byte alignment; those are copied out so the spans stay aligned.
+class MeshFile
+{
+public:
+    static constexpr u32 Magic   = 0x53574150; // "PAWS"
+    static constexpr u16 Version = 2;
+
+    MeshFile() = default;
+
+    MeshFile(const MeshFile& other)                = delete;
+    MeshFile(MeshFile&& other) noexcept            = delete;
+    MeshFile& operator=(const MeshFile& other)     = delete;
+    MeshFile& operator=(MeshFile&& other) noexcept = delete;
+
+    // Closes anything already open. Fails if the file is truncated, or its counts point outside it. With
+    // validateIndices, every index is also checked against its submesh's vertex count, which touches all the indices;
+    // without it, a corrupt file can only hurt what the GPU draws.
+    bool Open(const std::filesystem::path& path, bool validateIndices = true);
+    void Close();
+
+    // Creates (or replaces) the mesh's buffers in the resources, with the submeshes laid out as GetSubMeshes()
+    // describes.
+    bool Upload(GPUResources& resources, GPUMesh& mesh) const;
+
+    NODISCARD FORCEINLINE bool                                IsOpen() const { return m_File.IsOpen(); }
+    NODISCARD FORCEINLINE bool                                IsVersioned() const { return m_FileVersion > 1; }
+    NODISCARD FORCEINLINE u16                                 GetFileVersion() const { return m_FileVersion; }
+    NODISCARD FORCEINLINE u32                                 GetIndexSize() const { return m_IndexSize; }
+    NODISCARD FORCEINLINE GLenum                              GetIndexType() const { return m_IndexType; }
+    NODISCARD FORCEINLINE u32                                 GetVertexCount() const { return m_VertexCount; }
+    NODISCARD FORCEINLINE u32                                 GetIndexCount() const { return m_IndexCount; }
+    NODISCARD FORCEINLINE size_t                              GetFileSize() const { return m_File.GetSize(); }
+    // Vertices copied out of the mapping to align them (only ever in original layout files).
+    NODISCARD FORCEINLINE size_t                              GetCopiedVertexCount() const { return m_Copied.size(); }
+    NODISCARD FORCEINLINE const std::vector<MeshFileSubMesh>& GetData() const { return m_Data; }
+    // Where each submesh is once uploaded, for drawing it.
+    NODISCARD FORCEINLINE const std::vector<SubMesh>&         GetSubMeshes() const { return m_SubMeshes; }
+
+private:
+    // The version 2 header. The submesh table follows it, then the vertices at the next 16-byte boundary, then the
+    // indices.
+    struct Header
+    {
+        u32 Magic;
+        u32 Marker; // VersionMarker, where the original layout has its submesh count.
+        u16 Version;
+        u16 IndexSize;
+        u32 SubMeshCount;
+        u32 VertexCount;
+        u32 IndexCount;
+        u64 FileSize;
+    };
+
+    struct SubMeshEntry
+    {
+        u32 FirstVertex;
+        u32 VertexCount;
+        u32 FirstIndex;
+        u32 IndexCount;
+        u32 MaterialIndex;
+        u32 Reserved;
+    };
+
+    static_assert(sizeof(Header) == 32 && sizeof(SubMeshEntry) == 24, "MeshFile's layout must match Mesh.cs");
+
+    static constexpr u32 VersionMarker = 0xFFFFFFFF;
+
+    bool ParseLegacy(const std::filesystem::path& path);
+    bool ParseVersioned(const std::filesystem::path& path);
+    bool ValidateIndices(const std::filesystem::path& path) const;
+
+    MappedFile                   m_File;
+    u16                          m_FileVersion = 0;
+    u32                          m_IndexSize   = 2;
+    GLenum                       m_IndexType   = GL_UNSIGNED_SHORT;
+    u32                          m_VertexCount = 0;
+    u32                          m_IndexCount  = 0;
+    std::vector<MeshFileSubMesh> m_Data;
+    std::vector<SubMesh>         m_SubMeshes;
+    std::vector<MeshVertex>      m_Copied;
+    // Version 2 only: every submesh's vertices and indices, as they're uploaded.
+    std::span<const MeshVertex> m_AllVertices;
+    std::span<const u8>         m_AllIndices;
+};
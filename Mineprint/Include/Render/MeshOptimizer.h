@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Render/Mesh.h"
+
+struct MeshOptimizerSpecification
+{
+    // Reorder each submesh's triangles so their vertices are reused while they're still in the post-transform cache.
+    bool VertexCache = true;
+    // Then reorder the vertices into the order the triangles first use them, so fetching them walks memory forwards
+    // (and drop any that no triangle uses).
+    bool VertexFetch = true;
+    // The FIFO the cache statistics are measured with. 16 is typical of current GPUs; it's only for the stats, the
+    // reordering doesn't depend on it.
+    u32 AnalysisCacheSize = 16;
+};
+
+struct MeshOptimizationStats
+{
+    u32 Vertices  = 0;
+    u32 Triangles = 0;
+    // Vertices transformed per triangle (ACMR; 0.5 is the best a regular grid can do, 3 the worst) and per vertex
+    // (ATVR; 1 is ideal), with the analysis cache.
+    f32 ACMRBefore = 0;
+    f32 ACMRAfter  = 0;
+    f32 ATVRBefore = 0;
+    f32 ATVRAfter  = 0;
+    // Bytes of vertices read through 64-byte cache lines to draw the mesh once. Vertex bytes are what it takes to
+    // keep them; the "after" figures include quantisation, if it was done.
+    u64 FetchedBytesBefore = 0;
+    u64 FetchedBytesAfter  = 0;
+    u64 VertexBytesBefore  = 0;
+    u64 VertexBytesAfter   = 0;
+    // The worst each attribute moved when quantised (positions in the mesh's units, normals in degrees).
+    f32 MaxPositionError = 0;
+    f32 MaxNormalError   = 0;
+    f32 MaxUVError       = 0;
+    f64 OptimizeMS       = 0;
+    f64 QuantizeMS       = 0;
+
+    void Reset() { *this = MeshOptimizationStats(); }
+};
+
+// Optimisations for meshes, run while baking or loading them, before they're cached or uploaded.
+//
+// OptimizeVertexCache() is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": triangles are emitted greedily,
+// each scored by how recently its vertices were used (in a simulated 32 entry LRU cache) and how few triangles they
+// have left, which works well for any real cache size. OptimizeVertexFetch() then renumbers vertices in the order
+// the new index buffer first reaches them. Quantize() halves the vertex size: 16-bit positions within the mesh's
+// bounds, octahedral 16-bit normals and half float UVs. Half floats keep about 11 bits near 1, so UVs into atlases
+// much bigger than 2048 texels across can land on the wrong texel; check MaxUVError before using it there.
+class MeshOptimizer
+{
+public:
+    // Optimises every submesh. Indices are left relative to the start of the vertices, with every BaseVertex 0 (any
+    // BaseVertex is folded into the indices first).
+    static MeshOptimizationStats Optimize(const MeshOptimizerSpecification& spec, std::vector<MeshVertex>& vertices,
+                                          std::vector<u32>& indices, std::vector<SubMesh>& subMeshes);
+
+    // Reorders the triangles in place. Every index must be below vertexCount.
+    static void OptimizeVertexCache(std::span<u32> indices, u32 vertexCount);
+    // Reorders the vertices to match the indices, dropping unused ones, and rewrites the indices. Returns how many
+    // vertices are left.
+    static u32 OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::span<u32> indices);
+
+    // With stats, fills in the quantisation errors and the "after" vertex bytes, and (given the indices) the "after"
+    // fetched bytes.
+    static MeshQuantization Quantize(std::span<const MeshVertex> vertices, std::vector<QuantizedMeshVertex>& quantized,
+                                     MeshOptimizationStats* stats = nullptr, std::span<const u32> indices = {});
+
+    // How many vertex shader runs drawing the indices takes, with a FIFO post-transform cache of the given size.
+    NODISCARD static u32 AnalyzeVertexCache(std::span<const u32> indices, u32 vertexCount, u32 cacheSize);
+    // How many bytes of vertices drawing the indices reads, through a small cache of 64-byte lines.
+    NODISCARD static u64 AnalyzeVertexFetch(std::span<const u32> indices, u32 vertexCount, u32 vertexSize);
+
+    // The same encoding Mesh.vert decodes.
+    NODISCARD static glm::i16vec2 EncodeOctahedral(glm::vec3 normal);
+    NODISCARD static glm::vec3    DecodeOctahedral(glm::i16vec2 encoded);
+};
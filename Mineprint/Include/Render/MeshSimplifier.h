@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Render/Mesh.h"
+
+struct MeshSimplifierSpecification
+{
+    // The most LODs to make after the full mesh. Each aims for Ratio of the triangles of the one before it.
+    u32 MaxLODs = 4;
+    f32 Ratio   = 0.5f;
+    // Stop early once a LOD would stray further than this from the full mesh, as a fraction of the mesh's size (its
+    // bounds' diagonal).
+    f32 MaxError = 0.05f;
+    // Stop early once a LOD can't get below this fraction of the previous one's triangles, because what's left is held
+    // in place by seams and borders; it would cost memory without saving much.
+    f32 MinReduction = 0.8f;
+    // How much more boundary edges (of holes, and between submeshes) resist moving than the surface does.
+    f32 BorderWeight = 10.0f;
+    // Reorder each LOD's triangles for the vertex cache, as MeshOptimizer does the full mesh.
+    bool OptimizeVertexCache = true;
+};
+
+struct MeshSimplificationStats
+{
+    u32 LODs       = 0;
+    u32 Collapses  = 0;
+    u32 Rejected   = 0; // Collapses that would have torn a seam, folded the surface or flipped a triangle.
+    f64 SimplifyMS = 0;
+
+    void Reset() { *this = MeshSimplificationStats(); }
+};
+
+// Builds LODs with Garland and Heckbert's quadric error metric: each vertex keeps a quadric summing the squared
+// distances to the planes of the triangles around it (and to planes along boundary edges, so outlines hold their
+// shape), and the edge whose collapse adds the least error is collapsed first, onto one of its ends. Collapsing onto
+// existing vertices means every LOD is just another set of indices into the full mesh's vertices.
+//
+// Vertices that share a position but not attributes (UV seams, hard edges) only collapse along the seam, with each
+// side onto the matching side, so textures don't smear across it. A model built from cubes, whose faces each have
+// their own vertices, is all seams and barely simplifies; LODs are for free-form and imported meshes.
+//
+// At runtime, SelectLOD() picks the coarsest LOD whose error covers at most a pixel or so on screen.
+class MeshSimplifier
+{
+public:
+    // Simplifies the triangles towards targetIndexCount indices, stopping early once the quadrics put the next
+    // collapse past maxError. Writes the remaining triangles (indices into the same vertices) to result, and returns
+    // their error, measured as the furthest any vertex collapsed away is from the triangles that replaced it. Indices
+    // outside the vertices are an error, and leave result empty.
+    static f32 Simplify(std::span<const MeshVertex> vertices, std::span<const u32> indices, u32 targetIndexCount,
+                        f32 maxError, f32 borderWeight, std::vector<u32>& result,
+                        MeshSimplificationStats* stats = nullptr);
+
+    // Builds a LOD chain from the full mesh, appending each LOD's indices to indices. Each LOD is simplified from the
+    // full mesh, so its error is measured against it rather than against the LOD before. A submesh outside the mesh
+    // is an error, and gives no LODs.
+    static std::vector<MeshLOD> BuildLODs(const MeshSimplifierSpecification& spec, std::span<const MeshVertex> vertices,
+                                          std::vector<u32>& indices, std::span<const SubMesh> subMeshes,
+                                          MeshSimplificationStats* stats = nullptr);
+
+    // How many pixels a unit at the given view space depth covers on a viewport of the given height, with either a
+    // perspective or an orthographic projection.
+    NODISCARD static f32 GetPixelsPerUnit(const glm::mat4& projection, f32 viewDepth, f32 viewportHeight);
+    // The coarsest LOD whose error covers at most maxPixelError pixels: 0 for the full mesh, or 1 plus its index.
+    NODISCARD static u32 SelectLOD(std::span<const MeshLOD> lods, f32 pixelsPerUnit, f32 maxPixelError = 1.0f);
+};
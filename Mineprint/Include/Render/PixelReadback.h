@@ -0,0 +1,97 @@
+#pragma once
+
+#include <mutex>
+
+#include <glad/gl.h>
+
+#include "Render/GPUResources.h"
+
+class Framebuffer;
+
+// RGBA8 pixels read back from a framebuffer, top row first.
+struct ReadbackResult
+{
+    u64             ID   = 0;
+    glm::ivec2      Size = {};
+    std::vector<u8> Pixels;
+    u32             FramesWaited = 0; // Polls between the request and the pixels being ready.
+};
+
+struct ReadbackStats
+{
+    u64 Requests          = 0;
+    u64 Completed         = 0;
+    u32 Pending           = 0;
+    u32 PixelBuffers      = 0; // Allocated, in flight or not.
+    f64 AverageWaitFrames = 0;
+    f64 BlockedMS         = 0; // Time spent waiting for the GPU (synchronous reads, or Flush()).
+
+    void Reset() { *this = ReadbackStats(); }
+};
+
+// Reads framebuffers back to the CPU without stalling. Request() queues a copy into a pixel buffer object and fences
+// it; Poll() maps the buffers whose fences have signalled - usually a frame or two later - and hands the pixels to
+// TakeCompleted(). Nothing waits on the GPU unless asked to (Flush(), or synchronous mode, which is there to compare
+// against).
+//
+// Init(), Shutdown(), Request(), Poll() and Flush() must be called on the thread that owns the GL context.
+// TakeCompleted() and GetStats() are safe from any thread.
+class PixelReadback
+{
+public:
+    PixelReadback() = default;
+    ~PixelReadback();
+
+    PixelReadback(const PixelReadback& other)                = delete;
+    PixelReadback(PixelReadback&& other) noexcept            = delete;
+    PixelReadback& operator=(const PixelReadback& other)     = delete;
+    PixelReadback& operator=(PixelReadback&& other) noexcept = delete;
+
+    // The pixel buffers are created in the resources, which must outlive this.
+    void Init(GPUResources& resources);
+    void Shutdown();
+
+    // Copies the framebuffer's (resolved) colour. Returns immediately unless synchronous.
+    void Request(u64 id, const Framebuffer& source);
+    // Collects whatever the GPU has finished, in request order, without waiting. Returns how many reads completed.
+    u32 Poll();
+    // Waits for everything requested so far.
+    void Flush();
+
+    NODISCARD std::vector<ReadbackResult> TakeCompleted();
+    NODISCARD ReadbackStats               GetStats();
+
+    NODISCARD FORCEINLINE u32  GetPendingCount() const { return static_cast<u32>(m_Pending.size()); }
+    // Read straight into memory with glReadPixels, stalling until the GPU is done, like a naive implementation would.
+    FORCEINLINE void           SetSynchronous(const bool synchronous) { m_Synchronous = synchronous; }
+    NODISCARD FORCEINLINE bool IsSynchronous() const { return m_Synchronous; }
+
+private:
+    struct PixelBuffer
+    {
+        BufferHandle Buffer;
+        u64          Capacity = 0;
+    };
+
+    struct PendingRead
+    {
+        u64         ID = 0;
+        glm::ivec2  Size;
+        PixelBuffer Buffer;
+        GLsync      Fence = nullptr;
+        u32         Polls = 0;
+    };
+
+    PixelBuffer AcquireBuffer(u64 size);
+    void        Complete(PendingRead& read);
+    void        AddCompleted(ReadbackResult&& result);
+
+    GPUResources*            m_Resources = nullptr;
+    std::vector<PixelBuffer> m_FreeBuffers;
+    std::deque<PendingRead>  m_Pending;
+    bool                     m_Synchronous = false;
+
+    std::mutex                  m_CompletedMutex; // Guards m_Completed and m_Stats.
+    std::vector<ReadbackResult> m_Completed;
+    ReadbackStats               m_Stats;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Render/GLStateCache.h"
+#include "Render/StreamBuffer.h"
+
+// Passes run in this order. Within a pass, draws are sorted by shader, then material, then depth (front to back) -
+// except in Transparent, where depth comes first (back to front) so blending is correct.
+enum class RenderPass : u8
+{
+    Background,
+    Opaque,
+    Transparent,
+    Overlay
+};
+
+inline const char* RenderPassToString(const RenderPass pass)
+{
+    switch (pass)
+    {
+    case RenderPass::Background:
+        return "Background";
+    case RenderPass::Opaque:
+        return "Opaque";
+    case RenderPass::Transparent:
+        return "Transparent";
+    case RenderPass::Overlay:
+        return "Overlay";
+    default:
+        return "Unknown";
+    }
+}
+
+// 64-bit draw sort key. From the most significant bits down:
+//   Other passes:       pass (8) | shader (16) | material (16) | depth (24)
+//   Transparent pass:   pass (8) | inverted depth (24) | shader (16) | material (16)
+// Shader and material are small IDs picked by the submitter (e.g. an index into its own table), not GL names - all
+// that matters is that draws sharing state share IDs, so they end up next to each other.
+struct RenderSortKey
+{
+    static constexpr u32 DepthBits = 24;
+    static constexpr u32 DepthMax  = (1u << DepthBits) - 1;
+
+    // depth is view depth normalised to [0, 1]; values outside are clamped.
+    NODISCARD static u64 Make(RenderPass pass, u16 shader, u16 material, f32 depth);
+
+    NODISCARD static constexpr RenderPass GetPass(const u64 key) { return static_cast<RenderPass>(key >> 56); }
+};
+
+// One draw. Plain data, so the queue can be filled quickly and copied to the render thread.
+struct DrawPacket
+{
+    static constexpr u32 MaxTextures = 4;
+    static constexpr u32 MaxParams   = 5;
+    static constexpr u32 NoStream    = ~0u;
+
+    u64         SortKey     = 0;
+    GLuint      Program     = 0;
+    GLuint      VertexArray = 0;
+    RenderState State;
+
+    std::array<GLuint, MaxTextures> Textures     = {}; // Bound to units 0..TextureCount-1.
+    u8                              TextureCount = 0;
+
+    // Per-draw constants, uploaded to "layout(location = 0) uniform vec4 u_DrawParams[MaxParams]".
+    std::array<glm::vec4, MaxParams> Params     = {};
+    u8                               ParamCount = 0;
+
+    GLenum Primitive     = GL_TRIANGLES;
+    GLenum IndexType     = GL_NONE; // GL_NONE for non-indexed draws.
+    u32    Count         = 0;       // Index count, or vertex count if non-indexed.
+    u32    First         = 0;       // First index, or first vertex if non-indexed.
+    s32    BaseVertex    = 0;
+    u32    InstanceCount = 1;
+    u32    BaseInstance  = 0;
+
+    // Offsets from RenderQueue::AllocateStream(), for vertices/indices that are rebuilt every frame. The VAO's vertex
+    // binding 0 (and element buffer) are pointed at the stream buffer for this draw only, then put back; First is
+    // then relative to the streamed indices. NoStream to use the VAO's own buffers.
+    u32 StreamVertexOffset = NoStream;
+    u32 StreamVertexStride = 0;
+    u32 StreamIndexOffset  = NoStream;
+
+    NODISCARD FORCEINLINE bool UsesStream() const
+    {
+        return StreamVertexOffset != NoStream || StreamIndexOffset != NoStream;
+    }
+};
+
+struct StreamRange
+{
+    u32 Offset = DrawPacket::NoStream;
+    u8* Data   = nullptr; // Only valid until the next AllocateStream().
+};
+
+struct RenderQueueStats
+{
+    u32 Packets      = 0;
+    u32 DrawCalls    = 0;
+    u32 ParamUploads = 0;
+    u32 StreamBytes  = 0;
+    u32 SkippedDraws = 0; // Streamed draws that were dropped because the stream buffer was full.
+    f64 SortMS       = 0;
+    f64 ExecuteMS    = 0; // Including the sort.
+
+    GLStateCacheStats State;
+
+    void Reset() { *this = RenderQueueStats(); }
+};
+
+// Subsystems submit draw packets in any order over the frame; Execute() radix sorts them by key, then issues them
+// through a GLStateCache so that only the state that actually changes between neighbouring draws is set.
+//
+// Submitting isn't thread-safe: fill a queue from one thread (usually the main thread), then hand it to the thread
+// that owns the GL context (see RenderThread) to execute.
+class RenderQueue
+{
+public:
+    // The stream data is copied to an allocation aligned to this (enough for uniform buffer offsets everywhere), so
+    // alignments within it up to this still hold in the stream buffer.
+    static constexpr u32 StreamAlignment = 256;
+
+    RenderQueue() = default;
+    RenderQueue(const RenderQueue& other) { *this = other; }
+    RenderQueue(RenderQueue&& other) noexcept = default;
+    // Copies the packets and their order, but not the sort's working space.
+    RenderQueue& operator=(const RenderQueue& other);
+    RenderQueue& operator=(RenderQueue&& other) noexcept = default;
+
+    void Submit(const DrawPacket& packet);
+    void Reserve(u32 packetCount);
+    // Reserves per-frame data (vertices, indices...) for packets to reference. It's copied into the renderer's
+    // StreamBuffer when the queue is executed, so it can be written from any thread that's filling the queue.
+    NODISCARD StreamRange AllocateStream(u32 size, u32 alignment = 16);
+    u32                   WriteStream(const void* data, u32 size, u32 alignment = 16);
+    // Keeps the allocations, so a queue that's reused every frame stops allocating after the first few.
+    void Clear();
+
+    // Sorts the packets by key. Stable, so packets with equal keys are drawn in submission order.
+    void Sort();
+    // Sorts (if needed) and draws everything. Must be called on the GL thread. stream is where the stream data was
+    // copied to; if it isn't valid, packets that use it are skipped.
+    void Execute(GLStateCache& stateCache, const StreamAllocation& stream = {});
+
+    NODISCARD FORCEINLINE u32                     GetPacketCount() const { return static_cast<u32>(m_Packets.size()); }
+    NODISCARD FORCEINLINE bool                    IsEmpty() const { return m_Packets.empty(); }
+    NODISCARD FORCEINLINE const RenderQueueStats& GetStats() const { return m_Stats; }
+    NODISCARD FORCEINLINE const std::vector<u8>&  GetStreamData() const { return m_StreamData; }
+
+    // The order Sort() puts the packets in, as indices into the submitted packets.
+    NODISCARD FORCEINLINE const std::vector<u32>& GetSortedOrder() const { return m_Order; }
+
+    // LSD radix sort of (key, index) pairs, 8 bits per pass. Passes where every key has the same digit are skipped,
+    // which is usually several of them (there are only a few passes and shaders). Scratch is resized as needed.
+    struct SortEntry
+    {
+        u64 Key;
+        u32 Index;
+    };
+    static void RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+private:
+    // A VAO's own vertex binding 0 and element buffer, from before a streamed draw repointed them.
+    struct StreamBindings
+    {
+        GLuint  VertexBuffer  = 0;
+        GLint64 VertexOffset  = 0;
+        GLint   VertexStride  = 0;
+        GLuint  ElementBuffer = 0;
+    };
+
+    static StreamBindings SaveStreamBindings(const DrawPacket& packet);
+    static void           RestoreStreamBindings(const DrawPacket& packet, const StreamBindings& bindings);
+    static void           Draw(const DrawPacket& packet, u64 indexOffset);
+
+    std::vector<DrawPacket> m_Packets;
+    std::vector<SortEntry>  m_Entries;
+    std::vector<SortEntry>  m_Scratch;
+    std::vector<u32>        m_Order;
+    std::vector<u8>         m_StreamData;
+    bool                    m_Sorted = true;
+    RenderQueueStats        m_Stats;
+};
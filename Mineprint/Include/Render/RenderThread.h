@@ -0,0 +1,99 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <imgui.h>
+
+#include "Render/RenderQueue.h"
+
+class Window;
+class Renderer;
+
+struct RenderThreadSpecification
+{
+    Window*   TargetWindow   = nullptr;
+    Renderer* TargetRenderer = nullptr;
+
+    // How many frames the main thread can get ahead of the render thread before Submit() blocks.
+    u32 MaxFramesInFlight = 2;
+};
+
+struct RenderThreadStats
+{
+    u64 FramesPresented     = 0;
+    u64 SynchronousFrames   = 0; // Frames the main thread had to wait for (e.g. ImGui texture uploads).
+    f64 AverageLatencyMS    = 0; // Frame start (input sampled) to swap, exponential moving average.
+    f64 MaxLatencyMS        = 0;
+    f64 AverageRenderMS     = 0; // Render thread time per frame, excluding the swap.
+    f64 AverageSubmitWaitMS = 0; // Time the main thread spent blocked because the queue was full.
+
+    void Reset() { *this = RenderThreadStats(); }
+};
+
+// Pipelined rendering: the main thread builds frame N+1 while this thread submits frame N to GL and swaps.
+// The render thread owns the GL context while it's running - nothing else may touch GL until Stop().
+//
+// ImGui's draw data is only valid until the next NewFrame(), so Submit() copies it into one of a fixed set of frame
+// slots. The slots (and their draw lists) are reused, so after the first few frames copying doesn't allocate.
+class RenderThread
+{
+public:
+    RenderThread() = default;
+    ~RenderThread();
+
+    RenderThread(const RenderThread& other)                = delete;
+    RenderThread(RenderThread&& other) noexcept            = delete;
+    RenderThread& operator=(const RenderThread& other)     = delete;
+    RenderThread& operator=(RenderThread&& other) noexcept = delete;
+
+    // Hands the GL context over to a new render thread. Must be called from the thread that currently owns it.
+    bool Start(const RenderThreadSpecification& spec);
+    // Waits for queued frames, stops the thread, and makes the GL context current on the calling thread again.
+    void Stop();
+
+    // Copies the draw data and render queue, and queues them for rendering. Blocks while MaxFramesInFlight frames are
+    // queued. frameStartNS is the SDL_GetTicksNS() time the frame started, used for latency measurement.
+    // Frames carrying ImGui texture updates are rendered synchronously, as the texture data belongs to the main thread.
+    void Submit(const ImDrawData* drawData, const RenderQueue& queue, const glm::ivec2& viewportSize,
+                u64 frameStartNS);
+    // Blocks until every queued frame has been presented.
+    void Flush();
+
+    NODISCARD FORCEINLINE bool IsRunning() const { return m_Thread.joinable(); }
+    NODISCARD RenderThreadStats GetStats();
+    NODISCARD u32               GetQueuedFrameCount();
+
+private:
+    struct Frame
+    {
+        ~Frame();
+
+        ImDrawData               DrawData;
+        std::vector<ImDrawList*> DrawLists; // Owned, reused from frame to frame.
+        RenderQueue              Queue;     // Copied rather than swapped, as the main thread may reuse its queue.
+        glm::ivec2               ViewportSize = {0, 0};
+        u64                      StartNS      = 0;
+    };
+
+    void RenderLoop();
+
+    static void CopyDrawData(Frame& frame, const ImDrawData* drawData, bool withTextures);
+    static bool HasPendingTextureUpdates(const ImDrawData* drawData);
+
+    RenderThreadSpecification m_Spec;
+    std::thread               m_Thread;
+
+    // Ring of frame slots. [m_ReadIndex, m_ReadIndex + m_QueuedFrames) are waiting to be (or being) rendered.
+    std::vector<Scope<Frame>> m_Frames;
+    std::mutex                m_QueueMutex;
+    std::condition_variable   m_FrameQueued;
+    std::condition_variable   m_FrameFinished;
+    u32                       m_ReadIndex     = 0;
+    u32                       m_WriteIndex    = 0;
+    u32                       m_QueuedFrames  = 0;
+    u64                       m_FramesDone    = 0;
+    bool                      m_StopRequested = false;
+    RenderThreadStats         m_Stats; // Guarded by m_QueueMutex.
+};
@@ -1,13 +1,41 @@
 ﻿#pragma once
 
+#include <mutex>
+
 #include <glad/gl.h>
 
+#include "Render/CanvasRenderer.h"
+#include "Render/Framebuffer.h"
+#include "Render/GPUResources.h"
+#include "Render/HeadlessContext.h"
+#include "Render/PixelReadback.h"
+#include "Render/RenderQueue.h"
+#include "Render/ShaderCache.h"
+#include "Render/ShaderCompiler.h"
+
 class Application;
 class Window;
 
 struct RendererSpecification
 {
-    Application* App   = nullptr;
+    Application*              App = nullptr;
+    StreamBufferSpecification Stream;
+    // Where linked shader programs are cached between runs (see ShaderCache). Empty to always compile them.
+    std::filesystem::path ShaderCacheDirectory;
+    // Build shaders on a worker thread (see ShaderCompiler), drawing with a fallback until they're ready. Without a
+    // shared context to build them on, they're built synchronously anyway.
+    bool AsyncShaders = true;
+};
+
+// A queue to draw into an offscreen target rather than the window. The target comes from a pool, so it's only good
+// for the frame; what's drawn is read back, and comes out of Renderer::TakeReadbacks() tagged with ID a frame or two
+// later.
+struct OffscreenRequest
+{
+    u64                      ID = 0;
+    FramebufferSpecification Target;
+    glm::vec4                ClearColour = {0.0f, 0.0f, 0.0f, 0.0f};
+    RenderQueue              Queue;
 };
 
 class Renderer
@@ -22,12 +50,52 @@ public:
     Renderer& operator=(Renderer&& other) noexcept = delete;
 
     bool Init(const RendererSpecification& spec);
-    void Render();
+    // Without a window: creates its own context (see HeadlessContext), current on the calling thread. Only offscreen
+    // requests can be drawn, with RenderOffscreen().
+    bool InitHeadless(const RendererSpecification& spec);
+    // Starts a new frame's render queue. Main thread, before anything submits to GetQueue().
+    void BeginFrame();
+    // Sets the viewport, clears and executes the queue. Called from whichever thread owns the GL context (see
+    // RenderThread) - with the main thread's queue when rendering serially, or the render thread's copy of it.
+    void Render(const glm::ivec2& viewportSize, RenderQueue& queue);
+    // Draws the offscreen requests and collects finished readbacks, for when Render() isn't being called (headless).
+    // GL thread only.
+    void RenderOffscreen();
     void Present();
     void Shutdown();
 
     NODISCARD FORCEINLINE const RendererSpecification& GetSpecification() const { return m_Spec; }
-    
+    // The queue for the frame being built. Main thread only; submit from OnDrawIMGui, so the draws are kept when the
+    // UI isn't rebuilt (see IdleFrameMode).
+    NODISCARD FORCEINLINE RenderQueue& GetQueue() { return m_Queue; }
+    // For code running on the GL thread; anything else should stream through the queue.
+    NODISCARD FORCEINLINE StreamBuffer& GetStreamBuffer() { return m_StreamBuffer; }
+    // Handles to GL objects, deleted once the frames in flight are done with them. GL thread only.
+    NODISCARD FORCEINLINE GPUResources& GetResources() { return m_Resources; }
+    // Submit CanvasBatches to GetQueue() with this.
+    NODISCARD FORCEINLINE const CanvasRenderer& GetCanvas() const { return m_Canvas; }
+    // Counters from the last executed queue. Safe to call from any thread.
+    NODISCARD RenderQueueStats  GetLastFrameStats();
+    NODISCARD StreamBufferStats GetStreamBufferStats();
+    NODISCARD GPUResourceStats  GetGPUResourceStats();
+    NODISCARD ShaderCacheStats    GetShaderCacheStats() { return m_ShaderCache.GetStats(); }
+    NODISCARD ShaderCompilerStats GetShaderCompilerStats() { return m_ShaderCompiler.GetStats(); }
+    // For shaders outside the renderer. GL thread only. The compiler isn't running if AsyncShaders is off, or it
+    // couldn't get a context.
+    NODISCARD FORCEINLINE ShaderCache&    GetShaderCache() { return m_ShaderCache; }
+    NODISCARD FORCEINLINE ShaderCompiler& GetShaderCompiler() { return m_ShaderCompiler; }
+    // Draws nothing. For Shader::InitAsync().
+    NODISCARD FORCEINLINE const Shader& GetFallbackShader() const { return m_FallbackShader; }
+
+    // Safe to call from any thread. The request is drawn at the start of the next Render() or RenderOffscreen().
+    void SubmitOffscreen(OffscreenRequest request);
+    // Safe to call from any thread.
+    NODISCARD std::vector<ReadbackResult> TakeReadbacks();
+    NODISCARD ReadbackStats               GetReadbackStats();
+    // GL thread only (e.g. to switch to synchronous reads).
+    NODISCARD FORCEINLINE PixelReadback& GetReadback() { return m_Readback; }
+    NODISCARD FORCEINLINE bool           IsHeadless() const { return m_Headless.IsValid(); }
+
     static void GLErrorCallback(GLenum        source,
                                 GLenum        type,
                                 GLuint        id,
@@ -39,15 +107,61 @@ public:
 protected:
     // Initialisation functions
     bool InitOpenGL();
+    bool LoadOpenGL(GLADloadfunc loader);
+    bool InitResources();
+    // Builds the fallback shader, and starts the compiler if it can. Returns whether it's running.
+    bool InitShaderCompiler();
+    void ShutdownShaderCompiler();
+
+    // Copies the queue's stream data into this frame's part of the stream buffer.
+    StreamAllocation UploadStream(const RenderQueue& queue);
+    void             DrawOffscreenRequests();
+    // A pooled target matching the specification, recreating the least recently used one if there's no match.
+    Framebuffer* AcquireOffscreenTarget(const FramebufferSpecification& spec);
+    void         CollectReadbacks();
+    // Swaps in shaders the compiler has finished.
+    void UpdateShaders();
 
-    // Event functions
-    static bool OnWindowResize(const glm::ivec2& newSize);
+    // Offscreen targets kept alive between frames. Requests with other specifications recreate them.
+    static constexpr u32 MaxOffscreenTargets = 8;
 
-    Window*       m_Window  = nullptr;
-    SDL_GLContext m_Context = nullptr;
+    Window*         m_Window  = nullptr;
+    SDL_GLContext   m_Context = nullptr;
+    HeadlessContext m_Headless;
     
     // Frame state data
-    u64 m_FrameIndex = 0;
+    u64            m_FrameIndex = 0;
+    RenderQueue    m_Queue;
+    GLStateCache   m_StateCache; // Only touched on the GL thread.
+    StreamBuffer   m_StreamBuffer;
+    GPUResources   m_Resources;
+    ShaderCache    m_ShaderCache;
+    ShaderCompiler m_ShaderCompiler;
+    Shader         m_FallbackShader;
+    CanvasRenderer m_Canvas;
+
+    // The compiler's context: shared with m_Context, or with m_Headless when headless.
+    SDL_GLContext   m_CompilerContext = nullptr;
+    HeadlessContext m_CompilerHeadless;
+
+    struct OffscreenTarget
+    {
+        std::unique_ptr<Framebuffer> Target;
+        FramebufferSpecification     Requested; // Init() may clamp the samples, so match on what was asked for.
+        u64                          LastUsedFrame = 0;
+    };
+
+    std::mutex                    m_OffscreenMutex;
+    std::vector<OffscreenRequest> m_OffscreenRequests; // Guarded by m_OffscreenMutex.
+    std::vector<OffscreenRequest> m_OffscreenWork;     // The GL thread's, swapped with the above.
+    std::vector<OffscreenTarget>  m_OffscreenTargets;
+    u64                           m_OffscreenFrame = 0;
+    PixelReadback                 m_Readback;
+
+    std::mutex        m_StatsMutex;
+    RenderQueueStats  m_LastFrameStats;
+    StreamBufferStats m_StreamBufferStats;
+    GPUResourceStats  m_ResourceStats;
 
     RendererSpecification m_Spec = {};
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+
+#include <glad/gl.h>
+
+#include "Render/GPUResources.h"
+
+class ShaderCache;
+class ShaderCompiler;
+
+struct ShaderSpecification
+{
+    std::string      Name; // For log messages.
+    std::string_view VertexSource;
+    std::string_view FragmentSource;
+    // Each is added to both stages as "#define <define>" after the #version line, e.g. "MSAA" or "SAMPLES 4".
+    std::vector<std::string> Defines;
+    // Optional. Linked programs are loaded from here if they're there, and added if they're not.
+    ShaderCache* Cache = nullptr;
+};
+
+// A program being built, from Shader::BeginBuild(). The stages are compiled and linked without waiting on the driver,
+// so with GL_KHR_parallel_shader_compile several can be in flight at once.
+struct ShaderBuild
+{
+    GLuint    Program   = 0;
+    GLuint    Vertex    = 0;
+    GLuint    Fragment  = 0;
+    u64       CacheKey  = 0;
+    bool      FromCache = false;
+    Stopwatch Timer;
+};
+
+// A linked vertex + fragment program. Must only be used on the thread that owns the GL context, apart from
+// GetProgram() and the state getters, which the main thread can call while it fills a render queue.
+//
+// The program belongs to the resources passed to Init() or InitAsync(), which must outlive the shader. It's only added
+// to them once it's linked: builds in progress are the compiler's (or Init()'s) to clean up.
+//
+// A shader can be built in the background with InitAsync(); until it's ready, GetProgram() returns the fallback's
+// program, so draws that use it can be submitted straight away.
+class Shader
+{
+public:
+    Shader() = default;
+    ~Shader();
+
+    Shader(const Shader& other)                = delete;
+    Shader(Shader&& other) noexcept            = delete;
+    Shader& operator=(const Shader& other)     = delete;
+    Shader& operator=(Shader&& other) noexcept = delete;
+
+    // Compiles and links (or loads from the cache). Logs the driver's info log and returns false on failure.
+    bool Init(GPUResources& resources, const ShaderSpecification& spec);
+    // Queues the build on the compiler and returns straight away; the program is swapped in by
+    // ShaderCompiler::Update() once it's ready. The fallback (optional) must outlive this shader. Returns false if
+    // the specification is missing a stage; compile errors are logged by the compiler, and leave the shader invalid
+    // (and not pending), as a failed Init() would.
+    bool InitAsync(GPUResources& resources, const ShaderSpecification& spec, ShaderCompiler& compiler,
+                   const Shader* fallback);
+    // The program is deleted once the frames in flight are done with it.
+    void Shutdown();
+
+    NODISCARD FORCEINLINE bool IsValid() const { return m_Program != 0; }
+    // Waiting on the compiler.
+    NODISCARD FORCEINLINE bool IsPending() const { return m_Pending; }
+    // Has a program to draw with, even if it's only the fallback.
+    NODISCARD FORCEINLINE bool IsUsable() const { return GetProgram() != 0; }
+
+    NODISCARD FORCEINLINE GLuint GetProgram() const
+    {
+        const GLuint program = m_Program;
+        return program != 0 || !m_Pending || !m_Fallback ? program : m_Fallback->GetProgram();
+    }
+
+    NODISCARD FORCEINLINE const std::string& GetName() const { return m_Name; }
+
+private:
+    friend class ShaderCompiler;
+
+    // Starts compiling and linking the specification's stages (or loads the program from its cache), on whichever
+    // thread has a context current. Both stages must be there.
+    static void BeginBuild(const ShaderSpecification& spec, ShaderBuild& build);
+    // Whether FinishBuild() can be called without waiting on the driver.
+    NODISCARD static bool IsBuildComplete(const ShaderBuild& build);
+    // Checks the result and cleans up the stages. Returns the linked program, or 0 (having logged why) on failure.
+    NODISCARD static GLuint FinishBuild(const ShaderSpecification& spec, ShaderBuild& build);
+    // Releases an unfinished build's objects.
+    static void AbandonBuild(ShaderBuild& build);
+
+    static GLuint CompileStage(GLenum stage, std::string_view source, const std::string& defines);
+    // Logs the stage's info log if it failed to compile. Returns whether it compiled.
+    static bool CheckStage(GLuint stage, GLenum type, const std::string& name);
+    // GL thread: hands a linked program to the resources.
+    void Adopt(GLuint program);
+
+    std::string         m_Name;
+    GPUResources*       m_Resources = nullptr;
+    ProgramHandle       m_Handle;
+    std::atomic<GLuint> m_Program  = 0; // The handle's, for GetProgram() on the main thread, which can't use the pools.
+    std::atomic<bool>   m_Pending  = false;
+    const Shader*       m_Fallback = nullptr;
+    ShaderCompiler*     m_Compiler = nullptr;
+    u64                 m_JobID    = 0;
+};
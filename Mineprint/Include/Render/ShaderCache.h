@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include <glad/gl.h>
+
+struct ShaderSpecification;
+
+struct ShaderCacheStats
+{
+    u32 Hits     = 0;
+    u32 Misses   = 0;
+    u32 Rejected = 0; // Entries that were corrupt, or that the driver refused. Counted as misses too.
+    u32 Stored   = 0;
+    u32 Compiled = 0; // Programs compiled from source, whether or not the cache is enabled.
+    f64 LoadMS    = 0; // Creating programs from cached binaries.
+    f64 CompileMS = 0; // Compiling and linking the Compiled programs.
+
+    void Reset() { *this = ShaderCacheStats(); }
+};
+
+// Keeps linked programs on disk (from glGetProgramBinary), so later runs can skip compiling and linking them. Entries
+// are keyed by a hash of the sources, the defines, and the driver's vendor, renderer and version strings, so editing
+// a shader or updating the driver just misses, and Shader::Init() compiles (and re-caches) it as if there were no
+// cache. Drivers can also refuse a binary they made themselves; that's treated the same way.
+//
+// Init(), Shutdown() and Clear() must be called on the thread that owns the GL context. Load() and Store() can also be
+// called from a thread with a shared context current (see ShaderCompiler); Prefetch() and GetStats() from any thread.
+class ShaderCache
+{
+public:
+    // Bump when the entry format changes, to ignore older entries.
+    static constexpr u16 Version = 1;
+
+    ShaderCache() = default;
+
+    ShaderCache(const ShaderCache& other)                = delete;
+    ShaderCache(ShaderCache&& other) noexcept            = delete;
+    ShaderCache& operator=(const ShaderCache& other)     = delete;
+    ShaderCache& operator=(ShaderCache&& other) noexcept = delete;
+
+    // Entries are kept in directory, which is created if needed. Returns false (and every lookup misses) if it can't
+    // be, or the driver doesn't support any program binary formats.
+    bool Init(const std::filesystem::path& directory);
+    // Reads the entries in directory into memory, so Load() doesn't wait on the disk for them. Needs no GL context, so
+    // it can run on a worker before Init() while the window and context are created. Load() still checks each one.
+    void Prefetch(const std::filesystem::path& directory);
+    void Shutdown();
+    // Deletes every entry, for after changing drivers (stale entries are never used, but they do take up space).
+    void Clear();
+
+    NODISCARD u64 GetKey(const ShaderSpecification& spec) const;
+    // A linked program from the cached binary, or 0 if there isn't a usable one.
+    NODISCARD GLuint Load(u64 key, const std::string& name);
+    // The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    void Store(u64 key, GLuint program);
+    // For the stats: how long a program took to compile and link. Counted even when the cache is disabled, so the
+    // two can be compared.
+    void RecordCompile(f64 milliseconds);
+
+    NODISCARD FORCEINLINE bool                         IsEnabled() const { return !m_Directory.empty(); }
+    NODISCARD FORCEINLINE const std::filesystem::path& GetDirectory() const { return m_Directory; }
+    NODISCARD ShaderCacheStats                         GetStats();
+
+private:
+    struct EntryHeader
+    {
+        u32 Magic;
+        u16 Version;
+        u16 Reserved;
+        u64 Key;
+        u32 Format; // The GLenum from glGetProgramBinary.
+        u32 Size;
+    };
+
+    static constexpr u32 Magic         = 0x4353504D; // "MPSC"
+    static constexpr u64 PrefetchLimit = 64ull << 20;
+
+    // The whole entry, header included. False if the file can't be read.
+    static bool                     ReadEntry(const std::filesystem::path& path, std::vector<u8>& bytes);
+    NODISCARD std::filesystem::path GetEntryPath(u64 key) const;
+
+    std::filesystem::path m_Directory;
+    u64                   m_DriverHash = 0;
+
+    std::mutex       m_StatsMutex;
+    ShaderCacheStats m_Stats;
+
+    std::mutex                               m_PrefetchMutex;
+    std::unordered_map<u64, std::vector<u8>> m_Prefetched; // By key, until Load() takes them.
+};
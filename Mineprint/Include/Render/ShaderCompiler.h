@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "Render/Shader.h"
+
+struct ShaderCompilerSpecification
+{
+    // Called on the worker thread, to make a context that shares objects with the renderer's current there, and to
+    // release it again when the worker stops.
+    std::function<bool()> MakeContextCurrent;
+    std::function<void()> ReleaseContext;
+};
+
+struct ShaderCompilerStats
+{
+    u32  Submitted = 0;
+    u32  Completed = 0; // Swapped in, failed or not.
+    u32  Failed    = 0;
+    u32  Pending   = 0; // Submitted, but not swapped in yet.
+    f64  BuildMS   = 0; // Worker time from starting a build to its program being ready.
+    bool Parallel  = false; // Whether the driver compiles in parallel (GL_KHR_parallel_shader_compile).
+
+    void Reset() { *this = ShaderCompilerStats(); }
+};
+
+// Compiles and links shaders on a worker thread with its own GL context, shared with the renderer's, so building a
+// program never stalls a frame. Where the driver supports GL_KHR_parallel_shader_compile, the worker starts every
+// queued build at once and polls for them to complete, rather than compiling one at a time.
+//
+// A finished program is fenced on the worker; Update() swaps it into its Shader once the fence has signalled, which
+// is what makes the program safe to use from the renderer's context. Until then the shader draws with its fallback
+// (see Shader::InitAsync()).
+//
+// Everything but GetStats() must be called on the thread that owns the renderer's context.
+class ShaderCompiler
+{
+public:
+    ShaderCompiler() = default;
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler& other)                = delete;
+    ShaderCompiler(ShaderCompiler&& other) noexcept            = delete;
+    ShaderCompiler& operator=(const ShaderCompiler& other)     = delete;
+    ShaderCompiler& operator=(ShaderCompiler&& other) noexcept = delete;
+
+    // Starts the worker. Returns false if its context couldn't be made current, in which case shaders should be
+    // built with Shader::Init() instead.
+    bool Init(const ShaderCompilerSpecification& spec);
+    // Stops the worker, dropping anything that's still queued. Programs that were built but not swapped in yet are
+    // deleted.
+    void Shutdown();
+
+    // Swaps in every program whose fence has signalled. Call once a frame. Returns how many shaders were finished
+    // (including ones that failed to build).
+    u32 Update();
+    // Blocks until everything submitted so far has been swapped in (e.g. before a benchmark, or a screenshot).
+    void WaitIdle();
+
+    NODISCARD FORCEINLINE bool IsRunning() const { return m_Thread.joinable(); }
+    NODISCARD FORCEINLINE u32  GetPendingCount() const { return static_cast<u32>(m_Targets.size()); }
+    NODISCARD ShaderCompilerStats GetStats();
+
+private:
+    friend class Shader;
+
+    struct Job
+    {
+        u64                 ID = 0;
+        ShaderSpecification Spec; // Its sources point into the strings below.
+        std::string         VertexSource;
+        std::string         FragmentSource;
+        ShaderBuild         Build;
+    };
+
+    struct Result
+    {
+        u64    ID      = 0;
+        GLuint Program = 0; // 0 if the build failed.
+        GLsync Fence   = nullptr;
+    };
+
+    // From Shader::InitAsync() and Shutdown().
+    u64  Submit(Shader& shader, const ShaderSpecification& spec);
+    void Cancel(u64 id);
+
+    void WorkerLoop(std::promise<bool> started);
+    // Worker thread: fences the program and hands it to Update().
+    void Finish(Job& job, GLuint program);
+
+    ShaderCompilerSpecification m_Spec;
+    std::thread                 m_Thread;
+    bool                        m_Parallel = false;
+
+    std::mutex              m_Mutex;
+    std::condition_variable m_WorkQueued;
+    std::condition_variable m_ResultReady;
+    std::deque<Scope<Job>>  m_Queue; // Guarded by m_Mutex, as is everything down to m_Stats.
+    std::vector<Result>     m_Results;
+    bool                    m_StopRequested = false;
+    ShaderCompilerStats     m_Stats;
+
+    // GL thread only.
+    std::unordered_map<u64, Shader*> m_Targets; // By job ID; cancelled jobs are removed.
+    u64                              m_NextID = 1;
+};
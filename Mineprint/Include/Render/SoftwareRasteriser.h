@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "Render/Mesh.h"
+
+class BlockBenchModel;
+class JobSystem;
+class TextureAtlas;
+
+struct SoftwareRasteriserSpecification
+{
+    u32 Width  = 128;
+    u32 Height = 128;
+    // Each square tile is rasterised by one job, start to finish. Must be a multiple of 4, as pixels are shaded four
+    // at a time.
+    u32 TileSize = 32;
+    // Transparent by default, so thumbnails can go on any background.
+    glm::u8vec4 ClearColour = glm::u8vec4(0);
+};
+
+struct SoftwareRasteriserStats
+{
+    u32 Draws     = 0;
+    u32 Triangles = 0; // Submitted.
+    u32 SetUp     = 0; // Left after clipping, and dropping those too thin to cover a pixel centre.
+    u32 Binned    = 0; // Triangle and tile pairs.
+    u32 Pixels    = 0; // Written, counting overdraw.
+    u32 Discarded = 0; // Passed the depth test, but their texel was transparent.
+    f64 VertexMS  = 0;
+    f64 SetupMS   = 0; // Clipping, setting up and binning triangles.
+    f64 RasterMS  = 0;
+
+    void Reset() { *this = SoftwareRasteriserStats(); }
+};
+
+// Draws textured meshes on the CPU, for thumbnails and previews on machines without a GPU (build and CI machines).
+// It takes the same data as the GL path - MeshVertex buffers, submeshes whose MaterialIndex is an atlas layer, and a
+// TextureAtlas's pixels - and shades them as Mesh.frag does: nearest texels from the atlas's base level, alpha tested
+// at a half, lit by the same fixed light. Depth is tested and written as GL's LESS, and both sides of every triangle
+// are drawn, as nothing in the GL path culls faces.
+//
+// Draw() only queues meshes; Render() draws them all over the job system. Vertices are transformed in parallel, then
+// triangles are clipped and set up in batches, each binning its triangles into the screen tiles they touch. Then every
+// tile is a job: it walks the bins in draw order, and tests four pixels at a time against the edge functions, and
+// against the depth buffer, with SIMD. Tiles own their pixels, so nothing is shared or locked while drawing.
+//
+// Attributes are interpolated perspective correctly, but the light is worked out per vertex rather than per pixel;
+// the meshes it's for are flat faced, where that's the same.
+class SoftwareRasteriser
+{
+public:
+    // Sizes the targets, clears them, and forgets anything queued.
+    void Begin(const SoftwareRasteriserSpecification& spec);
+    // Queues a mesh's submeshes (indices relative to each one's BaseVertex), sampling the atlas layer in each one's
+    // MaterialIndex. Without an atlas, or if its pixels have been released, it's drawn white. Nothing is copied, so
+    // the data must live until Render().
+    void Draw(std::span<const MeshVertex> vertices, std::span<const u32> indices, std::span<const SubMesh> subMeshes,
+              const glm::mat4& objectToClip, const TextureAtlas* atlas = nullptr);
+    // A baked model, at one of its LODs (see BlockBenchModel::GetLODSubMeshes()).
+    void Draw(const BlockBenchModel& model, const glm::mat4& objectToClip, u32 lod = 0);
+    // Draws everything queued since Begin(), on top of what's already there.
+    void Render(JobSystem& jobs);
+
+    // The image as a PNG, or empty if it couldn't be encoded.
+    NODISCARD std::vector<u8> EncodePNG() const;
+    bool                      SavePNG(const std::filesystem::path& path) const;
+
+    NODISCARD FORCEINLINE u32                            GetWidth() const { return m_Spec.Width; }
+    NODISCARD FORCEINLINE u32                            GetHeight() const { return m_Spec.Height; }
+    // RGBA8, top row first, like a readback (see ReadbackResult).
+    NODISCARD FORCEINLINE std::span<const u8>            GetPixels() const { return m_Colours; }
+    NODISCARD FORCEINLINE const SoftwareRasteriserStats& GetStats() const { return m_Stats; }
+
+private:
+    struct DrawCall
+    {
+        std::span<const MeshVertex> Vertices;
+        std::span<const u32>        Indices;
+        std::span<const SubMesh>    SubMeshes;
+        glm::mat4                   ObjectToClip;
+        const TextureAtlas*         Atlas;
+        u32                         FirstVertex; // Into m_ClipVertices.
+    };
+
+    // A submesh of a draw, with its triangles numbered after those of the runs before it.
+    struct Run
+    {
+        u32       Draw;
+        u32       FirstIndex;
+        u32       BaseVertex; // Into m_ClipVertices.
+        u32       FirstTriangle;
+        u32       TriangleCount;
+        const u8* Texels; // The atlas layer, or null for white.
+        u32       TextureSize;
+    };
+
+    struct ClipVertex
+    {
+        glm::vec4 Position;
+        glm::vec2 UV;
+        f32       Light;
+    };
+
+    // Something that varies linearly over the screen: its value at the centre of pixel (0, 0), and its steps to the
+    // next pixel right and down.
+    struct Plane
+    {
+        f32 Value;
+        f32 X;
+        f32 Y;
+    };
+
+    // A triangle ready to rasterise. A pixel is inside where all three edge functions are at least zero. Depth is
+    // linear on screen; the UV and light are divided by w, to be divided by the interpolated 1/w per pixel.
+    struct Triangle
+    {
+        std::array<Plane, 3> Edges;
+        Plane                Depth;
+        Plane                InverseW;
+        Plane                U;
+        Plane                V;
+        Plane                Light;
+        glm::ivec4           Rect; // The pixels it covers: min x, min y, max x, max y, inclusive.
+        const u8*            Texels;
+        u32                  TextureSize;
+    };
+
+    // A batch of triangles set up by one job, and which of them each tile needs.
+    struct Batch
+    {
+        u32                           FirstTriangle;
+        u32                           TriangleCount;
+        std::vector<Triangle>         Triangles;
+        std::vector<std::vector<u32>> Bins; // By tile.
+        u32                           Binned = 0;
+    };
+
+    void SetUpBatch(Batch& batch) const;
+    // A triangle in clip space, clipped to the frustum (if it crosses it) and fanned into triangles on screen.
+    void ClipAndSetUp(Batch& batch, const Run& run, const ClipVertex& a, const ClipVertex& b,
+                      const ClipVertex& c) const;
+    // Screen positions are in pixels, with depth from 0 to 1 in z and 1/w in w.
+    void SetUp(Batch& batch, const Run& run, const std::array<glm::vec4, 3>& screen,
+               const std::array<const ClipVertex*, 3>& vertices) const;
+    void RasteriseTile(u32 tile, u32& pixels, u32& discarded);
+
+    SoftwareRasteriserSpecification m_Spec;
+    u32                             m_TilesX      = 0;
+    u32                             m_TilesY      = 0;
+    u32                             m_DepthStride = 0; // Rows of the depth buffer are padded to four pixels.
+
+    std::vector<DrawCall>   m_Draws;
+    std::vector<Run>        m_Runs;
+    std::vector<ClipVertex> m_ClipVertices;
+    std::vector<Batch>      m_Batches;
+    u32                     m_TriangleCount = 0;
+
+    std::vector<u8>  m_Colours;
+    std::vector<f32> m_Depths;
+
+    SoftwareRasteriserStats m_Stats;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include "Render/GPUResources.h"
+
+struct StreamBufferSpecification
+{
+    u64 FrameSize  = 4 * 1024 * 1024; // Bytes available to each frame.
+    u32 FrameCount = 3;               // Frames the GPU can be behind us before we have to wait for it.
+};
+
+// Where an allocation ended up. Data is write-only mapped memory: write to it, never read it.
+struct StreamAllocation
+{
+    void*  Data   = nullptr;
+    GLuint Buffer = 0;
+    u64    Offset = 0; // Into Buffer, for glVertexArrayVertexBuffer, glBindBufferRange, etc.
+    u64    Size   = 0;
+
+    NODISCARD FORCEINLINE bool IsValid() const { return Data != nullptr; }
+};
+
+struct StreamBufferStats
+{
+    u64 Frames            = 0;
+    u64 Allocations       = 0;
+    u64 FailedAllocations = 0; // Didn't fit in what was left of the frame's segment.
+    u64 BytesThisFrame    = 0;
+    u64 PeakFrameBytes    = 0;
+    u64 Stalls            = 0; // Frames where the GPU was still using the segment we wanted, so we had to wait.
+    f64 StallMS           = 0;
+
+    void Reset() { *this = StreamBufferStats(); }
+};
+
+// A ring of FrameCount segments in one buffer, created with glBufferStorage and kept persistently and coherently
+// mapped, for data that's rewritten every frame (dynamic vertices, indices, uniforms). Each frame sub-allocates
+// linearly from its own segment. EndFrame() fences the segment, and BeginFrame() waits on that fence before the
+// segment is reused, FrameCount frames later. So we never map/unmap or orphan buffers, and only wait when the GPU
+// really is that far behind.
+//
+// Must only be used on the thread that owns the GL context. To stream data from another thread, write it into a
+// RenderQueue (see RenderQueue::AllocateStream()), which is copied in here when the queue is executed.
+class StreamBuffer
+{
+public:
+    StreamBuffer() = default;
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer& other)                = delete;
+    StreamBuffer(StreamBuffer&& other) noexcept            = delete;
+    StreamBuffer& operator=(const StreamBuffer& other)     = delete;
+    StreamBuffer& operator=(StreamBuffer&& other) noexcept = delete;
+
+    // The buffer is created in the resources, which must outlive this.
+    bool Init(GPUResources& resources, const StreamBufferSpecification& spec);
+    void Shutdown();
+
+    // Moves to the next segment, waiting for the GPU to be done with it if it isn't already.
+    void BeginFrame();
+    // Fences the current segment.
+    void EndFrame();
+
+    // Returns an invalid allocation if the frame's segment is full.
+    NODISCARD StreamAllocation Allocate(u64 size, u64 alignment = 16);
+
+    NODISCARD FORCEINLINE bool                     IsValid() const { return !m_Buffer.IsNull(); }
+    NODISCARD FORCEINLINE GLuint                   GetBuffer() const
+    {
+        return IsValid() ? m_Resources->Get(m_Buffer) : 0;
+    }
+    NODISCARD FORCEINLINE const StreamBufferStats& GetStats() const { return m_Stats; }
+    NODISCARD FORCEINLINE u64                      GetRemaining() const { return m_Spec.FrameSize - m_FrameOffset; }
+
+private:
+    StreamBufferSpecification m_Spec;
+    GPUResources*             m_Resources = nullptr;
+    BufferHandle              m_Buffer;
+    u8*                       m_Mapped = nullptr;
+    std::vector<GLsync>       m_Fences; // One per segment; null if the segment has never been used.
+    u32                       m_Segment     = 0;
+    u64                       m_FrameOffset = 0;
+    bool                      m_InFrame     = false;
+    StreamBufferStats         m_Stats;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <span>
+
+#include <glad/gl.h>
+
+#include "Render/GPUResources.h"
+
+class JobSystem;
+
+// An RGBA8 image to pack, and the resource location its sprite is found by (e.g. "minecraft:block/stone"). Images
+// taller than they are wide, with a whole number of squares, are animation strips: each square is a frame (unless
+// SplitFrames is off, for images that are just tall).
+struct AtlasImage
+{
+    std::string     Location;
+    u32             Width  = 0;
+    u32             Height = 0;
+    std::vector<u8> Pixels;
+    bool            SplitFrames = true;
+};
+
+// Where one frame of a sprite ended up: a layer of the texture array, and the UVs of its corners within it.
+struct AtlasRegion
+{
+    glm::vec2 UVMin;
+    glm::vec2 UVMax;
+    u32       Layer;
+};
+
+struct AtlasSprite
+{
+    u32 FirstFrame = 0; // Index of its first region; the rest follow it.
+    u16 FrameCount = 1;
+    u16 Width      = 0; // Of one frame, in pixels.
+    u16 Height     = 0;
+};
+
+struct TextureAtlasSpecification
+{
+    // Layers start at MinPageSize and double (up to MaxPageSize) until everything fits in one. Past that, more layers
+    // are added instead.
+    u32 MinPageSize = 256;
+    u32 MaxPageSize = 2048;
+    // Mip levels below the base one. Frames are placed on multiples of 2^MipLevels pixels, so every level's box filter
+    // only ever averages pixels from one frame.
+    u32 MipLevels = 2;
+    // Each frame's edge pixels are copied outwards by this much, at every level, so filtering at a frame's edge never
+    // picks up its neighbours. Rounded up to a multiple of 2^MipLevels.
+    u32 Padding = 4;
+
+    // For BuildFromResourcePack(): the folders under assets/<namespace>/textures/ to pack (empty for all of them), and
+    // where to cache the result (empty to always build it).
+    std::vector<std::string> Folders = {"block", "item", "gui"};
+    std::filesystem::path    CacheDirectory;
+};
+
+struct TextureAtlasStats
+{
+    u32  Sprites   = 0;
+    u32  Frames    = 0;
+    u32  Skipped   = 0; // Images that were empty, or too big for a layer.
+    u32  Layers    = 0;
+    u32  PageSize  = 0;
+    f32  Occupancy = 0; // Of the packed layers, by padded frame area.
+    bool FromCache = false;
+    f64  DecodeMS  = 0;
+    f64  PackMS    = 0;
+    f64  CopyMS    = 0;
+    f64  MipMS     = 0;
+    f64  CacheMS   = 0; // Loading the cached atlas, or saving a new one.
+
+    void Reset() { *this = TextureAtlasStats(); }
+};
+
+// Packs lots of small textures (block, item and GUI sprites) into the layers of one 2D texture array, so drawing them
+// doesn't mean binding a texture per sprite. Look sprites up by resource location, then sample the array with their
+// regions' UVs and layer.
+//
+// Building is done on the CPU, spread over the job system: decoding, copying frames in, and filtering each mip level
+// all run in parallel; only the packing itself (skyline, tallest frames first) is serial. Nothing touches GL until
+// Upload(), which must be called on the thread that owns the GL context.
+class TextureAtlas
+{
+public:
+    // Bump when the cache format changes, to ignore older files.
+    static constexpr u16 Version = 1;
+
+    TextureAtlas() = default;
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas& other)                = delete;
+    TextureAtlas(TextureAtlas&& other) noexcept            = delete;
+    TextureAtlas& operator=(const TextureAtlas& other)     = delete;
+    TextureAtlas& operator=(TextureAtlas&& other) noexcept = delete;
+
+    // Replaces anything already built (but not the texture; call Upload() again). Returns false if nothing could be
+    // packed.
+    bool Build(const TextureAtlasSpecification& spec, std::span<const AtlasImage> images, JobSystem& jobs);
+    // Packs every PNG under assets/<namespace>/textures/ in a resource pack, or an extracted mod or game jar. With a
+    // cache directory, an atlas built from the same files (by name, size and modification time) is loaded instead.
+    bool BuildFromResourcePack(const TextureAtlasSpecification& spec, const std::filesystem::path& root,
+                               JobSystem& jobs);
+
+    // The atlas as built, and the key it must be loaded with. Load() fails if the file is missing, corrupt, or was
+    // saved with a different key or version.
+    bool Save(const std::filesystem::path& path, u64 key) const;
+    bool Load(const std::filesystem::path& path, u64 key);
+
+    // Creates (or replaces) the texture array from the built pixels. The resources must outlive the atlas.
+    bool Upload(GPUResources& resources);
+    // Frees the CPU copy of the pixels, once uploaded. Lookups still work.
+    void ReleasePixels();
+    // The texture is deleted once the frames in flight are done with it.
+    void Shutdown();
+
+    // Null if there's no sprite with that location.
+    NODISCARD const AtlasSprite* Find(const std::string& location) const;
+
+    NODISCARD FORCEINLINE std::span<const AtlasRegion> GetFrames(const AtlasSprite& sprite) const
+    {
+        return std::span(m_Regions).subspan(sprite.FirstFrame, sprite.FrameCount);
+    }
+
+    // Every layer of a mip level, one after the other, as RGBA8 rows.
+    NODISCARD FORCEINLINE std::span<const u8> GetPixels(const u32 level) const
+    {
+        return level < m_Levels.size() ? std::span<const u8>(m_Levels[level]) : std::span<const u8>();
+    }
+
+    NODISCARD FORCEINLINE bool                            IsBuilt() const { return !m_Sprites.empty(); }
+    NODISCARD FORCEINLINE bool                            IsUploaded() const { return !m_Texture.IsNull(); }
+    NODISCARD FORCEINLINE GLuint                          GetTexture() const
+    {
+        return IsUploaded() ? m_Resources->Get(m_Texture) : 0;
+    }
+    NODISCARD FORCEINLINE u32                             GetPageSize() const { return m_PageSize; }
+    NODISCARD FORCEINLINE u32                             GetLayerCount() const { return m_LayerCount; }
+    NODISCARD FORCEINLINE u32                             GetLevelCount() const { return m_LevelCount; }
+    NODISCARD FORCEINLINE const std::vector<AtlasSprite>& GetSprites() const { return m_Sprites; }
+    NODISCARD FORCEINLINE const std::vector<std::string>& GetLocations() const { return m_Locations; }
+    NODISCARD FORCEINLINE const TextureAtlasStats&        GetStats() const { return m_Stats; }
+
+private:
+    // A frame's place in the atlas, at the base level: the padded cell it owns, and the frame within it.
+    struct Placement
+    {
+        u32        Image;
+        u32        Frame;
+        u32        Region;
+        u32        Layer;
+        glm::uvec2 CellMin;
+        glm::uvec2 CellMax;
+        glm::uvec2 FrameMin;
+        glm::uvec2 FrameMax;
+    };
+
+    struct CacheHeader
+    {
+        u32 Magic;
+        u16 Version;
+        u16 Reserved;
+        u64 Key;
+        u32 PageSize;
+        u32 LayerCount;
+        u32 LevelCount;
+        u32 SpriteCount;
+        u32 FrameCount;
+        u32 LocationBytes; // Every location, each followed by a zero.
+        f32 Occupancy;
+        u32 Skipped;
+    };
+
+    static constexpr u32 Magic = 0x4154504D; // "MPTA"
+
+    // Packs every frame into as few layers as it can, filling in m_Sprites, m_Regions and placements.
+    bool Pack(const TextureAtlasSpecification& spec, std::span<const AtlasImage> images,
+              std::vector<Placement>& placements);
+    void GenerateMips(std::span<const Placement> placements, JobSystem& jobs);
+    void Clear();
+
+    NODISCARD FORCEINLINE size_t GetLayerBytes(const u32 level) const
+    {
+        const size_t size = m_PageSize >> level;
+        return size * size * 4;
+    }
+
+    std::vector<AtlasSprite>             m_Sprites;
+    std::vector<AtlasRegion>             m_Regions;
+    std::vector<std::string>             m_Locations; // By sprite.
+    std::unordered_map<std::string, u32> m_SpriteIndices;
+
+    std::vector<std::vector<u8>> m_Levels;
+    u32                          m_PageSize   = 0;
+    u32                          m_LayerCount = 0;
+    u32                          m_LevelCount = 0;
+
+    GPUResources*     m_Resources = nullptr;
+    TextureHandle     m_Texture;
+    TextureAtlasStats m_Stats;
+};
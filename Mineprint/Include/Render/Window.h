@@ -52,12 +52,18 @@ public:
     Window& operator=(Window&& other) noexcept = delete;
 
     bool Create();
-    void PollEvents();
+    u32  PollEvents();
+    u32  WaitEvents(s32 timeoutMS);
     void Destroy();
 
     void           Show();
     void           Hide();
     void           SetGLContextCurrent() const;
+    // Releases the GL context from the calling thread, so another thread can make it current.
+    void           ReleaseGLContext() const;
+    // A new context that shares objects with the window's, for another thread to make current against this window
+    // (e.g. to compile shaders on). Leaves the window's context current. Destroy it with SDL_GL_DestroyContext().
+    NODISCARD SDL_GLContext CreateSharedGLContext() const;
     void           LockCursor() const;
     void           UnlockCursor() const;
     NODISCARD bool IsCursorLocked() const;
@@ -97,6 +103,8 @@ public:
     CascadingMulticastDelegate<false, const SDL_Event&>            OnSDLEvent;
 
 protected:
+    void DispatchEvent(const SDL_Event& windowEvent);
+
     WindowSpecification m_Specification;
 
     bool          m_IsVisible = false;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <span>
+
+// A cubic bezier, in canvas units (y down).
+struct WireCurve
+{
+    glm::vec2 P0;
+    glm::vec2 P1;
+    glm::vec2 P2;
+    glm::vec2 P3;
+
+    bool operator==(const WireCurve& other) const = default;
+
+    // The usual node editor link: leaves the output pin heading right, and comes into the input pin from the left.
+    NODISCARD static WireCurve MakeLink(const glm::vec2& from, const glm::vec2& to);
+};
+
+// A point on a tessellated wire's centreline.
+struct WirePoint
+{
+    glm::vec2 Position;
+    glm::vec2 Normal; // Unit length.
+};
+
+struct WireVertex
+{
+    glm::vec2 Position;
+    u32       Colour = 0; // IM_COL32 layout.
+    f32       Edge   = 0; // -1 on one side of the line and 1 on the other; the shader antialiases with it.
+};
+
+static_assert(sizeof(WireVertex) == 16, "WireVertex must match the vertex layout in CanvasRenderer");
+
+struct WireStats
+{
+    u32 Wires       = 0;
+    u32 CulledWires = 0;
+    u32 CacheHits   = 0;
+    u32 Tessellated = 0; // Wires whose curve was evaluated this frame (not culled or cached).
+    u32 Points      = 0;
+    u32 Vertices    = 0;
+    u32 Indices     = 0;
+    f64 BuildMS     = 0;
+
+    void Reset() { *this = WireStats(); }
+};
+
+// Tessellated centrelines of wires that don't change between frames, keyed by an ID that's stable across frames (e.g.
+// the link's). An entry is reused for as long as its curve and level of detail match. Only the centreline is kept,
+// so the cached wire's thickness and colour can still change.
+class WireCache
+{
+public:
+    // Returns the points of the wire if they're cached for this curve and segment count, or nothing.
+    NODISCARD std::span<const WirePoint> Find(u64 id, const WireCurve& curve, u32 segments);
+    void                                 Store(u64 id, const WireCurve& curve, std::span<const WirePoint> points);
+
+    // Evicts entries that haven't been used for maxUnusedFrames calls of this. Call once per frame.
+    void Trim(u32 maxUnusedFrames = 120);
+    void Clear();
+
+    NODISCARD FORCEINLINE u32 GetEntryCount() const { return static_cast<u32>(m_Entries.size()); }
+
+private:
+    struct Entry
+    {
+        WireCurve              Curve;
+        u64                    LastUsedFrame = 0;
+        std::vector<WirePoint> Points;
+    };
+
+    std::unordered_map<u64, Entry> m_Entries;
+    u64                            m_Frame = 0;
+};
+
+// Builds a frame's worth of wires as one batch of thick-line triangles.
+//
+// Each wire gets just enough segments that the line is never more than Tolerance pixels off the true curve at the
+// current zoom (Wang's formula), rounded up to a power of two so the LOD - and so the cache - only changes when the
+// zoom does by a good amount. Culling, segment counts and evaluation all work on four wires at once (SSE, with a
+// scalar fallback), from structure-of-arrays control points. Wires with similar segment counts are evaluated
+// together, so few lanes sit idle.
+//
+// Doesn't touch GL; hand it to CanvasRenderer::SubmitWires() to draw it. Keeps its allocations between frames.
+class WireBatch
+{
+public:
+    static constexpr u32 MaxSegments = 64;
+    static constexpr f32 Tolerance   = 0.25f;
+
+    // Starts a new frame. view is the area of the canvas that fills the viewport, in canvas units.
+    void Begin(const FRect& view, const glm::vec2& viewportSize);
+    // thickness is in canvas units (so it scales with zoom), but the line is never drawn thinner than a pixel. Give
+    // wires that are likely to stay put a non-zero ID, and Build() can reuse their tessellation from a cache.
+    void AddWire(const WireCurve& curve, u32 colour, f32 thickness, u64 id = 0);
+    // Culls, tessellates and expands everything added since Begin().
+    void Build(WireCache* cache = nullptr);
+
+    // The segment count Build() would use for the curve at this zoom.
+    NODISCARD static u32 GetSegmentCount(const WireCurve& curve, f32 pixelsPerUnit);
+
+    NODISCARD FORCEINLINE std::span<const WireVertex> GetVertices() const { return m_Vertices; }
+    NODISCARD FORCEINLINE std::span<const u32>        GetIndices() const { return m_Indices; }
+    NODISCARD FORCEINLINE const FRect&                GetView() const { return m_View; }
+    NODISCARD FORCEINLINE f32                         GetPixelsPerUnit() const { return m_PixelsPerUnit; }
+    NODISCARD FORCEINLINE const WireStats&            GetStats() const { return m_Stats; }
+
+private:
+    void ComputeSegmentCounts();
+    void Tessellate();
+    void Expand();
+
+    FRect m_View          = {0.0f, 0.0f, 0.0f, 0.0f};
+    f32   m_PixelsPerUnit = 1.0f;
+
+    // Control points, structure-of-arrays: m_X[1][i] is wire i's P1.x. Padded to a multiple of four during Build().
+    std::array<std::vector<f32>, 4> m_X;
+    std::array<std::vector<f32>, 4> m_Y;
+    std::vector<f32>                m_HalfWidths; // In canvas units.
+    std::vector<u32>                m_Colours;
+    std::vector<u64>                m_IDs;
+    u32                             m_WireCount = 0;
+
+    // Per wire, during Build().
+    std::vector<u32>                        m_Segments; // 0 if culled.
+    std::vector<u32>                        m_PointOffsets; // Into m_Points, for wires that were tessellated.
+    std::vector<std::span<const WirePoint>> m_Paths;
+
+    std::vector<u32>        m_TessellateOrder; // Wires to tessellate, grouped by segment count.
+    std::vector<u32>        m_SortScratch;
+    std::vector<WirePoint>  m_Points;
+    std::vector<WireVertex> m_Vertices;
+    std::vector<u32>        m_Indices;
+    WireStats               m_Stats;
+};
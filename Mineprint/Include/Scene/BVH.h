@@ -0,0 +1,123 @@
+#pragma once
+
+#include <span>
+
+#include "Scene/Bounds.h"
+
+class OcclusionBuffer;
+
+struct BVHSpecification
+{
+    // Leaves hold up to this many items, tested four at a time.
+    u32 MaxLeafSize = 8;
+    // Candidate splits per axis, when building with the SAH.
+    u32 Bins = 16;
+};
+
+// What a cull did. Items culled by a node are counted once, by whichever test culled it.
+struct CullStats
+{
+    u32 Items           = 0;
+    u32 Visible         = 0;
+    u32 FrustumCulled   = 0;
+    u32 OcclusionCulled = 0;
+    u32 NodesVisited    = 0;
+    u32 ItemsTested     = 0; // Against the frustum, individually; items in nodes entirely inside it aren't.
+    f64 CullMS          = 0;
+
+    void Reset() { *this = CullStats(); }
+};
+
+struct BVHStats
+{
+    u32 Items         = 0;
+    u32 Nodes         = 0;
+    u32 Leaves        = 0;
+    u32 Depth         = 0;
+    u32 RefittedNodes = 0; // By the last Refit().
+    f64 BuildMS       = 0;
+    f64 RefitMS       = 0;
+
+    void Reset() { *this = BVHStats(); }
+};
+
+// A binary bounding volume hierarchy over a set of boxes ("items", numbered from 0), for culling.
+//
+// Built top-down with a binned surface area heuristic. Every node covers a contiguous run of items in leaf order, so a
+// node that's entirely inside the frustum is accepted whole, without visiting what's under it. Item bounds are kept
+// as structure-of-arrays in that order, and leaves are tested against the frustum four items at a time (SSE, with a
+// scalar fallback); each node only tests the planes its parent straddled.
+//
+// Moving items doesn't need a rebuild: SetBounds() marks them, and Refit() updates their leaves and the nodes above.
+// The tree gets looser as things move, which GetCost() measures against how it was built; rebuild once it's too
+// loose.
+class BVH
+{
+public:
+    // Nodes any deeper are made leaves, however many items they hold, so traversal never needs a bigger stack.
+    static constexpr u32 MaxDepth = 64;
+
+    void Build(const BVHSpecification& spec, std::span<const AABB> bounds);
+    void Clear();
+
+    // Takes effect on the next Refit().
+    void SetBounds(u32 item, const AABB& bounds);
+    void Refit();
+
+    // Appends the items inside (or straddling) the frustum to visible, and with an occlusion buffer, leaves out those
+    // it hides. Adds to the stats rather than resetting them.
+    void Cull(const Frustum& frustum, std::vector<u32>& visible, CullStats& stats,
+              const OcclusionBuffer* occlusion = nullptr) const;
+    // The same test on every item, without the tree, as a baseline.
+    void CullFlat(const Frustum& frustum, std::vector<u32>& visible, CullStats& stats) const;
+
+    // The SAH cost: roughly how many nodes and items a query covering a random part of the tree touches. Only
+    // meaningful next to GetBuildCost(), what it was when the tree was last built.
+    NODISCARD f32 GetCost() const;
+
+    NODISCARD FORCEINLINE bool            IsBuilt() const { return !m_Nodes.empty(); }
+    NODISCARD FORCEINLINE bool            NeedsRefit() const { return !m_DirtyNodes.empty(); }
+    NODISCARD FORCEINLINE const AABB&     GetBounds() const { return m_Nodes[0].Bounds; }
+    NODISCARD FORCEINLINE f32             GetBuildCost() const { return m_BuildCost; }
+    NODISCARD FORCEINLINE const BVHStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Node
+    {
+        AABB Bounds;
+        u32  First = 0; // The node's items, in leaf order.
+        u32  Count = 0;
+        u32  Left  = 0; // Children are Left and Left + 1. 0 for leaves, as the root is never a child.
+    };
+
+    struct BuildTask
+    {
+        u32 Node;
+        u32 Depth;
+    };
+
+    NODISCARD FORCEINLINE bool IsLeaf(const Node& node) const { return node.Left == 0; }
+    NODISCARD AABB             GetItemBounds(u32 slot) const;
+    // The items of a leaf against the planes in planeMask (none means they're all inside).
+    void CullLeaf(const Frustum& frustum, const Node& node, u32 planeMask, std::vector<u32>& visible,
+                  CullStats& stats, const OcclusionBuffer* occlusion) const;
+    // Partitions a node's items for its children, returning how many go to the left one.
+    NODISCARD u32 Partition(const BVHSpecification& spec, const Node& node, std::span<const AABB> bounds,
+                            std::span<const glm::vec3> centers);
+
+    std::vector<Node> m_Nodes;
+    std::vector<u32>  m_Parents;
+    std::vector<u32>  m_Order;  // Item by slot (position in leaf order).
+    std::vector<u32>  m_SlotOf; // Slot by item.
+    std::vector<u32>  m_LeafOf; // Leaf by slot.
+    // Item bounds by slot, structure-of-arrays: m_Min[1][slot] is the item's minimum Y. Padded by three.
+    std::array<std::vector<f32>, 3> m_Min;
+    std::array<std::vector<f32>, 3> m_Max;
+
+    std::vector<u32>       m_DirtyNodes;
+    std::vector<u8>        m_Dirty;
+    std::vector<BuildTask> m_BuildStack;
+    f64                    m_Cost      = 0.0; // Unnormalised: GetCost() divides by the root's area.
+    f32                    m_BuildCost = 0.0f;
+    BVHStats               m_Stats;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <limits>
+
+// An axis-aligned box. The default one is empty (inverted), so growing it by anything gives that thing's bounds.
+struct AABB
+{
+    glm::vec3 Min = glm::vec3(std::numeric_limits<f32>::max());
+    glm::vec3 Max = glm::vec3(-std::numeric_limits<f32>::max());
+
+    NODISCARD FORCEINLINE bool      IsEmpty() const { return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z; }
+    NODISCARD FORCEINLINE glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+    NODISCARD FORCEINLINE glm::vec3 GetExtent() const { return (Max - Min) * 0.5f; }
+
+    // Half the surface area, which is all the SAH needs (it only compares areas). 0 when empty.
+    NODISCARD FORCEINLINE f32 GetHalfArea() const
+    {
+        if (IsEmpty())
+            return 0.0f;
+        const glm::vec3 size = Max - Min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    void Grow(const glm::vec3& point)
+    {
+        Min = glm::min(Min, point);
+        Max = glm::max(Max, point);
+    }
+
+    void Grow(const AABB& other)
+    {
+        Min = glm::min(Min, other.Min);
+        Max = glm::max(Max, other.Max);
+    }
+
+    NODISCARD bool Overlaps(const AABB& other) const
+    {
+        return Min.x <= other.Max.x && Max.x >= other.Min.x && Min.y <= other.Max.y && Max.y >= other.Min.y
+               && Min.z <= other.Max.z && Max.z >= other.Min.z;
+    }
+
+    NODISCARD bool Contains(const AABB& other) const
+    {
+        return Min.x <= other.Min.x && Max.x >= other.Max.x && Min.y <= other.Min.y && Max.y >= other.Max.y
+               && Min.z <= other.Min.z && Max.z >= other.Max.z;
+    }
+
+    bool operator==(const AABB& other) const = default;
+
+    // The bounds of the box after a transform (Arvo's method: exact for the transformed box, not its corners).
+    NODISCARD AABB Transform(const glm::mat4& transform) const
+    {
+        const glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+        const glm::vec3 half   = GetExtent();
+        const glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * half.x + glm::abs(glm::vec3(transform[1])) * half.y
+                                 + glm::abs(glm::vec3(transform[2])) * half.z;
+        return {center - extent, center + extent};
+    }
+};
+
+// Which side of a frustum a box is on.
+enum class FrustumTest : u8
+{
+    Outside,
+    Intersects,
+    Inside,
+};
+
+// The six planes of a view frustum, pointing inwards: a point p is inside plane i when dot(Planes[i], vec4(p, 1))
+// is at least 0.
+struct Frustum
+{
+    std::array<glm::vec4, 6> Planes = {};
+
+    // From a view-projection matrix with GL's clip space (-w to w on every axis), by Gribb and Hartmann's method.
+    // The planes come out in the order left, right, bottom, top, near, far, normalised.
+    NODISCARD static Frustum FromMatrix(const glm::mat4& viewProjection)
+    {
+        const glm::mat4 m = glm::transpose(viewProjection);
+        Frustum         frustum;
+        frustum.Planes[0] = m[3] + m[0];
+        frustum.Planes[1] = m[3] - m[0];
+        frustum.Planes[2] = m[3] + m[1];
+        frustum.Planes[3] = m[3] - m[1];
+        frustum.Planes[4] = m[3] + m[2];
+        frustum.Planes[5] = m[3] - m[2];
+        for (glm::vec4& plane : frustum.Planes)
+            plane /= glm::length(glm::vec3(plane));
+        return frustum;
+    }
+
+    // The box against each plane, by its nearest and furthest corners along the plane's normal. Conservative: a box
+    // near a corner of the frustum can be outside it but still reported as intersecting.
+    NODISCARD FrustumTest Test(const AABB& box) const
+    {
+        const glm::vec3 center = box.GetCenter();
+        const glm::vec3 extent = box.GetExtent();
+        FrustumTest     result = FrustumTest::Inside;
+        for (const glm::vec4& plane : Planes)
+        {
+            const f32 distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            const f32 radius   = glm::dot(glm::abs(glm::vec3(plane)), extent);
+            if (distance < -radius)
+                return FrustumTest::Outside;
+            if (distance < radius)
+                result = FrustumTest::Intersects;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <span>
+
+#include "Scene/Bounds.h"
+
+struct OcclusionBufferSpecification
+{
+    // Occluders are big (walls, solid chunk sections), so a coarse buffer finds nearly everything a full-size one
+    // would, for a fraction of the fill.
+    u32 Width  = 256;
+    u32 Height = 128;
+};
+
+struct OcclusionStats
+{
+    u32 Occluders = 0;
+    u32 Triangles = 0; // After clipping to the near plane.
+    u32 Pixels    = 0; // Covered by a triangle, counting overdraw.
+    f64 RenderMS  = 0; // Rasterising the occluders and building the pyramid.
+
+    void Reset() { *this = OcclusionStats(); }
+};
+
+// A low resolution depth buffer, rasterised on the CPU from a few large occluders, for throwing away what they hide
+// before it's drawn.
+//
+// Begin() with the frame's view-projection, add occluders, then Finish() builds a pyramid of the furthest depth in
+// each 2x2 block. IsOccluded() projects a box, picks the level where its screen rectangle covers a few texels, and
+// calls it hidden if every one of them holds something nearer than the box's nearest point. Boxes crossing the near
+// plane are always visible. Testing is read-only, so several threads can cull against one buffer.
+//
+// Occluders must be solid - nothing seen through them - and what they hide is decided at pixel centres, so a box
+// peeking out less than a pixel past an occluder's edge can be culled. At this resolution that's a sliver of the
+// final image; it's what makes the test fast.
+class OcclusionBuffer
+{
+public:
+    void Begin(const OcclusionBufferSpecification& spec, const glm::mat4& viewProjection);
+    // Triangles, with positions transformed by transform before viewProjection.
+    void AddOccluder(std::span<const glm::vec3> positions, std::span<const u32> indices,
+                     const glm::mat4& transform = glm::mat4(1.0f));
+    // A box that's solid all the way through.
+    void AddOccluder(const AABB& box);
+    void Finish();
+
+    NODISCARD bool IsOccluded(const AABB& box) const;
+
+    NODISCARD FORCEINLINE u32                   GetWidth() const { return m_Width; }
+    NODISCARD FORCEINLINE u32                   GetHeight() const { return m_Height; }
+    NODISCARD FORCEINLINE u32                   GetLevelCount() const { return static_cast<u32>(m_Levels.size()); }
+    // Depths from 0 (near) to 1 (far), row by row from the bottom; level 0 is the full resolution.
+    NODISCARD FORCEINLINE std::span<const f32>  GetDepths(const u32 level = 0) const { return m_Levels[level].Depths; }
+    NODISCARD FORCEINLINE const OcclusionStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Level
+    {
+        u32              Width  = 0;
+        u32              Height = 0;
+        std::vector<f32> Depths;
+    };
+
+    // A clip space triangle, clipped to the near plane.
+    void ClipAndRasterise(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+    // A triangle in pixels, with depth from 0 to 1.
+    void Rasterise(const glm::vec3& a, glm::vec3 b, glm::vec3 c);
+
+    glm::mat4              m_ViewProjection = glm::mat4(1.0f);
+    u32                    m_Width          = 0;
+    u32                    m_Height         = 0;
+    std::vector<Level>     m_Levels;
+    std::vector<glm::vec4> m_Transformed; // Scratch: an occluder's vertices, in clip space.
+    OcclusionStats         m_Stats;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core/Utility/HandlePool.h"
+#include "Scene/BVH.h"
+
+class OcclusionBuffer;
+
+struct SceneObjectTag;
+using SceneObjectHandle = Handle<SceneObjectTag>;
+
+struct SceneSpecification
+{
+    BVHSpecification BVH;
+    // Refitting lets the tree get looser as objects move. Once its cost (see BVH::GetCost()) is this many times what
+    // it was when it was built, it's rebuilt instead.
+    f32 RebuildCost = 1.5f;
+};
+
+// What the last Cull() did, and what changed since the one before.
+struct SceneStats
+{
+    CullStats Cull;
+    u32       Objects  = 0;
+    u32       Moved    = 0; // Since the last Cull().
+    bool      Rebuilt  = false;
+    f64       UpdateMS = 0; // Refitting or rebuilding the BVH.
+
+    void Reset() { *this = SceneStats(); }
+};
+
+// The objects of a preview scene, as bounds, for culling. Each has a handle, and a value of the caller's (an index
+// into its own draw list, say) that Cull() gives back for the visible ones.
+//
+// The BVH is rebuilt after objects are added or removed, and refitted after they move, when the scene is next culled
+// (or Update() is called). Adding many objects at once is best done before a frame, as each Cull() after a change
+// pays for the rebuild.
+class Scene
+{
+public:
+    explicit Scene(const SceneSpecification& spec = {});
+
+    SceneObjectHandle Add(const AABB& bounds, u32 userData = 0);
+    void              Remove(SceneObjectHandle handle);
+    void              SetBounds(SceneObjectHandle handle, const AABB& bounds);
+    void              Clear();
+
+    // Null for stale handles.
+    NODISCARD const AABB* GetBounds(SceneObjectHandle handle) const;
+
+    // Brings the BVH up to date with the changes since the last one.
+    void Update();
+    // Replaces visible with the user data of the objects inside the frustum of a GL view-projection matrix, less those
+    // the occlusion buffer (if any) hides. Resets the stats first.
+    void Cull(const glm::mat4& viewProjection, std::vector<u32>& visible, const OcclusionBuffer* occlusion = nullptr);
+
+    NODISCARD FORCEINLINE u32               GetObjectCount() const { return static_cast<u32>(m_Bounds.size()); }
+    NODISCARD FORCEINLINE const BVH&        GetBVH() const { return m_BVH; }
+    NODISCARD FORCEINLINE const SceneStats& GetStats() const { return m_Stats; }
+
+private:
+    SceneSpecification m_Spec;
+
+    // Objects are kept dense, in the order the BVH numbers its items. Handles find their index, and removing one
+    // moves the last into its place.
+    HandlePool<u32, SceneObjectTag> m_Handles;
+    std::vector<AABB>               m_Bounds;
+    std::vector<u32>                m_UserData;
+    std::vector<SceneObjectHandle>  m_HandleOf;
+
+    BVH        m_BVH;
+    bool       m_NeedsRebuild = false;
+    // What's happened since the last Cull(), for its stats.
+    u32        m_Moved    = 0;
+    bool       m_Rebuilt  = false;
+    f64        m_UpdateMS = 0;
+    SceneStats m_Stats;
+};
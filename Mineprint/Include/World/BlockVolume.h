@@ -0,0 +1,120 @@
+#pragma once
+
+using BlockID = u16;
+
+static constexpr BlockID AirBlock = 0;
+
+// In Minecraft's order (and its names: north is -Z, and east is +X).
+enum class BlockFace : u8
+{
+    Down,
+    Up,
+    North,
+    South,
+    West,
+    East,
+    Count
+};
+
+inline const char* BlockFaceToString(const BlockFace face)
+{
+    switch (face)
+    {
+    case BlockFace::Down:
+        return "Down";
+    case BlockFace::Up:
+        return "Up";
+    case BlockFace::North:
+        return "North";
+    case BlockFace::South:
+        return "South";
+    case BlockFace::West:
+        return "West";
+    case BlockFace::East:
+        return "East";
+    default:
+        return "Unknown";
+    }
+}
+
+// How a block ID looks: a texture per face, and whether it hides what's behind it.
+struct BlockType
+{
+    std::array<u16, static_cast<size_t>(BlockFace::Count)> Textures = {}; // Whatever the renderer indexes, by face.
+    // Opaque blocks hide their neighbours' faces and darken the corners next to them. Others (glass, leaves) only hide
+    // faces between two of the same block.
+    bool Opaque = true;
+};
+
+// 16x16x16 blocks, stored in Minecraft's order: x fastest, then z, then y.
+class ChunkSection
+{
+public:
+    static constexpr u32 Size   = 16;
+    static constexpr u32 Volume = Size * Size * Size;
+
+    NODISCARD static FORCEINLINE u32 GetIndex(const u32 x, const u32 y, const u32 z) { return (y << 8) | (z << 4) | x; }
+
+    NODISCARD FORCEINLINE BlockID Get(const u32 x, const u32 y, const u32 z) const
+    {
+        return m_Blocks[GetIndex(x, y, z)];
+    }
+
+    void Set(const u32 x, const u32 y, const u32 z, const BlockID block)
+    {
+        BlockID& existing = m_Blocks[GetIndex(x, y, z)];
+        m_BlockCount += (block != AirBlock) - (existing != AirBlock);
+        existing = block;
+    }
+
+    NODISCARD FORCEINLINE const std::array<BlockID, Volume>& GetBlocks() const { return m_Blocks; }
+    // Blocks that aren't air.
+    NODISCARD FORCEINLINE u32  GetBlockCount() const { return m_BlockCount; }
+    NODISCARD FORCEINLINE bool IsEmpty() const { return m_BlockCount == 0; }
+
+private:
+    std::array<BlockID, Volume> m_Blocks     = {};
+    u32                         m_BlockCount = 0;
+};
+
+// A sparse grid of sections, e.g. a structure or a multiblock machine. Sections are created as blocks are set, and
+// anything outside them is air. Coordinates are in blocks, and can be negative.
+class BlockVolume
+{
+public:
+    BlockVolume() = default;
+
+    BlockVolume(const BlockVolume& other)                = delete;
+    BlockVolume(BlockVolume&& other) noexcept            = default;
+    BlockVolume& operator=(const BlockVolume& other)     = delete;
+    BlockVolume& operator=(BlockVolume&& other) noexcept = default;
+
+    void SetBlock(const glm::ivec3& position, BlockID block);
+    NODISCARD BlockID GetBlock(const glm::ivec3& position) const;
+
+    // Null if there's no section there (it's all air).
+    NODISCARD const ChunkSection* GetSection(const glm::ivec3& section) const;
+    ChunkSection&                 GetOrCreateSection(const glm::ivec3& section);
+    // Positions of every section with at least one block in, sorted (y, then z, then x).
+    NODISCARD std::vector<glm::ivec3> GetSectionPositions() const;
+
+    void Clear() { m_Sections.clear(); }
+
+    NODISCARD FORCEINLINE u32 GetSectionCount() const { return static_cast<u32>(m_Sections.size()); }
+
+    NODISCARD static FORCEINLINE glm::ivec3 GetSectionPosition(const glm::ivec3& block)
+    {
+        return {block.x >> 4, block.y >> 4, block.z >> 4};
+    }
+
+private:
+    // 21 bits per axis, which is more than a Minecraft world needs.
+    NODISCARD static FORCEINLINE u64 GetKey(const glm::ivec3& section)
+    {
+        constexpr u64 mask = (1ull << 21) - 1;
+        return (static_cast<u64>(section.y) & mask) << 42 | (static_cast<u64>(section.z) & mask) << 21
+               | (static_cast<u64>(section.x) & mask);
+    }
+
+    std::unordered_map<u64, Scope<ChunkSection>> m_Sections;
+};
@@ -11,6 +11,7 @@
 #include <functional>
 #include <filesystem>
 #include <deque>
+#include <atomic>
 
 // Data types
 #include <string>
@@ -39,6 +40,7 @@
 #include "Core/Utility/UUID.h"
 #include "Core/Utility/Buffer.h"
 #include "Core/Utility/Timer.h"
+#include "Core/Utility/StartupTimeline.h"
 #include "Core/Utility/FileUtil.h"
 #include "Core/MathUtil.h"
 #include "Core/Delegate.h"
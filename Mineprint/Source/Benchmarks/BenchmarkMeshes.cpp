@@ -0,0 +1,61 @@
+#include "mppch.h"
+
+#include "Benchmarks/BenchmarkMeshes.h"
+#include "Render/MeshFile.h"
+
+TestMesh BenchmarkMeshes::MakeSphere(const u32 rings, const u32 segments)
+{
+    TestMesh mesh;
+    mesh.Name         = fmt::format("{}x{} sphere", segments, rings);
+    mesh.SphereRadius = 5.0f;
+    for (u32 ring = 0; ring <= rings; ring++)
+    {
+        for (u32 segment = 0; segment <= segments; segment++)
+        {
+            const glm::vec2 uv     = {static_cast<f32>(segment) / segments, static_cast<f32>(ring) / rings};
+            const f32       theta  = uv.y * glm::pi<f32>();
+            const f32       phi    = uv.x * glm::two_pi<f32>();
+            const glm::vec3 normal = {
+                std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)
+            };
+            mesh.Vertices.push_back({.Position = normal * mesh.SphereRadius, .Normal = normal, .UV = uv});
+        }
+    }
+    for (u32 half = 0; half < 2; half++)
+    {
+        const u32 first = static_cast<u32>(mesh.Indices.size());
+        for (u32 ring = half * rings / 2; ring < (half + 1) * rings / 2; ring++)
+        {
+            for (u32 segment = 0; segment < segments; segment++)
+            {
+                const u32 corner = ring * (segments + 1) + segment;
+                mesh.Indices.insert(mesh.Indices.end(), {corner, corner + 1, corner + segments + 1});
+                mesh.Indices.insert(mesh.Indices.end(), {corner + 1, corner + segments + 2, corner + segments + 1});
+            }
+        }
+        mesh.SubMeshes.push_back({
+            .FirstIndex    = first,
+            .IndexCount    = static_cast<u32>(mesh.Indices.size()) - first,
+            .MaterialIndex = half
+        });
+    }
+    return mesh;
+}
+
+TestMesh BenchmarkMeshes::CopyMeshFile(const MeshFile& file, const std::string& name)
+{
+    TestMesh mesh;
+    mesh.Name = name;
+    for (size_t i = 0; i < file.GetData().size(); i++)
+    {
+        const MeshFileSubMesh& data    = file.GetData()[i];
+        SubMesh                subMesh = file.GetSubMeshes()[i];
+        subMesh.FirstIndex             = static_cast<u32>(mesh.Indices.size());
+        subMesh.BaseVertex             = static_cast<u32>(mesh.Vertices.size());
+        mesh.Vertices.insert(mesh.Vertices.end(), data.Vertices.begin(), data.Vertices.end());
+        mesh.Indices.insert(mesh.Indices.end(), data.Indices16.begin(), data.Indices16.end());
+        mesh.Indices.insert(mesh.Indices.end(), data.Indices32.begin(), data.Indices32.end());
+        mesh.SubMeshes.push_back(subMesh);
+    }
+    return mesh;
+}
@@ -0,0 +1,234 @@
+#include "mppch.h"
+
+#include <fstream>
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Render/BlockBenchModel.h"
+
+namespace
+{
+    u32 Crc32(const u8* data, const size_t size, u32 crc = 0)
+    {
+        static const std::array<u32, 256> table = []
+        {
+            std::array<u32, 256> result;
+            for (u32 i = 0; i < 256; i++)
+            {
+                u32 value = i;
+                for (u32 bit = 0; bit < 8; bit++)
+                    value = value & 1 ? 0xEDB88320 ^ value >> 1 : value >> 1;
+                result[i] = value;
+            }
+            return result;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ crc >> 8;
+        return ~crc;
+    }
+
+    // A PNG with its image data stored rather than compressed. Big, but any decoder takes it, and it's quick to write.
+    std::vector<u8> EncodeStoredPNG(const u32 width, const u32 height, const std::vector<u8>& pixels)
+    {
+        std::vector<u8> png  = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        auto            be32 = [](std::vector<u8>& bytes, const u32 value)
+        {
+            bytes.insert(bytes.end(), {
+                             static_cast<u8>(value >> 24), static_cast<u8>(value >> 16), static_cast<u8>(value >> 8),
+                             static_cast<u8>(value)
+                         });
+        };
+        auto chunk = [&](const char* type, const std::vector<u8>& data)
+        {
+            be32(png, static_cast<u32>(data.size()));
+            const size_t start = png.size();
+            png.insert(png.end(), type, type + 4);
+            png.insert(png.end(), data.begin(), data.end());
+            be32(png, Crc32(png.data() + start, png.size() - start));
+        };
+
+        std::vector<u8> header;
+        be32(header, width);
+        be32(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0}); // 8-bit RGBA.
+        chunk("IHDR", header);
+
+        // Each row starts with filter 0 (none). Then zlib: a header, stored blocks of up to 65535 bytes, and Adler-32.
+        std::vector<u8> rows;
+        for (u32 y = 0; y < height; y++)
+        {
+            rows.push_back(0);
+            rows.insert(rows.end(), pixels.begin() + y * width * 4, pixels.begin() + (y + 1) * width * 4);
+        }
+        std::vector<u8> zlib = {0x78, 0x01};
+        for (size_t offset = 0; offset < rows.size() || offset == 0; offset += 65535)
+        {
+            const u16 size = static_cast<u16>(std::min<size_t>(rows.size() - offset, 65535));
+            zlib.insert(zlib.end(), {
+                            static_cast<u8>(offset + size == rows.size()), static_cast<u8>(size),
+                            static_cast<u8>(size >> 8), static_cast<u8>(~size), static_cast<u8>(~size >> 8)
+                        });
+            zlib.insert(zlib.end(), rows.begin() + offset, rows.begin() + offset + size);
+        }
+        u32 a = 1, b = 0;
+        for (const u8 byte : rows)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        be32(zlib, b << 16 | a);
+        chunk("IDAT", zlib);
+        chunk("IEND", {});
+        return png;
+    }
+
+    std::string EncodeBase64(const std::vector<u8>& bytes)
+    {
+        constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string text;
+        for (size_t i = 0; i < bytes.size(); i += 3)
+        {
+            const u32 count = static_cast<u32>(std::min<size_t>(bytes.size() - i, 3));
+            u32       bits  = bytes[i] << 16;
+            if (count > 1)
+                bits |= bytes[i + 1] << 8;
+            if (count > 2)
+                bits |= bytes[i + 2];
+            for (u32 c = 0; c < 4; c++)
+                text += c <= count ? alphabet[bits >> (18 - c * 6) & 63] : '=';
+        }
+        return text;
+    }
+}
+
+// Bakes a generated .bbmodel shaped like a big entity or machine model: cubes in rotated groups, some of them rotated
+// themselves, textured from a few embedded 64x64 PNGs. Times baking from the JSON (parse, texture decode, geometry and
+// atlas), then loading the same file again from the baked cache, and checks the cached mesh matches the baked one.
+static void BlockBenchBenchmark(const BenchmarkContext& context)
+{
+    const u32 cubeCount  = static_cast<u32>(context.Args.GetInt("benchmark-cubes", 2000));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 10));
+
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<s32> coordinate(-64, 64);
+    std::uniform_int_distribution<s32> size(1, 12);
+    std::uniform_int_distribution<u32> chance(0, 99);
+    std::uniform_int_distribution<u32> colour(0, 0xFFFFFF);
+
+    constexpr u32 textureCount = 4;
+    constexpr u32 groupCount   = 50;
+    std::string   json         = R"({"meta": {"format_version": "4.5", "model_format": "free"}, "name": "benchmark",)"
+                                 R"( "resolution": {"width": 64, "height": 64}, "elements": [)";
+    for (u32 i = 0; i < cubeCount; i++)
+    {
+        const glm::ivec3 from     = {coordinate(random), coordinate(random), coordinate(random)};
+        const glm::ivec3 to       = from + glm::ivec3(size(random), size(random), size(random));
+        const s32        rotation = chance(random) < 20 ? 22 : 0;
+
+        std::string faces;
+        for (const char* face : {"north", "south", "east", "west", "up", "down"})
+        {
+            faces += fmt::format(R"({}"{}": {{"uv": [{}, {}, {}, {}], "texture": {}, "rotation": {}}})",
+                                 faces.empty() ? "" : ", ", face, 0, 0, to.x - from.x, to.y - from.y,
+                                 chance(random) % textureCount, chance(random) % 4 * 90);
+        }
+        json += fmt::format(R"({}{{"name": "cube{}", "from": [{}, {}, {}], "to": [{}, {}, {}], "origin": [{}, {}, {}],)"
+                            R"( "rotation": [0, {}, 0], "faces": {{{}}}, "uuid": "cube-{}"}})",
+                            i == 0 ? "" : ", ", i, from.x, from.y, from.z, to.x, to.y, to.z, from.x, from.y, from.z,
+                            rotation, faces, i);
+    }
+
+    json += R"(], "outliner": [)";
+    for (u32 group = 0; group < groupCount; group++)
+    {
+        std::string children;
+        for (u32 i = group; i < cubeCount; i += groupCount)
+            children += fmt::format(R"({}"cube-{}")", children.empty() ? "" : ", ", i);
+        json += fmt::format(R"({}{{"name": "group{}", "origin": [0, {}, 0], "rotation": [{}, 0, 0],)"
+                            R"( "children": [{}]}})", group == 0 ? "" : ", ", group, group, group % 5 * 10, children);
+    }
+
+    json += R"(], "textures": [)";
+    for (u32 i = 0; i < textureCount; i++)
+    {
+        std::vector<u8> pixels(64 * 64 * 4);
+        for (size_t p = 0; p < pixels.size(); p += 4)
+        {
+            const u32 value = colour(random);
+            pixels[p]       = static_cast<u8>(value);
+            pixels[p + 1]   = static_cast<u8>(value >> 8);
+            pixels[p + 2]   = static_cast<u8>(value >> 16);
+            pixels[p + 3]   = 255;
+        }
+        json += fmt::format(R"({}{{"name": "texture{}.png", "width": 64, "height": 64,)"
+                            R"( "source": "data:image/png;base64,{}"}})", i == 0 ? "" : ", ", i,
+                            EncodeBase64(EncodeStoredPNG(64, 64, pixels)));
+    }
+    json += "]}";
+
+    JobSystem&                   jobs = context.App.GetJobSystem();
+    BlockBenchModelSpecification spec;
+    BlockBenchModel              baked;
+    bool                         valid      = true;
+    const BenchmarkResult        bakeResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= baked.Bake(spec, json, jobs);
+    });
+    const BlockBenchModelStats stats = baked.GetStats();
+
+    // Load() from a file, once to fill the cache and then from it.
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() /
+                                         fmt::format("MineprintBlockBenchBenchmark{}", SDL_GetTicksNS());
+    const std::filesystem::path path   = folder / "benchmark.bbmodel";
+    std::error_code             error;
+    std::filesystem::create_directories(folder, error);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+    spec.CacheDirectory = folder / "cache";
+
+    BlockBenchModel cached;
+    valid = valid && cached.Load(spec, path, jobs) && !cached.GetStats().FromCache;
+
+    const BenchmarkResult cachedResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= cached.Load(spec, path, jobs) && cached.GetStats().FromCache;
+    });
+    const BlockBenchModelStats cachedStats = cached.GetStats();
+    std::filesystem::remove_all(folder, error);
+
+    auto       sameLOD = [](const MeshLOD& a, const MeshLOD& b)
+    {
+        return a.Error == b.Error && a.SubMeshes.size() == b.SubMeshes.size()
+               && std::memcmp(a.SubMeshes.data(), b.SubMeshes.data(), a.SubMeshes.size() * sizeof(SubMesh)) == 0;
+    };
+    const bool matches = cached.GetIndices() == baked.GetIndices()
+                         && std::ranges::equal(cached.GetLODs(), baked.GetLODs(), sameLOD)
+                         && cached.GetVertices().size() == baked.GetVertices().size()
+                         && std::memcmp(cached.GetVertices().data(), baked.GetVertices().data(),
+                                        baked.GetVertices().size() * sizeof(MeshVertex)) == 0
+                         && std::ranges::equal(cached.GetAtlas().GetPixels(0), baked.GetAtlas().GetPixels(0));
+
+    MP_INFO("BlockBench model, {} cubes in {} groups, {:.1f}KB of JSON ({} iterations, best time):", cubeCount,
+            groupCount, static_cast<f64>(json.size()) / 1024.0, iterations);
+    MP_INFO("   {} faces, {} vertices, {} indices, {} textures, {} LODs", stats.Faces, stats.Vertices, stats.Indices,
+            stats.Textures, baked.GetLODs().size());
+    MP_INFO("   Baked:  {:.3f}ms (parse {:.3f}ms, textures {:.3f}ms, geometry and atlas {:.3f}ms)", bakeResult.MinMS,
+            stats.ParseMS, stats.DecodeMS, stats.BakeMS);
+    MP_INFO("   Cached: {:.3f}ms (read and hash {:.3f}ms, load {:.3f}ms), {:.1f}x faster", cachedResult.MinMS,
+            cachedStats.ReadMS, cachedStats.CacheMS, bakeResult.MinMS / cachedResult.MinMS);
+
+    if (!valid || !matches || stats.Faces != cubeCount * 6)
+    {
+        MP_ERROR("BlockBench results are wrong: {} faces baked (expected {}), cache {}", stats.Faces, cubeCount * 6,
+                 matches ? "matched" : "didn't match");
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(BlockBenchBenchmark, "blockbench", "BlockBench model baking, and loading it from the cache");
@@ -0,0 +1,72 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Render/CanvasRenderer.h"
+
+// Builds the canvas instances for a large graph of nodes, as the node editor would each frame. Only the CPU side:
+// the GPU side is one instanced draw however many nodes there are.
+static void CanvasBuildBenchmark(const BenchmarkContext& context)
+{
+    const u32 nodeCount  = static_cast<u32>(context.Args.GetInt("benchmark-nodes", 100000));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+
+    // A square grid of nodes with a few pins each.
+    constexpr glm::vec2                nodeSize    = {160.0f, 120.0f};
+    constexpr glm::vec2                nodeSpacing = {220.0f, 170.0f};
+    const u32                          columns     = static_cast<u32>(std::ceil(std::sqrt(nodeCount)));
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<u32> pins(0, 4);
+
+    std::vector<CanvasNode> nodes(nodeCount);
+    for (u32 i = 0; i < nodeCount; i++)
+    {
+        const glm::vec2 position = glm::vec2(i % columns, i / columns) * nodeSpacing;
+        nodes[i].Bounds     = FRect(position, nodeSize);
+        nodes[i].InputPins  = static_cast<u8>(pins(random));
+        nodes[i].OutputPins = static_cast<u8>(pins(random));
+    }
+
+    const glm::vec2 graphSize = glm::vec2(columns, (nodeCount + columns - 1) / columns) * nodeSpacing;
+
+    struct Case
+    {
+        const char* Name;
+        FRect       View;
+        glm::vec2   Viewport;
+    };
+    const Case cases[] = {
+        // Every node on screen at 1:1, so full detail for all of them - the worst case for instance building.
+        {"All nodes, full detail", FRect({0.0f, 0.0f}, graphSize), graphSize},
+        // Zoomed out to fit the graph in a 1080p window: every node is visible, but a single LOD quad.
+        {"All nodes, fit to 1080p", FRect({0.0f, 0.0f}, graphSize), {1920.0f, 1920.0f * graphSize.y / graphSize.x}},
+        // A 1080p window at 1:1 in the middle of the graph: nearly everything is culled.
+        {"1080p at 1:1", FRect(graphSize * 0.5f, {1920.0f, 1080.0f}), {1920.0f, 1080.0f}},
+    };
+
+    MP_INFO("Canvas instance build, {} nodes ({} iterations, best time):", nodeCount, iterations);
+
+    CanvasBatch batch;
+    for (const Case& test : cases)
+    {
+        const BenchmarkResult result = Benchmarks::Measure(iterations, [&]
+        {
+            batch.Begin(test.View, test.Viewport);
+            batch.DrawNodes(nodes);
+        });
+
+        const CanvasStats& stats = batch.GetStats();
+        const u64          bytes = static_cast<u64>(stats.Instances) * sizeof(CanvasInstance);
+        MP_INFO("   {:<24} {:.3f}ms ({:.1f}ns/node), {} instances ({:.1f} KB), {} culled, {} LOD", test.Name,
+                result.MinMS, result.MinMS * 1e6 / nodeCount, stats.Instances, static_cast<f64>(bytes) / 1024.0,
+                stats.CulledNodes, stats.LODNodes);
+
+        if (stats.Nodes != nodeCount || stats.Instances != batch.GetInstances(CanvasLayer::Nodes).size())
+        {
+            MP_ERROR("Canvas batch stats don't match what was drawn!");
+            context.App.SetExitCode(1);
+        }
+    }
+}
+
+MP_REGISTER_BENCHMARK(CanvasBuildBenchmark, "canvas-build", "Builds and culls node editor canvas instances");
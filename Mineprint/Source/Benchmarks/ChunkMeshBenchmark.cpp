@@ -0,0 +1,160 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Render/ChunkMesher.h"
+
+namespace
+{
+    enum Block : BlockID
+    {
+        Air,
+        Stone,
+        Dirt,
+        Grass,
+        Glass,
+        Leaves,
+        BlockCount
+    };
+
+    // Faces of every block one at a time, the obvious way, to check the mesher's bitmasks against.
+    u32 CountVisibleFaces(const BlockVolume& volume, const std::span<const BlockType> palette)
+    {
+        constexpr glm::ivec3 directions[6] = {{0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}};
+
+        u32 faces = 0;
+        for (const glm::ivec3& section : volume.GetSectionPositions())
+        {
+            for (u32 i = 0; i < ChunkSection::Volume; i++)
+            {
+                const glm::ivec3 position = section * 16 + glm::ivec3(i & 15, i >> 8, i >> 4 & 15);
+                const BlockID    block    = volume.GetBlock(position);
+                if (block == AirBlock)
+                    continue;
+                for (const glm::ivec3& direction : directions)
+                {
+                    const BlockID neighbour = volume.GetBlock(position + direction);
+                    if (neighbour != AirBlock && (palette[neighbour].Opaque || neighbour == block))
+                        continue;
+                    faces++;
+                }
+            }
+        }
+        return faces;
+    }
+
+    // Total area of the quads, in block faces. Merging mustn't lose or add any.
+    u32 CountQuadArea(const std::span<const ChunkMesh> meshes)
+    {
+        u32 area = 0;
+        for (const ChunkMesh& mesh : meshes)
+        {
+            for (size_t quad = 0; quad < mesh.Vertices.size(); quad += 4)
+            {
+                glm::uvec3 min = mesh.Vertices[quad].GetPosition();
+                glm::uvec3 max = min;
+                for (size_t i = 1; i < 4; i++)
+                {
+                    min = glm::min(min, mesh.Vertices[quad + i].GetPosition());
+                    max = glm::max(max, mesh.Vertices[quad + i].GetPosition());
+                }
+                const glm::uvec3 size = max - min; // Zero along the normal.
+                area                  += std::max(size.x, 1u) * std::max(size.y, 1u) * std::max(size.z, 1u);
+            }
+        }
+        return area;
+    }
+}
+
+// Meshes a patch of generated terrain: rolling stone and dirt under grass, with caves, and see-through glass and
+// leaves scattered about. Measures sections per second on the job system and on one thread, and checks the merged
+// quads cover exactly the faces a block-by-block count finds.
+static void ChunkMeshBenchmark(const BenchmarkContext& context)
+{
+    // 4 sections high, and this many across each way.
+    constexpr s32 height     = 4;
+    const s32     width      = static_cast<s32>(context.Args.GetInt("benchmark-sections", 16));
+    const u32     iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 10));
+
+    std::array<BlockType, BlockCount> palette;
+    auto setTextures = [&](const Block block, const u16 side, const u16 top, const u16 bottom)
+    {
+        palette[block].Textures.fill(side);
+        palette[block].Textures[static_cast<size_t>(BlockFace::Up)]   = top;
+        palette[block].Textures[static_cast<size_t>(BlockFace::Down)] = bottom;
+    };
+    setTextures(Stone, 1, 1, 1);
+    setTextures(Dirt, 2, 2, 2);
+    setTextures(Grass, 3, 4, 2);
+    setTextures(Glass, 5, 5, 5);
+    setTextures(Leaves, 6, 6, 6);
+    palette[Glass].Opaque  = false;
+    palette[Leaves].Opaque = false;
+
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<u32> chance(0, 99);
+    BlockVolume                        volume;
+    for (s32 z = 0; z < width * 16; z++)
+    {
+        for (s32 x = 0; x < width * 16; x++)
+        {
+            const f32 wave    = std::sin(static_cast<f32>(x) * 0.07f) + std::cos(static_cast<f32>(z) * 0.05f);
+            const s32 surface = 24 + static_cast<s32>(wave * 10.0f) + static_cast<s32>(chance(random) % 3);
+            for (s32 y = 0; y <= surface; y++)
+            {
+                const bool cave = y > 2 && y < surface - 4 && chance(random) < 8;
+                const u32  roll = chance(random);
+                Block      block = y == surface ? Grass : y > surface - 4 ? Dirt : Stone;
+                if (cave)
+                    block = Air;
+                else if (roll < 2)
+                    block = Glass;
+                volume.SetBlock({x, y, z}, block);
+            }
+            // The odd bush on top.
+            if (chance(random) < 3)
+            {
+                for (s32 y = 1; y <= 3 && surface + y < height * 16; y++)
+                    volume.SetBlock({x, surface + y, z}, Leaves);
+            }
+        }
+    }
+
+    JobSystem&             jobs = context.App.GetJobSystem();
+    JobSystem              serial; // Never initialised, so ParallelFor() runs everything inline.
+    std::vector<ChunkMesh> meshes;
+    ChunkMeshStats         stats;
+
+    const BenchmarkResult parallelResult = Benchmarks::Measure(iterations, [&]
+    {
+        stats = ChunkMesher::MeshVolume(volume, palette, jobs, meshes);
+    });
+    const BenchmarkResult serialResult = Benchmarks::Measure(iterations, [&]
+    {
+        ChunkMesher::MeshVolume(volume, palette, serial, meshes);
+    });
+
+    const u32 expectedFaces = CountVisibleFaces(volume, palette);
+    const u32 quadArea      = CountQuadArea(meshes);
+    size_t    vertexBytes   = 0;
+    for (const ChunkMesh& mesh : meshes)
+        vertexBytes += mesh.Vertices.size() * sizeof(ChunkVertex);
+
+    MP_INFO("Chunk meshing, {} sections ({} iterations, best time):", stats.Sections, iterations);
+    MP_INFO("   {} visible faces merged into {} quads ({:.1f}x fewer), {:.1f}KB of vertices", stats.Faces, stats.Quads,
+            static_cast<f64>(stats.Faces) / std::max(stats.Quads, 1u), static_cast<f64>(vertexBytes) / 1024.0);
+    MP_INFO("   Job system ({} threads): {:.3f}ms ({:.0f} sections/s)", jobs.GetThreadCount(), parallelResult.MinMS,
+            stats.Sections * 1000.0 / parallelResult.MinMS);
+    MP_INFO("   One thread:             {:.3f}ms ({:.0f} sections/s, {:.2f}x slower)", serialResult.MinMS,
+            stats.Sections * 1000.0 / serialResult.MinMS, serialResult.MinMS / parallelResult.MinMS);
+
+    if (stats.Faces != expectedFaces || quadArea != expectedFaces)
+    {
+        MP_ERROR("Chunk meshes are wrong: {} faces expected, {} found, {} covered by quads", expectedFaces,
+                 stats.Faces, quadArea);
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(ChunkMeshBenchmark, "chunk-mesh", "Greedy meshing of block sections, in sections per second");
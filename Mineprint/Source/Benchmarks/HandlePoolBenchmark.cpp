@@ -0,0 +1,82 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Utility/HandlePool.h"
+
+// Looks up random handles in a HandlePool that's seen some churn, against the same items in an unordered_map keyed by
+// ID, and checks that handles to removed items stay dead once their slots are reused.
+static void HandlePoolBenchmark(const BenchmarkContext& context)
+{
+    const u32 itemCount   = static_cast<u32>(context.Args.GetInt("benchmark-items", 100000));
+    const u32 lookupCount = static_cast<u32>(context.Args.GetInt("benchmark-lookups", 1000000));
+    const u32 iterations  = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+
+    struct Tag;
+    HandlePool<u32, Tag>         pool;
+    std::unordered_map<u64, u32> map;
+    std::vector<Handle<Tag>>     handles(itemCount);
+    std::vector<u64>             ids(itemCount);
+    for (u32 i = 0; i < itemCount; i++)
+    {
+        handles[i] = pool.Add(i);
+        ids[i]     = i;
+        map[i]     = i;
+    }
+
+    // Replace a quarter of the items, so slots are reused and the pool's free list has been through some use.
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<u32> item(0, itemCount - 1);
+    std::vector<Handle<Tag>>           removed;
+    u64                                nextID = itemCount;
+    for (u32 i = 0; i < itemCount / 4; i++)
+    {
+        const u32 index = item(random);
+        if (pool.Remove(handles[index]))
+            removed.push_back(handles[index]);
+        handles[index] = pool.Add(index);
+
+        map.erase(ids[index]);
+        ids[index]      = nextID++;
+        map[ids[index]] = index;
+    }
+
+    std::vector<u32> lookups(lookupCount);
+    for (u32& lookup : lookups)
+        lookup = item(random);
+
+    u64                   poolSum    = 0;
+    const BenchmarkResult poolResult = Benchmarks::Measure(iterations, [&]
+    {
+        poolSum = 0;
+        for (const u32 lookup : lookups)
+            poolSum += *pool.Get(handles[lookup]);
+    });
+
+    u64                   mapSum    = 0;
+    const BenchmarkResult mapResult = Benchmarks::Measure(iterations, [&]
+    {
+        mapSum = 0;
+        for (const u32 lookup : lookups)
+            mapSum += map.find(ids[lookup])->second;
+    });
+
+    const u32 staleFound = static_cast<u32>(std::ranges::count_if(removed, [&](const Handle<Tag>& handle)
+    {
+        return pool.Contains(handle);
+    }));
+
+    MP_INFO("Handle lookups, {} of {} items ({} iterations, best time):", lookupCount, itemCount, iterations);
+    MP_INFO("   HandlePool:         {:.3f}ms ({:.1f}ns each)", poolResult.MinMS,
+            poolResult.MinMS * 1e6 / lookupCount);
+    MP_INFO("   std::unordered_map: {:.3f}ms ({:.2f}x slower)", mapResult.MinMS, mapResult.MinMS / poolResult.MinMS);
+    MP_INFO("   Pool slots: {} for {} items; {} stale handles checked", pool.GetCapacity(), pool.GetCount(),
+            removed.size());
+    if (poolSum != mapSum || staleFound > 0 || pool.GetCapacity() != itemCount)
+    {
+        MP_ERROR("Handle pool results are wrong ({} stale handles still resolved)", staleFound);
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(HandlePoolBenchmark, "handle-pool", "Generational handle lookups vs an unordered_map");
@@ -0,0 +1,107 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/JobSystem.h"
+
+#include <SDL3/SDL_cpuinfo.h>
+
+// Measures how the job system scales from 1 thread up to every logical core, with a fresh JobSystem per thread
+// count so the application's own workers don't interfere. Each thread count is checked first: a ParallelFor has to
+// cover every item exactly as the serial loop does, and every tiny job has to have run by the time Wait() returns.
+static void JobSystemScalingBenchmark(const BenchmarkContext& context)
+{
+    const u32 maxThreads = static_cast<u32>(context.Args.GetInt("benchmark-max-threads", SDL_GetNumLogicalCPUCores()));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 10));
+
+    std::vector<u32> threadCounts;
+    for (u32 threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(std::max(maxThreads, 1u));
+
+    // Uneven per-item cost (later items are more expensive), to exercise stealing and adaptive chunking.
+    constexpr u32    itemCount = 1 << 20;
+    std::vector<f32> output(itemCount);
+    auto             computeKernel = [&output](u32 begin, u32 end)
+    {
+        for (u32 i = begin; i < end; i++)
+        {
+            f32       value = static_cast<f32>(i);
+            const u32 steps = 8 + (i >> 16);
+            for (u32 step = 0; step < steps; step++)
+                value = std::sqrt(value * 1.0001f + 1.0f);
+            output[i] = value;
+        }
+    };
+
+    // Summed in index order, so the total only depends on what was written, not on how the work was split.
+    auto sumOutput = [&output]
+    {
+        f64 sum = 0;
+        for (const f32 value : output)
+            sum += value;
+        return sum;
+    };
+    computeKernel(0, itemCount);
+    const f64 expectedSum = sumOutput();
+
+    constexpr u32 tinyJobCount = 100000;
+    u32           failures     = 0;
+
+    MP_INFO("Job system scaling ({} iterations, best time):", iterations);
+    MP_INFO("{: >8} | {: >14} | {: >8} | {: >18} | {: >10}", "Threads", "ParallelFor ms", "Speedup", "Tiny jobs/second",
+            "Stolen");
+
+    f64 baselineMS = 0;
+    for (const u32 threads : threadCounts)
+    {
+        JobSystem jobSystem;
+        jobSystem.Init({.WorkerCount = static_cast<s32>(threads) - 1});
+
+        std::ranges::fill(output, 0.0f);
+        jobSystem.ParallelFor(0, itemCount, computeKernel);
+        if (const f64 sum = sumOutput(); sum != expectedSum)
+        {
+            MP_ERROR("ParallelFor on {} threads summed to {}, expected {}", threads, sum, expectedSum);
+            failures++;
+        }
+
+        std::atomic<u32> completed = 0;
+        JobCounter       checkCounter;
+        for (u32 i = 0; i < tinyJobCount; i++)
+            jobSystem.Schedule([&completed] { completed.fetch_add(1, std::memory_order_relaxed); }, &checkCounter);
+        jobSystem.Wait(checkCounter);
+        if (completed.load() != tinyJobCount)
+        {
+            MP_ERROR("{} of {} jobs on {} threads had run after Wait()", completed.load(), tinyJobCount, threads);
+            failures++;
+        }
+
+        const BenchmarkResult parallelFor = Benchmarks::Measure(iterations, [&]
+        {
+            jobSystem.ParallelFor(0, itemCount, computeKernel);
+        });
+
+        const BenchmarkResult tinyJobs = Benchmarks::Measure(iterations, [&]
+        {
+            JobCounter counter;
+            for (u32 i = 0; i < tinyJobCount; i++)
+                jobSystem.Schedule([] {}, &counter);
+            jobSystem.Wait(counter);
+        });
+
+        if (threads == 1)
+            baselineMS = parallelFor.MinMS;
+
+        MP_INFO("{: >8} | {: >14.3f} | {: >7.2f}x | {: >18.0f} | {: >10}", threads, parallelFor.MinMS,
+                baselineMS / parallelFor.MinMS, tinyJobCount / (tinyJobs.MinMS / 1000.0), jobSystem.GetJobsStolen());
+
+        jobSystem.Shutdown();
+    }
+
+    if (failures > 0)
+        context.App.SetExitCode(1);
+}
+
+MP_REGISTER_BENCHMARK(JobSystemScalingBenchmark, "jobs",
+                      "Job system ParallelFor and scheduling throughput, 1 to N threads");
@@ -0,0 +1,289 @@
+#include "mppch.h"
+
+#include <fstream>
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Render/MeshFile.h"
+
+namespace
+{
+    struct SourceSubMesh
+    {
+        std::vector<MeshVertex> Vertices;
+        std::vector<u32>        Indices;
+        u32                     MaterialIndex = 0;
+    };
+
+    template <typename T>
+    void Write(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteIndices(std::ofstream& file, const std::vector<u32>& indices, const u32 indexSize)
+    {
+        for (const u32 index : indices)
+        {
+            if (indexSize == sizeof(u16))
+                Write(file, static_cast<u16>(index));
+            else
+                Write(file, index);
+        }
+    }
+
+    // The layouts as Mesh.cs writes them: the original one, and version 2.
+    void WriteLegacy(const std::filesystem::path& path, const std::vector<SourceSubMesh>& subMeshes)
+    {
+        std::ofstream file(path, std::ios::binary);
+        Write(file, MeshFile::Magic);
+        Write(file, static_cast<s32>(subMeshes.size()));
+        for (const SourceSubMesh& subMesh : subMeshes)
+        {
+            Write(file, static_cast<u32>(subMesh.Vertices.size()));
+            Write(file, static_cast<u32>(subMesh.Indices.size()));
+            Write(file, subMesh.MaterialIndex);
+            file.write(reinterpret_cast<const char*>(subMesh.Vertices.data()),
+                       static_cast<std::streamsize>(subMesh.Vertices.size() * sizeof(MeshVertex)));
+            WriteIndices(file, subMesh.Indices, sizeof(u16));
+        }
+    }
+
+    void WriteVersioned(const std::filesystem::path& path, const std::vector<SourceSubMesh>& subMeshes,
+                        const u32 indexSize)
+    {
+        u32 vertexCount = 0, indexCount = 0;
+        for (const SourceSubMesh& subMesh : subMeshes)
+        {
+            vertexCount += static_cast<u32>(subMesh.Vertices.size());
+            indexCount  += static_cast<u32>(subMesh.Indices.size());
+        }
+        const u64 vertexOffset = (32 + subMeshes.size() * 24 + 15) & ~15ull;
+
+        std::ofstream file(path, std::ios::binary);
+        Write(file, MeshFile::Magic);
+        Write(file, 0xFFFFFFFFu);
+        Write(file, MeshFile::Version);
+        Write(file, static_cast<u16>(indexSize));
+        Write(file, static_cast<u32>(subMeshes.size()));
+        Write(file, vertexCount);
+        Write(file, indexCount);
+        Write(file, vertexOffset + static_cast<u64>(vertexCount) * sizeof(MeshVertex) + indexCount * indexSize);
+
+        u32 firstVertex = 0, firstIndex = 0;
+        for (const SourceSubMesh& subMesh : subMeshes)
+        {
+            for (const u32 value : {firstVertex, static_cast<u32>(subMesh.Vertices.size()), firstIndex,
+                                    static_cast<u32>(subMesh.Indices.size()), subMesh.MaterialIndex, 0u})
+                Write(file, value);
+            firstVertex += static_cast<u32>(subMesh.Vertices.size());
+            firstIndex  += static_cast<u32>(subMesh.Indices.size());
+        }
+
+        while (static_cast<u64>(file.tellp()) < vertexOffset)
+            Write(file, static_cast<u8>(0));
+        for (const SourceSubMesh& subMesh : subMeshes)
+        {
+            file.write(reinterpret_cast<const char*>(subMesh.Vertices.data()),
+                       static_cast<std::streamsize>(subMesh.Vertices.size() * sizeof(MeshVertex)));
+        }
+        for (const SourceSubMesh& subMesh : subMeshes)
+            WriteIndices(file, subMesh.Indices, indexSize);
+    }
+
+    // What loading looks like without the mapping: read each submesh into vectors of its own.
+    bool ReadWithStream(const std::filesystem::path& path, std::vector<SourceSubMesh>& subMeshes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        u32           magic = 0;
+        s32           count = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!file || magic != MeshFile::Magic || count < 0)
+            return false;
+
+        subMeshes.resize(count);
+        std::vector<u16> indices;
+        for (SourceSubMesh& subMesh : subMeshes)
+        {
+            u32 vertexCount = 0, indexCount = 0;
+            file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+            file.read(reinterpret_cast<char*>(&indexCount), sizeof(indexCount));
+            file.read(reinterpret_cast<char*>(&subMesh.MaterialIndex), sizeof(subMesh.MaterialIndex));
+            subMesh.Vertices.resize(vertexCount);
+            indices.resize(indexCount);
+            file.read(reinterpret_cast<char*>(subMesh.Vertices.data()), vertexCount * sizeof(MeshVertex));
+            file.read(reinterpret_cast<char*>(indices.data()), indexCount * sizeof(u16));
+            subMesh.Indices.assign(indices.begin(), indices.end());
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool Matches(const MeshFile& mesh, const std::vector<SourceSubMesh>& subMeshes)
+    {
+        if (mesh.GetData().size() != subMeshes.size())
+            return false;
+
+        u32 baseVertex = 0;
+        for (size_t i = 0; i < subMeshes.size(); i++)
+        {
+            const MeshFileSubMesh& data   = mesh.GetData()[i];
+            const SourceSubMesh&   source = subMeshes[i];
+            const bool             same   = data.MaterialIndex == source.MaterialIndex
+                                            && mesh.GetSubMeshes()[i].BaseVertex == baseVertex
+                                            && data.Vertices.size() == source.Vertices.size()
+                                            && std::memcmp(data.Vertices.data(), source.Vertices.data(),
+                                                           source.Vertices.size() * sizeof(MeshVertex)) == 0
+                                            && (mesh.GetIndexSize() == sizeof(u16)
+                                                    ? std::ranges::equal(data.Indices16, source.Indices)
+                                                    : std::ranges::equal(data.Indices32, source.Indices));
+            if (!same || reinterpret_cast<uintptr_t>(data.Vertices.data()) % alignof(MeshVertex) != 0)
+                return false;
+            baseVertex += static_cast<u32>(source.Vertices.size());
+        }
+        return true;
+    }
+
+    // Rewrites part of a file, to corrupt it.
+    void Patch(const std::filesystem::path& path, const u64 offset, const std::vector<u8>& bytes)
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+}
+
+// Writes a generated mesh (a few submeshes, some with an odd number of indices) in the original .mesh layout and in
+// version 2, then times opening them mapped against reading the original layout into vectors. Checks the mapped spans
+// match what was written, that a submesh too big for 16-bit indices round trips with 32-bit ones, and that truncated
+// and corrupt files are rejected.
+//
+// --benchmark-mesh=<path> also times opening a real .mesh file.
+static void MeshFileBenchmark(const BenchmarkContext& context)
+{
+    const u32 vertexCount = static_cast<u32>(context.Args.GetInt("benchmark-vertices", 60000));
+    const u32 iterations  = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 10));
+
+    std::mt19937                          random(1234);
+    std::uniform_real_distribution<f32>   value(-1.0f, 1.0f);
+
+    auto generate = [&](const u32 vertices, const u32 triangles, const u32 material)
+    {
+        SourceSubMesh subMesh;
+        subMesh.MaterialIndex = material;
+        subMesh.Vertices.resize(vertices);
+        for (MeshVertex& vertex : subMesh.Vertices)
+        {
+            vertex.Position = {value(random), value(random), value(random)};
+            vertex.Normal   = glm::normalize(glm::vec3(value(random), value(random), 1.0f));
+            vertex.UV       = {value(random), value(random)};
+        }
+        std::uniform_int_distribution<u32> index(0, vertices - 1);
+        subMesh.Indices.resize(static_cast<size_t>(triangles) * 3);
+        for (u32& i : subMesh.Indices)
+            i = index(random);
+        return subMesh;
+    };
+
+    // Odd triangle counts leave the next submesh's vertices unaligned in the original layout. Capped at 65536 vertices
+    // a submesh, so the original layout's 16-bit indices can hold them.
+    std::vector<SourceSubMesh> subMeshes;
+    for (u32 i = 0, remaining = vertexCount; remaining > 0; i++)
+    {
+        const u32 vertices = std::min({remaining, 65536u, std::max(vertexCount / 6, 1u)});
+        subMeshes.push_back(generate(vertices, vertices * 2 + (i % 2), i));
+        remaining -= vertices;
+    }
+    const std::vector<SourceSubMesh> wide = {generate(70000, 1000, 0), generate(100, 33, 1)};
+
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() /
+                                         fmt::format("MineprintMeshFileBenchmark{}", SDL_GetTicksNS());
+    std::error_code             error;
+    std::filesystem::create_directories(folder, error);
+    const std::filesystem::path legacyPath    = folder / "legacy.mesh";
+    const std::filesystem::path versionedPath = folder / "versioned.mesh";
+    const std::filesystem::path widePath      = folder / "wide.mesh";
+    WriteLegacy(legacyPath, subMeshes);
+    WriteVersioned(versionedPath, subMeshes, sizeof(u16));
+    WriteVersioned(widePath, wide, sizeof(u32));
+
+    std::vector<SourceSubMesh> streamed;
+    MeshFile                   mesh;
+    bool                       valid        = true;
+    const BenchmarkResult      streamResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= ReadWithStream(legacyPath, streamed);
+    });
+    const BenchmarkResult      legacyResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= mesh.Open(legacyPath);
+    });
+    const size_t copied = mesh.GetCopiedVertexCount();
+    valid               = valid && !mesh.IsVersioned() && Matches(mesh, subMeshes);
+
+    const BenchmarkResult versionedResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= mesh.Open(versionedPath);
+    });
+    valid = valid && mesh.IsVersioned() && mesh.GetCopiedVertexCount() == 0 && Matches(mesh, subMeshes);
+    const BenchmarkResult unvalidatedResult = Benchmarks::Measure(iterations, [&]
+    {
+        valid &= mesh.Open(versionedPath, false);
+    });
+    const u64 fileSize = mesh.GetFileSize();
+
+    const bool wideMatches = mesh.Open(widePath) && mesh.GetIndexType() == GL_UNSIGNED_INT && Matches(mesh, wide);
+
+    // Every one of these must be rejected (and logs why).
+    MP_INFO("Mesh file corruption checks (errors expected):");
+    u32 accepted = 0;
+    std::filesystem::resize_file(widePath, std::filesystem::file_size(widePath) - 1, error);
+    accepted += mesh.Open(widePath);
+    WriteVersioned(widePath, wide, sizeof(u32));
+    Patch(widePath, 20, {0xFF, 0xFF, 0xFF, 0x7F}); // The total index count.
+    accepted += mesh.Open(widePath);
+    WriteVersioned(widePath, wide, sizeof(u32));
+    Patch(widePath, 10, {3, 0}); // The index size.
+    accepted += mesh.Open(widePath);
+    WriteVersioned(widePath, wide, sizeof(u32));
+    Patch(widePath, std::filesystem::file_size(widePath) - 4, {0xFF, 0xFF, 0, 0}); // An index past its submesh.
+    accepted += mesh.Open(widePath);
+    accepted += !mesh.Open(widePath, false); // Without validating indices, that one's only the GPU's problem.
+    std::filesystem::resize_file(legacyPath, std::filesystem::file_size(legacyPath) - 2, error);
+    accepted += mesh.Open(legacyPath);
+    std::filesystem::remove_all(folder, error);
+
+    MP_INFO("Mesh file, {} submeshes, {} vertices, {:.1f}MB ({} iterations, best time):", subMeshes.size(),
+            vertexCount, static_cast<f64>(fileSize) / (1024.0 * 1024.0), iterations);
+    MP_INFO("   Read into vectors:          {:.3f}ms", streamResult.MinMS);
+    MP_INFO("   Mapped, original layout:    {:.3f}ms ({} unaligned vertices copied), {:.1f}x faster",
+            legacyResult.MinMS, copied, streamResult.MinMS / legacyResult.MinMS);
+    MP_INFO("   Mapped, version 2:          {:.3f}ms, {:.1f}x faster", versionedResult.MinMS,
+            streamResult.MinMS / versionedResult.MinMS);
+    MP_INFO("   Mapped, indices unchecked:  {:.3f}ms", unvalidatedResult.MinMS);
+
+    if (!valid || !wideMatches || accepted > 0)
+    {
+        MP_ERROR("Mesh file results are wrong: spans {}, 32-bit indices {}, {} corrupt file(s) accepted",
+                 valid ? "matched" : "didn't match", wideMatches ? "matched" : "didn't match", accepted);
+        context.App.SetExitCode(1);
+    }
+
+    const std::string path = context.Args.GetValue("benchmark-mesh");
+    if (path.empty())
+        return;
+
+    Stopwatch  timer;
+    const bool opened   = mesh.Open(path);
+    const f64  openedMS = timer.GetElapsedMilliseconds();
+    MP_INFO("{}: version {}, {} submeshes, {} vertices, {} {}-bit indices, opened in {:.3f}ms", path,
+            mesh.GetFileVersion(), mesh.GetSubMeshes().size(), mesh.GetVertexCount(), mesh.GetIndexCount(),
+            mesh.GetIndexSize() * 8, openedMS);
+    if (!opened)
+    {
+        MP_ERROR("Failed to open {}", path);
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(MeshFileBenchmark, "mesh-file", "Opening .mesh files mapped, against reading them into vectors");
@@ -0,0 +1,192 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Benchmarks/BenchmarkMeshes.h"
+#include "Render/MeshFile.h"
+#include "Render/MeshSimplifier.h"
+
+namespace
+{
+    // Rolling hills, like a heightmap export: flat areas simplify a lot, and its outline must stay put.
+    TestMesh MakeTerrain(const u32 size)
+    {
+        TestMesh mesh;
+        mesh.Name = fmt::format("{}x{} terrain", size, size);
+        for (u32 y = 0; y <= size; y++)
+        {
+            for (u32 x = 0; x <= size; x++)
+            {
+                const glm::vec2 uv     = glm::vec2(x, y) / static_cast<f32>(size);
+                const f32       height = 2.0f * std::sin(uv.x * 6.0f) * std::cos(uv.y * 4.0f)
+                                         + 0.5f * std::sin(uv.x * 23.0f + uv.y * 17.0f);
+                mesh.Vertices.push_back({
+                    .Position = {uv.x * 64.0f, height, uv.y * 64.0f},
+                    .Normal   = {0.0f, 1.0f, 0.0f},
+                    .UV       = uv
+                });
+            }
+        }
+        for (u32 y = 0; y < size; y++)
+        {
+            for (u32 x = 0; x < size; x++)
+            {
+                const u32 corner = y * (size + 1) + x;
+                mesh.Indices.insert(mesh.Indices.end(), {corner, corner + size + 1, corner + 1});
+                mesh.Indices.insert(mesh.Indices.end(), {corner + 1, corner + size + 1, corner + size + 2});
+            }
+        }
+        mesh.SubMeshes.push_back({.FirstIndex = 0, .IndexCount = static_cast<u32>(mesh.Indices.size())});
+        return mesh;
+    }
+
+    u32 CountIndices(const std::span<const SubMesh> subMeshes)
+    {
+        u32 count = 0;
+        for (const SubMesh& subMesh : subMeshes)
+            count += subMesh.IndexCount;
+        return count;
+    }
+
+    // How far a sphere LOD's surface actually gets from the sphere: the deepest of its triangles' centres and edge
+    // midpoints below the radius.
+    f32 MeasureSphereError(const TestMesh& mesh, const MeshLOD& lod)
+    {
+        f32 deepest = 0.0f;
+        for (const SubMesh& subMesh : lod.SubMeshes)
+        {
+            for (u32 i = subMesh.FirstIndex; i + 2 < subMesh.FirstIndex + subMesh.IndexCount; i += 3)
+            {
+                const glm::vec3& a = mesh.Vertices[subMesh.BaseVertex + mesh.Indices[i]].Position;
+                const glm::vec3& b = mesh.Vertices[subMesh.BaseVertex + mesh.Indices[i + 1]].Position;
+                const glm::vec3& c = mesh.Vertices[subMesh.BaseVertex + mesh.Indices[i + 2]].Position;
+                for (const glm::vec3& point : {(a + b + c) / 3.0f, (a + b) * 0.5f, (b + c) * 0.5f, (c + a) * 0.5f})
+                    deepest = std::max(deepest, mesh.SphereRadius - glm::length(point));
+            }
+        }
+        return deepest;
+    }
+
+    // Builds a mesh's LODs, logs them and where they'd be used, and returns whether they hold up.
+    bool Report(TestMesh& mesh, const MeshSimplifierSpecification& spec, const u32 iterations)
+    {
+        const u32               fullIndices = CountIndices(mesh.SubMeshes);
+        std::vector<MeshLOD>    lods;
+        MeshSimplificationStats stats;
+        f64                     bestMS = std::numeric_limits<f64>::max();
+        for (u32 i = 0; i < std::max(iterations, 1u); i++)
+        {
+            mesh.Indices.resize(fullIndices);
+            stats.Reset();
+            lods   = MeshSimplifier::BuildLODs(spec, mesh.Vertices, mesh.Indices, mesh.SubMeshes, &stats);
+            bestMS = std::min(bestMS, stats.SimplifyMS);
+        }
+
+        glm::vec3 boundsMin = mesh.Vertices[0].Position;
+        glm::vec3 boundsMax = mesh.Vertices[0].Position;
+        for (const MeshVertex& vertex : mesh.Vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+        const f32 size = glm::distance(boundsMin, boundsMax);
+
+        MP_INFO("   {}: {} triangles, {} LODs in {:.2f}ms ({} collapses, {} rejected)", mesh.Name, fullIndices / 3,
+                lods.size(), bestMS, stats.Collapses, stats.Rejected);
+
+        // The distance each LOD takes over at, for a 256 pixel tall thumbnail with a 60 degree field of view.
+        const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+        const f32       unitPixels = MeshSimplifier::GetPixelsPerUnit(projection, 1.0f, 256.0f);
+
+        bool valid         = true;
+        u32  previousCount = fullIndices;
+        for (u32 i = 0; i < lods.size(); i++)
+        {
+            const MeshLOD& lod      = lods[i];
+            const u32      count    = CountIndices(lod.SubMeshes);
+            const f32      distance = lod.Error * unitPixels;
+            const f32      measured = mesh.SphereRadius > 0.0f ? MeasureSphereError(mesh, lod) : 0.0f;
+            const std::string measuredText =
+                mesh.SphereRadius > 0.0f ? fmt::format("; measured {:.4f}", measured) : std::string();
+            MP_INFO("      LOD {}: {} triangles ({:.1f}%), error {:.4f} ({:.3f}% of its size{}), used from {:.1f} "
+                    "units away", i + 1, count / 3, 100.0 * count / fullIndices, lod.Error, 100.0f * lod.Error / size,
+                    measuredText, distance);
+
+            // Every LOD must be smaller than the last, within the error allowed, and only index real vertices. A
+            // LOD's outline (the terrain's edges) holds still, so it covers the same ground.
+            glm::vec3 lodMin = glm::vec3(std::numeric_limits<f32>::max());
+            glm::vec3 lodMax = glm::vec3(std::numeric_limits<f32>::lowest());
+            for (const SubMesh& subMesh : lod.SubMeshes)
+            {
+                valid &= subMesh.FirstIndex + subMesh.IndexCount <= mesh.Indices.size();
+                for (u32 index = subMesh.FirstIndex; valid && index < subMesh.FirstIndex + subMesh.IndexCount; index++)
+                {
+                    valid &= subMesh.BaseVertex + mesh.Indices[index] < mesh.Vertices.size();
+                    if (valid)
+                    {
+                        lodMin = glm::min(lodMin, mesh.Vertices[subMesh.BaseVertex + mesh.Indices[index]].Position);
+                        lodMax = glm::max(lodMax, mesh.Vertices[subMesh.BaseVertex + mesh.Indices[index]].Position);
+                    }
+                }
+            }
+            valid &= count < previousCount && lod.Error <= spec.MaxError * size * 1.0001f;
+            valid &= mesh.SphereRadius > 0.0f || (lodMin.x == boundsMin.x && lodMin.z == boundsMin.z
+                                                  && lodMax.x == boundsMax.x && lodMax.z == boundsMax.z);
+            valid &= measured <= std::max(lod.Error * 4.0f, size * 1e-4f);
+
+            // Just past the distance it takes over at, it's the LOD chosen (unless a coarser one is fine too).
+            const f32 pixelsPerUnit = MeshSimplifier::GetPixelsPerUnit(projection, distance * 1.001f, 256.0f);
+            valid &= MeshSimplifier::SelectLOD(lods, pixelsPerUnit) >= i + 1;
+            previousCount = count;
+        }
+
+        valid &= MeshSimplifier::SelectLOD(lods, std::numeric_limits<f32>::max()) == 0 || lods.empty();
+        valid &= MeshSimplifier::SelectLOD(lods, 0.0f) == lods.size();
+        if (!valid)
+            MP_ERROR("LODs for {} are wrong", mesh.Name);
+        return valid;
+    }
+}
+
+// Builds LOD chains for generated meshes (rolling terrain, and a sphere with seams and a border), and reports each
+// LOD's triangles and error, and the distance it would be used from in a thumbnail. Checks each LOD is smaller than
+// the last and within its error, the terrain keeps its outline, and the sphere's measured error matches the estimate.
+//
+// --benchmark-mesh=<path> also builds LODs for a real .mesh file.
+static void MeshLODBenchmark(const BenchmarkContext& context)
+{
+    const u32 size       = static_cast<u32>(context.Args.GetInt("benchmark-grid", 256));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 3));
+
+    std::vector<TestMesh> meshes;
+    meshes.push_back(MakeTerrain(size));
+    meshes.push_back(BenchmarkMeshes::MakeSphere(size / 2, size));
+
+    const std::string path = context.Args.GetValue("benchmark-mesh");
+    if (!path.empty())
+    {
+        MeshFile file;
+        if (file.Open(path))
+            meshes.push_back(BenchmarkMeshes::CopyMeshFile(file, path));
+        else
+            context.App.SetExitCode(1);
+    }
+
+    const MeshSimplifierSpecification spec;
+    MP_INFO("Mesh LODs ({} iterations, best time; up to {} LODs, each {:.0f}% of the last, within {:.1f}% of the "
+            "mesh's size):", iterations, spec.MaxLODs, spec.Ratio * 100.0f, spec.MaxError * 100.0f);
+    bool valid = true;
+    for (TestMesh& mesh : meshes)
+        valid &= Report(mesh, spec, iterations);
+
+    // Orthographic projections don't shrink with distance.
+    const glm::mat4 orthographic = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 100.0f);
+    valid &= MeshSimplifier::GetPixelsPerUnit(orthographic, 1.0f, 256.0f)
+             == MeshSimplifier::GetPixelsPerUnit(orthographic, 50.0f, 256.0f);
+
+    if (!valid)
+        context.App.SetExitCode(1);
+}
+
+MP_REGISTER_BENCHMARK(MeshLODBenchmark, "mesh-lod",
+                      "Quadric error LOD chains for meshes, with their errors and where they'd be used");
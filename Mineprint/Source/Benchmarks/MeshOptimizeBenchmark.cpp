@@ -0,0 +1,201 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Benchmarks/BenchmarkMeshes.h"
+#include "Render/MeshFile.h"
+#include "Render/MeshOptimizer.h"
+
+#include <glm/gtx/component_wise.hpp>
+
+namespace
+{
+    // Every triangle as its corners' positions, starting from the smallest corner so the winding is kept, sorted.
+    // Reordering the triangles and vertices mustn't change it.
+    std::vector<std::array<f32, 9>> GetTriangles(const TestMesh& mesh)
+    {
+        std::vector<std::array<f32, 9>> triangles;
+        for (const SubMesh& subMesh : mesh.SubMeshes)
+        {
+            for (u32 i = subMesh.FirstIndex; i + 2 < subMesh.FirstIndex + subMesh.IndexCount; i += 3)
+            {
+                std::array<std::array<f32, 3>, 3> corners;
+                for (u32 corner = 0; corner < 3; corner++)
+                {
+                    const glm::vec3& position = mesh.Vertices[subMesh.BaseVertex + mesh.Indices[i + corner]].Position;
+                    corners[corner]           = {position.x, position.y, position.z};
+                }
+                std::ranges::rotate(corners, std::ranges::min_element(corners));
+
+                std::array<f32, 9>& triangle = triangles.emplace_back();
+                for (u32 corner = 0; corner < 3; corner++)
+                    std::ranges::copy(corners[corner], triangle.begin() + corner * 3);
+            }
+        }
+        std::ranges::sort(triangles);
+        return triangles;
+    }
+
+    // A bumpy terrain grid, like a heightmap export.
+    TestMesh MakeGrid(const u32 size, std::mt19937& random)
+    {
+        std::uniform_real_distribution<f32> height(0.0f, 0.2f);
+
+        TestMesh mesh;
+        mesh.Name = fmt::format("{}x{} grid", size, size);
+        for (u32 y = 0; y <= size; y++)
+        {
+            for (u32 x = 0; x <= size; x++)
+            {
+                const glm::vec2 uv = glm::vec2(x, y) / static_cast<f32>(size);
+                mesh.Vertices.push_back({
+                    .Position = {uv.x * 64.0f, height(random), uv.y * 64.0f},
+                    .Normal   = glm::normalize(glm::vec3(height(random), 1.0f, height(random))),
+                    .UV       = uv
+                });
+            }
+        }
+        for (u32 y = 0; y < size; y++)
+        {
+            for (u32 x = 0; x < size; x++)
+            {
+                const u32 corner = y * (size + 1) + x;
+                mesh.Indices.insert(mesh.Indices.end(), {corner, corner + size + 1, corner + 1});
+                mesh.Indices.insert(mesh.Indices.end(), {corner + 1, corner + size + 1, corner + size + 2});
+            }
+        }
+        mesh.SubMeshes.push_back({.FirstIndex = 0, .IndexCount = static_cast<u32>(mesh.Indices.size())});
+        return mesh;
+    }
+
+    // Triangles and vertices in a random order, like a mesh that's been through tools that don't care.
+    void Shuffle(TestMesh& mesh, std::mt19937& random)
+    {
+        std::vector<u32> order(mesh.Vertices.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::ranges::shuffle(order, random);
+        std::vector<MeshVertex> vertices(mesh.Vertices.size());
+        for (u32 i = 0; i < order.size(); i++)
+            vertices[order[i]] = mesh.Vertices[i];
+        mesh.Vertices = std::move(vertices);
+        for (u32& index : mesh.Indices)
+            index = order[index];
+
+        for (const SubMesh& subMesh : mesh.SubMeshes)
+        {
+            std::vector<std::array<u32, 3>> triangles(subMesh.IndexCount / 3);
+            std::memcpy(triangles.data(), &mesh.Indices[subMesh.FirstIndex], triangles.size() * sizeof(triangles[0]));
+            std::ranges::shuffle(triangles, random);
+            std::memcpy(&mesh.Indices[subMesh.FirstIndex], triangles.data(), triangles.size() * sizeof(triangles[0]));
+        }
+    }
+
+    // Optimises and quantises a mesh, logs what it saves, and returns whether the results hold up.
+    bool Report(const TestMesh& source, const u32 iterations)
+    {
+        TestMesh              mesh;
+        MeshOptimizationStats stats;
+        f64                   bestMS = std::numeric_limits<f64>::max();
+        for (u32 i = 0; i < std::max(iterations, 1u); i++)
+        {
+            mesh   = source;
+            stats  = MeshOptimizer::Optimize({}, mesh.Vertices, mesh.Indices, mesh.SubMeshes);
+            bestMS = std::min(bestMS, stats.OptimizeMS);
+        }
+        const MeshOptimizationStats optimized = stats;
+
+        std::vector<QuantizedMeshVertex> quantized;
+        const MeshQuantization           quantization = MeshOptimizer::Quantize(mesh.Vertices, quantized, &stats,
+                                                                                mesh.Indices);
+
+        auto kb        = [](const u64 bytes) { return static_cast<f64>(bytes) / 1024.0; };
+        const f64 less = static_cast<f64>(stats.FetchedBytesBefore)
+                         / static_cast<f64>(std::max<u64>(stats.FetchedBytesAfter, 1));
+        MP_INFO("   {}: {} vertices, {} triangles, {} submesh(es)", source.Name, source.Vertices.size(),
+                stats.Triangles, source.SubMeshes.size());
+        MP_INFO("      Transformed per triangle: {:.3f} -> {:.3f} (per vertex {:.3f} -> {:.3f})", stats.ACMRBefore,
+                stats.ACMRAfter, stats.ATVRBefore, stats.ATVRAfter);
+        MP_INFO("      Fetched per draw:        {:.1f}KB -> {:.1f}KB reordered -> {:.1f}KB quantised ({:.1f}x less)",
+                kb(stats.FetchedBytesBefore), kb(optimized.FetchedBytesAfter), kb(stats.FetchedBytesAfter), less);
+        MP_INFO("      Vertex memory:           {:.1f}KB -> {:.1f}KB quantised", kb(stats.VertexBytesBefore),
+                kb(stats.VertexBytesAfter));
+        MP_INFO("      Quantisation error:      position {:.6f} (of {:.1f} across), normal {:.4f} degrees, UV {:.6f}",
+                stats.MaxPositionError, glm::compMax(quantization.Scale), stats.MaxNormalError, stats.MaxUVError);
+        MP_INFO("      Optimised in {:.3f}ms, quantised in {:.3f}ms", bestMS, stats.QuantizeMS);
+
+        const bool sameTriangles = GetTriangles(mesh) == GetTriangles(source);
+        const bool accurate      = stats.MaxPositionError <= glm::compMax(quantization.Scale) / 65535.0f
+                                   && stats.MaxNormalError < 0.05f;
+        if (!sameTriangles || !accurate || stats.ACMRAfter > stats.ACMRBefore + 0.01f)
+        {
+            MP_ERROR("Mesh optimisation results for {} are wrong: triangles {}, quantisation {}", source.Name,
+                     sameTriangles ? "kept" : "changed", accurate ? "accurate" : "inaccurate");
+            return false;
+        }
+        return true;
+    }
+}
+
+// Optimises generated meshes (a grid and a sphere, in their natural order and shuffled) for the vertex caches, and
+// quantises them, then reports the vertex shader runs, vertex fetch traffic and memory each saves, and checks the
+// triangles are all still there and the quantisation error is within a step.
+//
+// --benchmark-mesh=<path> also reports on a real .mesh file.
+static void MeshOptimizeBenchmark(const BenchmarkContext& context)
+{
+    const u32 gridSize   = static_cast<u32>(context.Args.GetInt("benchmark-grid", 256));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 5));
+
+    std::mt19937 random(1234);
+
+    std::vector<TestMesh> meshes = {MakeGrid(gridSize, random), BenchmarkMeshes::MakeSphere(gridSize / 2, gridSize)};
+    for (size_t i = 0, count = meshes.size(); i < count; i++)
+    {
+        TestMesh shuffled = meshes[i];
+        shuffled.Name     += ", shuffled";
+        Shuffle(shuffled, random);
+        meshes.push_back(std::move(shuffled));
+    }
+
+    const std::string path = context.Args.GetValue("benchmark-mesh");
+    if (!path.empty())
+    {
+        MeshFile file;
+        if (file.Open(path))
+            meshes.push_back(BenchmarkMeshes::CopyMeshFile(file, path));
+        else
+            context.App.SetExitCode(1);
+    }
+
+    MP_INFO("Mesh optimisation ({} iterations, best time; {} entry FIFO for the stats):", iterations,
+            MeshOptimizerSpecification().AnalysisCacheSize);
+    bool valid = true;
+    for (const TestMesh& mesh : meshes)
+        valid &= Report(mesh, iterations);
+
+    // The octahedral encoding, on its own: the axes (where the folds are) and random directions.
+    std::uniform_real_distribution<f32> component(-1.0f, 1.0f);
+    f32                                 worstCosine = 1.0f;
+    for (u32 i = 0; i < 10000; i++)
+    {
+        glm::vec3 normal = i < 6 ? glm::vec3(0.0f) : glm::vec3(component(random), component(random), component(random));
+        if (i < 6)
+            normal[i % 3] = i < 3 ? 1.0f : -1.0f;
+        if (glm::dot(normal, normal) < 1e-6f)
+            continue;
+        normal                  = glm::normalize(normal);
+        const glm::vec3 decoded = MeshOptimizer::DecodeOctahedral(MeshOptimizer::EncodeOctahedral(normal));
+        worstCosine             = std::min(worstCosine, glm::dot(normal, decoded));
+    }
+    if (worstCosine < 0.99999f)
+    {
+        MP_ERROR("Octahedral normals are off by up to {:.4f} degrees", glm::degrees(std::acos(worstCosine)));
+        valid = false;
+    }
+
+    if (!valid)
+        context.App.SetExitCode(1);
+}
+
+MP_REGISTER_BENCHMARK(MeshOptimizeBenchmark, "mesh-optimize",
+                      "Vertex cache and fetch optimisation, and quantisation, with the savings per mesh");
@@ -0,0 +1,109 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Render/Renderer.h"
+
+// Renders a canvas into an offscreen target every frame and reads it back, once with glReadPixels straight into
+// memory and once through pixel buffers, to compare how long each keeps the CPU waiting and how many frames late the
+// pixels arrive. Needs a GL context, so run it with --headless-gl (which works on a software rasteriser, e.g.
+// LIBGL_ALWAYS_SOFTWARE=1 with Mesa).
+static void OffscreenReadbackBenchmark(const BenchmarkContext& context)
+{
+    Renderer& renderer = context.App.GetRenderer();
+    if (!renderer.IsHeadless())
+    {
+        MP_ERROR("The offscreen readback benchmark needs an offscreen context: run it with --headless-gl");
+        context.App.SetExitCode(1);
+        return;
+    }
+
+    const s32 size    = static_cast<s32>(context.Args.GetInt("benchmark-readback-size", 1024));
+    const u32 frames  = static_cast<u32>(context.Args.GetInt("benchmark-frames", 120));
+    const u32 samples = static_cast<u32>(context.Args.GetInt("benchmark-samples", 4));
+
+    // Enough nodes to give the GPU some work. The top left corner is left clear, so we can check it against the
+    // clear colour.
+    constexpr glm::vec4 clearColour = {0.25f, 0.5f, 0.75f, 1.0f};
+    const glm::vec2     targetSize  = glm::vec2(size);
+    CanvasBatch         batch;
+    batch.Begin(FRect({-64.0f, -64.0f}, targetSize), targetSize);
+    for (f32 y = 0.0f; y < targetSize.y; y += 140.0f)
+    {
+        for (f32 x = 0.0f; x < targetSize.x; x += 200.0f)
+            batch.DrawNode({.Bounds = FRect({x, y}, {160.0f, 110.0f}), .InputPins = 2, .OutputPins = 3});
+    }
+
+    MP_INFO("Offscreen readback, {}x{} ({} samples), {} frames:", size, size, samples, frames);
+
+    for (const bool synchronous : {true, false})
+    {
+        PixelReadback& readback = renderer.GetReadback();
+        readback.SetSynchronous(synchronous);
+        const ReadbackStats before = readback.GetStats();
+
+        u64 received     = 0;
+        u64 framesWaited = 0;
+        u64 nextID       = 0;
+        f64 frameMS      = 0;
+        f64 worstFrameMS = 0;
+        u32 badResults   = 0;
+        auto collect = [&]
+        {
+            for (const ReadbackResult& result : renderer.TakeReadbacks())
+            {
+                constexpr u8 expected[] = {64, 128, 191, 255};
+                const u8*    pixel      = result.Pixels.data();
+                bool         matches    = result.ID == nextID && result.Size == glm::ivec2(size);
+                for (u32 channel = 0; channel < 4 && matches; channel++)
+                    matches = std::abs(pixel[channel] - expected[channel]) <= 1;
+                if (!matches)
+                    badResults++;
+
+                nextID++;
+                received++;
+                framesWaited += result.FramesWaited;
+            }
+        };
+
+        for (u32 frame = 0; frame < frames; frame++)
+        {
+            OffscreenRequest request = {
+                .ID = frame,
+                .Target = {.Size = {size, size}, .Samples = samples},
+                .ClearColour = clearColour
+            };
+            renderer.GetCanvas().Submit(batch, request.Queue);
+            renderer.SubmitOffscreen(std::move(request));
+
+            Stopwatch timer;
+            renderer.RenderOffscreen();
+            const f64 elapsed = timer.GetElapsedMilliseconds();
+            frameMS           += elapsed;
+            worstFrameMS      = std::max(worstFrameMS, elapsed);
+            collect();
+        }
+
+        // Whatever's still in flight. Not counted in the frame times: a real app would carry on with other frames.
+        readback.Flush();
+        collect();
+
+        const ReadbackStats after = readback.GetStats();
+        MP_INFO("   {:<12} {:.3f}ms/frame (worst {:.3f}ms), {:.3f}ms/frame blocked, {:.2f} frames latency",
+                synchronous ? "Synchronous" : "PBO", frameMS / frames, worstFrameMS,
+                (after.BlockedMS - before.BlockedMS) / frames,
+                received > 0 ? static_cast<f64>(framesWaited) / static_cast<f64>(received) : 0.0);
+
+        if (received != frames || badResults > 0)
+        {
+            MP_ERROR("Got {} of {} readbacks, {} of them out of order or with the wrong pixels!", received, frames,
+                     badResults);
+            context.App.SetExitCode(1);
+        }
+    }
+
+    renderer.GetReadback().SetSynchronous(false);
+}
+
+MP_REGISTER_BENCHMARK(OffscreenReadbackBenchmark, "offscreen-readback",
+                      "Reads back offscreen renders synchronously and through pixel buffers");
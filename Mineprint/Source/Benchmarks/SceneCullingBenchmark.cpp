@@ -0,0 +1,270 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Scene/OcclusionBuffer.h"
+#include "Scene/Scene.h"
+
+#include <random>
+
+namespace
+{
+    constexpr f32 WorldSize = 1024.0f;
+    constexpr u32 ViewCount = 8;
+
+    // A preview scene spread over a world 1024 blocks across: mostly small things (entities, block models), some
+    // chunk section sized, a few big. Log-uniform sizes from half a block to 16.
+    std::vector<AABB> MakeObjects(const u32 count, std::mt19937& random)
+    {
+        std::uniform_real_distribution<f32> horizontal(-WorldSize * 0.5f, WorldSize * 0.5f);
+        std::uniform_real_distribution<f32> vertical(0.0f, 96.0f);
+        std::uniform_real_distribution<f32> logSize(std::log(0.5f), std::log(16.0f));
+
+        std::vector<AABB> objects(count);
+        for (AABB& object : objects)
+        {
+            const glm::vec3 position = {horizontal(random), vertical(random), horizontal(random)};
+            const glm::vec3 size     = glm::exp(glm::vec3(logSize(random), logSize(random), logSize(random)));
+            object                   = {position, position + size};
+        }
+        return objects;
+    }
+
+    // Looking out from the middle of the world in evenly spaced directions, slightly down.
+    glm::mat4 GetViewProjection(const u32 view)
+    {
+        const f32       yaw        = glm::two_pi<f32>() * static_cast<f32>(view) / ViewCount;
+        const glm::vec3 eye        = {0.0f, 48.0f, 0.0f};
+        const glm::vec3 forward    = {std::cos(yaw), -0.2f, std::sin(yaw)};
+        const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+        return projection * glm::lookAt(eye, eye + forward, {0.0f, 1.0f, 0.0f});
+    }
+
+    // Walls between the camera and most of the world, with gaps, as a structure's would be.
+    std::vector<AABB> MakeOccluders()
+    {
+        std::vector<AABB> walls;
+        for (u32 i = 0; i < 12; i++)
+        {
+            const f32       angle  = glm::two_pi<f32>() * (static_cast<f32>(i) + 0.5f) / 12.0f;
+            const glm::vec3 center = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * 60.0f + glm::vec3(0, 32, 0);
+            walls.push_back({center - glm::vec3(12.0f, 32.0f, 12.0f), center + glm::vec3(12.0f, 32.0f, 12.0f)});
+        }
+        return walls;
+    }
+
+    // Every object against the frustum, one at a time, as the baseline.
+    void CullScalar(const Frustum& frustum, const std::span<const AABB> objects, std::vector<u32>& visible)
+    {
+        visible.clear();
+        for (u32 i = 0; i < objects.size(); i++)
+        {
+            if (frustum.Test(objects[i]) != FrustumTest::Outside)
+                visible.push_back(i);
+        }
+    }
+}
+
+// Culls a preview scene of 100k objects against several views: through the BVH, with SIMD tests over every object,
+// and one object at a time, checking they agree (and that small trees do too). Then moves some objects to time
+// refitting, and adds occluders.
+static void SceneCullingBenchmark(const BenchmarkContext& context)
+{
+    const u32 objectCount = static_cast<u32>(context.Args.GetInt("benchmark-objects", 100000));
+    const u32 iterations  = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+
+    std::mt19937      random(1234);
+    std::vector<AABB> objects = MakeObjects(objectCount, random);
+
+    // Objects are added with their index as their value, so the scene's results are comparable to the others'.
+    Scene                          scene;
+    std::vector<SceneObjectHandle> handles(objectCount);
+    for (u32 i = 0; i < objectCount; i++)
+        handles[i] = scene.Add(objects[i], i);
+    scene.Update();
+
+    BVH                   bvh;
+    const BenchmarkResult build = Benchmarks::Measure(iterations, [&] { bvh.Build({}, objects); });
+
+    std::array<glm::mat4, ViewCount> views;
+    std::array<Frustum, ViewCount>   frustums;
+    for (u32 view = 0; view < ViewCount; view++)
+    {
+        views[view]    = GetViewProjection(view);
+        frustums[view] = Frustum::FromMatrix(views[view]);
+    }
+
+    std::vector<u32>      visible;
+    CullStats             sceneStats;
+    const BenchmarkResult bvhCull = Benchmarks::Measure(iterations, [&]
+    {
+        sceneStats.Reset();
+        for (u32 view = 0; view < ViewCount; view++)
+        {
+            scene.Cull(views[view], visible);
+            const CullStats& stats     = scene.GetStats().Cull;
+            sceneStats.Visible       += stats.Visible;
+            sceneStats.FrustumCulled += stats.FrustumCulled;
+            sceneStats.NodesVisited  += stats.NodesVisited;
+            sceneStats.ItemsTested   += stats.ItemsTested;
+        }
+    });
+    CullStats             flatStats;
+    const BenchmarkResult flatCull = Benchmarks::Measure(iterations, [&]
+    {
+        for (const Frustum& frustum : frustums)
+        {
+            visible.clear();
+            bvh.CullFlat(frustum, visible, flatStats);
+        }
+    });
+    const BenchmarkResult scalarCull = Benchmarks::Measure(iterations, [&]
+    {
+        for (const Frustum& frustum : frustums)
+            CullScalar(frustum, objects, visible);
+    });
+
+    // The three should find exactly the same objects.
+    auto countMismatches = [&]
+    {
+        u32              mismatches = 0;
+        std::vector<u32> fromScene, fromFlat, fromScalar;
+        for (u32 view = 0; view < ViewCount; view++)
+        {
+            CullStats unused;
+            scene.Cull(views[view], fromScene);
+            fromFlat.clear();
+            scene.GetBVH().CullFlat(frustums[view], fromFlat, unused);
+            CullScalar(frustums[view], objects, fromScalar);
+            std::ranges::sort(fromScene);
+            std::ranges::sort(fromFlat);
+            mismatches += fromScene != fromScalar || fromFlat != fromScalar;
+        }
+        return mismatches;
+    };
+    u32 mismatches = countMismatches();
+
+    // Small trees, whose leaves start at any slot and may end at the last: a row of boxes, half of them in view.
+    for (u32 count = 1; count <= 9; count++)
+    {
+        std::vector<AABB> row(count);
+        for (u32 i = 0; i < count; i++)
+            row[i] = {glm::vec3(i, -0.25f, -0.25f), glm::vec3(i + 0.5f, 0.25f, 0.25f)};
+        const Frustum    half = Frustum::FromMatrix(glm::ortho(-1.0f, count * 0.5f, -1.0f, 1.0f, -1.0f, 1.0f));
+        std::vector<u32> expected;
+        CullScalar(half, row, expected);
+        for (u32 leafSize = 1; leafSize <= 3; leafSize++)
+        {
+            BVH       small;
+            CullStats unused;
+            small.Build({.MaxLeafSize = leafSize}, row);
+            visible.clear();
+            small.Cull(half, visible, unused);
+            std::ranges::sort(visible);
+            mismatches += visible != expected;
+        }
+    }
+
+    // Entities wander: a tenth of the objects move a little each frame, and the tree is refitted rather than rebuilt.
+    std::uniform_int_distribution<u32>  pick(0, objectCount - 1);
+    std::uniform_real_distribution<f32> step(-0.5f, 0.5f);
+    const f32                           builtCost = scene.GetBVH().GetBuildCost();
+    f32                                 lastBuilt = builtCost;
+    u32                                 rebuilds  = 0;
+    u32                                 refitted  = 0;
+    const BenchmarkResult               refit     = Benchmarks::Measure(iterations, [&]
+    {
+        for (u32 i = 0; i < objectCount / 10; i++)
+        {
+            const u32       object = pick(random);
+            const glm::vec3 offset = {step(random), step(random), step(random)};
+            objects[object]        = {objects[object].Min + offset, objects[object].Max + offset};
+            scene.SetBounds(handles[object], objects[object]);
+        }
+        scene.Update();
+        // A rebuild resets the build cost (to less than the refitted tree's).
+        rebuilds  += scene.GetBVH().GetBuildCost() != lastBuilt;
+        lastBuilt  = scene.GetBVH().GetBuildCost();
+        refitted   = scene.GetBVH().GetStats().RefittedNodes;
+    });
+    const f32 refitCost = scene.GetBVH().GetCost();
+    mismatches          += countMismatches();
+
+    // Occlusion: walls around the camera, rasterised for each view, then the same culls against them.
+    const std::vector<AABB>      walls = MakeOccluders();
+    OcclusionBuffer              occlusion;
+    OcclusionBufferSpecification occlusionSpec;
+    u32                          occluded = 0, occlusionVisible = 0, notSubset = 0;
+    f64                          renderMS = 0;
+    std::vector<u32>             withoutOcclusion;
+    const BenchmarkResult        occlusionCull = Benchmarks::Measure(iterations, [&]
+    {
+        occluded = occlusionVisible = 0;
+        renderMS = 0;
+        for (u32 view = 0; view < ViewCount; view++)
+        {
+            occlusion.Begin(occlusionSpec, views[view]);
+            for (const AABB& wall : walls)
+                occlusion.AddOccluder(wall);
+            occlusion.Finish();
+            renderMS += occlusion.GetStats().RenderMS;
+
+            scene.Cull(views[view], visible, &occlusion);
+            occluded         += scene.GetStats().Cull.OcclusionCulled;
+            occlusionVisible += scene.GetStats().Cull.Visible;
+        }
+    });
+
+    // Occlusion must only take objects away, never add them; and whatever's right behind a wall, as seen from the
+    // camera, is hidden while the same box in front of it isn't.
+    for (u32 view = 0; view < ViewCount; view++)
+    {
+        occlusion.Begin(occlusionSpec, views[view]);
+        for (const AABB& wall : walls)
+            occlusion.AddOccluder(wall);
+        occlusion.Finish();
+        scene.Cull(views[view], visible, &occlusion);
+        scene.Cull(views[view], withoutOcclusion);
+        std::ranges::sort(visible);
+        std::ranges::sort(withoutOcclusion);
+        notSubset += !std::ranges::includes(withoutOcclusion, visible);
+    }
+    occlusion.Begin(occlusionSpec, views[0]);
+    for (const AABB& wall : walls)
+        occlusion.AddOccluder(wall);
+    occlusion.Finish();
+    const glm::vec3 wallCenter  = walls[0].GetCenter();
+    const glm::vec3 direction   = glm::normalize(wallCenter - glm::vec3(0.0f, 48.0f, 0.0f));
+    const glm::vec3 behind      = wallCenter + direction * 40.0f;
+    const glm::vec3 inFront     = glm::vec3(0.0f, 48.0f, 0.0f) + direction * 20.0f;
+    const bool      hidesBehind = occlusion.IsOccluded({behind - 1.0f, behind + 1.0f});
+    const bool      showsFront  = !occlusion.IsOccluded({inFront - 1.0f, inFront + 1.0f});
+
+    const f64 perView = static_cast<f64>(ViewCount);
+    MP_INFO("Scene culling, {} objects, {} views ({} iterations, best time):", objectCount, ViewCount, iterations);
+    MP_INFO("   BVH build: {:.3f}ms ({} nodes, {} leaves, depth {})", build.MinMS, bvh.GetStats().Nodes,
+            bvh.GetStats().Leaves, bvh.GetStats().Depth);
+    MP_INFO("   BVH cull:  {:.3f}ms per view ({:.0f} visible, {:.0f} culled; {:.0f} nodes visited, {:.0f} objects "
+            "tested)", bvhCull.MinMS / perView, sceneStats.Visible / perView, sceneStats.FrustumCulled / perView,
+            sceneStats.NodesVisited / perView, sceneStats.ItemsTested / perView);
+    MP_INFO("   SIMD, every object:   {:.3f}ms per view ({:.1f}x slower)", flatCull.MinMS / perView,
+            flatCull.MinMS / bvhCull.MinMS);
+    MP_INFO("   Scalar, every object: {:.3f}ms per view ({:.1f}x slower)", scalarCull.MinMS / perView,
+            scalarCull.MinMS / bvhCull.MinMS);
+    MP_INFO("   Refit, {} objects moved: {:.3f}ms ({} nodes; cost {:.2f} -> {:.2f}, {} rebuilds)", objectCount / 10,
+            refit.MinMS, refitted, builtCost, refitCost, rebuilds);
+    MP_INFO("   Occlusion, {} walls at {}x{}: {:.3f}ms per view to render, {:.3f}ms to cull; {:.0f} culled by it, "
+            "{:.0f} left visible", walls.size(), occlusionSpec.Width, occlusionSpec.Height, renderMS / perView,
+            occlusionCull.MinMS / perView - renderMS / perView, occluded / perView, occlusionVisible / perView);
+
+    if (mismatches > 0 || notSubset > 0 || !hidesBehind || !showsFront || occluded == 0)
+    {
+        MP_ERROR("Culling results are wrong: {} views disagreed, {} views where occlusion added objects, occlusion "
+                 "behind a wall {}, in front of it {}", mismatches, notSubset, hidesBehind ? "worked" : "failed",
+                 showsFront ? "worked" : "failed");
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(SceneCullingBenchmark, "scene-culling",
+                      "Frustum and occlusion culling 100k objects with a BVH, vs SIMD and scalar brute force");
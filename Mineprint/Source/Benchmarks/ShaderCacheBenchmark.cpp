@@ -0,0 +1,85 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/EmbeddedContent/EmbeddedContent.h"
+#include "Render/Renderer.h"
+
+// Creates the renderer's shaders from source and from the program binary cache, to see what the cache saves at
+// startup. Needs a GL context, so run it with --headless-gl. The driver may have a shader cache of its own (Mesa does,
+// and only supports program binaries while it's on), so the compiled shaders get a new define every time.
+static void ShaderCacheBenchmark(const BenchmarkContext& context)
+{
+    if (!context.App.GetRenderer().IsHeadless())
+    {
+        MP_ERROR("The shader cache benchmark needs an offscreen context: run it with --headless-gl");
+        context.App.SetExitCode(1);
+        return;
+    }
+
+    const u32     iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+    GPUResources& resources  = context.App.GetRenderer().GetResources();
+
+    auto getSource = [](const std::string_view path)
+    {
+        const std::span<const u8> data = EmbeddedContent::Get(path);
+        return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+    };
+    std::vector<ShaderSpecification> specs = {
+        {.Name = "Canvas", .VertexSource = getSource("Shaders/Canvas.vert"),
+         .FragmentSource = getSource("Shaders/Canvas.frag")},
+        {.Name = "Wire", .VertexSource = getSource("Shaders/Wire.vert"),
+         .FragmentSource = getSource("Shaders/Wire.frag")},
+    };
+
+    // A cache of its own, so the app's isn't touched and the first run is always a miss.
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                            fmt::format("MineprintShaderCacheBenchmark{}", SDL_GetTicksNS());
+    ShaderCache cache;
+    if (!cache.Init(directory))
+    {
+        MP_ERROR("The driver can't cache shaders");
+        context.App.SetExitCode(1);
+        return;
+    }
+
+    // Defines that change every iteration keep the driver's own cache (if it has one) from helping when we compile.
+    u32  variant   = 0;
+    bool succeeded = true;
+    auto createAll = [&](ShaderCache* shaderCache, const bool uniqueVariant)
+    {
+        if (uniqueVariant)
+            variant++;
+        for (ShaderSpecification& spec : specs)
+        {
+            spec.Cache   = shaderCache;
+            spec.Defines = {fmt::format("BENCHMARK_VARIANT {}", variant)};
+            Shader shader;
+            succeeded &= shader.Init(resources, spec);
+        }
+    };
+
+    MP_INFO("Shader creation, {} programs ({} iterations, average time):", specs.size(), iterations);
+
+    const BenchmarkResult compiled = Benchmarks::Measure(iterations, [&] { createAll(nullptr, true); });
+    MP_INFO("   {:<20} {:.3f}ms", "Compiled", compiled.AverageMS);
+
+    // The warm-up run stores the entries, and every run after that loads them.
+    const BenchmarkResult loaded = Benchmarks::Measure(iterations, [&] { createAll(&cache, false); });
+    MP_INFO("   {:<20} {:.3f}ms ({:.1f}x faster)", "From cache", loaded.AverageMS,
+            compiled.AverageMS / std::max(loaded.AverageMS, 1e-6));
+
+    const ShaderCacheStats stats = cache.GetStats();
+    if (!succeeded || stats.Hits != iterations * specs.size() || stats.Rejected > 0)
+    {
+        MP_ERROR("Expected {} cache hits, got {} ({} rejected), and {} shaders failed", iterations * specs.size(),
+                 stats.Hits, stats.Rejected, succeeded ? "no" : "some");
+        context.App.SetExitCode(1);
+    }
+
+    cache.Clear();
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+MP_REGISTER_BENCHMARK(ShaderCacheBenchmark, "shader-cache", "Creates shaders from source and from the program cache");
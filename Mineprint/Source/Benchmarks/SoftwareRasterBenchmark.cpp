@@ -0,0 +1,278 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Benchmarks/BenchmarkMeshes.h"
+#include "Render/SoftwareRasteriser.h"
+#include "Render/TextureAtlas.h"
+
+#include <random>
+
+namespace
+{
+    constexpr u32 SolidColour = 0xFF4080C0; // ABGR, as the atlas's pixels read as u32s.
+
+    // Four 16x16 textures: a solid one for checking colours, two noisy ones, and a cutout (glass-like, with a clear
+    // middle), to exercise the alpha test.
+    std::vector<AtlasImage> MakeTextures(std::mt19937& random)
+    {
+        std::uniform_int_distribution<u32> noise(0, 0x3F);
+        std::vector<AtlasImage>            images(4);
+        for (u32 i = 0; i < images.size(); i++)
+        {
+            AtlasImage& image = images[i];
+            image.Location    = fmt::format("benchmark:block/texture_{}", i);
+            image.Width       = 16;
+            image.Height      = 16;
+            image.Pixels.resize(16 * 16 * 4);
+            u32* pixels = reinterpret_cast<u32*>(image.Pixels.data());
+            for (u32 p = 0; p < 16 * 16; p++)
+            {
+                const u32  x    = p % 16;
+                const u32  y    = p / 16;
+                const bool edge = x == 0 || y == 0 || x == 15 || y == 15;
+                switch (i)
+                {
+                case 0:
+                    pixels[p] = SolidColour;
+                    break;
+                case 3:
+                    pixels[p] = edge ? 0xFFE0E0E0 : 0;
+                    break;
+                default:
+                    pixels[p] = 0xFF000000 | (0x40 + noise(random)) << (i * 8) | noise(random) * 0x010101;
+                    break;
+                }
+            }
+        }
+        return images;
+    }
+
+    // A cube from min to max, its faces showing one sprite, appended to the mesh's indices for that sprite's layer.
+    void AddCube(std::vector<MeshVertex>& vertices, std::vector<std::vector<u32>>& indices, const glm::vec3& min,
+                 const glm::vec3& max, const AtlasRegion& region)
+    {
+        static const std::array<glm::vec3, 6> Normals = {
+            glm::vec3(-1, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, -1, 0),
+            glm::vec3(0, 1, 0),  glm::vec3(0, 0, -1), glm::vec3(0, 0, 1),
+        };
+
+        if (indices.size() <= region.Layer)
+            indices.resize(region.Layer + 1);
+        for (const glm::vec3& normal : Normals)
+        {
+            // Two axes across the face, and the side of the box it's on.
+            const s32       axis  = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+            const glm::vec3 u     = axis == 0 ? glm::vec3(0, 0, 1) : glm::vec3(1, 0, 0);
+            const glm::vec3 v     = axis == 1 ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+            const glm::vec3 size  = max - min;
+            const glm::vec3 start = glm::mix(min, max, glm::max(normal, glm::vec3(0.0f))) * glm::abs(normal)
+                                    + min * (glm::vec3(1.0f) - glm::abs(normal));
+
+            const u32 first = static_cast<u32>(vertices.size());
+            for (u32 corner = 0; corner < 4; corner++)
+            {
+                const f32 s = static_cast<f32>(corner & 1);
+                const f32 t = static_cast<f32>(corner >> 1);
+                vertices.push_back({start + u * size * s + v * size * t, normal,
+                                    glm::mix(region.UVMin, region.UVMax, glm::vec2(s, 1.0f - t))});
+            }
+            for (const u32 corner : {0u, 1u, 3u, 0u, 3u, 2u})
+                indices[region.Layer].push_back(first + corner);
+        }
+    }
+
+    // A submesh per atlas layer, as BlockBenchModel bakes them.
+    TestMesh Finish(std::vector<MeshVertex>&& vertices, const std::vector<std::vector<u32>>& indices)
+    {
+        TestMesh mesh;
+        mesh.Vertices = std::move(vertices);
+        for (u32 layer = 0; layer < indices.size(); layer++)
+        {
+            if (indices[layer].empty())
+                continue;
+            mesh.SubMeshes.push_back({.FirstIndex    = static_cast<u32>(mesh.Indices.size()),
+                                      .IndexCount    = static_cast<u32>(indices[layer].size()),
+                                      .MaterialIndex = layer});
+            mesh.Indices.insert(mesh.Indices.end(), indices[layer].begin(), indices[layer].end());
+        }
+        return mesh;
+    }
+
+    // An item thumbnail's worth: one block.
+    TestMesh MakeBlock(const TextureAtlas& atlas)
+    {
+        const AtlasSprite*            solid = atlas.Find("benchmark:block/texture_0");
+        std::vector<MeshVertex>       vertices;
+        std::vector<std::vector<u32>> indices;
+        AddCube(vertices, indices, glm::vec3(-0.5f), glm::vec3(0.5f), atlas.GetFrames(*solid)[0]);
+        return Finish(std::move(vertices), indices);
+    }
+
+    // A structure preview's worth: a 16x8x16 region, about half of it filled with every texture, cutouts included.
+    // Every cube has all six faces, as nothing here culls hidden ones, so there's plenty of overdraw.
+    TestMesh MakeStructure(const TextureAtlas& atlas, std::mt19937& random)
+    {
+        std::uniform_int_distribution<u32> fill(0, 7);
+        std::vector<MeshVertex>            vertices;
+        std::vector<std::vector<u32>>      indices;
+        for (s32 y = 0; y < 8; y++)
+        {
+            for (s32 z = 0; z < 16; z++)
+            {
+                for (s32 x = 0; x < 16; x++)
+                {
+                    const u32 kind = fill(random);
+                    if (kind >= atlas.GetSprites().size())
+                        continue;
+                    const glm::vec3 min = glm::vec3(x - 8, y - 4, z - 8);
+                    AddCube(vertices, indices, min, min + 1.0f, atlas.GetFrames(atlas.GetSprites()[kind])[0]);
+                }
+            }
+        }
+        return Finish(std::move(vertices), indices);
+    }
+
+    // Inventory icons: orthographic, from above and to one corner.
+    glm::mat4 GetBlockViewProjection()
+    {
+        const glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 1.6f, 2.4f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return glm::ortho(-0.9f, 0.9f, -0.9f, 0.9f, 0.1f, 10.0f) * view;
+    }
+
+    glm::mat4 GetStructureViewProjection()
+    {
+        const glm::mat4 view = glm::lookAt(glm::vec3(16.0f, 14.0f, 20.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+        return glm::perspective(glm::radians(50.0f), 1.0f, 0.1f, 100.0f) * view;
+    }
+
+    // What the solid texture should come out as, lit from a face with the given normal (as Mesh.frag lights it).
+    glm::ivec3 GetLitColour(const glm::vec3& normal)
+    {
+        const f32       facing = glm::dot(normal, glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f)));
+        const f32       light  = 0.6f + 0.4f * std::max(facing, 0.0f);
+        const glm::vec3 colour = glm::vec3(SolidColour & 0xFF, SolidColour >> 8 & 0xFF, SolidColour >> 16 & 0xFF);
+        return glm::ivec3(colour * light + 0.5f);
+    }
+}
+
+// Draws thumbnails on the CPU: a single block, as an inventory icon is, and a structure preview of a few thousand
+// cubes, at the sizes thumbnails are made at, on the job system and on one thread. Then checks the block's pixels
+// are its three front faces, lit, and nothing else; that tiling and threading don't change a pixel; and that the
+// result encodes as a PNG.
+//
+// --benchmark-output=<folder> saves each thumbnail there, to look at.
+static void SoftwareRasterBenchmark(const BenchmarkContext& context)
+{
+    const u32                   iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+    const std::filesystem::path output     = context.Args.GetValue("benchmark-output");
+
+    JobSystem& jobs = context.App.GetJobSystem();
+    JobSystem  serial; // Never initialised, so ParallelFor() runs everything inline.
+
+    std::mt19937                  random(1234);
+    const std::vector<AtlasImage> images = MakeTextures(random);
+    TextureAtlas                  atlas;
+    if (!atlas.Build({.MinPageSize = 64, .Folders = {}}, images, jobs))
+    {
+        MP_ERROR("Couldn't build the software raster benchmark's atlas");
+        context.App.SetExitCode(1);
+        return;
+    }
+    const TestMesh block     = MakeBlock(atlas);
+    const TestMesh structure = MakeStructure(atlas, random);
+
+    struct Thumbnail
+    {
+        const char*     Name;
+        const TestMesh* Mesh;
+        glm::mat4       ViewProjection;
+    };
+    const std::array<Thumbnail, 2> thumbnails = {{
+        {"block", &block, GetBlockViewProjection()},
+        {"structure", &structure, GetStructureViewProjection()},
+    }};
+
+    SoftwareRasteriser rasteriser;
+    auto render = [&](const Thumbnail& thumbnail, const u32 size, JobSystem& system, const u32 tileSize = 32)
+    {
+        rasteriser.Begin({.Width = size, .Height = size, .TileSize = tileSize});
+        rasteriser.Draw(thumbnail.Mesh->Vertices, thumbnail.Mesh->Indices, thumbnail.Mesh->SubMeshes,
+                        thumbnail.ViewProjection, &atlas);
+        rasteriser.Render(system);
+    };
+
+    MP_INFO("Software rasteriser ({} iterations, best time, {} threads):", iterations, jobs.GetThreadCount());
+    bool saved = true;
+    for (const Thumbnail& thumbnail : thumbnails)
+    {
+        MP_INFO("   {}, {} triangles:", thumbnail.Name, thumbnail.Mesh->Indices.size() / 3);
+        for (const u32 size : {32u, 64u, 128u, 256u, 512u})
+        {
+            auto                           draw   = [&] { render(thumbnail, size, jobs); };
+            const BenchmarkResult          result = Benchmarks::Measure(iterations, draw);
+            const SoftwareRasteriserStats& stats  = rasteriser.GetStats();
+            MP_INFO("      {}x{}: {:.3f}ms, {:.0f} a second (vertices {:.3f}ms, setup {:.3f}ms, raster {:.3f}ms; {} "
+                    "set up, {} binned, {} pixels, {} discarded)", size, size, result.MinMS, 1000.0 / result.MinMS,
+                    stats.VertexMS, stats.SetupMS, stats.RasterMS, stats.SetUp, stats.Binned, stats.Pixels,
+                    stats.Discarded);
+            if (!output.empty())
+                saved &= rasteriser.SavePNG(output / fmt::format("{}_{}.png", thumbnail.Name, size));
+        }
+    }
+
+    const BenchmarkResult parallelResult = Benchmarks::Measure(iterations, [&] { render(thumbnails[1], 256, jobs); });
+    const BenchmarkResult serialResult   = Benchmarks::Measure(iterations, [&] { render(thumbnails[1], 256, serial); });
+    MP_INFO("   Structure at 256x256 on one thread: {:.3f}ms ({:.2f}x slower)", serialResult.MinMS,
+            serialResult.MinMS / parallelResult.MinMS);
+
+    // The block from its corner shows three faces, each the solid texture at its own light. Any other colour is a
+    // back face showing through (or a bad texel); anything outside the three is transparent.
+    render(thumbnails[0], 64, jobs);
+    const std::array<glm::ivec3, 3> front = {GetLitColour({1, 0, 0}), GetLitColour({0, 1, 0}),
+                                             GetLitColour({0, 0, 1})};
+    std::array<u32, 3>        faces  = {};
+    u32                       wrong  = 0;
+    const std::span<const u8> pixels = rasteriser.GetPixels();
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        if (pixels[i + 3] == 0)
+            continue;
+        const glm::ivec3 colour = {pixels[i], pixels[i + 1], pixels[i + 2]};
+        const auto       match  = std::ranges::find_if(front, [&](const glm::ivec3& expected)
+        {
+            return glm::all(glm::lessThanEqual(glm::abs(colour - expected), glm::ivec3(1)));
+        });
+        if (match == front.end())
+            wrong++;
+        else
+            faces[match - front.begin()]++;
+    }
+    const bool blockCorrect = wrong == 0 && faces[0] > 0 && faces[1] > 0 && faces[2] > 0;
+
+    // Tiles own whole pixels and walk the bins in draw order, so neither the tile size nor the threads may change
+    // the result.
+    render(thumbnails[1], 200, jobs, 32);
+    const std::vector<u8> reference(rasteriser.GetPixels().begin(), rasteriser.GetPixels().end());
+    render(thumbnails[1], 200, serial, 8);
+    const bool tilesMatch = std::ranges::equal(reference, rasteriser.GetPixels());
+    render(thumbnails[1], 200, jobs, 64);
+    const bool threadsMatch = std::ranges::equal(reference, rasteriser.GetPixels());
+
+    const std::vector<u8> png     = rasteriser.EncodePNG();
+    const bool            encoded = png.size() > 8 && std::memcmp(png.data(), "\x89PNG\r\n\x1a\n", 8) == 0;
+    MP_INFO("   Structure at 200x200 as a PNG: {} bytes", png.size());
+
+    if (!blockCorrect || !tilesMatch || !threadsMatch || !encoded || !saved)
+    {
+        MP_ERROR("Software rasteriser results are wrong: block had {} wrong pixels (faces {}, {}, {}), tile sizes "
+                 "{}, threads {}, PNG {}, saving {}", wrong, faces[0], faces[1], faces[2],
+                 tilesMatch ? "matched" : "differed", threadsMatch ? "matched" : "differed",
+                 encoded ? "encoded" : "failed", saved ? "worked" : "failed");
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(SoftwareRasterBenchmark, "software-raster",
+                      "Thumbnails of a block and a structure on the CPU, at 32 to 512 pixels, threaded and not");
@@ -0,0 +1,182 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/Task.h"
+
+#include <fstream>
+
+namespace
+{
+    // Sums [begin, end) on a worker.
+    Task<u64> SumRange(JobSystem& jobSystem, const u64 begin, const u64 end, CancellationToken token = {})
+    {
+        co_await Async::SwitchToWorker(jobSystem, token);
+
+        u64 sum = 0;
+        for (u64 i = begin; i < end; i++)
+            sum += i;
+        co_return sum;
+    }
+
+    // Awaits a chain of tasks, each resuming its awaiter directly when it returns.
+    Task<u32> Chain(const u32 depth)
+    {
+        if (depth == 0)
+            co_return 0;
+        co_return *co_await Chain(depth - 1) + 1;
+    }
+
+    // Whoever picks up the first half (the main thread helps, while it waits), the second is on the main thread.
+    Task<bool> RoundTrip(JobSystem& jobSystem)
+    {
+        co_await Async::SwitchToWorker(jobSystem);
+        co_await Async::SwitchToMainThread(jobSystem);
+        co_return jobSystem.IsMainThread();
+    }
+
+    // Counts how many of itself have been destroyed, to check that stopped tasks' frames are cleaned up.
+    struct FrameGuard
+    {
+        u32* Destroyed;
+
+        ~FrameGuard() { ++*Destroyed; }
+    };
+
+    // Cancels itself part way through. Nothing after the cancellation point should run.
+    Task<> StopHalfway(CancellationSource source, u32& destroyed, bool& ranOn)
+    {
+        FrameGuard guard{&destroyed};
+        source.Cancel();
+        co_await Async::StopIfCancelled(source.GetToken());
+        ranOn = true;
+    }
+
+    // Passes on a cancelled child's result.
+    Task<u64> SumOrStop(JobSystem& jobSystem, CancellationToken token)
+    {
+        const std::optional<u64> sum = co_await SumRange(jobSystem, 0, 100, std::move(token));
+        if (!sum)
+            co_await Async::Cancel();
+        co_return *sum;
+    }
+
+    // Waits on a worker forever, if no worker ever picks it up.
+    Task<> WaitForWorker(JobSystem& jobSystem, u32& destroyed)
+    {
+        FrameGuard guard{&destroyed};
+        co_await Async::SwitchToWorker(jobSystem);
+    }
+}
+
+// Checks tasks on the application's job system - results, thread switches, WhenAll(), reading files, cancellation,
+// and spawned tasks left queued at shutdown - then times awaiting chains of tasks and WhenAll() over many small ones.
+static void TaskBenchmark(const BenchmarkContext& context)
+{
+    const u32 taskCount  = static_cast<u32>(context.Args.GetInt("benchmark-tasks", 10000));
+    const u32 chainDepth = static_cast<u32>(context.Args.GetInt("benchmark-chain-depth", 1000));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+
+    JobSystem&               jobSystem = context.App.GetJobSystem();
+    std::vector<std::string> failures;
+    auto                     check = [&failures](const bool passed, const char* what)
+    {
+        if (!passed)
+            failures.emplace_back(what);
+    };
+
+    check(Async::SyncWait(jobSystem, SumRange(jobSystem, 0, 1000)) == 499500u, "a task's result");
+    check(Async::SyncWait(jobSystem, Chain(chainDepth)) == chainDepth, "a chain of tasks");
+    check(Async::SyncWait(jobSystem, RoundTrip(jobSystem)).value_or(false), "switching back to the main thread");
+
+    // The middle task gets the token.
+    auto makeSums = [&](const u32 count, const CancellationToken& token)
+    {
+        std::vector<Task<u64>> tasks;
+        tasks.reserve(count);
+        for (u32 i = 0; i < count; i++)
+        {
+            const u64 begin = i * 100ull;
+            tasks.push_back(SumRange(jobSystem, begin, begin + 100, i == count / 2 ? token : CancellationToken()));
+        }
+        return tasks;
+    };
+    const std::optional<std::vector<u64>> sums = Async::SyncWait(jobSystem,
+                                                                 Async::WhenAll(jobSystem, makeSums(100, {})));
+    u64 total = 0;
+    if (sums)
+    {
+        for (const u64 sum : *sums)
+            total += sum;
+    }
+    check(sums && sums->size() == 100 && total == 10000ull * 9999 / 2, "WhenAll()'s results");
+
+    // Reading this file back, and one that doesn't exist.
+    const std::filesystem::path path     = std::filesystem::temp_directory_path() / "MineprintTaskBenchmark.bin";
+    const std::string           contents = "Read on a worker";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << contents;
+    }
+    std::optional<Buffer> read = Async::SyncWait(jobSystem, Async::ReadFile(jobSystem, path));
+    check(read && std::string_view(reinterpret_cast<const char*>(read->Data), read->Size) == contents,
+          "reading a file");
+    if (read)
+        read->Release();
+    std::filesystem::remove(path);
+    std::optional<Buffer> missing = Async::SyncWait(jobSystem, Async::ReadFile(jobSystem, path));
+    check(missing && missing->Size == 0, "reading a missing file");
+
+    // Cancellation.
+    CancellationSource cancelled;
+    cancelled.Cancel();
+    check(!Async::SyncWait(jobSystem, SumRange(jobSystem, 0, 100, cancelled.GetToken())), "a cancelled task");
+    check(!Async::SyncWait(jobSystem, SumOrStop(jobSystem, cancelled.GetToken())), "passing on a cancellation");
+    check(!Async::SyncWait(jobSystem, Async::WhenAll(jobSystem, makeSums(10, cancelled.GetToken()))),
+          "WhenAll() with a cancelled task");
+    check(!Async::SyncWait(jobSystem, Async::ReadFile(jobSystem, path, cancelled.GetToken())),
+          "a cancelled file read");
+    u32  destroyed = 0;
+    bool ranOn     = false;
+    {
+        Task<> task = StopHalfway(CancellationSource(), destroyed, ranOn);
+        check(!Async::SyncWait(jobSystem, std::move(task)) && !ranOn, "stopping at a cancellation point");
+    }
+    check(destroyed == 1, "destroying a stopped task's frame");
+
+    // A spawned task that's still queued when its job system shuts down (which warns about it). With no workers,
+    // nothing runs it, so it should be destroyed along with its frame.
+    destroyed = 0;
+    {
+        JobSystem idle;
+        idle.Init({.WorkerCount = 0});
+        Async::Spawn(idle, WaitForWorker(idle, destroyed));
+        check(destroyed == 0, "a spawned task waiting");
+        idle.Shutdown();
+    }
+    check(destroyed == 1, "destroying a spawned task at shutdown");
+
+    const BenchmarkResult chain = Benchmarks::Measure(iterations, [&]
+    {
+        (void)Async::SyncWait(jobSystem, Chain(chainDepth));
+    });
+    const BenchmarkResult whenAll = Benchmarks::Measure(iterations, [&]
+    {
+        (void)Async::SyncWait(jobSystem, Async::WhenAll(jobSystem, makeSums(taskCount, {})));
+    });
+
+    MP_INFO("Tasks, {} threads ({} iterations, best time):", jobSystem.GetThreadCount(), iterations);
+    MP_INFO("   Chain of {} awaits: {:.3f}ms ({:.0f}ns per task)", chainDepth, chain.MinMS,
+            chain.MinMS * 1e6 / chainDepth);
+    MP_INFO("   WhenAll() over {} tasks on workers: {:.3f}ms ({:.0f}ns per task)", taskCount, whenAll.MinMS,
+            whenAll.MinMS * 1e6 / taskCount);
+
+    if (!failures.empty())
+    {
+        for (const std::string& failure : failures)
+            MP_ERROR("Task check failed: {}", failure);
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(TaskBenchmark, "tasks", "Checks coroutine tasks, then times task chains and WhenAll()");
@@ -0,0 +1,171 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Render/TextureAtlas.h"
+
+// Whether every pixel of the sprite's frames, at every level, is the colour it was filled with. Padding exists so
+// this holds: any bleeding from a neighbour (or a blend with the empty space around the frame) changes some of them.
+static bool IsSolid(const TextureAtlas& atlas, const AtlasSprite& sprite, const u32 colour)
+{
+    for (u32 level = 0; level < atlas.GetLevelCount(); level++)
+    {
+        const u32  size   = atlas.GetPageSize() >> level;
+        const u32* pixels = reinterpret_cast<const u32*>(atlas.GetPixels(level).data());
+        for (const AtlasRegion& region : atlas.GetFrames(sprite))
+        {
+            const glm::uvec2 min   = glm::uvec2(region.UVMin * static_cast<f32>(size));
+            const glm::uvec2 max   = glm::uvec2(glm::ceil(region.UVMax * static_cast<f32>(size)));
+            const u32*       layer = pixels + static_cast<size_t>(region.Layer) * size * size;
+            for (u32 y = min.y; y < max.y; y++)
+            {
+                for (u32 x = min.x; x < max.x; x++)
+                {
+                    if (layer[static_cast<size_t>(y) * size + x] != colour)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Builds an atlas from a resource pack's worth of generated sprites (mostly 16x16 blocks and items, some animation
+// strips, and a few bigger GUI textures), on the job system and on one thread, then saves and reloads it as the disk
+// cache would. Half the sprites are one solid colour, to check that no level bleeds between frames. Also packs one
+// tall image on its own, which needs a bigger page than the area alone asks for.
+//
+// --benchmark-resource-pack=<path> also times BuildFromResourcePack() on a real pack (an extracted game jar works),
+// with and without the cache.
+static void TextureAtlasBenchmark(const BenchmarkContext& context)
+{
+    const u32 imageCount = static_cast<u32>(context.Args.GetInt("benchmark-sprites", 4000));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 10));
+
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<u32> colour(0, 0xFFFFFF);
+    std::uniform_int_distribution<u32> kind(0, 99);
+    std::uniform_int_distribution<u32> frames(2, 32);
+
+    std::vector<AtlasImage> images(imageCount);
+    std::vector<u32>        solidColours(imageCount, 0);
+    for (u32 i = 0; i < imageCount; i++)
+    {
+        // 10% animation strips, 75% 16x16, 10% 32x32 and 5% 256x256 GUI textures.
+        AtlasImage& image = images[i];
+        const u32   type  = kind(random);
+        image.Location    = fmt::format("benchmark:{}/sprite_{}", type < 95 ? "block" : "gui", i);
+        image.Width       = type < 85 ? 16 : type < 95 ? 32 : 256;
+        image.Height      = type < 10 ? image.Width * frames(random) : image.Width;
+
+        image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+        u32* pixels = reinterpret_cast<u32*>(image.Pixels.data());
+        if (i % 2 == 0)
+        {
+            solidColours[i] = 0xFF000000 | colour(random);
+            std::fill_n(pixels, static_cast<size_t>(image.Width) * image.Height, solidColours[i]);
+        }
+        else
+        {
+            // Some fully transparent pixels, like a cutout texture.
+            for (size_t p = 0; p < static_cast<size_t>(image.Width) * image.Height; p++)
+                pixels[p] = (colour(random) & 3) == 0 ? 0 : 0xFF000000 | colour(random);
+        }
+    }
+
+    const TextureAtlasSpecification spec;
+    JobSystem&                      jobs = context.App.GetJobSystem();
+    JobSystem                       serial; // Never initialised, so ParallelFor() runs everything inline.
+
+    TextureAtlas          atlas;
+    bool                  built          = true;
+    const BenchmarkResult parallelResult = Benchmarks::Measure(iterations, [&]
+    {
+        built &= atlas.Build(spec, images, jobs);
+    });
+    TextureAtlasStats     stats        = atlas.GetStats();
+    const BenchmarkResult serialResult = Benchmarks::Measure(iterations, [&]
+    {
+        built &= atlas.Build(spec, images, serial);
+    });
+
+    u32 bleeding = 0;
+    for (u32 i = 0; i < imageCount; i++)
+    {
+        const AtlasSprite* sprite = atlas.Find(images[i].Location);
+        if (solidColours[i] != 0 && (!sprite || !IsSolid(atlas, *sprite, solidColours[i])))
+            bleeding++;
+    }
+
+    // The cache, round trip.
+    const std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                       fmt::format("MineprintAtlasBenchmark{}.atlas", SDL_GetTicksNS());
+    constexpr u64   key    = 0x1234;
+    TextureAtlas    cached;
+    bool            loaded = atlas.Save(path, key);
+    BenchmarkResult loadResult;
+    if (loaded)
+        loadResult = Benchmarks::Measure(iterations, [&] { loaded &= cached.Load(path, key); });
+    loaded = loaded && !cached.Load(path, key + 1) && cached.Load(path, key);
+    for (u32 level = 0; loaded && level < atlas.GetLevelCount(); level++)
+        loaded = std::ranges::equal(atlas.GetPixels(level), cached.GetPixels(level));
+    loaded = loaded && atlas.GetLocations() == cached.GetLocations();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    // One solid image taller than the smallest page, kept whole (as BlockBench textures are): the page grows to fit.
+    constexpr u32 tallColour = 0xFF2060A0;
+    AtlasImage    tallImage  = {.Location = "benchmark:block/tall", .Width = 16, .Height = 500, .SplitFrames = false};
+    tallImage.Pixels.resize(static_cast<size_t>(tallImage.Width) * tallImage.Height * 4);
+    std::fill_n(reinterpret_cast<u32*>(tallImage.Pixels.data()), tallImage.Width * tallImage.Height, tallColour);
+    TextureAtlas       tall;
+    const AtlasSprite* tallSprite = tall.Build(spec, {&tallImage, 1}, jobs) ? tall.Find(tallImage.Location) : nullptr;
+    bleeding                      += !tallSprite || !IsSolid(tall, *tallSprite, tallColour);
+
+    MP_INFO("Texture atlas, {} images ({} iterations, best time):", imageCount, iterations);
+    MP_INFO("   {} sprites, {} frames, {} layer(s) of {}x{}, {:.0f}% occupied, {} mip levels",
+            stats.Sprites, stats.Frames, stats.Layers, stats.PageSize, stats.PageSize, stats.Occupancy * 100.0f,
+            atlas.GetLevelCount() - 1);
+    MP_INFO("   Job system ({} threads): {:.3f}ms (pack {:.3f}ms, copy {:.3f}ms, mips {:.3f}ms)", jobs.GetThreadCount(),
+            parallelResult.MinMS, stats.PackMS, stats.CopyMS, stats.MipMS);
+    MP_INFO("   One thread:             {:.3f}ms ({:.2f}x slower)", serialResult.MinMS,
+            serialResult.MinMS / parallelResult.MinMS);
+    MP_INFO("   From the cache:         {:.3f}ms", loadResult.MinMS);
+
+    if (!built || bleeding > 0 || !loaded)
+    {
+        MP_ERROR("Texture atlas results are wrong ({} solid sprites bled or went missing, cache {})", bleeding,
+                 loaded ? "matched" : "didn't match");
+        context.App.SetExitCode(1);
+    }
+
+    const std::string pack = context.Args.GetValue("benchmark-resource-pack");
+    if (pack.empty())
+        return;
+
+    TextureAtlasSpecification packSpec = spec;
+    packSpec.CacheDirectory = std::filesystem::temp_directory_path() /
+                              fmt::format("MineprintAtlasBenchmark{}", SDL_GetTicksNS());
+    Stopwatch timer;
+    built            = atlas.BuildFromResourcePack(packSpec, pack, jobs);
+    const f64 coldMS = timer.GetElapsedMilliseconds();
+    stats            = atlas.GetStats();
+    timer.Restart();
+    built              = built && atlas.BuildFromResourcePack(packSpec, pack, jobs) && atlas.GetStats().FromCache;
+    const f64 cachedMS = timer.GetElapsedMilliseconds();
+    std::filesystem::remove_all(packSpec.CacheDirectory, error);
+
+    MP_INFO("Resource pack {}: {} sprites, {} layer(s) of {}x{}", pack, stats.Sprites, stats.Layers, stats.PageSize,
+            stats.PageSize);
+    MP_INFO("   Built:  {:.3f}ms (decode {:.3f}ms, pack {:.3f}ms, copy {:.3f}ms, mips {:.3f}ms)", coldMS,
+            stats.DecodeMS, stats.PackMS, stats.CopyMS, stats.MipMS);
+    MP_INFO("   Cached: {:.3f}ms", cachedMS);
+    if (!built)
+    {
+        MP_ERROR("Failed to build (or reload) the atlas for {}", pack);
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(TextureAtlasBenchmark, "texture-atlas", "Sprite atlas packing, mip generation and caching");
@@ -0,0 +1,110 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+#include "Render/WireGeometry.h"
+
+// The same tessellation as WireBatch::Build(), one wire and one point at a time, as a baseline for the SIMD version
+// (and to check it against). Assumes every wire is visible.
+static void BuildWiresScalar(const std::vector<WireCurve>& curves, const f32 thickness, const f32 pixelsPerUnit,
+                             std::vector<WireVertex>& vertices, std::vector<u32>& indices)
+{
+    vertices.clear();
+    indices.clear();
+
+    const f32 pixel     = 1.0f / pixelsPerUnit;
+    const f32 halfWidth = std::max(thickness * 0.5f, pixel * 0.5f) + pixel;
+    for (const WireCurve& curve : curves)
+    {
+        const u32 segments = WireBatch::GetSegmentCount(curve, pixelsPerUnit);
+        const u32 base     = static_cast<u32>(vertices.size());
+        for (u32 segment = 0; segment <= segments; segment++)
+        {
+            const f32 t = std::min(static_cast<f32>(segment) * (1.0f / static_cast<f32>(segments)), 1.0f);
+            const f32 u = 1.0f - t;
+
+            const glm::vec2 position = u * u * u * curve.P0 + 3.0f * u * u * t * curve.P1 + 3.0f * u * t * t * curve.P2
+                                       + t * t * t * curve.P3;
+            glm::vec2 tangent = u * u * (curve.P1 - curve.P0) + 2.0f * u * t * (curve.P2 - curve.P1)
+                                + t * t * (curve.P3 - curve.P2);
+            if (glm::dot(tangent, tangent) < 1e-12f)
+                tangent = curve.P3 - curve.P0;
+
+            const f32       length = std::sqrt(std::max(glm::dot(tangent, tangent), 1e-12f));
+            const glm::vec2 offset = glm::vec2(-tangent.y, tangent.x) / length * halfWidth;
+            vertices.push_back({position + offset, 0xFFFFFFFF, 1.0f});
+            vertices.push_back({position - offset, 0xFFFFFFFF, -1.0f});
+        }
+
+        for (u32 segment = 0; segment < segments; segment++)
+        {
+            const u32 index = base + segment * 2;
+            indices.insert(indices.end(), {index, index + 1, index + 2, index + 1, index + 3, index + 2});
+        }
+    }
+}
+
+// Tessellates a frame's worth of node editor links: with SIMD, from the cache, and one at a time for comparison.
+static void WireTessellationBenchmark(const BenchmarkContext& context)
+{
+    const u32 wireCount  = static_cast<u32>(context.Args.GetInt("benchmark-wires", 10000));
+    const u32 iterations = static_cast<u32>(context.Args.GetInt("benchmark-iterations", 20));
+
+    // Links between random points of a canvas the size of a 4K screen, viewed at 1:1 so every wire is visible and
+    // long ones get plenty of segments.
+    constexpr glm::vec2                 canvasSize = {3840.0f, 2160.0f};
+    constexpr f32                       thickness  = 3.0f;
+    std::mt19937                        random(1234);
+    std::uniform_real_distribution<f32> x(0.0f, canvasSize.x);
+    std::uniform_real_distribution<f32> y(0.0f, canvasSize.y);
+
+    std::vector<WireCurve> curves(wireCount);
+    for (WireCurve& curve : curves)
+        curve = WireCurve::MakeLink({x(random), y(random)}, {x(random), y(random)});
+
+    const FRect view({0.0f, 0.0f}, canvasSize);
+    WireBatch   batch;
+    WireCache   cache;
+    auto        build = [&](WireCache* useCache)
+    {
+        batch.Begin(view, canvasSize);
+        for (u32 i = 0; i < wireCount; i++)
+            batch.AddWire(curves[i], 0xFFFFFFFF, thickness, i + 1);
+        batch.Build(useCache);
+    };
+
+    const BenchmarkResult simd = Benchmarks::Measure(iterations, [&] { build(nullptr); });
+    const WireStats       stats = batch.GetStats();
+    const std::vector<WireVertex> simdVertices(batch.GetVertices().begin(), batch.GetVertices().end());
+
+    build(&cache);
+    const BenchmarkResult cached = Benchmarks::Measure(iterations, [&] { build(&cache); });
+    const u32             hits   = batch.GetStats().CacheHits;
+
+    std::vector<WireVertex> scalarVertices;
+    std::vector<u32>        scalarIndices;
+    const BenchmarkResult   scalar = Benchmarks::Measure(iterations, [&]
+    {
+        BuildWiresScalar(curves, thickness, 1.0f, scalarVertices, scalarIndices);
+    });
+
+    // SIMD keeps each wire's vertices in submission order, so the two should line up exactly, give or take rounding.
+    f32 maxError = scalarVertices.size() == simdVertices.size() ? 0.0f : std::numeric_limits<f32>::infinity();
+    for (size_t i = 0; i < simdVertices.size() && i < scalarVertices.size(); i++)
+        maxError = std::max(maxError, glm::length(simdVertices[i].Position - scalarVertices[i].Position));
+
+    MP_INFO("Wire tessellation, {} wires, {} points, {} vertices ({} iterations, best time):", wireCount,
+            stats.Points, stats.Vertices, iterations);
+    MP_INFO("   SIMD:            {:.3f}ms ({:.1f}ns/wire)", simd.MinMS, simd.MinMS * 1e6 / wireCount);
+    MP_INFO("   Scalar:          {:.3f}ms ({:.2f}x slower)", scalar.MinMS, scalar.MinMS / simd.MinMS);
+    MP_INFO("   Cached (static): {:.3f}ms ({}/{} cache hits)", cached.MinMS, hits, wireCount);
+    MP_INFO("   Max difference from scalar: {:.6f} units", maxError);
+
+    if (maxError > 0.01f || hits != wireCount)
+    {
+        MP_ERROR("SIMD wire tessellation doesn't match the scalar version, or the cache missed!");
+        context.App.SetExitCode(1);
+    }
+}
+
+MP_REGISTER_BENCHMARK(WireTessellationBenchmark, "wire-tessellate", "SIMD bezier tessellation vs scalar and cached");
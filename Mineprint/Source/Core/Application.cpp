@@ -12,12 +12,17 @@
 #endif
 
 #include "Core/Input/Input.h"
-#include "Core/EmbeddedContent/OpenSans.h"
-
-Application* Application::s_Instance        = nullptr;
-bool         Application::s_ShouldRestart   = false;
-ImFont*      Application::s_OpenSansRegular = nullptr;
-ImFont*      Application::s_OpenSansBold    = nullptr;
+#include "Core/Benchmark.h"
+#include "Core/EmbeddedContent/EmbeddedContent.h"
+
+Application* Application::s_Instance         = nullptr;
+RestartMode  Application::s_RestartMode      = RestartMode::None;
+Stopwatch    Application::s_RestartTimer;
+RestartMode  Application::s_MeasuringRestart = RestartMode::None;
+f64          Application::s_LastRestartMS    = 0.0;
+u32          Application::s_WakeEventType    = 0;
+ImFont*      Application::s_OpenSansRegular  = nullptr;
+ImFont*      Application::s_OpenSansBold     = nullptr;
 
 Application::Application(ApplicationSpecification spec)
     : m_Specification(std::move(spec)),
@@ -39,22 +44,114 @@ bool Application::Initialise()
     MP_ASSERT(!s_Instance, "Application already initialised!");
     s_Instance = this;
 
+    StartupTimeline::Start();
+
     // Initialise core systems.
-    InitLog(SDL_GetPrefPath(m_Specification.Author.c_str(), m_Specification.Name.c_str()));
+    {
+        STARTUP_SCOPE("InitLog");
+        InitLog(SDL_GetPrefPath(m_Specification.Author.c_str(), m_Specification.Name.c_str()));
+    }
     Random::Init();
 
     MP_INFO("Initialising application: {} by {}", m_Specification.Name, m_Specification.Author);
     auto workingDir = std::filesystem::current_path().string();
     MP_INFO("Working directory: {}", workingDir);
 
-    if (!InitSDL())
-        return false;
+    {
+        STARTUP_SCOPE("JobSystem::Init");
+        m_JobSystem.Init({
+            .WorkerCount = m_Specification.WorkerCount,
+            .OnMainThreadJobQueued = [this] { RequestRedraw(); }
+        });
+    }
+
+    // Only reads the table of contents; files are decompressed when they're first used.
+    EmbeddedContent::Init();
+
+    // Font decoding doesn't need SDL or GL, so it overlaps with their startup. InitImGUI() waits for it.
+    if (!IsHeadless() && !m_FontAtlas)
+        m_JobSystem.Schedule([this] { LoadFontAtlas(); }, &m_FontAtlasJob);
+
+    // Likewise reading the shader cache; only making programs from it needs the context. The renderer waits for it.
+    const RendererSpecification rendererSpec = MakeRendererSpecification();
+    if ((!IsHeadless() || m_Specification.HeadlessGL) && !rendererSpec.ShaderCacheDirectory.empty())
+    {
+        m_JobSystem.Schedule([this, directory = rendererSpec.ShaderCacheDirectory]
+        {
+            const StartupTimeline::Scope scope("Prefetch shader cache");
+            m_ShaderCachePrefetchSpan = scope.GetSpan();
+            m_Renderer.GetShaderCache().Prefetch(directory);
+        }, &m_ShaderCachePrefetchJob);
+    }
+
+    {
+        STARTUP_SCOPE("InitSDL");
+        if (!InitSDL())
+            return false;
+    }
+
+    Input::Init();
+
+    if (m_Specification.Args.HasFlag("benchmark"))
+        Benchmarks::QueueFromCommandLine(*this);
+
+    if (IsHeadless())
+    {
+        // No window, GL context or ImGui - just the core systems.
+        MP_INFO("Running headless");
+        // Unless we were asked for an offscreen context, e.g. for exporting renders.
+        if (m_Specification.HeadlessGL)
+        {
+            WaitForShaderCachePrefetch();
+            if (!m_Renderer.InitHeadless(rendererSpec))
+                return false;
+        }
+        return true;
+    }
 
     if (!m_Window.Create())
         return false;
 
-    Input::Init();
+    BindWindowEvents();
+
+    WaitForShaderCachePrefetch();
+    if (!m_Renderer.Init(rendererSpec))
+    {
+        // The renderer will do its own error logging.
+        return false;
+    }
+
+    if (!InitImGUI())
+    {
+        MP_ERROR("Failed to initialise ImGUI");
+        return false;
+    }
+
+    m_FrameLimiter.SetFrameRateCap(m_Specification.FrameRateCap);
 
+    return true;
+}
+
+RendererSpecification Application::MakeRendererSpecification()
+{
+    RendererSpecification spec = {.App = this};
+
+    // Shaders are cached next to the logs. --no-shader-cache compiles them every time, to compare startup times.
+    if (!m_Specification.Args.HasFlag("no-shader-cache"))
+    {
+        char* prefPath = SDL_GetPrefPath(m_Specification.Author.c_str(), m_Specification.Name.c_str());
+        if (prefPath)
+            spec.ShaderCacheDirectory = std::filesystem::path(prefPath) / "ShaderCache";
+        SDL_free(prefPath);
+    }
+    // --sync-shaders builds them on the GL thread, blocking, as they were before the background compiler.
+    spec.AsyncShaders = !m_Specification.Args.HasFlag("sync-shaders");
+
+    return spec;
+}
+
+void Application::BindWindowEvents()
+{
     // Bindings to window events.
     m_Window.OnWindowClose.BindMethod(this, &Application::OnWindowClosed);
 
@@ -77,30 +174,44 @@ bool Application::Initialise()
         Input::ProcessMouseMotionEvent(event);
         return false;
     });
+}
 
-    if (!m_Renderer.Init({.App = this}))
+void Application::Run()
+{
+    m_Running = true;
+
+    if (IsHeadless())
     {
-        // The renderer will do its own error logging.
-        return false;
+        RunHeadless();
+        return;
     }
 
-    if (!InitImGUI())
+    m_LoopStats.Reset();
+    RequestRedraw(ImGuiSettleFrames);
     {
-        MP_ERROR("Failed to initialise ImGUI");
-        return false;
+        STARTUP_SCOPE("Load editor state");
+        OnLoadEditorState.Execute();
     }
 
-    return true;
-}
-
-void Application::Run()
-{
-    m_Running = true;
+    // Startup isn't over until the first frame is on screen.
+    u32 firstFrameSpan = StartupTimeline::BeginSpan("First frame");
 
     while (m_Running)
     {
+        if (s_RestartMode == RestartMode::Soft)
+            SoftRestart();
+
         Input::PreUpdate();
-        m_Window.PollEvents();
+        // The adaptive loop only gets here once something has invalidated the UI. The continuous loop always does,
+        // and runs an idle frame if nothing has.
+        const bool invalidated = PumpEvents();
+        if (!invalidated && m_Specification.Loop == LoopMode::Adaptive)
+            continue;
+
+        m_JobSystem.ProcessMainThreadJobs();
+
+        m_FrameLimiter.BeginFrame();
+        const u64 frameStart = SDL_GetTicksNS();
 
         static s32 theInteger = 5;
         MP_CHECK(!Input::IsKeyDownThisFrame(Scancode::R),
@@ -114,49 +225,256 @@ void Application::Run()
         if (Input::IsKeyDownThisFrame(Scancode::Escape))
             Close();
 
+        StepCommands();
+        OnUpdate.Execute();
+
+        if (!invalidated && m_RenderedFirstFrame)
+        {
+            RenderIdleFrame(frameStart);
+            m_LoopStats.IdleMS += m_FrameLimiter.WaitForNextFrame();
+            continue;
+        }
+
+        m_Renderer.BeginFrame();
         BeginImGUI();
 
         OnDrawIMGui.Execute();
 
-        ImGui::Begin("App Settings");
-        ImGui::Checkbox("Should Restart", &s_ShouldRestart);
-        if (ImGui::BeginCombo("VSync", VSyncModeToString(m_Window.GetVSync())))
+        DrawAppSettings();
+
+        // ImGui animates the text caret, so keep ticking while a text field is active.
+        if (ImGui::GetIO().WantTextInput)
+            ScheduleRedraw(100);
+
+        ImGui::Render();
+
+        RenderFrame(frameStart);
+        FinishRestartMeasurement();
+
+        if (firstFrameSpan != StartupTimeline::InvalidSpan)
         {
-            if (ImGui::Selectable("Off", m_Window.GetVSync() == VSyncMode::Off))
-                m_Window.SetVSync(VSyncMode::Off);
-            if (ImGui::Selectable("On", m_Window.GetVSync() == VSyncMode::On))
-                m_Window.SetVSync(VSyncMode::On);
-            if (ImGui::Selectable("Adaptive", m_Window.GetVSync() == VSyncMode::Adaptive))
-                m_Window.SetVSync(VSyncMode::Adaptive);
-            ImGui::EndCombo();
+            StartupTimeline::EndSpan(firstFrameSpan);
+            StartupTimeline::Finish();
+            firstFrameSpan = StartupTimeline::InvalidSpan;
         }
-        ImGui::End();
 
-        ImGui::Render();
+        m_LoopStats.IdleMS += m_FrameLimiter.WaitForNextFrame();
+    }
 
-        m_Renderer.Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    if (m_LoopStats.IdleFrames > 0)
+    {
+        MP_INFO("{} idle frames ({}), {:.3f}ms CPU each vs {:.3f}ms for a rebuilt frame", m_LoopStats.IdleFrames,
+                IdleFrameModeToString(m_Specification.IdleFrames), m_LoopStats.AverageIdleFrameCPUMS,
+                m_LoopStats.AverageFrameCPUMS);
+    }
 
-        SDL_Window*   backupCurrentWindow  = SDL_GL_GetCurrentWindow();
-        SDL_GLContext backupCurrentContext = SDL_GL_GetCurrentContext();
+    OnUnloadEditorState.Execute();
+}
+
+void Application::SoftRestart()
+{
+    MP_INFO("Soft restarting {}", m_Specification.Name);
+    s_RestartMode      = RestartMode::None;
+    s_MeasuringRestart = RestartMode::Soft;
+    s_RestartTimer.Restart();
+
+    OnUnloadEditorState.Execute();
+
+    // Application-level state that a full restart would have reset. Everything else - SDL, the window, the GL context
+    // and everything on the GPU, ImGui and its font atlas, the job system's threads - is kept.
+    m_Commands.clear();
+    m_CommandStarted = false;
+    Input::Shutdown();
+    Input::Init();
+    m_LoopStats.Reset();
+    m_SkippedFrameRemainder = 0.0;
+
+    OnLoadEditorState.Execute();
+    RequestRedraw(ImGuiSettleFrames);
+}
+
+void Application::FinishRestartMeasurement()
+{
+    if (s_MeasuringRestart == RestartMode::None)
+        return;
+
+    s_LastRestartMS = s_RestartTimer.GetElapsedMilliseconds();
+    MP_INFO("{} restart took {:.2f}ms (teardown to first frame)", RestartModeToString(s_MeasuringRestart),
+            s_LastRestartMS);
+    s_MeasuringRestart = RestartMode::None;
+}
+
+void Application::RenderFrame(u64 frameStartNS, bool reuseDrawData)
+{
+    UpdateRenderThread();
+
+    if (m_RenderThread.IsRunning())
+    {
+        // Only the main viewport exists (see UpdateRenderThread()), so this just keeps ImGui's bookkeeping ticking.
+        if (!reuseDrawData)
+            ImGui::UpdatePlatformWindows();
+
+        // We measure CPU time before handing off, as the submit may block on a full frame queue.
+        RecordFrameCPUTime(frameStartNS, reuseDrawData);
+        m_RenderThread.Submit(ImGui::GetDrawData(), m_Renderer.GetQueue(), m_Window.GetSize(), frameStartNS);
+        return;
+    }
+
+    m_Renderer.Render(m_Window.GetSize(), m_Renderer.GetQueue());
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+    SDL_Window*   backupCurrentWindow  = SDL_GL_GetCurrentWindow();
+    SDL_GLContext backupCurrentContext = SDL_GL_GetCurrentContext();
+    // Platform windows can only be updated once per ImGui frame; a reused frame just renders them again.
+    if (!reuseDrawData)
         ImGui::UpdatePlatformWindows();
-        ImGui::RenderPlatformWindowsDefault();
-        SDL_GL_MakeCurrent(backupCurrentWindow, backupCurrentContext);
+    ImGui::RenderPlatformWindowsDefault();
+    SDL_GL_MakeCurrent(backupCurrentWindow, backupCurrentContext);
+
+    // We measure CPU time before the swap, as the swap may block on VSync.
+    RecordFrameCPUTime(frameStartNS, reuseDrawData);
 
-        m_Renderer.Present();
+    m_Renderer.Present();
+
+    if (reuseDrawData)
+        return;
+
+    const f64 latencyMS = static_cast<f64>(SDL_GetTicksNS() - frameStartNS) / static_cast<f64>(SDL_NS_PER_MS);
+    if (m_LoopStats.FramesRendered == 1)
+        m_LoopStats.AverageLatencyMS = latencyMS;
+    else
+        m_LoopStats.AverageLatencyMS += (latencyMS - m_LoopStats.AverageLatencyMS) * 0.05;
+    m_RenderedFirstFrame = true;
+}
+
+void Application::RenderIdleFrame(u64 frameStartNS)
+{
+    switch (m_Specification.IdleFrames)
+    {
+    case IdleFrameMode::Reuse:
+        // We haven't started a new ImGui frame, so the last frame's draw data is still valid.
+        RenderFrame(frameStartNS, true);
+        break;
+    case IdleFrameMode::Skip:
+        RecordFrameCPUTime(frameStartNS, true);
+        // Nothing's blocking on VSync, so pace ourselves as if we'd presented.
+        m_LoopStats.IdleMS += m_FrameLimiter.WaitForFrameTime(
+            static_cast<u64>(GetReferenceFrameTimeMS() * static_cast<f64>(SDL_NS_PER_MS)));
+        break;
+    default:
+        MP_ASSERT(false, "Idle frames shouldn't happen in {} mode", IdleFrameModeToString(m_Specification.IdleFrames));
+        break;
+    }
+}
+
+void Application::RecordFrameCPUTime(u64 frameStartNS, bool idleFrame)
+{
+    const f64 frameCPUMS = static_cast<f64>(SDL_GetTicksNS() - frameStartNS) / static_cast<f64>(SDL_NS_PER_MS);
+    if (idleFrame)
+    {
+        if (m_LoopStats.IdleFrames == 0)
+            m_LoopStats.AverageIdleFrameCPUMS = frameCPUMS;
+        else
+            m_LoopStats.AverageIdleFrameCPUMS += (frameCPUMS - m_LoopStats.AverageIdleFrameCPUMS) * 0.05;
+        m_LoopStats.IdleFrames++;
+        m_LoopStats.CPUTimeSavedMS += std::max(0.0, m_LoopStats.AverageFrameCPUMS - frameCPUMS);
+        return;
+    }
+
+    if (m_LoopStats.FramesRendered == 0)
+        m_LoopStats.AverageFrameCPUMS = frameCPUMS;
+    else
+        m_LoopStats.AverageFrameCPUMS += (frameCPUMS - m_LoopStats.AverageFrameCPUMS) * 0.05;
+    m_LoopStats.FramesRendered++;
+}
+
+void Application::UpdateRenderThread()
+{
+    // Secondary viewports get their own platform windows and GL contexts, which the backends create and render on the
+    // main thread - so we can only pipeline while everything is inside the main window. The first frame is always
+    // serial, as the ImGui backend creates its GL objects lazily in NewFrame().
+    const bool pipeline = m_Specification.PipelinedRendering && m_RenderedFirstFrame &&
+                          ImGui::GetPlatformIO().Viewports.Size <= 1;
+    if (pipeline == m_RenderThread.IsRunning())
+        return;
+
+    if (pipeline)
+    {
+        m_RenderThread.Start({.TargetWindow = &m_Window, .TargetRenderer = &m_Renderer});
+    }
+    else
+    {
+        if (m_Specification.PipelinedRendering)
+            MP_INFO("Falling back to serial rendering while there are multiple viewports");
+        m_RenderThread.Stop();
+    }
+}
+
+void Application::RunHeadless()
+{
+    OnLoadEditorState.Execute();
+    // There are no frames, so a restart (or startup) is done as soon as we're back up.
+    FinishRestartMeasurement();
+    StartupTimeline::Finish();
+
+    while (m_Running)
+    {
+        if (s_RestartMode == RestartMode::Soft)
+        {
+            SoftRestart();
+            FinishRestartMeasurement();
+        }
+
+        PumpHeadlessEvents();
+        m_JobSystem.ProcessMainThreadJobs();
+
+        StepCommands();
+        OnUpdate.Execute();
+        if (m_Renderer.IsHeadless())
+            m_Renderer.RenderOffscreen();
+
+        if (m_Commands.empty())
+        {
+            MP_INFO("All commands finished; exiting.");
+            Close();
+            // Nothing is left to do, so a vetoed close would just spin here.
+            if (m_Running)
+            {
+                MP_WARN("Closing was cancelled, but there's nothing left to run headless; exiting anyway.");
+                m_Running = false;
+            }
+        }
     }
+
+    OnUnloadEditorState.Execute();
 }
 
 void Application::Shutdown()
 {
     MP_INFO("Shutting down {}", m_Specification.Name);
 
+    if (ShouldRestart())
+    {
+        s_MeasuringRestart = RestartMode::Full;
+        s_RestartTimer.Restart();
+    }
+
+    // Finish with the workers first, so nothing is running against systems we're about to tear down.
+    m_JobSystem.Shutdown();
+
+    // Hands the GL context back to us.
+    m_RenderThread.Stop();
+
     m_Renderer.Shutdown();
 
-    ShutdownImGUI();
+    if (m_ImGUIInitialized)
+        ShutdownImGUI();
 
     Input::Shutdown();
 
+    // After ImGui, since the font atlas uses the embedded font data without copying it.
+    EmbeddedContent::Shutdown();
+
     if (m_Window.IsValid())
         m_Window.Destroy();
 
@@ -204,29 +522,387 @@ void Application::Close()
     m_Running = false;
 }
 
+void Application::RequestRedraw(u32 frames)
+{
+    // Only ever raise the pending frame count - a request for 1 frame shouldn't cancel a request for 3.
+    u32 current = m_RedrawFramesRequested.load();
+    while (current < frames && !m_RedrawFramesRequested.compare_exchange_weak(current, frames))
+    {
+    }
+
+    // If the main loop is blocked in SDL_WaitEventTimeout, push an event to wake it up.
+    // PumpEvents() sets m_WaitingForEvents before re-checking for pending redraws, so one of us always sees the other.
+    if (m_WaitingForEvents.load() && s_WakeEventType != 0)
+    {
+        SDL_Event wakeEvent = {};
+        wakeEvent.type      = s_WakeEventType;
+        SDL_PushEvent(&wakeEvent);
+    }
+}
+
+void Application::InvalidateUI(u32 frames)
+{
+    m_UIInvalidations.fetch_add(1, std::memory_order_relaxed);
+    RequestRedraw(frames);
+}
+
+void Application::ScheduleRedraw(u32 delayMS)
+{
+    const u64 deadline = SDL_GetTicksNS() + static_cast<u64>(delayMS) * SDL_NS_PER_MS;
+
+    // Keep the earliest deadline.
+    u64 current = m_ScheduledRedrawNS.load();
+    while ((current == 0 || deadline < current) && !m_ScheduledRedrawNS.compare_exchange_weak(current, deadline))
+    {
+    }
+
+    if (m_WaitingForEvents.load() && s_WakeEventType != 0)
+    {
+        // The waiting thread needs to recalculate its timeout.
+        SDL_Event wakeEvent = {};
+        wakeEvent.type      = s_WakeEventType;
+        SDL_PushEvent(&wakeEvent);
+    }
+}
+
+void Application::QueueCommand(ApplicationCommand command)
+{
+    MP_ASSERT(command.Step, "Command {} has no step function", command.Name);
+    m_Commands.push_back(std::move(command));
+    RequestRedraw();
+}
+
+void Application::StepCommands()
+{
+    if (m_Commands.empty())
+        return;
+
+    ApplicationCommand& command = m_Commands.front();
+    if (!m_CommandStarted)
+    {
+        MP_INFO("Running command: {}", command.Name);
+        m_CommandTimer.Restart();
+        m_CommandStarted = true;
+    }
+
+    if (command.Step())
+    {
+        MP_INFO("Command {} finished in {:.3f}ms", command.Name, m_CommandTimer.GetElapsedMilliseconds());
+        m_Commands.pop_front();
+        m_CommandStarted = false;
+    }
+
+    // Keep the loop ticking while there's work to do.
+    if (!m_Commands.empty())
+        RequestRedraw();
+}
+
+void Application::PumpHeadlessEvents()
+{
+    // Without a window, the only events we care about are quit requests (e.g. SIGINT/SIGTERM).
+    SDL_Event event;
+    while (SDL_PollEvent(&event))
+    {
+        if (event.type == SDL_EVENT_QUIT)
+            Close();
+    }
+}
+
+void Application::SetLoopMode(LoopMode mode)
+{
+    if (m_Specification.Loop == mode)
+        return;
+
+    MP_INFO("Switching main loop mode to {}", LoopModeToString(mode));
+    m_Specification.Loop = mode;
+    m_LoopStats.Reset();
+    m_SkippedFrameRemainder = 0.0;
+    RequestRedraw(ImGuiSettleFrames);
+}
+
+void Application::SetIdleFrameMode(IdleFrameMode mode)
+{
+    if (m_Specification.IdleFrames == mode)
+        return;
+
+    MP_INFO("Switching idle frame mode to {}", IdleFrameModeToString(mode));
+    m_Specification.IdleFrames = mode;
+    RequestRedraw(ImGuiSettleFrames);
+}
+
+void Application::SetFrameRateCap(u16 fps)
+{
+    m_Specification.FrameRateCap = fps;
+    m_FrameLimiter.SetFrameRateCap(fps);
+}
+
+void Application::SetVSync(VSyncMode vsync)
+{
+    // The swap interval is set on the current GL context, so take it back from the render thread first. The render
+    // thread will be restarted next frame.
+    m_RenderThread.Stop();
+    m_Window.SetVSync(vsync);
+}
+
+void Application::SetPipelinedRendering(bool pipelined)
+{
+    if (m_Specification.PipelinedRendering == pipelined)
+        return;
+
+    MP_INFO("{} pipelined rendering", pipelined ? "Enabling" : "Disabling");
+    m_Specification.PipelinedRendering = pipelined;
+    if (!pipelined)
+        m_RenderThread.Stop();
+    RequestRedraw(ImGuiSettleFrames);
+}
+
+bool Application::PumpEvents()
+{
+    if (m_Specification.Loop == LoopMode::Continuous)
+    {
+        const u32 eventCount = m_Window.PollEvents();
+        if (m_Specification.IdleFrames == IdleFrameMode::Rebuild)
+            return true;
+
+        if (eventCount > 0)
+            RequestRedraw(ImGuiSettleFrames);
+        return ConsumeRedrawRequest();
+    }
+
+    u32 eventCount = m_Window.PollEvents();
+    if (eventCount == 0)
+    {
+        m_WaitingForEvents = true;
+        if (!IsRedrawPending())
+        {
+            const u64 waitStart = SDL_GetTicksNS();
+            eventCount          = m_Window.WaitEvents(GetIdleWaitTimeoutMS());
+            RecordIdleTime(static_cast<f64>(SDL_GetTicksNS() - waitStart) / static_cast<f64>(SDL_NS_PER_MS));
+        }
+        m_WaitingForEvents = false;
+    }
+
+    if (eventCount > 0)
+        RequestRedraw(ImGuiSettleFrames);
+
+    return ConsumeRedrawRequest();
+}
+
+bool Application::ConsumeRedrawRequest()
+{
+    // Consume a scheduled redraw if its deadline has passed.
+    const u64 scheduled = m_ScheduledRedrawNS.load();
+    if (scheduled != 0 && SDL_GetTicksNS() >= scheduled)
+    {
+        u64 expected = scheduled;
+        if (m_ScheduledRedrawNS.compare_exchange_strong(expected, 0))
+            RequestRedraw(1);
+    }
+
+    // Consume one pending frame.
+    u32 pending = m_RedrawFramesRequested.load();
+    while (pending > 0 && !m_RedrawFramesRequested.compare_exchange_weak(pending, pending - 1))
+    {
+    }
+
+    return pending > 0;
+}
+
+bool Application::IsRedrawPending() const
+{
+    if (m_RedrawFramesRequested.load() > 0)
+        return true;
+
+    const u64 scheduled = m_ScheduledRedrawNS.load();
+    return scheduled != 0 && SDL_GetTicksNS() >= scheduled;
+}
+
+s32 Application::GetIdleWaitTimeoutMS() const
+{
+    const u64 scheduled = m_ScheduledRedrawNS.load();
+    if (scheduled == 0)
+        return MaxIdleWaitMS;
+
+    const u64 now = SDL_GetTicksNS();
+    if (scheduled <= now)
+        return 0;
+
+    // Round up, so we don't wake a fraction of a millisecond early and spin.
+    const u64 remainingMS = (scheduled - now + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS;
+    return static_cast<s32>(std::min<u64>(remainingMS, MaxIdleWaitMS));
+}
+
+f64 Application::GetReferenceFrameTimeMS() const
+{
+    // The frame rate we would have been rendering at if we weren't idle: the cap if there is one, otherwise the
+    // display refresh rate.
+    if (m_FrameLimiter.IsCapped())
+        return static_cast<f64>(m_FrameLimiter.GetTargetFrameTimeNS()) / static_cast<f64>(SDL_NS_PER_MS);
+
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(m_Window.GetSDLWindow()));
+    if (mode && mode->refresh_rate > 0.0f)
+        return 1000.0 / static_cast<f64>(mode->refresh_rate);
+
+    return 1000.0 / 60.0;
+}
+
+void Application::RecordIdleTime(f64 idleMS)
+{
+    m_LoopStats.IdleMS += idleMS;
+
+    m_SkippedFrameRemainder += idleMS / GetReferenceFrameTimeMS();
+    const u64 skipped       = static_cast<u64>(m_SkippedFrameRemainder);
+    m_SkippedFrameRemainder -= static_cast<f64>(skipped);
+
+    m_LoopStats.FramesSkipped  += skipped;
+    m_LoopStats.CPUTimeSavedMS += static_cast<f64>(skipped) * m_LoopStats.AverageFrameCPUMS;
+}
+
+void Application::DrawAppSettings()
+{
+    ImGui::Begin("App Settings");
+    bool fullRestart = ShouldRestart();
+    if (ImGui::Checkbox("Should Restart", &fullRestart))
+        RequestRestart(fullRestart ? RestartMode::Full : RestartMode::None);
+    ImGui::SameLine();
+    if (ImGui::Button("Soft Restart"))
+        RequestRestart(RestartMode::Soft);
+    if (s_LastRestartMS > 0.0)
+        ImGui::Text("Last restart: %.2fms", s_LastRestartMS);
+    if (ImGui::BeginCombo("VSync", VSyncModeToString(m_Window.GetVSync())))
+    {
+        if (ImGui::Selectable("Off", m_Window.GetVSync() == VSyncMode::Off))
+            SetVSync(VSyncMode::Off);
+        if (ImGui::Selectable("On", m_Window.GetVSync() == VSyncMode::On))
+            SetVSync(VSyncMode::On);
+        if (ImGui::Selectable("Adaptive", m_Window.GetVSync() == VSyncMode::Adaptive))
+            SetVSync(VSyncMode::Adaptive);
+        ImGui::EndCombo();
+    }
+
+    if (ImGui::BeginCombo("Loop Mode", LoopModeToString(m_Specification.Loop)))
+    {
+        if (ImGui::Selectable("Continuous", m_Specification.Loop == LoopMode::Continuous))
+            SetLoopMode(LoopMode::Continuous);
+        if (ImGui::Selectable("Adaptive", m_Specification.Loop == LoopMode::Adaptive))
+            SetLoopMode(LoopMode::Adaptive);
+        ImGui::EndCombo();
+    }
+
+    if (ImGui::BeginCombo("Idle Frames", IdleFrameModeToString(m_Specification.IdleFrames)))
+    {
+        for (const IdleFrameMode mode : {IdleFrameMode::Rebuild, IdleFrameMode::Reuse, IdleFrameMode::Skip})
+        {
+            if (ImGui::Selectable(IdleFrameModeToString(mode), m_Specification.IdleFrames == mode))
+                SetIdleFrameMode(mode);
+        }
+        ImGui::EndCombo();
+    }
+
+    s32 frameRateCap = m_Specification.FrameRateCap;
+    if (ImGui::SliderInt("Frame Rate Cap", &frameRateCap, 0, 360, frameRateCap == 0 ? "Uncapped" : "%d"))
+        SetFrameRateCap(static_cast<u16>(frameRateCap));
+
+    ImGui::Text("Frames rendered: %llu", static_cast<unsigned long long>(m_LoopStats.FramesRendered));
+    ImGui::Text("Frames skipped: %llu", static_cast<unsigned long long>(m_LoopStats.FramesSkipped));
+    ImGui::Text("Average frame CPU time: %.3fms", m_LoopStats.AverageFrameCPUMS);
+    ImGui::Text("Idle frames: %llu (%.3fms CPU each)", static_cast<unsigned long long>(m_LoopStats.IdleFrames),
+                m_LoopStats.AverageIdleFrameCPUMS);
+    ImGui::Text("UI invalidations: %llu", static_cast<unsigned long long>(m_UIInvalidations.load()));
+    ImGui::Text("Idle time: %.1fs", m_LoopStats.IdleMS / 1000.0);
+    ImGui::Text("CPU time saved: %.1fs", m_LoopStats.CPUTimeSavedMS / 1000.0);
+
+    bool pipelined = m_Specification.PipelinedRendering;
+    if (ImGui::Checkbox("Pipelined Rendering", &pipelined))
+        SetPipelinedRendering(pipelined);
+
+    if (m_RenderThread.IsRunning())
+    {
+        const RenderThreadStats renderStats = m_RenderThread.GetStats();
+        ImGui::Text("Latency: %.2fms (max %.2fms)", renderStats.AverageLatencyMS, renderStats.MaxLatencyMS);
+        ImGui::Text("Render thread time: %.3fms", renderStats.AverageRenderMS);
+        ImGui::Text("Submit wait: %.3fms", renderStats.AverageSubmitWaitMS);
+        ImGui::Text("Synchronous frames: %llu", static_cast<unsigned long long>(renderStats.SynchronousFrames));
+    }
+    else
+    {
+        ImGui::Text("Latency: %.2fms (serial)", m_LoopStats.AverageLatencyMS);
+    }
+
+    const RenderQueueStats queueStats = m_Renderer.GetLastFrameStats();
+    ImGui::Text("Render queue: %u draws, %u state changes (%u elided), %.3fms", queueStats.DrawCalls,
+                queueStats.State.GetTotalChanges(), queueStats.State.ElidedStateChanges, queueStats.ExecuteMS);
+    const StreamBufferStats streamStats = m_Renderer.GetStreamBufferStats();
+    ImGui::Text("Stream buffer: %.1f KB/frame (peak %.1f KB), %llu stalls (%.2fms)",
+                static_cast<f64>(streamStats.BytesThisFrame) / 1024.0,
+                static_cast<f64>(streamStats.PeakFrameBytes) / 1024.0,
+                static_cast<unsigned long long>(streamStats.Stalls), streamStats.StallMS);
+
+    const GPUResourceStats resourceStats = m_Renderer.GetGPUResourceStats();
+    u32                    liveResources = 0;
+    for (const u32 count : resourceStats.Live)
+        liveResources += count;
+    ImGui::Text("GPU resources: %u live, %u awaiting deletion, %llu deleted, %u overflows (%.2fms)", liveResources,
+                resourceStats.Deletions.Pending, static_cast<unsigned long long>(resourceStats.Deletions.Released),
+                resourceStats.Deletions.Overflows, resourceStats.Deletions.StallMS);
+
+    const ReadbackStats readbackStats = m_Renderer.GetReadbackStats();
+    ImGui::Text("Readbacks: %llu done, %u pending, %.1f frames latency, %u pixel buffers",
+                static_cast<unsigned long long>(readbackStats.Completed), readbackStats.Pending,
+                readbackStats.AverageWaitFrames, readbackStats.PixelBuffers);
+
+    const ShaderCacheStats shaderStats = m_Renderer.GetShaderCacheStats();
+    ImGui::Text("Shaders: %u from cache (%.2fms), %u compiled (%.2fms), %u rejected", shaderStats.Hits,
+                shaderStats.LoadMS, shaderStats.Compiled, shaderStats.CompileMS, shaderStats.Rejected);
+    const ShaderCompilerStats compilerStats = m_Renderer.GetShaderCompilerStats();
+    ImGui::Text("Shader compiler: %u built in the background (%.2fms), %u pending, %u failed%s",
+                compilerStats.Completed, compilerStats.BuildMS, compilerStats.Pending, compilerStats.Failed,
+                compilerStats.Parallel ? ", parallel" : "");
+
+    const EmbeddedContentStats embeddedStats = EmbeddedContent::GetStats();
+    ImGui::Text("Embedded content: %u/%u files loaded, %.1f KB resident (%.1f KB packed)", embeddedStats.LoadedFiles,
+                embeddedStats.FileCount, static_cast<f64>(embeddedStats.ResidentBytes) / 1024.0,
+                static_cast<f64>(embeddedStats.PackSize) / 1024.0);
+    ImGui::End();
+}
+
 void Application::ShowError(const std::string& message, const std::string& title) const
 {
     MP_ERROR("{}", message);
+    if (IsHeadless())
+        return; // Nobody's there to click the message box.
+
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.data(), message.data(), m_Window.GetSDLWindow());
 }
 
 bool Application::InitSDL() const
 {
-    if (!SDL_Init(SDL_INIT_VIDEO))
+    if (!SDL_Init(IsHeadless() ? SDL_INIT_EVENTS : SDL_INIT_VIDEO))
     {
         ShowError(fmt::format("Failed to initialise SDL: {}", SDL_GetError()), "SDL Error");
         return false;
     }
 
+    // Event type used to wake the main loop when it's blocked waiting for events (see RequestRedraw()).
+    s_WakeEventType = SDL_RegisterEvents(1);
+
     return true;
 }
 
 bool Application::InitImGUI()
 {
     MP_CHECK(!m_ImGUIInitialized, "ImGUI already initialized");
+    STARTUP_SCOPE("InitImGUI");
+
+    {
+        const StartupTimeline::Scope waitScope("Wait for font atlas");
+        m_JobSystem.Wait(m_FontAtlasJob);
+        StartupTimeline::AddDependency(waitScope.GetSpan(), m_FontAtlasSpan);
+    }
 
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    // The atlas is shared rather than owned by the context, so it's up to us to destroy it (see Shutdown()).
+    ImGui::CreateContext(m_FontAtlas);
 
     ImGuiIO& io    = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable | ImGuiConfigFlags_DockingEnable;
@@ -237,13 +913,6 @@ bool Application::InitImGUI()
              "Failed to init ImGUI SDL3 backend for OpenGL");
     MP_CHECK(ImGui_ImplOpenGL3_Init("#version 330"), "Failed to init ImGUI OpenGL3 backend");
 
-    // Add default fonts.
-    ImFontConfig config;
-    config.FontDataOwnedByAtlas = false;
-    s_OpenSansRegular = io.Fonts->AddFontFromMemoryTTF(OpenSans_Regular_ttf, static_cast<int>(OpenSans_Regular_ttf_len),
-                                                       16.0f, &config);
-    s_OpenSansBold = io.Fonts->AddFontFromMemoryTTF(OpenSans_Bold_ttf, static_cast<int>(OpenSans_Bold_ttf_len), 16.0f,
-                                                    &config);
     io.FontDefault = s_OpenSansRegular;
 
     m_ImGUIInitialized = true;
@@ -251,11 +920,43 @@ bool Application::InitImGUI()
     return true;
 }
 
+void Application::WaitForShaderCachePrefetch()
+{
+    const StartupTimeline::Scope waitScope("Wait for shader cache");
+    m_JobSystem.Wait(m_ShaderCachePrefetchJob);
+    StartupTimeline::AddDependency(waitScope.GetSpan(), m_ShaderCachePrefetchSpan);
+}
+
+void Application::LoadFontAtlas()
+{
+    const StartupTimeline::Scope scope("Load font atlas");
+    m_FontAtlasSpan = scope.GetSpan();
+
+    m_FontAtlas = IM_NEW(ImFontAtlas)();
+
+    // Add default fonts. The data belongs to EmbeddedContent, so the atlas mustn't free it.
+    ImFontConfig config;
+    config.FontDataOwnedByAtlas = false;
+    auto addFont = [&](const std::string_view path) -> ImFont*
+    {
+        const std::span<const u8> data = EmbeddedContent::Get(path);
+        if (data.empty())
+            return m_FontAtlas->AddFontDefault();
+        return m_FontAtlas->AddFontFromMemoryTTF(const_cast<u8*>(data.data()), static_cast<int>(data.size()), 16.0f,
+                                                 &config);
+    };
+    s_OpenSansRegular = addFont("Fonts/OpenSans-Regular.ttf");
+    s_OpenSansBold    = addFont("Fonts/OpenSans-Bold.ttf");
+}
+
 void Application::ShutdownImGUI()
 {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
 
+    IM_DELETE(m_FontAtlas);
+    m_FontAtlas = nullptr;
+
     m_ImGUIInitialized = false;
 }
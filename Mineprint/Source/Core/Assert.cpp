@@ -10,3 +10,9 @@ SDL_Window* GetAppWindow()
 
 	return app->GetWindow().GetSDLWindow();
 }
+
+bool IsAppHeadless()
+{
+	const Application* app = Application::Get();
+	return app && app->IsHeadless();
+}
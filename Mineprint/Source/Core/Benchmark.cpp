@@ -0,0 +1,67 @@
+#include "mppch.h"
+
+#include "Core/Benchmark.h"
+#include "Core/Application.h"
+
+static std::vector<BenchmarkInfo>& GetRegistry()
+{
+    // Function-local, so registration from static initialisers in other files doesn't depend on initialisation order.
+    static std::vector<BenchmarkInfo> registry;
+    return registry;
+}
+
+void Benchmarks::Register(const BenchmarkInfo& info)
+{
+    GetRegistry().push_back(info);
+}
+
+const std::vector<BenchmarkInfo>& Benchmarks::GetAll()
+{
+    return GetRegistry();
+}
+
+void Benchmarks::QueueFromCommandLine(Application& app)
+{
+    const CommandLine& args      = app.GetSpecification().Args;
+    const std::string  selection = args.GetValue("benchmark", "list");
+
+    if (selection == "list")
+    {
+        MP_INFO("Available benchmarks (run with --benchmark=<name>[,<name>...] or --benchmark=all):");
+        for (const BenchmarkInfo& info : GetAll())
+            MP_INFO("    {}: {}", info.Name, info.Description);
+        return;
+    }
+
+    std::vector<std::string> names;
+    std::stringstream        stream(selection);
+    std::string              name;
+    while (std::getline(stream, name, ','))
+    {
+        if (!name.empty())
+            names.push_back(name);
+    }
+
+    for (const BenchmarkInfo& info : GetAll())
+    {
+        const bool selected = selection == "all" || std::ranges::find(names, info.Name) != names.end();
+        if (!selected)
+            continue;
+
+        std::erase(names, info.Name);
+        app.QueueCommand({
+            .Name = fmt::format("Benchmark: {}", info.Name),
+            .Step = [&app, &args, function = info.Function]
+            {
+                function({.App = app, .Args = args});
+                return true;
+            }
+        });
+    }
+
+    for (const std::string& unknown : names)
+    {
+        MP_ERROR("Unknown benchmark: {}", unknown);
+        app.SetExitCode(1);
+    }
+}
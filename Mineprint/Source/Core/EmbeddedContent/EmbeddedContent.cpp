@@ -0,0 +1,267 @@
+#include "mppch.h"
+#include "Core/EmbeddedContent/EmbeddedContent.h"
+
+#include <stb_image.h>
+
+// Generated by the preprocessor next to the pack. It changes whenever the pack does, which is what makes this file
+// (and so the blob) get rebuilt. If the preprocessor hasn't run, we build without embedded content.
+#if __has_include(<EmbeddedContentPack.h>)
+#include <EmbeddedContentPack.h>
+#endif
+
+#ifndef MP_EMBEDDED_CONTENT_AVAILABLE
+#define MP_EMBEDDED_CONTENT_AVAILABLE 0
+#endif
+
+#if MP_EMBEDDED_CONTENT_AVAILABLE
+#ifdef MP_PLATFORM_WINDOWS
+// The pack is an RCDATA resource (see EmbeddedContent.rc), since MSVC has no equivalent of .incbin.
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+// The assembler finds the pack through the -Wa,-I include directory set up in premake5.lua.
+asm(R"(
+    .pushsection .rodata, "a"
+    .balign 16
+    .global MP_EmbeddedContentPack
+    .type MP_EmbeddedContentPack, @object
+MP_EmbeddedContentPack:
+    .incbin "EmbeddedContent.pack"
+    .global MP_EmbeddedContentPackEnd
+    .type MP_EmbeddedContentPackEnd, @object
+MP_EmbeddedContentPackEnd:
+    .byte 0
+    .popsection
+)");
+
+extern "C" const u8 MP_EmbeddedContentPack[];
+extern "C" const u8 MP_EmbeddedContentPackEnd[];
+#endif
+#endif
+
+const u8*                                      EmbeddedContent::s_Pack       = nullptr;
+const EmbeddedContent::PackEntry*              EmbeddedContent::s_Entries    = nullptr;
+u32                                            EmbeddedContent::s_EntryCount = 0;
+u64                                            EmbeddedContent::s_PackSize   = 0;
+std::unique_ptr<EmbeddedContent::LoadedFile[]> EmbeddedContent::s_Loaded;
+std::atomic<u32>                               EmbeddedContent::s_LoadedFiles   = 0;
+std::atomic<u64>                               EmbeddedContent::s_ResidentBytes = 0;
+std::atomic<u64>                               EmbeddedContent::s_DecompressUS  = 0;
+
+bool EmbeddedContent::Init()
+{
+    if (s_Pack)
+        return true;
+
+    const std::span<const u8> pack = GetPack();
+    if (pack.empty())
+    {
+        MP_WARN("No embedded content in this build; run the preprocessor to generate it");
+        return false;
+    }
+
+    // Nothing is installed from a bad pack, so every file just reads as missing.
+    if (reinterpret_cast<uintptr_t>(pack.data()) % alignof(PackEntry) != 0)
+    {
+        MP_ERROR("Embedded content is misaligned");
+        return false;
+    }
+    if (pack.size() < sizeof(PackHeader))
+    {
+        MP_ERROR("Embedded content is too small ({} bytes)", pack.size());
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const PackHeader*>(pack.data());
+    if (header->Magic != PackMagic)
+    {
+        MP_ERROR("Embedded content has the wrong magic number");
+        return false;
+    }
+    if (header->Version != PackVersion)
+    {
+        MP_ERROR("Embedded content is version {}, expected {}", header->Version, PackVersion);
+        return false;
+    }
+    if (sizeof(PackHeader) + static_cast<u64>(header->EntryCount) * sizeof(PackEntry) > pack.size())
+    {
+        MP_ERROR("Embedded content table of contents is truncated");
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const PackEntry*>(pack.data() + sizeof(PackHeader));
+    u64         totalSize = 0;
+    for (u32 i = 0; i < header->EntryCount; i++)
+    {
+        const PackEntry& entry = entries[i];
+        if (static_cast<u64>(entry.NameOffset) + entry.NameLength > pack.size() ||
+            static_cast<u64>(entry.DataOffset) + entry.StoredSize > pack.size())
+        {
+            MP_ERROR("Embedded content entry {} is out of bounds", i);
+            return false;
+        }
+        if (entry.Compression > static_cast<u32>(EmbeddedCompression::Zlib))
+        {
+            MP_ERROR("Embedded content entry {} has unknown compression {}", i, entry.Compression);
+            return false;
+        }
+        // Stored files are handed out in place, so their size has to be the size of what's stored.
+        if (static_cast<EmbeddedCompression>(entry.Compression) == EmbeddedCompression::None &&
+            entry.Size != entry.StoredSize)
+        {
+            MP_ERROR("Embedded content entry {} is stored as {} bytes but claims {}", i, entry.StoredSize, entry.Size);
+            return false;
+        }
+        totalSize += entry.Size;
+    }
+
+    s_Pack       = pack.data();
+    s_PackSize   = pack.size();
+    s_Entries    = entries;
+    s_EntryCount = header->EntryCount;
+    s_Loaded     = std::make_unique<LoadedFile[]>(s_EntryCount);
+
+    MP_INFO("Embedded content: {} files, {:.1f} KB packed ({:.1f} KB unpacked)", s_EntryCount,
+            static_cast<f64>(s_PackSize) / 1024.0, static_cast<f64>(totalSize) / 1024.0);
+    return true;
+}
+
+void EmbeddedContent::Shutdown()
+{
+    if (!s_Pack)
+        return;
+
+    for (u32 i = 0; i < s_EntryCount; i++)
+        s_Loaded[i].Data.Release();
+
+    s_Loaded.reset();
+    s_Pack       = nullptr;
+    s_PackSize   = 0;
+    s_Entries    = nullptr;
+    s_EntryCount = 0;
+    s_LoadedFiles.store(0);
+    s_ResidentBytes.store(0);
+    s_DecompressUS.store(0);
+}
+
+std::span<const u8> EmbeddedContent::Get(const std::string_view path)
+{
+    const PackEntry* entry = FindEntry(path);
+    if (!entry)
+    {
+        MP_ERROR("Embedded file {} does not exist", path);
+        return {};
+    }
+
+    return Load(static_cast<u32>(entry - s_Entries));
+}
+
+bool EmbeddedContent::Exists(const std::string_view path)
+{
+    return FindEntry(path) != nullptr;
+}
+
+std::vector<EmbeddedFileInfo> EmbeddedContent::List()
+{
+    std::vector<EmbeddedFileInfo> files;
+    files.reserve(s_EntryCount);
+    for (u32 i = 0; i < s_EntryCount; i++)
+    {
+        const PackEntry& entry       = s_Entries[i];
+        const auto       compression = static_cast<EmbeddedCompression>(entry.Compression);
+        files.push_back({
+            .Path        = {reinterpret_cast<const char*>(s_Pack + entry.NameOffset), entry.NameLength},
+            .Size        = entry.Size,
+            .StoredSize  = entry.StoredSize,
+            .Compression = compression,
+            .Loaded      = compression == EmbeddedCompression::None || s_Loaded[i].Loaded.load()
+        });
+    }
+
+    std::ranges::sort(files, {}, &EmbeddedFileInfo::Path);
+    return files;
+}
+
+EmbeddedContentStats EmbeddedContent::GetStats()
+{
+    EmbeddedContentStats stats;
+    stats.FileCount     = s_EntryCount;
+    stats.PackSize      = s_PackSize;
+    stats.LoadedFiles   = s_LoadedFiles.load();
+    stats.ResidentBytes = s_ResidentBytes.load();
+    stats.DecompressMS  = static_cast<f64>(s_DecompressUS.load()) / 1000.0;
+    for (u32 i = 0; i < s_EntryCount; i++)
+        stats.TotalSize += s_Entries[i].Size;
+    return stats;
+}
+
+std::span<const u8> EmbeddedContent::GetPack()
+{
+#if !MP_EMBEDDED_CONTENT_AVAILABLE
+    return {};
+#elif defined(MP_PLATFORM_WINDOWS)
+    HRSRC resource = FindResourceW(nullptr, L"MP_EMBEDDED_CONTENT", RT_RCDATA);
+    if (!resource)
+        return {};
+
+    HGLOBAL handle = LoadResource(nullptr, resource);
+    if (!handle)
+        return {};
+
+    return {static_cast<const u8*>(LockResource(handle)), SizeofResource(nullptr, resource)};
+#else
+    return {MP_EmbeddedContentPack, static_cast<size_t>(MP_EmbeddedContentPackEnd - MP_EmbeddedContentPack)};
+#endif
+}
+
+const EmbeddedContent::PackEntry* EmbeddedContent::FindEntry(const std::string_view path)
+{
+    const u64  hash  = HashPath(path);
+    const auto end   = s_Entries + s_EntryCount;
+    const auto entry = std::lower_bound(s_Entries, end, hash,
+                                        [](const PackEntry& e, const u64 h) { return e.NameHash < h; });
+    if (entry == end || entry->NameHash != hash)
+        return nullptr;
+
+    // The packer rejects hash collisions between files, but a path that isn't in the pack could still collide.
+    if (std::string_view(reinterpret_cast<const char*>(s_Pack + entry->NameOffset), entry->NameLength) != path)
+        return nullptr;
+
+    return entry;
+}
+
+std::span<const u8> EmbeddedContent::Load(const u32 index)
+{
+    const PackEntry& entry = s_Entries[index];
+    const u8*        data  = s_Pack + entry.DataOffset;
+    if (static_cast<EmbeddedCompression>(entry.Compression) == EmbeddedCompression::None)
+        return {data, entry.Size};
+
+    LoadedFile& file = s_Loaded[index];
+    std::call_once(file.Once, [&]
+    {
+        const std::string_view name(reinterpret_cast<const char*>(s_Pack + entry.NameOffset), entry.NameLength);
+        STARTUP_SCOPE(fmt::format("Decompress {}", name));
+        Stopwatch timer;
+
+        Buffer buffer(entry.Size);
+        const s32 size = stbi_zlib_decode_buffer(reinterpret_cast<char*>(buffer.Data), static_cast<s32>(entry.Size),
+                                                 reinterpret_cast<const char*>(data),
+                                                 static_cast<s32>(entry.StoredSize));
+        if (size != static_cast<s32>(entry.Size))
+        {
+            MP_ERROR("Failed to decompress embedded file {} (got {} bytes, expected {})", name, size, entry.Size);
+            buffer.Release();
+            return;
+        }
+
+        file.Data = std::move(buffer);
+        file.Loaded.store(true);
+        s_LoadedFiles.fetch_add(1);
+        s_ResidentBytes.fetch_add(entry.Size);
+        s_DecompressUS.fetch_add(timer.GetElapsedMicroseconds());
+    });
+
+    return {file.Data.Data, file.Data.Size};
+}
@@ -0,0 +1,419 @@
+#include "mppch.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+#include <SDL3/SDL_cpuinfo.h>
+
+thread_local JobSystem* JobSystem::t_System     = nullptr;
+thread_local u32        JobSystem::t_QueueIndex = JobSystem::InvalidIndex;
+thread_local u32        JobSystem::t_StealSeed  = 0;
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+bool JobSystem::Init(const JobSystemSpecification& spec)
+{
+    MP_ASSERT(!m_Initialised, "Job system already initialised");
+
+    m_Spec         = spec;
+    m_MainThreadID = std::this_thread::get_id();
+
+    u32 workerCount = 0;
+    if (m_Spec.WorkerCount < 0)
+        workerCount = static_cast<u32>(std::max(1, SDL_GetNumLogicalCPUCores() - 1));
+    else
+        workerCount = static_cast<u32>(m_Spec.WorkerCount);
+
+    m_Queues.reserve(workerCount + 1);
+    for (u32 i = 0; i < workerCount + 1; i++)
+        m_Queues.push_back(CreateScope<WorkStealingDeque<Job*>>());
+
+    // The main thread owns queue 0.
+    m_PreviousSystem     = t_System;
+    m_PreviousQueueIndex = t_QueueIndex;
+    t_System             = this;
+    t_QueueIndex         = 0;
+    t_StealSeed          = 0x9E3779B9u;
+
+    m_Running = true;
+    m_Workers.reserve(workerCount);
+    for (u32 i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+
+    m_Initialised = true;
+    MP_INFO("Initialised job system with {} worker threads", workerCount);
+
+    return true;
+}
+
+void JobSystem::Shutdown()
+{
+    if (!m_Initialised)
+        return;
+
+    MP_ASSERT(IsMainThread(), "Job system must be shut down from the main thread");
+
+    m_Running = false;
+    {
+        std::lock_guard lock(m_SleepMutex);
+    }
+    m_SleepCondition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+    m_Workers.clear();
+
+    // Anything still queued never ran; free it so we don't leak. Counters are left as-is, as nobody should be waiting.
+    // A queued coroutine is the innermost of a chain of tasks, each owned by the one awaiting it, so it's destroyed by
+    // destroying the chain's root: a spawned task. (The only other root is SyncWait(), which can't still be waiting.)
+    u32  droppedJobs       = 0;
+    u32  droppedCoroutines = 0;
+    Job* job               = nullptr;
+    auto discard           = [&](Job* dropped)
+    {
+        if (DiscardJob(dropped))
+            droppedJobs++;
+        else
+            droppedCoroutines++;
+    };
+    for (const auto& queue : m_Queues)
+    {
+        while (queue->Steal(job))
+            discard(job);
+    }
+    for (Job* injected : m_InjectionQueue)
+        discard(injected);
+    for (Job* mainThreadJob : m_MainThreadQueue)
+        discard(mainThreadJob);
+
+    std::unordered_set<void*> spawned;
+    {
+        std::lock_guard lock(m_SpawnedMutex);
+        spawned.swap(m_Spawned);
+    }
+    for (void* address : spawned)
+        std::coroutine_handle<>::from_address(address).destroy();
+
+    if (droppedJobs > 0 || droppedCoroutines > 0 || !spawned.empty())
+    {
+        MP_WARN("Job system shut down with {} jobs and {} coroutines still queued, and {} spawned tasks unfinished",
+                droppedJobs, droppedCoroutines, spawned.size());
+    }
+
+    m_InjectionQueue.clear();
+    m_MainThreadQueue.clear();
+    m_Queues.clear();
+    m_InjectedJobs = 0;
+    m_QueuedJobs   = 0;
+
+    if (t_System == this)
+    {
+        t_System     = m_PreviousSystem;
+        t_QueueIndex = m_PreviousQueueIndex;
+    }
+
+    m_Initialised = false;
+}
+
+void JobSystem::Schedule(JobFunction function, JobCounter* counter)
+{
+    MP_ASSERT(m_Initialised, "Job system must be initialised before scheduling jobs");
+
+    if (counter)
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+    Enqueue(new Job{.Function = std::move(function), .Counter = counter});
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, JobFunction function, JobCounter* counter)
+{
+    AddContinuation(dependency, std::move(function), counter, false);
+}
+
+void JobSystem::ScheduleOnMainThread(JobFunction function, JobCounter* counter)
+{
+    MP_ASSERT(m_Initialised, "Job system must be initialised before scheduling jobs");
+
+    if (counter)
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+    EnqueueMainThread(new Job{.Function = std::move(function), .Counter = counter});
+}
+
+void JobSystem::ScheduleOnMainThreadAfter(JobCounter& dependency, JobFunction function, JobCounter* counter)
+{
+    AddContinuation(dependency, std::move(function), counter, true);
+}
+
+void JobSystem::ScheduleResume(std::coroutine_handle<> handle)
+{
+    MP_ASSERT(m_Initialised, "Job system must be initialised before scheduling jobs");
+    Enqueue(TagCoroutine(handle));
+}
+
+void JobSystem::ScheduleResumeOnMainThread(std::coroutine_handle<> handle)
+{
+    MP_ASSERT(m_Initialised, "Job system must be initialised before scheduling jobs");
+    EnqueueMainThread(TagCoroutine(handle));
+}
+
+void JobSystem::TrackSpawned(const std::coroutine_handle<> handle)
+{
+    std::lock_guard lock(m_SpawnedMutex);
+    m_Spawned.insert(handle.address());
+}
+
+void JobSystem::ForgetSpawned(const std::coroutine_handle<> handle)
+{
+    std::lock_guard lock(m_SpawnedMutex);
+    m_Spawned.erase(handle.address());
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    WaitUntil([&counter] { return counter.IsDone(); });
+}
+
+u32 JobSystem::ProcessMainThreadJobs()
+{
+    MP_ASSERT(IsMainThread(), "Main-thread jobs must be processed on the main thread");
+
+    std::deque<Job*> jobs;
+    {
+        std::lock_guard lock(m_MainThreadMutex);
+        jobs.swap(m_MainThreadQueue);
+    }
+
+    // Jobs queued while we run these will be picked up next time, so a job that requeues itself can't starve the loop.
+    for (Job* job : jobs)
+        Execute(job);
+
+    return static_cast<u32>(jobs.size());
+}
+
+bool JobSystem::IsMainThread() const
+{
+    return std::this_thread::get_id() == m_MainThreadID;
+}
+
+bool JobSystem::IsOwnedThread() const
+{
+    return t_System == this && t_QueueIndex != InvalidIndex;
+}
+
+void JobSystem::WorkerLoop(u32 index)
+{
+    t_System     = this;
+    t_QueueIndex = index;
+    t_StealSeed  = 0x9E3779B9u * (index + 1);
+
+    u32 spins = 0;
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        if (Job* job = FindJob())
+        {
+            Execute(job);
+            spins = 0;
+            continue;
+        }
+
+        if (++spins < SpinsBeforeSleep)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Nothing to do for a while; sleep until more work is queued.
+        std::unique_lock lock(m_SleepMutex);
+        ++m_SleepingWorkers;
+        m_SleepCondition.wait(lock, [this]
+        {
+            return !m_Running.load() || m_QueuedJobs.load() > 0;
+        });
+        --m_SleepingWorkers;
+        spins = 0;
+    }
+
+    t_System     = nullptr;
+    t_QueueIndex = InvalidIndex;
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+    if (IsOwnedThread())
+    {
+        m_Queues[t_QueueIndex]->Push(job);
+    }
+    else
+    {
+        std::lock_guard lock(m_InjectionMutex);
+        m_InjectionQueue.push_back(job);
+        ++m_InjectedJobs;
+    }
+
+    ++m_QueuedJobs;
+    WakeWorkers();
+}
+
+void JobSystem::EnqueueMainThread(Job* job)
+{
+    {
+        std::lock_guard lock(m_MainThreadMutex);
+        m_MainThreadQueue.push_back(job);
+    }
+
+    if (m_Spec.OnMainThreadJobQueued)
+        m_Spec.OnMainThreadJobQueued();
+}
+
+JobSystem::Job* JobSystem::FindJob()
+{
+    const u32 ownIndex = IsOwnedThread() ? t_QueueIndex : InvalidIndex;
+    Job*      job      = nullptr;
+
+    // Our own queue first; it's the hottest in cache.
+    if (ownIndex != InvalidIndex && m_Queues[ownIndex]->Pop(job))
+    {
+        --m_QueuedJobs;
+        return job;
+    }
+
+    // Then work from outside threads.
+    if (m_InjectedJobs.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard lock(m_InjectionMutex);
+        if (!m_InjectionQueue.empty())
+        {
+            job = m_InjectionQueue.front();
+            m_InjectionQueue.pop_front();
+            --m_InjectedJobs;
+            --m_QueuedJobs;
+            return job;
+        }
+    }
+
+    // Then try to steal, starting at a random victim so thieves don't all pile onto the same queue.
+    u32& seed = t_StealSeed;
+    if (seed == 0)
+        seed = 0x2545F491u; // Threads we don't own start with no seed, and xorshift gets stuck on zero.
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    const u32 queueCount = static_cast<u32>(m_Queues.size());
+    const u32 start      = seed % queueCount;
+    for (u32 i = 0; i < queueCount; i++)
+    {
+        const u32 victim = (start + i) % queueCount;
+        if (victim == ownIndex)
+            continue;
+
+        if (m_Queues[victim]->Steal(job))
+        {
+            --m_QueuedJobs;
+            m_JobsStolen.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    if (IsCoroutine(job))
+    {
+        UntagCoroutine(job).resume();
+        m_JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    job->Function();
+    JobCounter* counter = job->Counter;
+    delete job;
+
+    m_JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+    FinishJob(counter);
+}
+
+bool JobSystem::DiscardJob(Job* job)
+{
+    if (IsCoroutine(job))
+        return false;
+
+    delete job;
+    return true;
+}
+
+void JobSystem::FinishJob(JobCounter* counter)
+{
+    if (!counter)
+        return;
+
+    // Fast path: we're not the last job, so nobody can be released by us and we don't need the lock.
+    u32 value = counter->m_Value.load(std::memory_order_relaxed);
+    while (value > 1)
+    {
+        if (counter->m_Value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+            return;
+    }
+
+    // We're probably the last job. Release the counter under the lock, so continuations can't be added in between,
+    // and so the counter can't be destroyed under us (see ~JobCounter()).
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard lock(counter->m_ContinuationMutex);
+        if (counter->m_Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(counter->m_Continuations);
+    }
+
+    for (JobCounter::Continuation& continuation : continuations)
+    {
+        // The continuation's own counter was incremented when it was added, so don't go through Schedule().
+        Job* job = new Job{.Function = std::move(continuation.Function), .Counter = continuation.Counter};
+        if (continuation.MainThread)
+            continuation.System->EnqueueMainThread(job);
+        else
+            continuation.System->Enqueue(job);
+    }
+}
+
+void JobSystem::WakeWorkers()
+{
+    if (m_SleepingWorkers.load() == 0)
+        return;
+
+    // Taking the lock makes sure a worker that's between checking its wait predicate and sleeping can't miss this.
+    {
+        std::lock_guard lock(m_SleepMutex);
+    }
+    m_SleepCondition.notify_one();
+}
+
+void JobSystem::AddContinuation(JobCounter& dependency, JobFunction function, JobCounter* counter, bool mainThread)
+{
+    MP_ASSERT(m_Initialised, "Job system must be initialised before scheduling jobs");
+
+    if (counter)
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard lock(dependency.m_ContinuationMutex);
+        if (!dependency.IsDone())
+        {
+            dependency.m_Continuations.push_back({
+                .System = this, .Function = std::move(function), .Counter = counter, .MainThread = mainThread
+            });
+            return;
+        }
+    }
+
+    // The dependency has already finished, so we can go straight onto a queue.
+    Job* job = new Job{.Function = std::move(function), .Counter = counter};
+    if (mainThread)
+        EnqueueMainThread(job);
+    else
+        Enqueue(job);
+}
@@ -0,0 +1,39 @@
+#include "mppch.h"
+
+#include "Core/Jobs/Task.h"
+#include "Core/Application.h"
+
+JobSystem& Async::GetDefaultJobSystem()
+{
+    MP_ASSERT(Application::Get(), "Tasks need an application (or an explicit job system)");
+    return Application::Get()->GetJobSystem();
+}
+
+Task<Buffer> Async::ReadFile(std::filesystem::path path, CancellationToken token)
+{
+    return ReadFile(GetDefaultJobSystem(), std::move(path), std::move(token));
+}
+
+Task<Buffer> Async::ReadFile(JobSystem& jobSystem, std::filesystem::path path, CancellationToken token)
+{
+    co_await SwitchToWorker(jobSystem, token);
+    // It may have been cancelled while it was queued.
+    co_await StopIfCancelled(token);
+    co_return FileUtil::ReadFileToBuffer(path);
+}
+
+void Async::Spawn(JobSystem& jobSystem, Task<> task)
+{
+    const TaskDetail::SpawnedTask spawned = RunSpawned(std::move(task));
+    spawned.Handle.promise().System       = &jobSystem;
+    jobSystem.TrackSpawned(spawned.Handle);
+    spawned.Handle.resume();
+}
+
+TaskDetail::SpawnedTask Async::RunSpawned(Task<> task)
+{
+    // Errors are the task's to log. (Not awaited in the if itself, which GCC 12 miscompiles.)
+    const bool finished = co_await task;
+    if (!finished)
+        MP_TRACE("Spawned task was cancelled");
+}
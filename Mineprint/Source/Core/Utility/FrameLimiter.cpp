@@ -0,0 +1,33 @@
+#include "mppch.h"
+
+#include "Core/Utility/FrameLimiter.h"
+
+void FrameLimiter::SetFrameRateCap(u16 fps)
+{
+    m_FrameRateCap      = fps;
+    m_TargetFrameTimeNS = fps > 0 ? SDL_NS_PER_SECOND / fps : 0;
+}
+
+void FrameLimiter::BeginFrame()
+{
+    m_FrameStartNS = SDL_GetTicksNS();
+}
+
+f64 FrameLimiter::WaitForNextFrame()
+{
+    if (!IsCapped())
+        return 0.0;
+
+    return WaitForFrameTime(m_TargetFrameTimeNS);
+}
+
+f64 FrameLimiter::WaitForFrameTime(u64 frameTimeNS)
+{
+    const u64 elapsed = SDL_GetTicksNS() - m_FrameStartNS;
+    if (elapsed >= frameTimeNS)
+        return 0.0;
+
+    const u64 remaining = frameTimeNS - elapsed;
+    SDL_DelayPrecise(remaining);
+    return static_cast<f64>(remaining) / static_cast<f64>(SDL_NS_PER_MS);
+}
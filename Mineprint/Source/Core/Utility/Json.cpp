@@ -0,0 +1,337 @@
+#include "mppch.h"
+
+#include "Core/Utility/Json.h"
+
+#include <charconv>
+
+// Recursive descent over the text, writing straight into the values. Strings are copied a run at a time between
+// escapes, so long ones (e.g. base64 images) don't go through the loop a character at a time.
+struct JsonValue::Parser
+{
+    std::string_view Text;
+    size_t           Position = 0;
+    std::string      Error;
+
+    bool Fail(const std::string_view message)
+    {
+        // Only worked out when something's wrong, so parsing doesn't have to track lines.
+        const size_t end    = std::min(Position, Text.size());
+        const size_t line   = std::count(Text.begin(), Text.begin() + static_cast<ptrdiff_t>(end), '\n') + 1;
+        const size_t start  = end == 0 ? std::string_view::npos : Text.rfind('\n', end - 1);
+        const size_t column = start == std::string_view::npos ? end + 1 : end - start;
+        Error               = fmt::format("{} (line {}, column {})", message, line, column);
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (Position < Text.size()
+               && (Text[Position] == ' ' || Text[Position] == '\n' || Text[Position] == '\r' || Text[Position] == '\t'))
+            Position++;
+    }
+
+    bool Expect(const std::string_view word)
+    {
+        if (Text.substr(Position, word.size()) != word)
+            return Fail("Unexpected character");
+        Position += word.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value, const u32 depth)
+    {
+        if (depth > MaxDepth)
+            return Fail("Too deeply nested");
+
+        SkipWhitespace();
+        if (Position >= Text.size())
+            return Fail("Unexpected end of document");
+
+        switch (Text[Position])
+        {
+        case '{':
+            value.m_Type = JsonType::Object;
+            return ParseObject(value, depth);
+        case '[':
+            value.m_Type = JsonType::Array;
+            return ParseArray(value, depth);
+        case '"':
+            value.m_Type = JsonType::String;
+            return ParseString(value.m_String);
+        case 't':
+            value.m_Type = JsonType::Bool;
+            value.m_Bool = true;
+            return Expect("true");
+        case 'f':
+            value.m_Type = JsonType::Bool;
+            value.m_Bool = false;
+            return Expect("false");
+        case 'n':
+            value.m_Type = JsonType::Null;
+            return Expect("null");
+        default:
+            value.m_Type = JsonType::Number;
+            return ParseNumber(value.m_Number);
+        }
+    }
+
+    bool ParseObject(JsonValue& value, const u32 depth)
+    {
+        Position++; // The '{'.
+        SkipWhitespace();
+        if (Position < Text.size() && Text[Position] == '}')
+        {
+            Position++;
+            return true;
+        }
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (Position >= Text.size() || Text[Position] != '"')
+                return Fail("Expected a key");
+            if (!ParseString(value.m_Keys.emplace_back()))
+                return false;
+
+            SkipWhitespace();
+            if (Position >= Text.size() || Text[Position] != ':')
+                return Fail("Expected ':'");
+            Position++;
+            if (!ParseValue(value.m_Elements.emplace_back(), depth + 1))
+                return false;
+
+            SkipWhitespace();
+            if (Position < Text.size() && Text[Position] == ',')
+            {
+                Position++;
+                continue;
+            }
+            if (Position < Text.size() && Text[Position] == '}')
+            {
+                Position++;
+                return true;
+            }
+            return Fail("Expected ',' or '}'");
+        }
+    }
+
+    bool ParseArray(JsonValue& value, const u32 depth)
+    {
+        Position++; // The '['.
+        SkipWhitespace();
+        if (Position < Text.size() && Text[Position] == ']')
+        {
+            Position++;
+            return true;
+        }
+
+        while (true)
+        {
+            if (!ParseValue(value.m_Elements.emplace_back(), depth + 1))
+                return false;
+
+            SkipWhitespace();
+            if (Position < Text.size() && Text[Position] == ',')
+            {
+                Position++;
+                continue;
+            }
+            if (Position < Text.size() && Text[Position] == ']')
+            {
+                Position++;
+                return true;
+            }
+            return Fail("Expected ',' or ']'");
+        }
+    }
+
+    bool ParseString(std::string& string)
+    {
+        Position++; // The opening quote.
+        while (true)
+        {
+            size_t end = Position;
+            while (end < Text.size() && Text[end] != '"' && Text[end] != '\\' && static_cast<u8>(Text[end]) >= 0x20)
+                end++;
+            string.append(Text.data() + Position, end - Position);
+            Position = end;
+
+            if (Position >= Text.size())
+                return Fail("Unterminated string");
+            if (Text[Position] == '"')
+            {
+                Position++;
+                return true;
+            }
+            if (Text[Position] != '\\')
+                return Fail("Control character in string");
+
+            Position++;
+            if (Position >= Text.size())
+                return Fail("Unterminated string");
+            switch (Text[Position++])
+            {
+            case '"':
+                string += '"';
+                break;
+            case '\\':
+                string += '\\';
+                break;
+            case '/':
+                string += '/';
+                break;
+            case 'b':
+                string += '\b';
+                break;
+            case 'f':
+                string += '\f';
+                break;
+            case 'n':
+                string += '\n';
+                break;
+            case 'r':
+                string += '\r';
+                break;
+            case 't':
+                string += '\t';
+                break;
+            case 'u':
+                if (!ParseCodePoint(string))
+                    return false;
+                break;
+            default:
+                Position--;
+                return Fail("Unknown escape in string");
+            }
+        }
+    }
+
+    bool ParseHex(u32& value)
+    {
+        if (Position + 4 > Text.size())
+            return Fail("Unterminated string");
+        const auto result = std::from_chars(Text.data() + Position, Text.data() + Position + 4, value, 16);
+        if (result.ec != std::errc() || result.ptr != Text.data() + Position + 4)
+            return Fail("Bad \\u escape in string");
+        Position += 4;
+        return true;
+    }
+
+    // After the "\u". Surrogate pairs are combined; unpaired surrogates become U+FFFD.
+    bool ParseCodePoint(std::string& string)
+    {
+        u32 codePoint;
+        if (!ParseHex(codePoint))
+            return false;
+
+        if (codePoint >= 0xD800 && codePoint < 0xDC00)
+        {
+            u32 low = 0;
+            if (Text.substr(Position, 2) == "\\u")
+            {
+                Position += 2;
+                if (!ParseHex(low))
+                    return false;
+            }
+            codePoint = low >= 0xDC00 && low < 0xE000 ? 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00)
+                                                      : 0xFFFD;
+        }
+        else if (codePoint >= 0xDC00 && codePoint < 0xE000)
+        {
+            codePoint = 0xFFFD;
+        }
+
+        if (codePoint < 0x80)
+        {
+            string += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            string += static_cast<char>(0xC0 | codePoint >> 6);
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            string += static_cast<char>(0xE0 | codePoint >> 12);
+            string += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            string += static_cast<char>(0xF0 | codePoint >> 18);
+            string += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+            string += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        return true;
+    }
+
+    bool ParseNumber(f64& number)
+    {
+        // from_chars also takes "inf" and "nan", which JSON doesn't.
+        const char first = Text[Position];
+        if (first != '-' && (first < '0' || first > '9'))
+            return Fail("Unexpected character");
+
+        const char* end    = Text.data() + Text.size();
+        const auto  result = std::from_chars(Text.data() + Position, end, number);
+        if (result.ec == std::errc::invalid_argument)
+            return Fail("Bad number");
+        // Out of range still parses the whole number; JSON has no limit, so it's just clamped.
+        if (result.ec == std::errc::result_out_of_range)
+            number = Text[Position] == '-' ? -std::numeric_limits<f64>::max() : std::numeric_limits<f64>::max();
+        Position = static_cast<size_t>(result.ptr - Text.data());
+        return true;
+    }
+};
+
+bool JsonValue::Parse(const std::string_view text, JsonValue& value, std::string& error)
+{
+    value = JsonValue();
+
+    Parser parser = {.Text = text};
+    // A UTF-8 byte order mark isn't valid JSON, but plenty of editors write one.
+    if (text.starts_with("\xEF\xBB\xBF"))
+        parser.Position = 3;
+
+    bool valid = parser.ParseValue(value, 0);
+    if (valid)
+    {
+        parser.SkipWhitespace();
+        if (parser.Position != text.size())
+            valid = parser.Fail("Unexpected text after the document");
+    }
+
+    if (!valid)
+    {
+        error = std::move(parser.Error);
+        value = JsonValue();
+    }
+    return valid;
+}
+
+const JsonValue& JsonValue::operator[](const std::string_view key) const
+{
+    static const JsonValue null;
+    const JsonValue*       value = Find(key);
+    return value ? *value : null;
+}
+
+const JsonValue& JsonValue::operator[](const size_t index) const
+{
+    static const JsonValue null;
+    return m_Type == JsonType::Array && index < m_Elements.size() ? m_Elements[index] : null;
+}
+
+const JsonValue* JsonValue::Find(const std::string_view key) const
+{
+    if (m_Type != JsonType::Object)
+        return nullptr;
+
+    for (size_t i = 0; i < m_Keys.size(); i++)
+    {
+        if (m_Keys[i] == key)
+            return &m_Elements[i];
+    }
+    return nullptr;
+}
@@ -0,0 +1,132 @@
+#include "mppch.h"
+
+#include "Core/Utility/MappedFile.h"
+
+#ifdef MP_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    Close();
+    m_Data = std::exchange(other.m_Data, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Open = std::exchange(other.m_Open, false);
+#ifdef MP_PLATFORM_WINDOWS
+    m_File    = std::exchange(other.m_File, nullptr);
+    m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+    return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef MP_PLATFORM_WINDOWS
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        MP_ERROR("Failed to open {} to map it (error {})", path.string(), GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        MP_ERROR("Failed to get the size of {} (error {})", path.string(), GetLastError());
+        CloseHandle(file);
+        return false;
+    }
+
+    // Empty files can't be mapped, but there's nothing to read anyway.
+    m_File = file;
+    m_Open = true;
+    if (size.QuadPart == 0)
+        return true;
+
+    m_Mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_Data    = m_Mapping ? static_cast<const u8*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!m_Data)
+    {
+        MP_ERROR("Failed to map {} (error {})", path.string(), GetLastError());
+        Close();
+        return false;
+    }
+    m_Size = static_cast<size_t>(size.QuadPart);
+#else
+    const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        MP_ERROR("Failed to open {} to map it: {}", path.string(), strerror(errno));
+        return false;
+    }
+
+    struct stat status = {};
+    if (fstat(file, &status) != 0)
+    {
+        MP_ERROR("Failed to get the size of {}: {}", path.string(), strerror(errno));
+        close(file);
+        return false;
+    }
+
+    // Empty files can't be mapped, but there's nothing to read anyway. The mapping outlives the descriptor.
+    m_Open = true;
+    if (status.st_size > 0)
+    {
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED)
+        {
+            MP_ERROR("Failed to map {}: {}", path.string(), strerror(errno));
+            close(file);
+            m_Open = false;
+            return false;
+        }
+        m_Data = static_cast<const u8*>(data);
+        m_Size = static_cast<size_t>(status.st_size);
+    }
+    close(file);
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef MP_PLATFORM_WINDOWS
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+    m_File    = nullptr;
+    m_Mapping = nullptr;
+#else
+    if (m_Data)
+        munmap(const_cast<u8*>(m_Data), m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
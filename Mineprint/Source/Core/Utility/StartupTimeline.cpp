@@ -0,0 +1,215 @@
+#include "mppch.h"
+
+#include "Core/Utility/StartupTimeline.h"
+
+std::mutex                         StartupTimeline::s_Mutex;
+std::vector<StartupTimeline::Span> StartupTimeline::s_Spans;
+std::vector<std::thread::id>       StartupTimeline::s_Threads;
+u64                                StartupTimeline::s_StartNS   = 0;
+bool                               StartupTimeline::s_Recording = false;
+
+static f64 NSToMS(u64 ns)
+{
+    return static_cast<f64>(ns) / static_cast<f64>(SDL_NS_PER_MS);
+}
+
+void StartupTimeline::Start()
+{
+    std::lock_guard lock(s_Mutex);
+    s_Spans.clear();
+    s_Threads.clear();
+    s_Threads.push_back(std::this_thread::get_id());
+    s_StartNS   = SDL_GetTicksNS();
+    s_Recording = true;
+}
+
+void StartupTimeline::Finish()
+{
+    std::lock_guard lock(s_Mutex);
+    if (!s_Recording)
+        return;
+
+    s_Recording = false;
+    PrintReport();
+}
+
+u32 StartupTimeline::BeginSpan(std::string_view name)
+{
+    std::lock_guard lock(s_Mutex);
+    if (!s_Recording)
+        return InvalidSpan;
+
+    s_Spans.push_back({
+        .Name    = std::string(name),
+        .Thread  = GetThreadIndex(),
+        .StartNS = SDL_GetTicksNS() - s_StartNS
+    });
+    return static_cast<u32>(s_Spans.size() - 1);
+}
+
+void StartupTimeline::EndSpan(u32 span)
+{
+    std::lock_guard lock(s_Mutex);
+    if (!s_Recording || span >= s_Spans.size())
+        return;
+
+    s_Spans[span].EndNS = SDL_GetTicksNS() - s_StartNS;
+}
+
+void StartupTimeline::AddDependency(u32 span, u32 dependency)
+{
+    std::lock_guard lock(s_Mutex);
+    if (!s_Recording || span >= s_Spans.size() || dependency >= s_Spans.size())
+        return;
+
+    s_Spans[span].Dependencies.push_back(dependency);
+}
+
+bool StartupTimeline::IsRecording()
+{
+    std::lock_guard lock(s_Mutex);
+    return s_Recording;
+}
+
+u32 StartupTimeline::GetThreadIndex()
+{
+    const std::thread::id id = std::this_thread::get_id();
+    for (u32 i = 0; i < s_Threads.size(); i++)
+    {
+        if (s_Threads[i] == id)
+            return i;
+    }
+
+    s_Threads.push_back(id);
+    return static_cast<u32>(s_Threads.size() - 1);
+}
+
+u32 StartupTimeline::GetTopLevelSpan(u32 span)
+{
+    // The outermost span on the same thread that contains this one. Spans on one thread nest properly (they're
+    // scopes), so that's just the earliest-starting container.
+    u32 topLevel = span;
+    for (u32 i = 0; i < s_Spans.size(); i++)
+    {
+        const Span& candidate = s_Spans[i];
+        const Span& current   = s_Spans[topLevel];
+        if (i == topLevel || candidate.Thread != current.Thread)
+            continue;
+
+        if (candidate.StartNS <= current.StartNS && candidate.EndNS >= current.EndNS && i < topLevel)
+            topLevel = i;
+    }
+
+    return topLevel;
+}
+
+void StartupTimeline::PrintReport()
+{
+    const u64 finishNS = SDL_GetTicksNS() - s_StartNS;
+    for (Span& span : s_Spans)
+    {
+        if (span.EndNS == 0)
+            span.EndNS = finishNS; // Never finished; treat it as running until now.
+    }
+
+    auto getThreadName = [](u32 thread)
+    {
+        return thread == 0 ? std::string("main") : fmt::format("thread {}", thread);
+    };
+
+    std::vector<u32> order(s_Spans.size());
+    for (u32 i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::ranges::stable_sort(order, [](u32 a, u32 b) { return s_Spans[a].StartNS < s_Spans[b].StartNS; });
+
+    MP_INFO("Startup timeline ({:.2f}ms):", NSToMS(finishNS));
+    MP_INFO("  {: >9} {: >9}  {: <9} {}", "Start", "Duration", "Thread", "Span");
+    for (const u32 index : order)
+    {
+        const Span& span = s_Spans[index];
+
+        // Nesting depth, for indentation.
+        u32 depth = 0;
+        for (const Span& other : s_Spans)
+        {
+            if (&other != &span && other.Thread == span.Thread && other.StartNS <= span.StartNS &&
+                other.EndNS >= span.EndNS)
+                depth++;
+        }
+
+        MP_INFO("  {: >7.2f}ms {: >7.2f}ms  {: <9} {: >{}}{}", NSToMS(span.StartNS), NSToMS(span.EndNS - span.StartNS),
+                getThreadName(span.Thread), "", depth * 2, span.Name);
+    }
+
+    // Walk back from whatever finished last. At each step, the span that held us up is whichever finished latest out
+    // of the previous span on the same thread, and anything this span (or something nested in it) waited on.
+    std::vector<u32> topLevel(s_Spans.size());
+    for (u32 i = 0; i < s_Spans.size(); i++)
+        topLevel[i] = GetTopLevelSpan(i);
+
+    u32 current = InvalidSpan;
+    for (u32 i = 0; i < s_Spans.size(); i++)
+    {
+        if (topLevel[i] == i && (current == InvalidSpan || s_Spans[i].EndNS > s_Spans[current].EndNS))
+            current = i;
+    }
+
+    std::vector<u32>  path;
+    std::vector<bool> visited(s_Spans.size(), false);
+    while (current != InvalidSpan && !visited[current])
+    {
+        visited[current] = true;
+        path.push_back(current);
+
+        const Span& span        = s_Spans[current];
+        u32         predecessor = InvalidSpan;
+        auto        consider    = [&](u32 candidate)
+        {
+            if (predecessor == InvalidSpan || s_Spans[candidate].EndNS > s_Spans[predecessor].EndNS)
+                predecessor = candidate;
+        };
+
+        for (u32 i = 0; i < s_Spans.size(); i++)
+        {
+            const bool sameThread = topLevel[i] == i && i != current && s_Spans[i].Thread == span.Thread;
+            if (sameThread && s_Spans[i].EndNS <= span.StartNS)
+                consider(i);
+
+            if (topLevel[i] != current)
+                continue;
+            for (const u32 dependency : s_Spans[i].Dependencies)
+            {
+                if (topLevel[dependency] != current)
+                    consider(topLevel[dependency]);
+            }
+        }
+
+        current = predecessor;
+    }
+    std::ranges::reverse(path);
+
+    // A span only adds the time after its predecessor finished - e.g. a wait overlaps the work it's waiting on.
+    u64 criticalNS  = 0;
+    u64 previousEnd = 0;
+    MP_INFO("Startup critical path:");
+    for (const u32 index : path)
+    {
+        const Span& span         = s_Spans[index];
+        const u64   contribution = span.EndNS - std::clamp(previousEnd, span.StartNS, span.EndNS);
+        criticalNS               += contribution;
+        previousEnd              = span.EndNS;
+        MP_INFO("  {: >7.2f}ms (of {:.2f}ms)  {} ({})", NSToMS(contribution), NSToMS(span.EndNS - span.StartNS),
+                span.Name, getThreadName(span.Thread));
+    }
+
+    u64 offPathNS = 0;
+    for (u32 i = 0; i < s_Spans.size(); i++)
+    {
+        if (topLevel[i] == i && std::ranges::find(path, i) == path.end())
+            offPathNS += s_Spans[i].EndNS - s_Spans[i].StartNS;
+    }
+
+    MP_INFO("Critical path: {:.2f}ms of {:.2f}ms ({:.2f}ms untracked). {:.2f}ms of work ran off the critical path.",
+            NSToMS(criticalNS), NSToMS(finishNS), NSToMS(finishNS > criticalNS ? finishNS - criticalNS : 0),
+            NSToMS(offPathNS));
+}
@@ -6,21 +6,37 @@
 
 int main(int argc, char* argv[])
 {
+	const CommandLine args(argc, argv);
+	s32               exitCode = 0;
+
+	const std::string   idleFrames    = args.GetValue("idle-frames", "rebuild");
+	const IdleFrameMode idleFrameMode = idleFrames == "reuse" ? IdleFrameMode::Reuse
+	                                    : idleFrames == "skip" ? IdleFrameMode::Skip
+	                                    : IdleFrameMode::Rebuild;
+
 	do
 	{
-		Application application({.Name = "Mineprint", .Author = "Mattie", .Version = SemVer(1, 0, 0)});
+		Application application({
+			.Name = "Mineprint", .Author = "Mattie", .Version = SemVer(1, 0, 0),
+			.IdleFrames = idleFrameMode,
+			.Args = args, .WorkerCount = static_cast<s32>(args.GetInt("workers", -1)),
+			.PipelinedRendering = args.HasFlag("pipelined-rendering"),
+			.Headless = args.HasFlag("headless") || args.HasFlag("headless-gl"),
+			.HeadlessGL = args.HasFlag("headless-gl")
+		});
 		if (application.Initialise())
 		{
 			application.Run();
+			exitCode = application.GetExitCode();
 			application.Shutdown();
 		}
 		else
 		{
-			Application::RequestRestart(false);
+			Application::RequestRestart(RestartMode::None);
 			return -1;
 		}
 	}
 	while (Application::ShouldRestart());
 
-	return 0;
+	return exitCode;
 }
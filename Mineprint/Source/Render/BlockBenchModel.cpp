@@ -0,0 +1,750 @@
+#include "mppch.h"
+
+#include "Render/BlockBenchModel.h"
+
+#include <fstream>
+
+#include <stb_image.h>
+
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Utility/Base64.h"
+#include "Core/Utility/Hash.h"
+#include "Core/Utility/Json.h"
+
+namespace
+{
+    // A cube face: BlockBench's name for it, and its corners as seen from outside (top left, bottom left, bottom
+    // right, top right, so counter-clockwise). Each corner's bits pick "to" over "from" on x (1), y (2) and z (4).
+    // The corners follow Minecraft's block model UV conventions, which BlockBench shares.
+    struct CubeFace
+    {
+        std::string_view  Name;
+        glm::vec3         Normal;
+        std::array<u8, 4> Corners;
+    };
+
+    constexpr std::array<CubeFace, 6> s_CubeFaces = {{
+        {"north", {0, 0, -1}, {3, 1, 0, 2}},
+        {"south", {0, 0, 1}, {6, 4, 5, 7}},
+        {"east", {1, 0, 0}, {7, 5, 1, 3}},
+        {"west", {-1, 0, 0}, {2, 0, 4, 6}},
+        {"up", {0, 1, 0}, {2, 6, 7, 3}},
+        {"down", {0, -1, 0}, {4, 0, 1, 5}}
+    }};
+
+    // Where an element (or group) sits: the transform from its own coordinates to the model's, and whether it's shown.
+    struct Placement
+    {
+        glm::mat4 Transform = glm::mat4(1.0f);
+        bool      Visible   = true;
+    };
+
+    glm::vec3 ReadVec3(const JsonValue& value, const glm::vec3& fallback = glm::vec3(0.0f))
+    {
+        if (!value.IsArray() || value.GetSize() < 3)
+            return fallback;
+        return {value[0].AsFloat(fallback.x), value[1].AsFloat(fallback.y), value[2].AsFloat(fallback.z)};
+    }
+
+    glm::mat4 Translation(const glm::vec3& offset)
+    {
+        glm::mat4 result = glm::mat4(1.0f);
+        result[3]        = glm::vec4(offset, 1.0f);
+        return result;
+    }
+
+    // Rotation about a pivot. Rotations are Euler angles in degrees, applied Z first, then Y, then X - which is what
+    // BlockBench uses (three.js's "ZYX" order). Older files give a single angle about one axis, with its own pivot.
+    glm::mat4 ReadRotation(const JsonValue& node, const glm::vec3& origin)
+    {
+        const JsonValue& rotation = node["rotation"];
+        if (rotation.IsObject())
+        {
+            const f32              angle = glm::radians(rotation["angle"].AsFloat());
+            const std::string_view axis  = rotation["axis"].AsString("y");
+            const glm::vec3        pivot = ReadVec3(rotation["origin"], origin);
+            const glm::mat4        turn  = axis == "x"   ? glm::eulerAngleX(angle)
+                                           : axis == "z" ? glm::eulerAngleZ(angle)
+                                                         : glm::eulerAngleY(angle);
+            return Translation(pivot) * turn * Translation(-pivot);
+        }
+
+        const glm::vec3 angles = glm::radians(ReadVec3(rotation));
+        if (angles == glm::vec3(0.0f))
+            return glm::mat4(1.0f);
+        return Translation(origin) * glm::eulerAngleZYX(angles.z, angles.y, angles.x) * Translation(-origin);
+    }
+
+    bool IsShown(const JsonValue& node)
+    {
+        return node["visibility"].AsBool(true) && node["export"].AsBool(true);
+    }
+
+    // Walks the outliner, placing every element under its groups. Groups are written inline in most versions; newer
+    // ones list them separately, with only their UUID and children in the outliner.
+    void PlaceElements(const JsonValue& children, const Placement& parent, const JsonValue& groups, const u32 depth,
+                       std::unordered_map<std::string_view, Placement>& placements)
+    {
+        if (depth > JsonValue::MaxDepth)
+            return;
+
+        for (const JsonValue& child : children.GetElements())
+        {
+            if (child.IsString())
+            {
+                placements[child.AsString()] = parent;
+                continue;
+            }
+            if (!child.IsObject())
+                continue;
+
+            const JsonValue* group = &child;
+            if (!child.Find("origin"))
+            {
+                for (const JsonValue& candidate : groups.GetElements())
+                {
+                    if (candidate["uuid"].AsString() == child["uuid"].AsString())
+                        group = &candidate;
+                }
+            }
+
+            const glm::vec3 origin = ReadVec3((*group)["origin"]);
+            Placement       placement;
+            placement.Transform = parent.Transform * ReadRotation(*group, origin);
+            placement.Visible   = parent.Visible && IsShown(*group);
+            PlaceElements(child["children"], placement, groups, depth + 1, placements);
+        }
+    }
+
+    // BlockBench doesn't keep a quad's vertices in order around it. Puts them in an order that isn't a bowtie: one
+    // where each diagonal has the other two vertices on opposite sides of it.
+    std::array<u32, 4> OrderQuad(const std::array<glm::vec3, 4>& positions)
+    {
+        auto opposite = [](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+        {
+            // Do b and d lie either side of the line through a and c?
+            return glm::dot(glm::cross(c - a, b - a), glm::cross(c - a, d - a)) < 0.0f;
+        };
+
+        constexpr std::array<std::array<u32, 4>, 3> orders = {{{0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}}};
+        for (const std::array<u32, 4>& order : orders)
+        {
+            const glm::vec3& a = positions[order[0]];
+            const glm::vec3& b = positions[order[1]];
+            const glm::vec3& c = positions[order[2]];
+            const glm::vec3& d = positions[order[3]];
+            if (opposite(a, b, c, d) && opposite(b, c, d, a))
+                return order;
+        }
+        return orders[0];
+    }
+
+    // A face's texture: an index into the textures, or (in some versions) a texture's UUID. -1 for none.
+    s32 FindTexture(const JsonValue& face, const JsonValue& textures)
+    {
+        const JsonValue& texture = face["texture"];
+        if (texture.IsNumber())
+            return static_cast<s32>(texture.AsNumber(-1.0));
+        if (texture.IsString())
+        {
+            const std::string_view uuid = texture.AsString();
+            for (size_t i = 0; i < textures.GetSize(); i++)
+            {
+                if (textures[i]["uuid"].AsString() == uuid || textures[i]["id"].AsString() == uuid)
+                    return static_cast<s32>(i);
+            }
+        }
+        return -1;
+    }
+}
+
+BlockBenchModel::~BlockBenchModel()
+{
+    Shutdown();
+}
+
+bool BlockBenchModel::Load(const BlockBenchModelSpecification& spec, const std::filesystem::path& path,
+                           JobSystem& jobs)
+{
+    Stopwatch timer;
+    Buffer    file = FileUtil::ReadBinaryFileToBuffer(path);
+    if (!file.Data)
+        return false;
+
+    const u64                   key       = GetCacheKey(spec, {file.Data, file.Size});
+    const f64                   readMS    = timer.GetElapsedMilliseconds();
+    const std::filesystem::path cachePath = spec.CacheDirectory.empty()
+                                                ? std::filesystem::path()
+                                                : spec.CacheDirectory / fmt::format("{:016X}.bbmesh", key);
+
+    timer.Restart();
+    if (!cachePath.empty() && LoadBaked(cachePath, key))
+    {
+        file.Release();
+        m_Quantize      = spec.Quantize;
+        m_Stats.ReadMS  = readMS;
+        m_Stats.CacheMS = timer.GetElapsedMilliseconds();
+        MP_INFO("Loaded the baked BlockBench model {} from the cache: {} vertices ({:.2f}ms)", path.string(),
+                m_Stats.Vertices, m_Stats.ReadMS + m_Stats.CacheMS);
+        return true;
+    }
+
+    const bool baked = Bake(spec, {reinterpret_cast<const char*>(file.Data), file.Size}, jobs, path.parent_path());
+    file.Release();
+    if (!baked)
+    {
+        MP_ERROR("Failed to load BlockBench model {}", path.string());
+        return false;
+    }
+    if (m_Name.empty())
+        m_Name = path.stem().string();
+    m_Stats.ReadMS = readMS;
+
+    if (!cachePath.empty())
+    {
+        timer.Restart();
+        std::error_code error;
+        std::filesystem::create_directories(spec.CacheDirectory, error);
+        if (!error && SaveBaked(cachePath, key))
+            m_Stats.CacheMS = timer.GetElapsedMilliseconds();
+    }
+    return true;
+}
+
+bool BlockBenchModel::Bake(const BlockBenchModelSpecification& spec, const std::string_view json, JobSystem& jobs,
+                           const std::filesystem::path& folder)
+{
+    Clear();
+    m_Quantize = spec.Quantize;
+
+    Stopwatch   timer;
+    JsonValue   root;
+    std::string error;
+    if (!JsonValue::Parse(json, root, error))
+    {
+        MP_ERROR("BlockBench model isn't valid JSON: {}", error);
+        return false;
+    }
+    if (!root["elements"].IsArray())
+    {
+        MP_ERROR("BlockBench model has no elements");
+        return false;
+    }
+    m_Stats.ParseMS = timer.GetElapsedMilliseconds();
+
+    std::vector<FaceTexture> textures;
+    if (!LoadTextures(spec, root, folder, jobs, textures))
+        return false;
+
+    timer.Restart();
+    m_Name = root["name"].AsString();
+
+    std::unordered_map<std::string_view, Placement> placements;
+    PlaceElements(root["outliner"], {}, root["groups"], 0, placements);
+
+    // Indices are gathered per atlas layer, then laid out one layer after another, a submesh each.
+    std::vector<std::vector<u32>> layerIndices(std::max(m_Atlas.GetLayerCount(), 1u));
+    auto addFace = [&](const std::span<const glm::vec3> positions, const std::span<const glm::vec2> uvs,
+                       const glm::vec3& normal, const FaceTexture& texture)
+    {
+        const u32 first = static_cast<u32>(m_Vertices.size());
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            const glm::vec2 uv = glm::mix(texture.Region->UVMin, texture.Region->UVMax, uvs[i] / texture.UVSize);
+            m_Vertices.push_back({positions[i] * spec.Scale, normal, uv});
+        }
+
+        std::vector<u32>& indices = layerIndices[texture.Region->Layer];
+        for (u32 i = 2; i < positions.size(); i++)
+            indices.insert(indices.end(), {first, first + i - 1, first + i});
+        m_Stats.Faces++;
+    };
+
+    const JsonValue& textureList = root["textures"];
+    auto             getTexture  = [&](const JsonValue& face) -> const FaceTexture*
+    {
+        const s32 index = FindTexture(face, textureList);
+        if (index < 0 || index >= static_cast<s32>(textures.size()) || !textures[index].Region)
+            return nullptr;
+        return &textures[index];
+    };
+
+    for (const JsonValue& element : root["elements"].GetElements())
+    {
+        const auto      found     = placements.find(element["uuid"].AsString());
+        const Placement placement = found != placements.end() ? found->second : Placement();
+        if (spec.SkipHidden && (!placement.Visible || !IsShown(element)))
+        {
+            m_Stats.Skipped++;
+            continue;
+        }
+
+        const std::string_view type   = element["type"].AsString("cube");
+        const glm::vec3        origin = ReadVec3(element["origin"]);
+        const JsonValue&       faces  = element["faces"];
+        if (type == "cube")
+        {
+            m_Stats.Cubes++;
+            const glm::mat4 transform = placement.Transform * ReadRotation(element, origin);
+            const glm::mat3 rotation  = glm::mat3(transform);
+            const f32       inflate   = element["inflate"].AsFloat();
+            const glm::vec3 from      = ReadVec3(element["from"]) - inflate;
+            const glm::vec3 to        = ReadVec3(element["to"]) + inflate;
+
+            for (const CubeFace& cubeFace : s_CubeFaces)
+            {
+                const JsonValue&   face    = faces[cubeFace.Name];
+                const FaceTexture* texture = getTexture(face);
+                if (!texture)
+                    continue;
+
+                std::array<glm::vec3, 4> positions;
+                for (size_t i = 0; i < 4; i++)
+                {
+                    const u8        corner = cubeFace.Corners[i];
+                    const glm::vec3 local  = {
+                        corner & 1 ? to.x : from.x, corner & 2 ? to.y : from.y, corner & 4 ? to.z : from.z
+                    };
+                    positions[i] = glm::vec3(transform * glm::vec4(local, 1.0f));
+                }
+                // Flat cubes (planes) have faces with no area along their thin side.
+                const glm::vec3 area = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                if (glm::dot(area, area) == 0.0f)
+                    continue;
+
+                // The texture's corners, clockwise from its top left. A face rotated by 90 degrees shows the
+                // texture turned clockwise, so each corner takes the UV from the one before it.
+                const JsonValue&               uv      = face["uv"];
+                const glm::vec2                uvMin   = {uv[0].AsFloat(), uv[1].AsFloat()};
+                const glm::vec2                uvMax   = {uv[2].AsFloat(), uv[3].AsFloat()};
+                const std::array<glm::vec2, 4> corners = {
+                    uvMin, glm::vec2(uvMax.x, uvMin.y), uvMax, glm::vec2(uvMin.x, uvMax.y)
+                };
+                const u32 turns = static_cast<u32>(std::lround(face["rotation"].AsFloat() / 90.0f)) & 3;
+
+                // Our corners go top left, bottom left, bottom right, top right: 0, 3, 2, 1 clockwise.
+                constexpr std::array<u32, 4> clockwise = {0, 3, 2, 1};
+                std::array<glm::vec2, 4>     uvs;
+                for (size_t i = 0; i < 4; i++)
+                    uvs[i] = corners[(clockwise[i] + 4 - turns) & 3];
+
+                addFace(positions, uvs, glm::normalize(rotation * cubeFace.Normal), *texture);
+            }
+        }
+        else if (type == "mesh")
+        {
+            // Mesh vertices are relative to the element's origin, and it rotates about that.
+            m_Stats.Meshes++;
+            const glm::mat4  transform = placement.Transform * Translation(origin) * ReadRotation(element, {});
+            const JsonValue& vertices  = element["vertices"];
+
+            for (const JsonValue& face : faces.GetElements())
+            {
+                const FaceTexture* texture = getTexture(face);
+                const JsonValue&   keys    = face["vertices"];
+                if (!texture || keys.GetSize() < 3 || keys.GetSize() > 4)
+                    continue;
+
+                const u32                count = static_cast<u32>(keys.GetSize());
+                std::array<glm::vec3, 4> positions;
+                std::array<glm::vec2, 4> uvs;
+                for (u32 i = 0; i < count; i++)
+                {
+                    const std::string_view key      = keys[i].AsString();
+                    const JsonValue&       uv       = face["uv"][key];
+                    const glm::vec3        position = ReadVec3(vertices[key]);
+                    positions[i]                    = glm::vec3(transform * glm::vec4(position, 1.0f));
+                    uvs[i]                          = {uv[0].AsFloat(), uv[1].AsFloat()};
+                }
+
+                if (count == 4)
+                {
+                    const std::array<u32, 4>       order   = OrderQuad(positions);
+                    const std::array<glm::vec3, 4> quad    = positions;
+                    const std::array<glm::vec2, 4> quadUVs = uvs;
+                    for (u32 i = 0; i < 4; i++)
+                    {
+                        positions[i] = quad[order[i]];
+                        uvs[i]       = quadUVs[order[i]];
+                    }
+                }
+
+                // Faces are flat shaded, as BlockBench draws them.
+                const glm::vec3 normal = count == 4
+                                             ? glm::cross(positions[2] - positions[0], positions[3] - positions[1])
+                                             : glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                if (glm::dot(normal, normal) == 0.0f)
+                    continue;
+                addFace(std::span(positions).first(count), std::span(uvs).first(count), glm::normalize(normal),
+                        *texture);
+            }
+        }
+        else
+        {
+            m_Stats.Skipped++;
+        }
+    }
+
+    for (u32 layer = 0; layer < layerIndices.size(); layer++)
+    {
+        if (layerIndices[layer].empty())
+            continue;
+        m_SubMeshes.push_back({
+            .FirstIndex    = static_cast<u32>(m_Indices.size()),
+            .IndexCount    = static_cast<u32>(layerIndices[layer].size()),
+            .MaterialIndex = layer
+        });
+        m_Indices.insert(m_Indices.end(), layerIndices[layer].begin(), layerIndices[layer].end());
+    }
+
+    if (m_Vertices.empty())
+    {
+        MP_ERROR("BlockBench model has no visible, textured faces");
+        Clear();
+        return false;
+    }
+
+    // Faces don't share vertices, so the triangle order gains little. The vertex order does: faces were baked in
+    // element order, but are drawn a texture layer at a time.
+    if (spec.Optimize)
+        m_Stats.Optimization = MeshOptimizer::Optimize({}, m_Vertices, m_Indices, m_SubMeshes);
+
+    m_BoundsMin = m_BoundsMax = m_Vertices[0].Position;
+    for (const MeshVertex& vertex : m_Vertices)
+    {
+        m_BoundsMin = glm::min(m_BoundsMin, vertex.Position);
+        m_BoundsMax = glm::max(m_BoundsMax, vertex.Position);
+    }
+
+    m_Stats.Vertices = static_cast<u32>(m_Vertices.size());
+    m_Stats.Indices  = static_cast<u32>(m_Indices.size());
+
+    // Built from the optimised mesh, so they share its vertex order; their indices go on the end.
+    if (spec.LODs.MaxLODs > 0)
+        m_LODs = MeshSimplifier::BuildLODs(spec.LODs, m_Vertices, m_Indices, m_SubMeshes, &m_Stats.Simplification);
+    m_Stats.BakeMS += timer.GetElapsedMilliseconds();
+    MP_INFO("Baked BlockBench model '{}': {} cubes, {} meshes, {} faces, {} textures ({:.2f}ms)", m_Name,
+            m_Stats.Cubes, m_Stats.Meshes, m_Stats.Faces, m_Stats.Textures,
+            m_Stats.ParseMS + m_Stats.DecodeMS + m_Stats.BakeMS);
+    if (spec.Optimize)
+    {
+        const MeshOptimizationStats& optimization = m_Stats.Optimization;
+        MP_INFO("   Optimised for the GPU: {:.2f} -> {:.2f} vertices transformed per triangle, {:.1f}KB -> {:.1f}KB of "
+                "vertices fetched per draw ({:.2f}ms)", optimization.ACMRBefore, optimization.ACMRAfter,
+                static_cast<f64>(optimization.FetchedBytesBefore) / 1024.0,
+                static_cast<f64>(optimization.FetchedBytesAfter) / 1024.0, optimization.OptimizeMS);
+    }
+    if (!m_LODs.empty())
+    {
+        std::string triangles;
+        for (const MeshLOD& lod : m_LODs)
+        {
+            u32 indices = 0;
+            for (const SubMesh& subMesh : lod.SubMeshes)
+                indices += subMesh.IndexCount;
+            triangles += fmt::format(" -> {}", indices / 3);
+        }
+        MP_INFO("   LODs: {}{} triangles, error {:.4f} at the coarsest ({:.2f}ms)", m_Stats.Indices / 3, triangles,
+                m_LODs.back().Error, m_Stats.Simplification.SimplifyMS);
+    }
+    return true;
+}
+
+bool BlockBenchModel::LoadTextures(const BlockBenchModelSpecification& spec, const JsonValue& root,
+                                   const std::filesystem::path& folder, JobSystem& jobs,
+                                   std::vector<FaceTexture>& textures)
+{
+    // UVs are in the project's resolution, unless a texture has its own (newer versions).
+    const JsonValue& textureList = root["textures"];
+    const glm::vec2  resolution  = {
+        root["resolution"]["width"].AsFloat(16.0f), root["resolution"]["height"].AsFloat(16.0f)
+    };
+
+    Stopwatch               timer;
+    std::vector<AtlasImage> images(textureList.GetSize());
+    jobs.ParallelFor(0, static_cast<u32>(images.size()), [&](const u32 begin, const u32 end)
+    {
+        std::vector<u8> bytes;
+        for (u32 i = begin; i < end; i++)
+        {
+            const JsonValue&       texture = textureList[i];
+            const std::string_view source  = texture["source"].AsString();
+            const std::string_view name    = texture["name"].AsString("unnamed");
+
+            // Embedded as a data URI, or (in files saved without them) a path to the image.
+            bool read = false;
+            if (const size_t comma = source.find(','); source.starts_with("data:") && comma != std::string_view::npos)
+            {
+                read = Base64::Decode(source.substr(comma + 1), bytes);
+            }
+            else
+            {
+                std::filesystem::path path = folder / texture["relative_path"].AsString();
+                std::error_code       error;
+                if (texture["relative_path"].IsNull() || !std::filesystem::is_regular_file(path, error))
+                    path = std::filesystem::path(texture["path"].AsString());
+                if (std::filesystem::is_regular_file(path, error))
+                {
+                    Buffer file = FileUtil::ReadBinaryFileToBuffer(path);
+                    bytes.assign(file.Data, file.Data + file.Size);
+                    file.Release();
+                    read = !bytes.empty();
+                }
+            }
+
+            // Left empty, so the atlas skips it.
+            images[i].Location    = std::to_string(i);
+            images[i].SplitFrames = false;
+            s32 width, height, channels;
+            u8* pixels = read
+                             ? stbi_load_from_memory(bytes.data(), static_cast<s32>(bytes.size()), &width, &height,
+                                                     &channels, 4)
+                             : nullptr;
+            if (!pixels)
+            {
+                MP_WARN("Failed to load BlockBench texture '{}': {}", name,
+                        read ? stbi_failure_reason() : "it isn't embedded, and the file wasn't found");
+                continue;
+            }
+            images[i].Width  = static_cast<u32>(width);
+            images[i].Height = static_cast<u32>(height);
+            images[i].Pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pixels);
+        }
+    }, 1);
+    m_Stats.DecodeMS = timer.GetElapsedMilliseconds();
+
+    timer.Restart();
+    textures.assign(images.size(), {});
+    const bool anyImages = std::ranges::any_of(images, [](const AtlasImage& image) { return image.Width > 0; });
+    if (anyImages && !m_Atlas.Build(spec.Atlas, images, jobs))
+        return false;
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        const JsonValue& texture = textureList[i];
+        textures[i].UVSize       = {
+            texture["uv_width"].AsFloat(resolution.x), texture["uv_height"].AsFloat(resolution.y)
+        };
+
+        const AtlasSprite* sprite = anyImages ? m_Atlas.Find(images[i].Location) : nullptr;
+        if (!sprite)
+            continue;
+        textures[i].Region = &m_Atlas.GetFrames(*sprite)[0];
+        m_Stats.Textures++;
+
+        // An animated texture is a strip of frames, each the shape of its UVs. Faces show the first.
+        const glm::vec2 size   = glm::vec2(images[i].Width, images[i].Height);
+        const f32       frames = std::round(size.y * textures[i].UVSize.x / (size.x * textures[i].UVSize.y));
+        textures[i].UVSize.y   *= std::max(frames, 1.0f);
+    }
+    m_Stats.BakeMS = timer.GetElapsedMilliseconds();
+    return true;
+}
+
+u64 BlockBenchModel::GetCacheKey(const BlockBenchModelSpecification& spec, const std::span<const u8> contents)
+{
+    const TextureAtlasSpecification&   atlas = spec.Atlas;
+    const MeshSimplifierSpecification& lods  = spec.LODs;
+
+    constexpr u16 versions[] = {Version, TextureAtlas::Version};
+    u64           key        = Hash::Bytes(Hash::Offset, versions, sizeof(versions));
+    key                      = Hash::Bytes(key, &spec.Scale, sizeof(spec.Scale));
+    key                      = Hash::Bytes(key, &spec.SkipHidden, sizeof(spec.SkipHidden));
+    key                      = Hash::Bytes(key, &spec.Optimize, sizeof(spec.Optimize));
+    key                      = Hash::Bytes(key, &atlas.MinPageSize, sizeof(atlas.MinPageSize));
+    key                      = Hash::Bytes(key, &atlas.MaxPageSize, sizeof(atlas.MaxPageSize));
+    key                      = Hash::Bytes(key, &atlas.MipLevels, sizeof(atlas.MipLevels));
+    key                      = Hash::Bytes(key, &atlas.Padding, sizeof(atlas.Padding));
+    key                      = Hash::Bytes(key, &lods.MaxLODs, sizeof(lods.MaxLODs));
+    key                      = Hash::Bytes(key, &lods.Ratio, sizeof(lods.Ratio));
+    key                      = Hash::Bytes(key, &lods.MaxError, sizeof(lods.MaxError));
+    key                      = Hash::Bytes(key, &lods.MinReduction, sizeof(lods.MinReduction));
+    key                      = Hash::Bytes(key, &lods.BorderWeight, sizeof(lods.BorderWeight));
+    key                      = Hash::Bytes(key, &lods.OptimizeVertexCache, sizeof(lods.OptimizeVertexCache));
+    return Hash::Bytes(key, contents.data(), contents.size());
+}
+
+bool BlockBenchModel::SaveBaked(const std::filesystem::path& path, const u64 key) const
+{
+    if (!IsBaked() || m_Vertices.empty() || !m_Atlas.IsBuilt())
+    {
+        MP_ERROR("Can't save a BlockBench model that hasn't been baked (or whose data has been released)");
+        return false;
+    }
+
+    std::filesystem::path atlasPath = path;
+    atlasPath += ".atlas";
+    if (!m_Atlas.Save(atlasPath, key))
+        return false;
+
+    const CacheHeader header = {
+        .Magic        = Magic,
+        .Version      = Version,
+        .LODCount     = static_cast<u16>(m_LODs.size()),
+        .Key          = key,
+        .VertexCount  = static_cast<u32>(m_Vertices.size()),
+        .IndexCount   = static_cast<u32>(m_Indices.size()),
+        .SubMeshCount = static_cast<u32>(m_SubMeshes.size()),
+        .NameBytes    = static_cast<u32>(m_Name.size()),
+        .BoundsMin    = m_BoundsMin,
+        .BoundsMax    = m_BoundsMax
+    };
+
+    // The atlas is written first, so a model file is never there without one.
+    return FileUtil::WriteFileAtomically(path, [&](std::ofstream& file)
+    {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(m_Name.data(), static_cast<std::streamsize>(m_Name.size()));
+        file.write(reinterpret_cast<const char*>(m_Vertices.data()), m_Vertices.size() * sizeof(MeshVertex));
+        file.write(reinterpret_cast<const char*>(m_Indices.data()), m_Indices.size() * sizeof(u32));
+        file.write(reinterpret_cast<const char*>(m_SubMeshes.data()), m_SubMeshes.size() * sizeof(SubMesh));
+        // Every LOD has as many submeshes as the full mesh.
+        for (const MeshLOD& lod : m_LODs)
+        {
+            file.write(reinterpret_cast<const char*>(&lod.Error), sizeof(lod.Error));
+            file.write(reinterpret_cast<const char*>(lod.SubMeshes.data()), lod.SubMeshes.size() * sizeof(SubMesh));
+        }
+    });
+}
+
+bool BlockBenchModel::LoadBaked(const std::filesystem::path& path, const u64 key)
+{
+    Clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    auto read = [&file](void* data, const size_t size)
+    {
+        file.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        return file && static_cast<size_t>(file.gcount()) == size;
+    };
+
+    CacheHeader header = {};
+    if (!read(&header, sizeof(header)) || header.Magic != Magic || header.Version != Version || header.Key != key)
+        return false;
+
+    // Sizes from the file are checked before anything's allocated for them.
+    constexpr u32 maxCount = 1u << 26;
+    const bool    sane     = header.VertexCount > 0 && header.VertexCount < maxCount && header.IndexCount > 0
+                             && header.IndexCount < maxCount && header.SubMeshCount > 0
+                             && header.SubMeshCount <= header.IndexCount && header.NameBytes < 4096
+                             && header.LODCount < 64;
+    if (!sane)
+    {
+        MP_WARN("Ignoring corrupt baked BlockBench model {}", path.string());
+        return false;
+    }
+
+    m_Name.resize(header.NameBytes);
+    m_Vertices.resize(header.VertexCount);
+    m_Indices.resize(header.IndexCount);
+    m_SubMeshes.resize(header.SubMeshCount);
+    bool valid = read(m_Name.data(), m_Name.size()) && read(m_Vertices.data(), m_Vertices.size() * sizeof(MeshVertex))
+                 && read(m_Indices.data(), m_Indices.size() * sizeof(u32))
+                 && read(m_SubMeshes.data(), m_SubMeshes.size() * sizeof(SubMesh));
+    m_LODs.resize(header.LODCount);
+    for (MeshLOD& lod : m_LODs)
+    {
+        lod.SubMeshes.resize(header.SubMeshCount);
+        valid = valid && read(&lod.Error, sizeof(lod.Error))
+                && read(lod.SubMeshes.data(), lod.SubMeshes.size() * sizeof(SubMesh));
+    }
+
+    // A LOD may have simplified a submesh away entirely, but the full mesh can't have empty ones. Indices are relative
+    // to their submesh's BaseVertex, so it's from there that they have to stay inside the vertices.
+    auto inRange = [&](const SubMesh& subMesh)
+    {
+        if (static_cast<u64>(subMesh.FirstIndex) + subMesh.IndexCount > header.IndexCount)
+            return false;
+        const std::span<const u32> indices  = std::span(m_Indices).subspan(subMesh.FirstIndex, subMesh.IndexCount);
+        const u32                  maxIndex = indices.empty() ? 0 : std::ranges::max(indices);
+        return static_cast<u64>(subMesh.BaseVertex) + maxIndex < header.VertexCount;
+    };
+    valid = valid && std::ranges::all_of(m_SubMeshes, [&](const SubMesh& subMesh)
+            {
+                return subMesh.IndexCount > 0 && inRange(subMesh);
+            })
+            && std::ranges::all_of(m_LODs, [&](const MeshLOD& lod)
+            {
+                return std::isfinite(lod.Error) && std::ranges::all_of(lod.SubMeshes, inRange);
+            });
+
+    std::filesystem::path atlasPath = path;
+    atlasPath += ".atlas";
+    if (!valid || !m_Atlas.Load(atlasPath, key))
+    {
+        MP_WARN("Ignoring corrupt baked BlockBench model {}", path.string());
+        Clear();
+        return false;
+    }
+
+    m_BoundsMin       = header.BoundsMin;
+    m_BoundsMax       = header.BoundsMax;
+    m_Stats.Vertices  = header.VertexCount;
+    m_Stats.Indices   = 0;
+    for (const SubMesh& subMesh : m_SubMeshes)
+        m_Stats.Indices += subMesh.IndexCount;
+    m_Stats.Textures  = m_Atlas.GetStats().Sprites;
+    m_Stats.FromCache = true;
+    return true;
+}
+
+bool BlockBenchModel::Upload(GPUResources& resources)
+{
+    if (!IsBaked() || m_Vertices.empty())
+    {
+        MP_ERROR("Can't upload a BlockBench model that hasn't been baked (or whose data has been released)");
+        return false;
+    }
+    if (!m_Quantize)
+        return m_Mesh.Upload(resources, m_Vertices, m_Indices) && m_Atlas.Upload(resources);
+
+    // The fetch stats are for the full mesh's indices, not the LODs' after them.
+    const SubMesh&                   last = m_SubMeshes.back();
+    std::vector<QuantizedMeshVertex> quantized;
+    const MeshQuantization           quantization = MeshOptimizer::Quantize(
+        m_Vertices, quantized, &m_Stats.Optimization, std::span(m_Indices).first(last.FirstIndex + last.IndexCount));
+    return m_Mesh.Upload(resources, quantized, m_Indices, quantization) && m_Atlas.Upload(resources);
+}
+
+void BlockBenchModel::ReleaseCPUData()
+{
+    m_Vertices.clear();
+    m_Vertices.shrink_to_fit();
+    m_Indices.clear();
+    m_Indices.shrink_to_fit();
+    m_Atlas.ReleasePixels();
+}
+
+void BlockBenchModel::Shutdown()
+{
+    m_Mesh.Shutdown();
+    m_Atlas.Shutdown();
+    Clear();
+}
+
+void BlockBenchModel::Clear()
+{
+    m_Name.clear();
+    m_Vertices.clear();
+    m_Indices.clear();
+    m_SubMeshes.clear();
+    m_LODs.clear();
+    m_BoundsMin = glm::vec3(0.0f);
+    m_BoundsMax = glm::vec3(0.0f);
+    m_Stats.Reset();
+}
+
+const std::vector<SubMesh>& BlockBenchModel::GetLODSubMeshes(const u32 lod) const
+{
+    if (lod == 0)
+        return m_SubMeshes;
+    if (lod - 1 < m_LODs.size())
+        return m_LODs[lod - 1].SubMeshes;
+
+    MP_ERROR("Model has no LOD {} (it has {}); using the full mesh", lod, m_LODs.size());
+    return m_SubMeshes;
+}
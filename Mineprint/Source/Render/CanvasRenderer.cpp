@@ -0,0 +1,303 @@
+#include "mppch.h"
+
+#include "Render/CanvasRenderer.h"
+
+#include "Core/EmbeddedContent/EmbeddedContent.h"
+
+u32 CanvasInstance::PackCornerRadii(const f32 topLeft, const f32 topRight, const f32 bottomRight, const f32 bottomLeft)
+{
+    auto pack = [](const f32 radius) { return static_cast<u32>(std::clamp(radius + 0.5f, 0.0f, 255.0f)); };
+    return pack(topLeft) | pack(topRight) << 8 | pack(bottomRight) << 16 | pack(bottomLeft) << 24;
+}
+
+void CanvasBatch::Begin(const FRect& view, const glm::vec2& viewportSize)
+{
+    MP_ASSERT(view.Size.x > 0 && view.Size.y > 0, "Canvas view must have a positive size");
+
+    m_View          = view;
+    m_ViewMin       = view.Position;
+    m_ViewMax       = view.Position + view.Size;
+    m_PixelsPerUnit = viewportSize.x / view.Size.x;
+
+    for (std::vector<CanvasInstance>& instances : m_Instances)
+        instances.clear();
+    m_Stats.Reset();
+}
+
+void CanvasBatch::DrawShape(const CanvasInstance& shape, const CanvasLayer layer)
+{
+    m_Stats.Shapes++;
+    if (!IsVisible(shape.Min, shape.Max))
+    {
+        m_Stats.CulledShapes++;
+        return;
+    }
+
+    Add(shape, layer);
+    m_Stats.Instances++;
+}
+
+void CanvasBatch::DrawRect(const FRect& rect, const u32 fillColour, const f32 cornerRadius, const CanvasLayer layer)
+{
+    DrawShape({
+                  .Min         = rect.Position,
+                  .Max         = rect.Position + rect.Size,
+                  .CornerRadii = CanvasInstance::PackCornerRadii(cornerRadius),
+                  .FillColour  = fillColour
+              }, layer);
+}
+
+void CanvasBatch::DrawCircle(const glm::vec2& centre, const f32 radius, const u32 fillColour, const CanvasLayer layer)
+{
+    DrawShape({
+                  .Min         = centre - radius,
+                  .Max         = centre + radius,
+                  .CornerRadii = CanvasInstance::PackCornerRadii(radius),
+                  .FillColour  = fillColour
+              }, layer);
+}
+
+void CanvasBatch::DrawNode(const CanvasNode& node)
+{
+    m_Stats.Nodes++;
+
+    // Pins stick out of the sides by their radius.
+    const glm::vec2 min = node.Bounds.Position;
+    const glm::vec2 max = node.Bounds.Position + node.Bounds.Size;
+    if (!IsVisible({min.x - PinRadius, min.y}, {max.x + PinRadius, max.y}))
+    {
+        m_Stats.CulledNodes++;
+        return;
+    }
+
+    std::vector<CanvasInstance>& instances = m_Instances[static_cast<size_t>(CanvasLayer::Nodes)];
+
+    if (node.Bounds.Size.y * m_PixelsPerUnit < LODNodePixels)
+    {
+        instances.push_back({.Min = min, .Max = max, .FillColour = node.BodyColour});
+        m_Stats.LODNodes++;
+        m_Stats.Instances++;
+        return;
+    }
+
+    const u32 radius    = CanvasInstance::PackCornerRadii(node.CornerRadius);
+    const f32 border    = 1.0f;
+    const u32 pinCount  = node.InputPins + node.OutputPins;
+    const u32 pinRadius = CanvasInstance::PackCornerRadii(PinRadius);
+
+    // Body, then the header over its top (inset by the border, so the border shows around it), then the pins.
+    instances.push_back({
+        .Min          = min,
+        .Max          = max,
+        .CornerRadii  = radius,
+        .FillColour   = node.BodyColour,
+        .BorderColour = node.BorderColour,
+        .BorderWidth  = border
+    });
+    instances.push_back({
+        .Min         = min + border,
+        .Max         = {max.x - border, std::min(min.y + node.HeaderHeight, max.y - border)},
+        .CornerRadii = CanvasInstance::PackCornerRadii(node.CornerRadius - border, node.CornerRadius - border, 0, 0),
+        .FillColour  = node.HeaderColour
+    });
+    m_Stats.Instances += 2;
+
+    // Pins smaller than a pixel aren't worth the fill rate.
+    if (pinCount == 0 || PinRadius * m_PixelsPerUnit < 1.0f)
+        return;
+
+    const f32 firstPinY = min.y + node.HeaderHeight + PinSpacing * 0.5f;
+    auto      addPins   = [&](const u8 count, const f32 x)
+    {
+        for (u8 i = 0; i < count; i++)
+        {
+            const glm::vec2 centre = {x, firstPinY + static_cast<f32>(i) * PinSpacing};
+            instances.push_back({
+                .Min         = centre - PinRadius,
+                .Max         = centre + PinRadius,
+                .CornerRadii = pinRadius,
+                .FillColour  = node.PinColour
+            });
+        }
+    };
+    addPins(node.InputPins, min.x);
+    addPins(node.OutputPins, max.x);
+    m_Stats.Instances += pinCount;
+}
+
+void CanvasBatch::DrawNodes(const std::span<const CanvasNode> nodes)
+{
+    for (const CanvasNode& node : nodes)
+        DrawNode(node);
+}
+
+CanvasRenderer::~CanvasRenderer()
+{
+    Shutdown();
+}
+
+bool CanvasRenderer::Init(GPUResources& resources, ShaderCache* shaderCache, ShaderCompiler* compiler,
+                          const Shader* fallback)
+{
+    MP_CHECK(!IsValid(), "Canvas renderer already initialised");
+
+    const std::span<const u8> vertexSource   = EmbeddedContent::Get("Shaders/Canvas.vert");
+    const std::span<const u8> fragmentSource = EmbeddedContent::Get("Shaders/Canvas.frag");
+    if (vertexSource.empty() || fragmentSource.empty())
+    {
+        MP_ERROR("Canvas shaders are missing from the embedded content");
+        return false;
+    }
+
+    const ShaderSpecification shaderSpec = {
+        .Name           = "Canvas",
+        .VertexSource   = {reinterpret_cast<const char*>(vertexSource.data()), vertexSource.size()},
+        .FragmentSource = {reinterpret_cast<const char*>(fragmentSource.data()), fragmentSource.size()},
+        .Cache          = shaderCache
+    };
+    m_Resources = &resources;
+    if (!InitShader(resources, m_Shader, shaderSpec, compiler, fallback))
+        return false;
+
+    // All attributes are per-instance, from binding 0. The queue points binding 0 at the batch's instances in the
+    // stream buffer for each draw.
+    m_VertexArray     = resources.CreateVertexArray();
+    m_VertexArrayName = resources.Get(m_VertexArray);
+    glVertexArrayBindingDivisor(m_VertexArrayName, 0, 1);
+
+    auto addAttribute = [this](const GLuint location, const GLint size, const GLenum type, const GLboolean normalised,
+                               const GLuint offset)
+    {
+        glEnableVertexArrayAttrib(m_VertexArrayName, location);
+        glVertexArrayAttribFormat(m_VertexArrayName, location, size, type, normalised, offset);
+        glVertexArrayAttribBinding(m_VertexArrayName, location, 0);
+    };
+    addAttribute(0, 4, GL_FLOAT, GL_FALSE, offsetof(CanvasInstance, Min)); // Min and Max
+    addAttribute(1, 4, GL_UNSIGNED_BYTE, GL_FALSE, offsetof(CanvasInstance, CornerRadii));
+    addAttribute(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(CanvasInstance, FillColour));
+    addAttribute(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(CanvasInstance, BorderColour));
+    addAttribute(4, 1, GL_FLOAT, GL_FALSE, offsetof(CanvasInstance, BorderWidth));
+
+    // Nodes can still be drawn without wires.
+    if (!InitWires(shaderCache, compiler, fallback))
+        MP_ERROR("Failed to initialise canvas wires");
+
+    return true;
+}
+
+bool CanvasRenderer::InitShader(GPUResources& resources, Shader& shader, const ShaderSpecification& spec,
+                                ShaderCompiler* compiler, const Shader* fallback)
+{
+    return compiler ? shader.InitAsync(resources, spec, *compiler, fallback) : shader.Init(resources, spec);
+}
+
+bool CanvasRenderer::InitWires(ShaderCache* shaderCache, ShaderCompiler* compiler, const Shader* fallback)
+{
+    const std::span<const u8> vertexSource   = EmbeddedContent::Get("Shaders/Wire.vert");
+    const std::span<const u8> fragmentSource = EmbeddedContent::Get("Shaders/Wire.frag");
+    if (vertexSource.empty() || fragmentSource.empty())
+    {
+        MP_ERROR("Wire shaders are missing from the embedded content");
+        return false;
+    }
+
+    const ShaderSpecification shaderSpec = {
+        .Name           = "Wire",
+        .VertexSource   = {reinterpret_cast<const char*>(vertexSource.data()), vertexSource.size()},
+        .FragmentSource = {reinterpret_cast<const char*>(fragmentSource.data()), fragmentSource.size()},
+        .Cache          = shaderCache
+    };
+    if (!InitShader(*m_Resources, m_WireShader, shaderSpec, compiler, fallback))
+        return false;
+
+    // Plain per-vertex attributes from binding 0, which the queue points at the batch's vertices for each draw.
+    m_WireVertexArray     = m_Resources->CreateVertexArray();
+    m_WireVertexArrayName = m_Resources->Get(m_WireVertexArray);
+    glEnableVertexArrayAttrib(m_WireVertexArrayName, 0);
+    glVertexArrayAttribFormat(m_WireVertexArrayName, 0, 2, GL_FLOAT, GL_FALSE, offsetof(WireVertex, Position));
+    glVertexArrayAttribBinding(m_WireVertexArrayName, 0, 0);
+    glEnableVertexArrayAttrib(m_WireVertexArrayName, 1);
+    glVertexArrayAttribFormat(m_WireVertexArrayName, 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(WireVertex, Colour));
+    glVertexArrayAttribBinding(m_WireVertexArrayName, 1, 0);
+    glEnableVertexArrayAttrib(m_WireVertexArrayName, 2);
+    glVertexArrayAttribFormat(m_WireVertexArrayName, 2, 1, GL_FLOAT, GL_FALSE, offsetof(WireVertex, Edge));
+    glVertexArrayAttribBinding(m_WireVertexArrayName, 2, 0);
+
+    return true;
+}
+
+void CanvasRenderer::Shutdown()
+{
+    m_Shader.Shutdown();
+    m_WireShader.Shutdown();
+    if (m_Resources)
+    {
+        m_Resources->Destroy(m_VertexArray);
+        m_Resources->Destroy(m_WireVertexArray);
+    }
+    m_Resources           = nullptr;
+    m_VertexArray         = {};
+    m_WireVertexArray     = {};
+    m_VertexArrayName     = 0;
+    m_WireVertexArrayName = 0;
+}
+
+void CanvasRenderer::Submit(const CanvasBatch& batch, RenderQueue& queue) const
+{
+    if (!IsValid())
+        return;
+
+    const glm::vec4 transform = GetClipTransform(batch.GetView());
+
+    for (u8 layer = 0; layer < static_cast<u8>(CanvasLayer::Count); layer++)
+    {
+        const std::span<const CanvasInstance> instances = batch.GetInstances(static_cast<CanvasLayer>(layer));
+        if (instances.empty())
+            continue;
+
+        DrawPacket packet;
+        packet.SortKey            = RenderSortKey::Make(RenderPass::Overlay, SortShaderID, layer, 0.0f);
+        packet.Program            = m_Shader.GetProgram();
+        packet.VertexArray        = m_VertexArrayName;
+        packet.State.Blend        = BlendMode::Alpha;
+        packet.Params[0]          = transform;
+        packet.Params[1]          = {1.0f / batch.GetPixelsPerUnit(), 0.0f, 0.0f, 0.0f};
+        packet.ParamCount         = 2;
+        packet.Primitive          = GL_TRIANGLE_STRIP;
+        packet.Count              = 4;
+        packet.InstanceCount      = static_cast<u32>(instances.size());
+        packet.StreamVertexOffset = queue.WriteStream(instances.data(), static_cast<u32>(instances.size_bytes()));
+        packet.StreamVertexStride = sizeof(CanvasInstance);
+        queue.Submit(packet);
+    }
+}
+
+void CanvasRenderer::SubmitWires(const WireBatch& wires, RenderQueue& queue) const
+{
+    if (!m_WireShader.IsUsable() || wires.GetIndices().empty())
+        return;
+
+    const std::span<const WireVertex> vertices = wires.GetVertices();
+    const std::span<const u32>        indices  = wires.GetIndices();
+
+    DrawPacket packet;
+    packet.SortKey            = RenderSortKey::Make(RenderPass::Overlay, WireSortShaderID, 0, 0.0f);
+    packet.Program            = m_WireShader.GetProgram();
+    packet.VertexArray        = m_WireVertexArrayName;
+    packet.State.Blend        = BlendMode::Alpha;
+    packet.Params[0]          = GetClipTransform(wires.GetView());
+    packet.ParamCount         = 1;
+    packet.IndexType          = GL_UNSIGNED_INT;
+    packet.Count              = static_cast<u32>(indices.size());
+    packet.StreamVertexOffset = queue.WriteStream(vertices.data(), static_cast<u32>(vertices.size_bytes()));
+    packet.StreamVertexStride = sizeof(WireVertex);
+    packet.StreamIndexOffset  = queue.WriteStream(indices.data(), static_cast<u32>(indices.size_bytes()), 4);
+    queue.Submit(packet);
+}
+
+glm::vec4 CanvasRenderer::GetClipTransform(const FRect& view)
+{
+    // Canvas (y down) to clip space (y up): the view's top-left goes to (-1, 1) and its bottom-right to (1, -1).
+    const glm::vec2 scale = {2.0f / view.Size.x, -2.0f / view.Size.y};
+    return {scale, -1.0f - view.Position.x * scale.x, 1.0f - view.Position.y * scale.y};
+}
@@ -0,0 +1,377 @@
+#include "mppch.h"
+
+#include "Render/ChunkMesher.h"
+
+#include "Core/Jobs/JobSystem.h"
+#include "Core/SIMD.h"
+
+namespace
+{
+    // The section plus a block of each neighbour all the way round, for culling and AO at its edges.
+    constexpr u32 Padded = ChunkSection::Size + 2;
+
+    // How each face's quads lie: the axis it faces along, and the two axes of its plane. Going round a quad along u
+    // then v is clockwise seen from outside the Reversed faces, so their vertices are put in the other way round.
+    struct FaceAxes
+    {
+        u32  Normal;
+        u32  U;
+        u32  V;
+        bool Positive;
+        bool Reversed;
+    };
+
+    constexpr std::array<FaceAxes, static_cast<size_t>(BlockFace::Count)> s_FaceAxes = {{
+        {1, 0, 2, false, false}, // Down
+        {1, 0, 2, true, true},   // Up
+        {2, 0, 1, false, true},  // North
+        {2, 0, 1, true, false},  // South
+        {0, 2, 1, false, false}, // West
+        {0, 2, 1, true, true},   // East
+    }};
+
+    struct MeshScratch
+    {
+        std::array<BlockID, Padded * Padded * Padded> Blocks; // y, then z, then x.
+
+        // A bit per block along each column, by padded coordinate. X columns are indexed [y][z], Y columns [z][x], and
+        // Z columns [y][x]: [v][u] for the faces along that axis.
+        std::array<std::array<u32, Padded * Padded>, 3> Solid;
+        std::array<std::array<u32, Padded * Padded>, 3> Opaque;
+
+        // Visible faces by BlockFace, for the section's own columns: [v][u], a bit per block.
+        std::array<std::array<u32, ChunkSection::Size * ChunkSection::Size>, static_cast<size_t>(BlockFace::Count)>
+        Faces;
+
+        // A slice's faces, waiting to be merged. 0 where there isn't one.
+        std::array<u32, ChunkSection::Size * ChunkSection::Size> Keys;
+
+        NODISCARD FORCEINLINE BlockID GetBlock(const glm::ivec3& p) const
+        {
+            return Blocks[(p.y * Padded + p.z) * Padded + p.x];
+        }
+
+        NODISCARD FORCEINLINE bool IsOpaque(const glm::ivec3& p) const
+        {
+            return (Opaque[0][p.y * Padded + p.z] >> p.x & 1) != 0;
+        }
+    };
+
+    // Slice keys: the texture, the AO of each corner, and whether the AO is the same at all four (only those faces
+    // are merged, as a merged quad can't carry a gradient from the middle of it).
+    constexpr u32 KeyPresent   = 1u << 31;
+    constexpr u32 KeyMergeable = 1u << 24;
+
+    NODISCARD FORCEINLINE bool IsOpaque(const std::span<const BlockType> palette, const BlockID block)
+    {
+        return block >= palette.size() || palette[block].Opaque;
+    }
+
+    NODISCARD FORCEINLINE u32 GetTexture(const std::span<const BlockType> palette, const BlockID block,
+                                         const BlockFace face)
+    {
+        return block < palette.size() ? palette[block].Textures[static_cast<size_t>(face)] : 0;
+    }
+
+    // Copies the section, and the edges of its neighbours, into scratch.Blocks.
+    void GatherBlocks(const BlockVolume& volume, const glm::ivec3& section, MeshScratch& scratch)
+    {
+        scratch.Blocks.fill(AirBlock);
+
+        // Per axis, for a neighbour at -1, 0 or +1: where to read from in it, where to write to, and how many blocks.
+        constexpr u32 source[3]      = {ChunkSection::Size - 1, 0, 0};
+        constexpr u32 destination[3] = {0, 1, ChunkSection::Size + 1};
+        constexpr u32 count[3]       = {1, ChunkSection::Size, 1};
+
+        for (s32 dy = -1; dy <= 1; dy++)
+        {
+            for (s32 dz = -1; dz <= 1; dz++)
+            {
+                for (s32 dx = -1; dx <= 1; dx++)
+                {
+                    const ChunkSection* neighbour = volume.GetSection(section + glm::ivec3(dx, dy, dz));
+                    if (!neighbour || neighbour->IsEmpty())
+                        continue;
+
+                    const std::array<BlockID, ChunkSection::Volume>& blocks = neighbour->GetBlocks();
+                    for (u32 y = 0; y < count[dy + 1]; y++)
+                    {
+                        for (u32 z = 0; z < count[dz + 1]; z++)
+                        {
+                            const u32 from = ChunkSection::GetIndex(source[dx + 1], source[dy + 1] + y,
+                                                                    source[dz + 1] + z);
+                            const u32 to = ((destination[dy + 1] + y) * Padded + destination[dz + 1] + z) * Padded
+                                           + destination[dx + 1];
+                            std::copy_n(blocks.data() + from, count[dx + 1], scratch.Blocks.data() + to);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void BuildColumns(const std::span<const BlockType> palette, MeshScratch& scratch)
+    {
+        for (auto& columns : scratch.Solid)
+            columns.fill(0);
+        for (auto& columns : scratch.Opaque)
+            columns.fill(0);
+
+        for (u32 y = 0; y < Padded; y++)
+        {
+            for (u32 z = 0; z < Padded; z++)
+            {
+                const BlockID* row = scratch.Blocks.data() + (y * Padded + z) * Padded;
+                for (u32 x = 0; x < Padded; x++)
+                {
+                    if (row[x] == AirBlock)
+                        continue;
+
+                    const u32 opaque = IsOpaque(palette, row[x]) ? ~0u : 0u;
+                    scratch.Solid[0][y * Padded + z] |= 1u << x;
+                    scratch.Solid[1][z * Padded + x] |= 1u << y;
+                    scratch.Solid[2][y * Padded + x] |= 1u << z;
+                    scratch.Opaque[0][y * Padded + z] |= (1u << x) & opaque;
+                    scratch.Opaque[1][z * Padded + x] |= (1u << y) & opaque;
+                    scratch.Opaque[2][y * Padded + x] |= (1u << z) & opaque;
+                }
+            }
+        }
+    }
+
+    // For the section's own columns along one axis: which blocks have a face towards +axis (a solid block, with no
+    // opaque one after it) and -axis. Bit k of each result is block k of the column.
+    void CullColumns(const std::array<u32, Padded * Padded>& solid, const std::array<u32, Padded * Padded>& opaque,
+                     u32* negative, u32* positive)
+    {
+        // The columns are a section wide, so they go four at a time with none left over.
+        static_assert(ChunkSection::Size % 4 == 0);
+        const UInt4 mask = UInt4::Splat(0xFFFF);
+        for (u32 v = 0; v < ChunkSection::Size; v++)
+        {
+            const u32* solidRow  = solid.data() + (v + 1) * Padded + 1;
+            const u32* opaqueRow = opaque.data() + (v + 1) * Padded + 1;
+            u32*       negRow    = negative + v * ChunkSection::Size;
+            u32*       posRow    = positive + v * ChunkSection::Size;
+            for (u32 u = 0; u < ChunkSection::Size; u += 4)
+            {
+                const UInt4 s   = UInt4::Load(solidRow + u);
+                const UInt4 o   = UInt4::Load(opaqueRow + u);
+                const UInt4 pos = AndNot(s, o >> 1);
+                const UInt4 neg = AndNot(s, o << 1);
+                // Drop the neighbours' bits, so bit k is block k.
+                (pos >> 1 & mask).Store(posRow + u);
+                (neg >> 1 & mask).Store(negRow + u);
+            }
+        }
+    }
+
+    // Fills scratch.Keys with the visible faces in one slice of the section. Returns how many there are.
+    u32 BuildSliceKeys(const MeshScratch& scratch, const std::span<const BlockType> palette, const BlockFace face,
+                       const u32 slice, std::array<u32, ChunkSection::Size * ChunkSection::Size>& keys)
+    {
+        const FaceAxes& axes   = s_FaceAxes[static_cast<size_t>(face)];
+        const u32*      faces  = scratch.Faces[static_cast<size_t>(face)].data();
+        glm::ivec3      normal = {};
+        glm::ivec3      uAxis  = {};
+        glm::ivec3      vAxis  = {};
+        normal[axes.Normal]    = axes.Positive ? 1 : -1;
+        uAxis[axes.U]          = 1;
+        vAxis[axes.V]          = 1;
+
+        u32 count = 0;
+        for (u32 v = 0; v < ChunkSection::Size; v++)
+        {
+            for (u32 u = 0; u < ChunkSection::Size; u++)
+            {
+                const u32 index = v * ChunkSection::Size + u;
+                keys[index]     = 0;
+                if ((faces[index] >> slice & 1) == 0)
+                    continue;
+
+                glm::ivec3 block;
+                block[axes.Normal] = static_cast<s32>(slice) + 1;
+                block[axes.U]      = static_cast<s32>(u) + 1;
+                block[axes.V]      = static_cast<s32>(v) + 1;
+
+                // See-through blocks hide each other's faces, but only when they're the same block.
+                const BlockID    id    = scratch.GetBlock(block);
+                const glm::ivec3 front = block + normal;
+                if (!IsOpaque(palette, id) && scratch.GetBlock(front) == id)
+                    continue;
+
+                // The three blocks around each corner, in front of the face. Corners go (-u, -v), (+u, -v), (+u, +v),
+                // (-u, +v).
+                u32 aos = 0;
+                for (u32 corner = 0; corner < 4; corner++)
+                {
+                    const glm::ivec3 du       = corner == 0 || corner == 3 ? -uAxis : uAxis;
+                    const glm::ivec3 dv       = corner < 2 ? -vAxis : vAxis;
+                    const u32        side1    = scratch.IsOpaque(front + du);
+                    const u32        side2    = scratch.IsOpaque(front + dv);
+                    const u32        diagonal = scratch.IsOpaque(front + du + dv);
+                    const u32        ao       = side1 && side2 ? 0 : 3 - (side1 + side2 + diagonal);
+                    aos |= ao << (corner * 2);
+                }
+
+                const bool uniform = aos == 0x00 || aos == 0x55 || aos == 0xAA || aos == 0xFF;
+                keys[index]        = KeyPresent | (uniform ? KeyMergeable : 0) | aos << 16
+                                     | GetTexture(palette, id, face);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void EmitQuad(const BlockFace face, const u32 slice, const u32 u0, const u32 v0, const u32 width, const u32 height,
+                  const u32 key, std::vector<ChunkVertex>& vertices)
+    {
+        const FaceAxes& axes  = s_FaceAxes[static_cast<size_t>(face)];
+        const u32       plane = slice + (axes.Positive ? 1 : 0);
+
+        // Corners in the same order as the AO bits.
+        const glm::uvec2 corners[4] = {{u0, v0}, {u0 + width, v0}, {u0 + width, v0 + height}, {u0, v0 + height}};
+
+        ChunkVertex quad[4];
+        for (u32 i = 0; i < 4; i++)
+        {
+            glm::uvec3 position;
+            position[axes.Normal] = plane;
+            position[axes.U]      = corners[i].x;
+            position[axes.V]      = corners[i].y;
+
+            // Textures are upright on the sides: v runs down the block.
+            glm::uvec2 uv = corners[i] - glm::uvec2(u0, v0);
+            if (axes.V == 1)
+                uv.y = height - uv.y;
+
+            quad[i] = ChunkVertex::Pack(position, face, key >> (16 + i * 2) & 3, key & 0xFFFF, uv);
+        }
+
+        // Counter-clockwise from outside, starting from whichever corner puts the diagonal through the darker pair
+        // (otherwise, one bright corner lights up half the quad and leaves a crease down the middle).
+        const u32 ao[4]    = {quad[0].GetAO(), quad[1].GetAO(), quad[2].GetAO(), quad[3].GetAO()};
+        u32       order[4] = {0, 1, 2, 3};
+        if (axes.Reversed)
+            std::swap(order[1], order[3]);
+        const u32 first = ao[0] + ao[2] > ao[1] + ao[3] ? 1 : 0;
+        for (u32 i = 0; i < 4; i++)
+            vertices.push_back(quad[order[(i + first) % 4]]);
+    }
+
+    // Merges runs of matching faces into rectangles, widest first, then as tall as the whole run matches.
+    void MergeSlice(const BlockFace face, const u32 slice,
+                    std::array<u32, ChunkSection::Size * ChunkSection::Size>& keys, std::vector<ChunkVertex>& vertices)
+    {
+        constexpr u32 size = ChunkSection::Size;
+        for (u32 v = 0; v < size; v++)
+        {
+            for (u32 u = 0; u < size;)
+            {
+                const u32 key = keys[v * size + u];
+                if (key == 0)
+                {
+                    u++;
+                    continue;
+                }
+
+                u32 width  = 1;
+                u32 height = 1;
+                if (key & KeyMergeable)
+                {
+                    while (u + width < size && keys[v * size + u + width] == key)
+                        width++;
+                    while (v + height < size)
+                    {
+                        const u32* row = keys.data() + (v + height) * size + u;
+                        if (!std::all_of(row, row + width, [key](const u32 other) { return other == key; }))
+                            break;
+                        height++;
+                    }
+                }
+
+                EmitQuad(face, slice, u, v, width, height, key, vertices);
+                for (u32 y = v; y < v + height; y++)
+                    std::fill_n(keys.data() + y * size + u, width, 0u);
+                u += width;
+            }
+        }
+    }
+}
+
+void ChunkMesher::MeshSection(const BlockVolume& volume, const glm::ivec3& section,
+                              const std::span<const BlockType> palette, ChunkMesh& mesh)
+{
+    mesh.Section = section;
+    mesh.Vertices.clear();
+    mesh.Faces = 0;
+
+    const ChunkSection* blocks = volume.GetSection(section);
+    if (!blocks || blocks->IsEmpty())
+        return;
+
+    // About 26KB; per thread, so meshing on several at once doesn't share it.
+    thread_local MeshScratch scratch;
+    GatherBlocks(volume, section, scratch);
+    BuildColumns(palette, scratch);
+
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        // Down/Up are the Y faces, North/South the Z faces, and West/East the X faces.
+        constexpr BlockFace negativeFaces[3] = {BlockFace::West, BlockFace::Down, BlockFace::North};
+        const size_t        negative         = static_cast<size_t>(negativeFaces[axis]);
+        CullColumns(scratch.Solid[axis], scratch.Opaque[axis], scratch.Faces[negative].data(),
+                    scratch.Faces[negative + 1].data());
+    }
+
+    for (u32 face = 0; face < static_cast<u32>(BlockFace::Count); face++)
+    {
+        for (u32 slice = 0; slice < ChunkSection::Size; slice++)
+        {
+            const u32 faces = BuildSliceKeys(scratch, palette, static_cast<BlockFace>(face), slice, scratch.Keys);
+            if (faces == 0)
+                continue;
+            mesh.Faces += faces;
+            MergeSlice(static_cast<BlockFace>(face), slice, scratch.Keys, mesh.Vertices);
+        }
+    }
+}
+
+ChunkMeshStats ChunkMesher::MeshVolume(const BlockVolume& volume, const std::span<const BlockType> palette,
+                                       JobSystem& jobs, std::vector<ChunkMesh>& meshes)
+{
+    Stopwatch                     timer;
+    const std::vector<glm::ivec3> sections = volume.GetSectionPositions();
+    meshes.resize(sections.size());
+    jobs.ParallelFor(0, static_cast<u32>(sections.size()), [&](const u32 begin, const u32 end)
+    {
+        for (u32 i = begin; i < end; i++)
+            MeshSection(volume, sections[i], palette, meshes[i]);
+    });
+
+    ChunkMeshStats stats;
+    stats.Sections = static_cast<u32>(sections.size());
+    for (const ChunkMesh& mesh : meshes)
+    {
+        stats.Faces += mesh.Faces;
+        stats.Quads += mesh.GetQuadCount();
+    }
+    stats.MeshMS = timer.GetElapsedMilliseconds();
+    return stats;
+}
+
+void ChunkMesher::BuildQuadIndices(const u32 quadCount, std::vector<u32>& indices)
+{
+    indices.resize(static_cast<size_t>(quadCount) * 6);
+    for (u32 quad = 0; quad < quadCount; quad++)
+    {
+        const u32 base = quad * 4;
+        u32*      out  = indices.data() + static_cast<size_t>(quad) * 6;
+        out[0]         = base;
+        out[1]         = base + 1;
+        out[2]         = base + 2;
+        out[3]         = base;
+        out[4]         = base + 2;
+        out[5]         = base + 3;
+    }
+}
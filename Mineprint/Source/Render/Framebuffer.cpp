@@ -0,0 +1,132 @@
+#include "mppch.h"
+
+#include "Render/Framebuffer.h"
+
+Framebuffer::~Framebuffer()
+{
+    Shutdown();
+}
+
+bool Framebuffer::Init(GPUResources& resources, const FramebufferSpecification& spec)
+{
+    MP_CHECK(!IsValid(), "Framebuffer already initialised");
+    if (spec.Size.x <= 0 || spec.Size.y <= 0)
+    {
+        MP_ERROR("Framebuffer size must be positive ({}x{})", spec.Size.x, spec.Size.y);
+        return false;
+    }
+
+    m_Spec      = spec;
+    m_Resources = &resources;
+
+    GLint maxSamples = 1;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    m_Spec.Samples = std::clamp(m_Spec.Samples, 1u, static_cast<u32>(maxSamples));
+    const GLsizei samples = static_cast<GLsizei>(m_Spec.Samples);
+
+    // The texture is what gets read, whether we draw into it directly or resolve into it.
+    m_ColourTexture            = resources.CreateTexture(GL_TEXTURE_2D);
+    const GLuint colourTexture = resources.Get(m_ColourTexture);
+    glTextureStorage2D(colourTexture, 1, m_Spec.ColourFormat, m_Spec.Size.x, m_Spec.Size.y);
+    glTextureParameteri(colourTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(colourTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(colourTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(colourTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_Framebuffer            = resources.CreateFramebuffer();
+    const GLuint framebuffer = resources.Get(m_Framebuffer);
+    GLuint       resolve     = 0;
+    if (IsMultisampled())
+    {
+        m_ColourRenderbuffer      = resources.CreateRenderbuffer();
+        const GLuint renderbuffer = resources.Get(m_ColourRenderbuffer);
+        glNamedRenderbufferStorageMultisample(renderbuffer, samples, m_Spec.ColourFormat, m_Spec.Size.x,
+                                              m_Spec.Size.y);
+        glNamedFramebufferRenderbuffer(framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+
+        m_ResolveFramebuffer = resources.CreateFramebuffer();
+        resolve              = resources.Get(m_ResolveFramebuffer);
+        glNamedFramebufferTexture(resolve, GL_COLOR_ATTACHMENT0, colourTexture, 0);
+    }
+    else
+    {
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, colourTexture, 0);
+    }
+
+    if (m_Spec.DepthStencil)
+    {
+        m_DepthRenderbuffer       = resources.CreateRenderbuffer();
+        const GLuint renderbuffer = resources.Get(m_DepthRenderbuffer);
+        if (IsMultisampled())
+        {
+            glNamedRenderbufferStorageMultisample(renderbuffer, samples, GL_DEPTH24_STENCIL8, m_Spec.Size.x,
+                                                  m_Spec.Size.y);
+        }
+        else
+            glNamedRenderbufferStorage(renderbuffer, GL_DEPTH24_STENCIL8, m_Spec.Size.x, m_Spec.Size.y);
+        glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffer);
+    }
+
+    const GLenum status        = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
+    const GLenum resolveStatus = IsMultisampled()
+                                     ? glCheckNamedFramebufferStatus(resolve, GL_FRAMEBUFFER)
+                                     : GL_FRAMEBUFFER_COMPLETE;
+    if (status != GL_FRAMEBUFFER_COMPLETE || resolveStatus != GL_FRAMEBUFFER_COMPLETE)
+    {
+        MP_ERROR("Framebuffer ({}x{}, {} samples) is incomplete: 0x{:X}, 0x{:X}", m_Spec.Size.x, m_Spec.Size.y,
+                 m_Spec.Samples, status, resolveStatus);
+        Shutdown();
+        return false;
+    }
+
+    return true;
+}
+
+void Framebuffer::Shutdown()
+{
+    // Init() creates the texture first, so this covers a partly initialised framebuffer too.
+    if (m_ColourTexture.IsNull())
+        return;
+
+    // Null handles are skipped.
+    m_Resources->Destroy(m_Framebuffer);
+    m_Resources->Destroy(m_ResolveFramebuffer);
+    m_Resources->Destroy(m_ColourRenderbuffer);
+    m_Resources->Destroy(m_DepthRenderbuffer);
+    m_Resources->Destroy(m_ColourTexture);
+
+    m_Framebuffer        = {};
+    m_ResolveFramebuffer = {};
+    m_ColourRenderbuffer = {};
+    m_DepthRenderbuffer  = {};
+    m_ColourTexture      = {};
+}
+
+bool Framebuffer::Resize(const glm::ivec2& size)
+{
+    if (IsValid() && size == m_Spec.Size)
+        return true;
+
+    MP_ASSERT(m_Resources, "Resizing a framebuffer that was never initialised");
+    FramebufferSpecification spec = m_Spec;
+    spec.Size                     = size;
+    Shutdown();
+    return Init(*m_Resources, spec);
+}
+
+void Framebuffer::Bind() const
+{
+    MP_ASSERT(IsValid(), "Binding an invalid framebuffer");
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Resources->Get(m_Framebuffer));
+    glViewport(0, 0, m_Spec.Size.x, m_Spec.Size.y);
+}
+
+void Framebuffer::Resolve() const
+{
+    if (!IsMultisampled())
+        return;
+
+    glBlitNamedFramebuffer(m_Resources->Get(m_Framebuffer), m_Resources->Get(m_ResolveFramebuffer), 0, 0,
+                           m_Spec.Size.x, m_Spec.Size.y, 0, 0, m_Spec.Size.x, m_Spec.Size.y, GL_COLOR_BUFFER_BIT,
+                           GL_NEAREST);
+}
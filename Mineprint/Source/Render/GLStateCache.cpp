@@ -0,0 +1,101 @@
+#include "mppch.h"
+
+#include "Render/GLStateCache.h"
+
+void GLStateCache::Invalidate()
+{
+    m_Program     = Unknown;
+    m_VertexArray = Unknown;
+    m_Textures.fill(Unknown);
+    m_StateKnown = false;
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+    if (m_Program == program)
+    {
+        m_Stats.ElidedStateChanges++;
+        return;
+    }
+
+    glUseProgram(program);
+    m_Program = program;
+    m_Stats.ProgramChanges++;
+}
+
+void GLStateCache::BindTexture(u32 unit, GLuint texture)
+{
+    MP_ASSERT(unit < MaxTextureUnits, "Texture unit {} is out of range (max {})", unit, MaxTextureUnits);
+    if (m_Textures[unit] == texture)
+    {
+        m_Stats.ElidedStateChanges++;
+        return;
+    }
+
+    glBindTextureUnit(unit, texture);
+    m_Textures[unit] = texture;
+    m_Stats.TextureChanges++;
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+    {
+        m_Stats.ElidedStateChanges++;
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    m_VertexArray = vertexArray;
+    m_Stats.VertexArrayChanges++;
+}
+
+void GLStateCache::SetRenderState(const RenderState& state)
+{
+    if (m_StateKnown && m_State == state)
+    {
+        m_Stats.ElidedStateChanges++;
+        return;
+    }
+
+    // Only touch the parts that differ, unless we don't know what's set at all.
+    if (!m_StateKnown || m_State.Blend != state.Blend)
+        ApplyBlend(state.Blend);
+    if (!m_StateKnown || m_State.DepthTest != state.DepthTest)
+        SetCapability(GL_DEPTH_TEST, state.DepthTest);
+    if (!m_StateKnown || m_State.DepthWrite != state.DepthWrite)
+        glDepthMask(state.DepthWrite ? GL_TRUE : GL_FALSE);
+    if (!m_StateKnown || m_State.CullFaces != state.CullFaces)
+        SetCapability(GL_CULL_FACE, state.CullFaces);
+
+    m_State      = state;
+    m_StateKnown = true;
+    m_Stats.RenderStateChanges++;
+}
+
+void GLStateCache::ApplyBlend(BlendMode blend)
+{
+    SetCapability(GL_BLEND, blend != BlendMode::None);
+    switch (blend)
+    {
+    case BlendMode::None:
+        break;
+    case BlendMode::Alpha:
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    case BlendMode::Premultiplied:
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    case BlendMode::Additive:
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        break;
+    }
+}
+
+void GLStateCache::SetCapability(GLenum capability, bool enabled)
+{
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
@@ -0,0 +1,260 @@
+#include "mppch.h"
+
+#include "Render/GPUResources.h"
+
+namespace
+{
+    void DeleteObjects(const GPUResourceType type, const GLsizei count, const GLuint* names)
+    {
+        switch (type)
+        {
+        case GPUResourceType::Texture:
+            glDeleteTextures(count, names);
+            break;
+        case GPUResourceType::Buffer:
+            glDeleteBuffers(count, names);
+            break;
+        case GPUResourceType::Program:
+            // The only one without an array version.
+            for (GLsizei i = 0; i < count; i++)
+                glDeleteProgram(names[i]);
+            break;
+        case GPUResourceType::Framebuffer:
+            glDeleteFramebuffers(count, names);
+            break;
+        case GPUResourceType::Renderbuffer:
+            glDeleteRenderbuffers(count, names);
+            break;
+        case GPUResourceType::VertexArray:
+            glDeleteVertexArrays(count, names);
+            break;
+        default:
+            MP_ERROR("Can't delete GL objects of unknown type {}", static_cast<u32>(type));
+            break;
+        }
+    }
+}
+
+GPUDeletionQueue::~GPUDeletionQueue()
+{
+    Shutdown();
+}
+
+void GPUDeletionQueue::Init(const u32 capacity)
+{
+    MP_CHECK(m_Names.empty(), "Deletion queue already initialised");
+
+    m_Names.assign(std::max(capacity, 1u), 0);
+    m_Types.assign(m_Names.size(), GPUResourceType::Texture);
+    m_Stats.Reset();
+}
+
+void GPUDeletionQueue::Shutdown()
+{
+    if (m_Names.empty())
+        return;
+
+    for (u32 i = 0; i < m_FrameCount; i++)
+        glDeleteSync(m_Frames[(m_FirstFrame + i) % MaxFrames].Fence);
+    if (GetPendingCount() > 0)
+    {
+        glFinish();
+        ReleaseUntil(m_Written);
+    }
+
+    m_Names.clear();
+    m_Types.clear();
+    m_Written    = 0;
+    m_Released   = 0;
+    m_Fenced     = 0;
+    m_FirstFrame = 0;
+    m_FrameCount = 0;
+}
+
+void GPUDeletionQueue::Defer(const GPUResourceType type, const GLuint name)
+{
+    if (name == 0)
+        return;
+
+    // Not set up (e.g. a renderer that never initialised), so there's nothing to wait for the GPU with.
+    if (m_Names.empty())
+    {
+        DeleteObjects(type, 1, &name);
+        return;
+    }
+
+    if (GetPendingCount() == GetCapacity())
+    {
+        m_Stats.Overflows++;
+        Stopwatch timer;
+        if (m_FrameCount > 0)
+        {
+            WaitForOldestFrame();
+        }
+        else
+        {
+            // Everything waiting is from this frame, so there's no fence to wait on yet.
+            glFinish();
+            ReleaseUntil(m_Written);
+            m_Fenced = m_Written;
+        }
+        m_Stats.StallMS += timer.GetElapsedMilliseconds();
+    }
+
+    const size_t index = m_Written % m_Names.size();
+    m_Names[index]     = name;
+    m_Types[index]     = type;
+    m_Written++;
+    m_Stats.Deferred++;
+}
+
+void GPUDeletionQueue::EndFrame()
+{
+    // Frames that didn't delete anything don't need a fence.
+    if (m_Written == m_Fenced)
+        return;
+
+    if (m_FrameCount == MaxFrames)
+    {
+        m_Stats.Overflows++;
+        Stopwatch timer;
+        WaitForOldestFrame();
+        m_Stats.StallMS += timer.GetElapsedMilliseconds();
+    }
+
+    Frame& frame = m_Frames[(m_FirstFrame + m_FrameCount) % MaxFrames];
+    frame.Fence  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame.End    = m_Written;
+    m_FrameCount++;
+    m_Fenced = m_Written;
+}
+
+u32 GPUDeletionQueue::Collect()
+{
+    const u64 released = m_Released;
+    while (m_FrameCount > 0)
+    {
+        Frame& frame = m_Frames[m_FirstFrame];
+        if (glClientWaitSync(frame.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            break;
+
+        glDeleteSync(frame.Fence);
+        ReleaseUntil(frame.End);
+        frame        = {};
+        m_FirstFrame = (m_FirstFrame + 1) % MaxFrames;
+        m_FrameCount--;
+    }
+    return static_cast<u32>(m_Released - released);
+}
+
+GPUDeletionStats GPUDeletionQueue::GetStats() const
+{
+    GPUDeletionStats stats = m_Stats;
+    stats.Pending          = GetPendingCount();
+    return stats;
+}
+
+void GPUDeletionQueue::ReleaseUntil(const u64 end)
+{
+    const u64 capacity = m_Names.size();
+    while (m_Released < end)
+    {
+        // A run of one type, up to the end of the ring, so the names can go to glDelete* as an array.
+        const size_t          start = m_Released % capacity;
+        const GPUResourceType type  = m_Types[start];
+        const u64             limit = std::min(end - m_Released, capacity - start);
+        u64                   count = 1;
+        while (count < limit && m_Types[start + count] == type)
+            count++;
+
+        DeleteObjects(type, static_cast<GLsizei>(count), &m_Names[start]);
+        m_Released += count;
+        m_Stats.Released += count;
+    }
+}
+
+void GPUDeletionQueue::WaitForOldestFrame()
+{
+    Frame& frame = m_Frames[m_FirstFrame];
+    // Flushed, in case the fence hasn't reached the GPU yet. Anything but a timeout means it's done (or never will
+    // be, and waiting longer won't help).
+    while (glClientWaitSync(frame.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+
+    glDeleteSync(frame.Fence);
+    ReleaseUntil(frame.End);
+    frame        = {};
+    m_FirstFrame = (m_FirstFrame + 1) % MaxFrames;
+    m_FrameCount--;
+}
+
+GPUResources::~GPUResources()
+{
+    Shutdown();
+}
+
+void GPUResources::Init(const u32 deletionCapacity)
+{
+    m_Deletions.Init(deletionCapacity);
+}
+
+void GPUResources::Shutdown()
+{
+    for (u32 i = 0; i < m_Pools.size(); i++)
+    {
+        const auto type = static_cast<GPUResourceType>(i);
+        Pool&      pool = m_Pools[i];
+        if (pool.GetCount() == 0)
+            continue;
+
+        MP_WARN("{} {} object(s) still alive at shutdown", pool.GetCount(), GPUResourceTypeToString(type));
+        pool.ForEach([this, type](PoolHandle, const GLuint name) { m_Deletions.Defer(type, name); });
+        pool.Clear();
+    }
+    m_Deletions.Shutdown();
+}
+
+TextureHandle GPUResources::CreateTexture(const GLenum target)
+{
+    GLuint name = 0;
+    glCreateTextures(target, 1, &name);
+    return Add<GPUResourceType::Texture>(name);
+}
+
+BufferHandle GPUResources::CreateBuffer()
+{
+    GLuint name = 0;
+    glCreateBuffers(1, &name);
+    return Add<GPUResourceType::Buffer>(name);
+}
+
+FramebufferHandle GPUResources::CreateFramebuffer()
+{
+    GLuint name = 0;
+    glCreateFramebuffers(1, &name);
+    return Add<GPUResourceType::Framebuffer>(name);
+}
+
+RenderbufferHandle GPUResources::CreateRenderbuffer()
+{
+    GLuint name = 0;
+    glCreateRenderbuffers(1, &name);
+    return Add<GPUResourceType::Renderbuffer>(name);
+}
+
+VertexArrayHandle GPUResources::CreateVertexArray()
+{
+    GLuint name = 0;
+    glCreateVertexArrays(1, &name);
+    return Add<GPUResourceType::VertexArray>(name);
+}
+
+GPUResourceStats GPUResources::GetStats() const
+{
+    GPUResourceStats stats;
+    for (size_t i = 0; i < m_Pools.size(); i++)
+        stats.Live[i] = m_Pools[i].GetCount();
+    stats.Deletions = m_Deletions.GetStats();
+    return stats;
+}
@@ -0,0 +1,240 @@
+#include "mppch.h"
+
+#include "Render/HeadlessContext.h"
+
+#ifdef MP_PLATFORM_LINUX
+#include <SDL3/SDL_loadso.h>
+// SDL's copy of the EGL headers, so we don't need the system's to build. glad's copy of khrplatform.h (which stops
+// SDL's being used) leaves out the calling convention, which is empty on Linux anyway.
+#define SDL_USE_BUILTIN_OPENGL_DEFINITIONS
+#ifndef KHRONOS_APIENTRY
+#define KHRONOS_APIENTRY
+#endif
+#include <SDL3/SDL_egl.h>
+
+namespace
+{
+    struct EGLFunctions
+    {
+        PFNEGLGETPROCADDRESSPROC        GetProcAddress        = nullptr;
+        PFNEGLGETERRORPROC              GetError              = nullptr;
+        PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplayEXT = nullptr;
+        PFNEGLINITIALIZEPROC            Initialize            = nullptr;
+        PFNEGLTERMINATEPROC             Terminate             = nullptr;
+        PFNEGLQUERYSTRINGPROC           QueryString           = nullptr;
+        PFNEGLBINDAPIPROC               BindAPI               = nullptr;
+        PFNEGLCREATECONTEXTPROC         CreateContext         = nullptr;
+        PFNEGLDESTROYCONTEXTPROC        DestroyContext        = nullptr;
+        PFNEGLMAKECURRENTPROC           MakeCurrent           = nullptr;
+    };
+
+    EGLFunctions s_EGL;
+
+    bool HasExtension(const char* extensions, const std::string_view name)
+    {
+        // Extension strings are space separated, and one name can be a prefix of another.
+        std::string_view remaining = extensions ? extensions : "";
+        while (!remaining.empty())
+        {
+            const size_t end = remaining.find(' ');
+            if (remaining.substr(0, end) == name)
+                return true;
+            if (end == std::string_view::npos)
+                break;
+            remaining.remove_prefix(end + 1);
+        }
+        return false;
+    }
+
+    EGLContext CreateGLContext(EGLDisplay display, EGLContext share)
+    {
+        const EGLint attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef MP_GL_DEBUG
+            EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+            EGL_NONE
+        };
+        return s_EGL.CreateContext(display, EGL_NO_CONFIG_KHR, share, attributes);
+    }
+}
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+    Shutdown();
+}
+
+#ifdef MP_PLATFORM_LINUX
+bool HeadlessContext::Init()
+{
+    MP_CHECK(!IsValid(), "Headless context already initialised");
+
+    if (!Create())
+    {
+        Shutdown();
+        return false;
+    }
+
+    MP_INFO("Created a headless OpenGL context ({})", s_EGL.QueryString(m_Display, EGL_VENDOR));
+    return true;
+}
+
+// Anything missing is an environment problem (no libEGL, an old Mesa...), not a bug, so just log it and fail.
+#define MP_EGL_CHECK(cond, ...) \
+    if (!(cond))                \
+    {                           \
+        MP_ERROR(__VA_ARGS__);  \
+        return false;           \
+    }
+
+bool HeadlessContext::Create()
+{
+    m_Library = SDL_LoadObject("libEGL.so.1");
+    MP_EGL_CHECK(m_Library, "Failed to load libEGL: {}", SDL_GetError());
+
+    s_EGL.GetProcAddress = reinterpret_cast<PFNEGLGETPROCADDRESSPROC>(
+        SDL_LoadFunction(static_cast<SDL_SharedObject*>(m_Library), "eglGetProcAddress"));
+    MP_EGL_CHECK(s_EGL.GetProcAddress, "libEGL doesn't export eglGetProcAddress");
+
+#define MP_LOAD_EGL(name, function) \
+    s_EGL.name = reinterpret_cast<decltype(s_EGL.name)>(s_EGL.GetProcAddress(function)); \
+    MP_EGL_CHECK(s_EGL.name, "Failed to load {}", function)
+
+    MP_LOAD_EGL(GetError, "eglGetError");
+    MP_LOAD_EGL(GetPlatformDisplayEXT, "eglGetPlatformDisplayEXT");
+    MP_LOAD_EGL(Initialize, "eglInitialize");
+    MP_LOAD_EGL(Terminate, "eglTerminate");
+    MP_LOAD_EGL(QueryString, "eglQueryString");
+    MP_LOAD_EGL(BindAPI, "eglBindAPI");
+    MP_LOAD_EGL(CreateContext, "eglCreateContext");
+    MP_LOAD_EGL(DestroyContext, "eglDestroyContext");
+    MP_LOAD_EGL(MakeCurrent, "eglMakeCurrent");
+#undef MP_LOAD_EGL
+
+    const char* clientExtensions = s_EGL.QueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    MP_EGL_CHECK(HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"),
+                 "EGL doesn't support the surfaceless platform (EGL_MESA_platform_surfaceless)");
+
+    m_Display = s_EGL.GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+    MP_EGL_CHECK(m_Display, "Failed to get the surfaceless EGL display (0x{:X})", s_EGL.GetError());
+    m_OwnsDisplay = true;
+
+    EGLint major = 0, minor = 0;
+    MP_EGL_CHECK(s_EGL.Initialize(m_Display, &major, &minor), "Failed to initialise EGL (0x{:X})",
+                 s_EGL.GetError());
+    MP_INFO("Initialised EGL {}.{} on the surfaceless platform", major, minor);
+
+    const char* displayExtensions = s_EGL.QueryString(m_Display, EGL_EXTENSIONS);
+    // Both let us make the context current without a surface, or a config to create one from.
+    MP_EGL_CHECK(HasExtension(displayExtensions, "EGL_KHR_surfaceless_context"),
+                 "EGL doesn't support surfaceless contexts (EGL_KHR_surfaceless_context)");
+    MP_EGL_CHECK(HasExtension(displayExtensions, "EGL_KHR_no_config_context"),
+                 "EGL doesn't support contexts without a config (EGL_KHR_no_config_context)");
+
+    MP_EGL_CHECK(s_EGL.BindAPI(EGL_OPENGL_API), "EGL doesn't support desktop OpenGL (0x{:X})", s_EGL.GetError());
+
+    m_Context = CreateGLContext(m_Display, EGL_NO_CONTEXT);
+    MP_EGL_CHECK(m_Context, "Failed to create a headless OpenGL 4.5 context (0x{:X})", s_EGL.GetError());
+
+    MP_EGL_CHECK(s_EGL.MakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context),
+                 "Failed to make the headless context current (0x{:X})", s_EGL.GetError());
+    return true;
+}
+
+#undef MP_EGL_CHECK
+
+bool HeadlessContext::InitShared(const HeadlessContext& other)
+{
+    MP_CHECK(!IsValid(), "Headless context already initialised");
+    MP_ASSERT(other.IsValid(), "Can't share with a headless context that isn't initialised");
+
+    // The other context's display and library; they're its to clean up.
+    m_Display = other.m_Display;
+    m_Context = CreateGLContext(m_Display, other.m_Context);
+    if (!m_Context)
+    {
+        MP_ERROR("Failed to create a shared headless OpenGL context (0x{:X})", s_EGL.GetError());
+        m_Display = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessContext::MakeCurrent() const
+{
+    // The bound API is per thread, and eglMakeCurrent() goes by it.
+    s_EGL.BindAPI(EGL_OPENGL_API);
+    return s_EGL.MakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context) == EGL_TRUE;
+}
+
+void HeadlessContext::Release() const
+{
+    s_EGL.BindAPI(EGL_OPENGL_API);
+    s_EGL.MakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void HeadlessContext::Shutdown()
+{
+    if (m_Display && m_OwnsDisplay)
+    {
+        s_EGL.MakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_Context)
+            s_EGL.DestroyContext(m_Display, m_Context);
+        s_EGL.Terminate(m_Display);
+    }
+    else if (m_Context)
+    {
+        // Shared contexts are made current on other threads, which should have released them by now.
+        s_EGL.DestroyContext(m_Display, m_Context);
+    }
+    m_Context     = nullptr;
+    m_Display     = nullptr;
+    m_OwnsDisplay = false;
+
+    if (m_Library)
+    {
+        SDL_UnloadObject(static_cast<SDL_SharedObject*>(m_Library));
+        m_Library = nullptr;
+        s_EGL     = {};
+    }
+}
+
+GLADapiproc HeadlessContext::GetProcAddress(const char* name)
+{
+    return reinterpret_cast<GLADapiproc>(s_EGL.GetProcAddress(name));
+}
+#else
+bool HeadlessContext::Init()
+{
+    MP_ERROR("Headless OpenGL contexts aren't supported on this platform yet");
+    return false;
+}
+
+bool HeadlessContext::InitShared(const HeadlessContext& other)
+{
+    return false;
+}
+
+bool HeadlessContext::MakeCurrent() const
+{
+    // The bound API is per thread, and eglMakeCurrent() goes by it.
+    s_EGL.BindAPI(EGL_OPENGL_API);
+    return false;
+}
+
+void HeadlessContext::Release() const
+{
+}
+
+void HeadlessContext::Shutdown()
+{
+}
+
+GLADapiproc HeadlessContext::GetProcAddress(const char* name)
+{
+    return nullptr;
+}
+#endif
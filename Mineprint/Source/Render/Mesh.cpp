@@ -0,0 +1,158 @@
+#include "mppch.h"
+
+#include "Render/Mesh.h"
+
+#include "Render/RenderQueue.h"
+
+GPUMesh::~GPUMesh()
+{
+    Shutdown();
+}
+
+bool GPUMesh::Upload(GPUResources& resources, const std::span<const MeshVertex> vertices,
+                     const std::span<const u8> indices, const GLenum indexType)
+{
+    const u32 indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    if (indices.size() % indexSize != 0)
+    {
+        MP_ERROR("Mesh index data isn't a whole number of {}-bit indices", indexSize * 8);
+        return false;
+    }
+    return Create(resources, MeshVertexFormat::Full, static_cast<u32>(vertices.size()),
+                  static_cast<u32>(indices.size() / indexSize), indexType, vertices.data(), indices.data(), 0);
+}
+
+bool GPUMesh::Upload(GPUResources& resources, const std::span<const QuantizedMeshVertex> vertices,
+                     const std::span<const u32> indices, const MeshQuantization& quantization)
+{
+    if (!Create(resources, MeshVertexFormat::Quantized, static_cast<u32>(vertices.size()),
+                static_cast<u32>(indices.size()), GL_UNSIGNED_INT, vertices.data(), indices.data(), 0))
+        return false;
+    m_Quantization = quantization;
+    return true;
+}
+
+bool GPUMesh::Allocate(GPUResources& resources, const u32 vertexCount, const u32 indexCount, const GLenum indexType)
+{
+    return Create(resources, MeshVertexFormat::Full, vertexCount, indexCount, indexType, nullptr, nullptr,
+                  GL_DYNAMIC_STORAGE_BIT);
+}
+
+void GPUMesh::WriteVertices(const u32 first, const std::span<const MeshVertex> vertices) const
+{
+    MP_CHECK(m_VertexFormat == MeshVertexFormat::Full, "Only full vertices can be written");
+    MP_CHECK(first + vertices.size() <= m_VertexCount, "Writing past the end of the mesh's vertices");
+    glNamedBufferSubData(m_Resources->Get(m_VertexBuffer), static_cast<GLintptr>(first) * sizeof(MeshVertex),
+                         static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data());
+}
+
+void GPUMesh::WriteIndices(const u32 first, const std::span<const u8> indices) const
+{
+    MP_CHECK(first + indices.size() / GetIndexSize() <= m_IndexCount, "Writing past the end of the mesh's indices");
+    glNamedBufferSubData(m_Resources->Get(m_IndexBuffer), static_cast<GLintptr>(first) * GetIndexSize(),
+                         static_cast<GLsizeiptr>(indices.size()), indices.data());
+}
+
+bool GPUMesh::Create(GPUResources& resources, const MeshVertexFormat format, const u32 vertexCount,
+                     const u32 indexCount, const GLenum indexType, const void* vertices, const void* indices,
+                     const GLbitfield flags)
+{
+    if (vertexCount == 0 || indexCount == 0)
+    {
+        MP_ERROR("Can't upload an empty mesh");
+        return false;
+    }
+    if (indexType != GL_UNSIGNED_SHORT && indexType != GL_UNSIGNED_INT)
+    {
+        MP_ERROR("Meshes need 16 or 32-bit indices");
+        return false;
+    }
+
+    Shutdown();
+    m_Resources    = &resources;
+    m_VertexCount  = vertexCount;
+    m_IndexCount   = indexCount;
+    m_IndexType    = indexType;
+    m_VertexFormat = format;
+    m_Quantization = {};
+
+    const u32 stride = format == MeshVertexFormat::Quantized ? sizeof(QuantizedMeshVertex) : sizeof(MeshVertex);
+
+    m_VertexBuffer = resources.CreateBuffer();
+    m_IndexBuffer  = resources.CreateBuffer();
+    m_VertexArray  = resources.CreateVertexArray();
+
+    const GLuint vertexBuffer = resources.Get(m_VertexBuffer);
+    const GLuint indexBuffer  = resources.Get(m_IndexBuffer);
+    const GLuint vertexArray  = resources.Get(m_VertexArray);
+    glNamedBufferStorage(vertexBuffer, static_cast<GLsizeiptr>(vertexCount) * stride, vertices, flags);
+    glNamedBufferStorage(indexBuffer, static_cast<GLsizeiptr>(indexCount) * GetIndexSize(), indices, flags);
+
+    glVertexArrayVertexBuffer(vertexArray, 0, vertexBuffer, 0, static_cast<GLsizei>(stride));
+    glVertexArrayElementBuffer(vertexArray, indexBuffer);
+    for (GLuint attribute = 0; attribute < 3; attribute++)
+    {
+        glEnableVertexArrayAttrib(vertexArray, attribute);
+        glVertexArrayAttribBinding(vertexArray, attribute, 0);
+    }
+    if (format == MeshVertexFormat::Quantized)
+    {
+        // Positions and normals are normalised integers, so they arrive in the shader as 0 to 1 and -1 to 1.
+        glVertexArrayAttribFormat(vertexArray, 0, 3, GL_UNSIGNED_SHORT, GL_TRUE,
+                                  offsetof(QuantizedMeshVertex, Position));
+        glVertexArrayAttribFormat(vertexArray, 1, 2, GL_SHORT, GL_TRUE, offsetof(QuantizedMeshVertex, Normal));
+        glVertexArrayAttribFormat(vertexArray, 2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedMeshVertex, UV));
+    }
+    else
+    {
+        glVertexArrayAttribFormat(vertexArray, 0, 3, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, Position));
+        glVertexArrayAttribFormat(vertexArray, 1, 3, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, Normal));
+        glVertexArrayAttribFormat(vertexArray, 2, 2, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, UV));
+    }
+    return true;
+}
+
+void GPUMesh::Shutdown()
+{
+    if (!IsUploaded())
+        return;
+
+    m_Resources->Destroy(m_VertexArray);
+    m_Resources->Destroy(m_VertexBuffer);
+    m_Resources->Destroy(m_IndexBuffer);
+
+    m_Resources    = nullptr;
+    m_VertexArray  = {};
+    m_VertexBuffer = {};
+    m_IndexBuffer  = {};
+    m_VertexCount  = 0;
+    m_IndexCount   = 0;
+    m_IndexType    = GL_UNSIGNED_INT;
+    m_VertexFormat = MeshVertexFormat::Full;
+    m_Quantization = {};
+}
+
+void GPUMesh::SetupDrawPacket(DrawPacket& packet, const SubMesh& subMesh) const
+{
+    MP_CHECK(subMesh.FirstIndex + subMesh.IndexCount <= m_IndexCount, "Submesh is outside the mesh's indices");
+
+    packet.VertexArray = GetVertexArray();
+    packet.Primitive   = GL_TRIANGLES;
+    packet.IndexType   = m_IndexType;
+    packet.Count       = subMesh.IndexCount;
+    packet.First       = subMesh.FirstIndex;
+    packet.BaseVertex  = static_cast<s32>(subMesh.BaseVertex);
+}
+
+void GPUMesh::SetTransform(DrawPacket& packet, const glm::mat4& objectToClip, const u32 layer) const
+{
+    static_assert(DrawPacket::MaxParams >= 5, "Mesh.vert takes a matrix and the layer in its draw params");
+
+    const glm::mat4 matrix = m_VertexFormat == MeshVertexFormat::Quantized
+                                 ? objectToClip * m_Quantization.GetMatrix()
+                                 : objectToClip;
+    for (u32 i = 0; i < 4; i++)
+        packet.Params[i] = matrix[static_cast<glm::length_t>(i)];
+    packet.Params[4]  = {static_cast<f32>(layer), 0.0f, 0.0f, 0.0f};
+    packet.ParamCount = 5;
+}
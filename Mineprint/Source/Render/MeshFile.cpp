@@ -0,0 +1,289 @@
+#include "mppch.h"
+
+#include "Render/MeshFile.h"
+
+namespace
+{
+    template <typename T>
+    T ReadValue(const u8* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    u32 MaxIndex(const std::span<const T> indices)
+    {
+        T result = 0;
+        for (const T index : indices)
+            result = std::max(result, index);
+        return result;
+    }
+}
+
+bool MeshFile::Open(const std::filesystem::path& path, const bool validateIndices)
+{
+    Close();
+    if (!m_File.Open(path))
+        return false;
+
+    if (m_File.GetSize() < 8 || ReadValue<u32>(m_File.GetData()) != Magic)
+    {
+        MP_ERROR("{} isn't a mesh file", path.string());
+        Close();
+        return false;
+    }
+
+    const bool parsed = ReadValue<u32>(m_File.GetData() + 4) == VersionMarker
+                            ? ParseVersioned(path)
+                            : ParseLegacy(path);
+    if (!parsed || (validateIndices && !ValidateIndices(path)))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MeshFile::Close()
+{
+    m_File.Close();
+    m_FileVersion = 0;
+    m_IndexSize   = 2;
+    m_IndexType   = GL_UNSIGNED_SHORT;
+    m_VertexCount = 0;
+    m_IndexCount  = 0;
+    m_Data.clear();
+    m_SubMeshes.clear();
+    m_Copied.clear();
+    m_AllVertices = {};
+    m_AllIndices  = {};
+}
+
+bool MeshFile::Upload(GPUResources& resources, GPUMesh& mesh) const
+{
+    if (!IsOpen())
+    {
+        MP_ERROR("Can't upload a mesh file that isn't open");
+        return false;
+    }
+
+    if (IsVersioned())
+        return mesh.Upload(resources, m_AllVertices, m_AllIndices, m_IndexType);
+
+    // The original layout interleaves each submesh's vertices and indices, so they go up a submesh at a time.
+    if (!mesh.Allocate(resources, m_VertexCount, m_IndexCount, m_IndexType))
+        return false;
+    for (size_t i = 0; i < m_Data.size(); i++)
+    {
+        const std::span<const u16> indices = m_Data[i].Indices16;
+        mesh.WriteVertices(m_SubMeshes[i].BaseVertex, m_Data[i].Vertices);
+        mesh.WriteIndices(m_SubMeshes[i].FirstIndex,
+                          {reinterpret_cast<const u8*>(indices.data()), indices.size_bytes()});
+    }
+    return true;
+}
+
+bool MeshFile::ParseLegacy(const std::filesystem::path& path)
+{
+    struct Entry
+    {
+        u64 Offset; // Of the vertices; the indices follow them.
+        u32 VertexCount;
+        u32 IndexCount;
+        u32 MaterialIndex;
+    };
+
+    const u8* data  = m_File.GetData();
+    const u64 size  = m_File.GetSize();
+    const s32 count = ReadValue<s32>(data + 4);
+    if (count < 0)
+    {
+        MP_ERROR("Mesh file {} has a negative submesh count", path.string());
+        return false;
+    }
+
+    // Find every submesh first, so the copies of unaligned vertices are made into storage that won't move.
+    std::vector<Entry> entries;
+    u64                offset      = 8;
+    u64                vertexCount = 0;
+    u64                indexCount  = 0;
+    u64                unaligned   = 0;
+    for (s32 i = 0; i < count; i++)
+    {
+        if (size - offset < 12)
+        {
+            MP_ERROR("Mesh file {} is truncated (in submesh {} of {})", path.string(), i, count);
+            return false;
+        }
+
+        Entry entry = {
+            .Offset        = offset + 12,
+            .VertexCount   = ReadValue<u32>(data + offset),
+            .IndexCount    = ReadValue<u32>(data + offset + 4),
+            .MaterialIndex = ReadValue<u32>(data + offset + 8),
+        };
+        const u64 bytes = static_cast<u64>(entry.VertexCount) * sizeof(MeshVertex) + entry.IndexCount * sizeof(u16);
+        if (size - entry.Offset < bytes)
+        {
+            MP_ERROR("Mesh file {} is truncated (in submesh {} of {})", path.string(), i, count);
+            return false;
+        }
+
+        if (entry.Offset % alignof(MeshVertex) != 0)
+            unaligned += entry.VertexCount;
+        vertexCount += entry.VertexCount;
+        indexCount  += entry.IndexCount;
+        offset       = entry.Offset + bytes;
+        entries.push_back(entry);
+    }
+
+    if (offset != size)
+    {
+        MP_ERROR("Mesh file {} has {} bytes of unexpected data at the end", path.string(), size - offset);
+        return false;
+    }
+    if (vertexCount > std::numeric_limits<u32>::max() || indexCount > std::numeric_limits<u32>::max())
+    {
+        MP_ERROR("Mesh file {} has too many vertices or indices", path.string());
+        return false;
+    }
+
+    m_FileVersion = 1;
+    m_IndexSize   = sizeof(u16);
+    m_IndexType   = GL_UNSIGNED_SHORT;
+    m_VertexCount = static_cast<u32>(vertexCount);
+    m_IndexCount  = static_cast<u32>(indexCount);
+    m_Copied.resize(unaligned);
+    m_Data.reserve(entries.size());
+    m_SubMeshes.reserve(entries.size());
+
+    u32 firstVertex = 0;
+    u32 firstIndex  = 0;
+    u64 copied      = 0;
+    for (const Entry& entry : entries)
+    {
+        const u8*         vertexData = data + entry.Offset;
+        const MeshVertex* vertices   = reinterpret_cast<const MeshVertex*>(vertexData);
+        if (entry.Offset % alignof(MeshVertex) != 0)
+        {
+            std::memcpy(m_Copied.data() + copied, vertexData, entry.VertexCount * sizeof(MeshVertex));
+            vertices  = m_Copied.data() + copied;
+            copied   += entry.VertexCount;
+        }
+
+        const u16* indices = reinterpret_cast<const u16*>(vertexData + entry.VertexCount * sizeof(MeshVertex));
+        m_Data.push_back({
+            .Vertices      = {vertices, entry.VertexCount},
+            .Indices16     = {indices, entry.IndexCount},
+            .Indices32     = {},
+            .MaterialIndex = entry.MaterialIndex,
+        });
+        m_SubMeshes.push_back({
+            .FirstIndex    = firstIndex,
+            .IndexCount    = entry.IndexCount,
+            .BaseVertex    = firstVertex,
+            .MaterialIndex = entry.MaterialIndex,
+        });
+        firstVertex += entry.VertexCount;
+        firstIndex  += entry.IndexCount;
+    }
+    return true;
+}
+
+bool MeshFile::ParseVersioned(const std::filesystem::path& path)
+{
+    const u8* data = m_File.GetData();
+    const u64 size = m_File.GetSize();
+    if (size < sizeof(Header))
+    {
+        MP_ERROR("Mesh file {} is truncated (in its header)", path.string());
+        return false;
+    }
+
+    const Header header = ReadValue<Header>(data);
+    if (header.Version != Version)
+    {
+        MP_ERROR("Mesh file {} is version {}, but only {} is supported", path.string(), header.Version, Version);
+        return false;
+    }
+    if (header.IndexSize != sizeof(u16) && header.IndexSize != sizeof(u32))
+    {
+        MP_ERROR("Mesh file {} has {}-byte indices; they must be 2 or 4 bytes", path.string(), header.IndexSize);
+        return false;
+    }
+
+    // Everything's checked in 64 bits, so no count in the file can overflow the sums.
+    const u64 tableOffset  = sizeof(Header);
+    const u64 vertexOffset = (tableOffset + static_cast<u64>(header.SubMeshCount) * sizeof(SubMeshEntry) + 15) & ~15ull;
+    const u64 indexOffset  = vertexOffset + static_cast<u64>(header.VertexCount) * sizeof(MeshVertex);
+    const u64 end          = indexOffset + static_cast<u64>(header.IndexCount) * header.IndexSize;
+    if (header.FileSize != size || end > size)
+    {
+        MP_ERROR("Mesh file {} is truncated ({} bytes, but its header says {} and its counts need {})", path.string(),
+                 size, header.FileSize, end);
+        return false;
+    }
+
+    m_FileVersion = header.Version;
+    m_IndexSize   = header.IndexSize;
+    m_IndexType   = header.IndexSize == sizeof(u16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    m_VertexCount = header.VertexCount;
+    m_IndexCount  = header.IndexCount;
+    m_AllVertices = {reinterpret_cast<const MeshVertex*>(data + vertexOffset), header.VertexCount};
+    m_AllIndices  = {data + indexOffset, static_cast<size_t>(header.IndexCount) * header.IndexSize};
+    m_Data.reserve(header.SubMeshCount);
+    m_SubMeshes.reserve(header.SubMeshCount);
+
+    for (u32 i = 0; i < header.SubMeshCount; i++)
+    {
+        const SubMeshEntry entry = ReadValue<SubMeshEntry>(data + tableOffset + i * sizeof(SubMeshEntry));
+        if (static_cast<u64>(entry.FirstVertex) + entry.VertexCount > header.VertexCount
+            || static_cast<u64>(entry.FirstIndex) + entry.IndexCount > header.IndexCount)
+        {
+            MP_ERROR("Mesh file {}'s submesh {} is outside its vertices or indices", path.string(), i);
+            return false;
+        }
+
+        MeshFileSubMesh subMesh = {
+            .Vertices      = m_AllVertices.subspan(entry.FirstVertex, entry.VertexCount),
+            .Indices16     = {},
+            .Indices32     = {},
+            .MaterialIndex = entry.MaterialIndex,
+        };
+        const u8* indices = m_AllIndices.data() + static_cast<size_t>(entry.FirstIndex) * header.IndexSize;
+        if (header.IndexSize == sizeof(u16))
+            subMesh.Indices16 = {reinterpret_cast<const u16*>(indices), entry.IndexCount};
+        else
+            subMesh.Indices32 = {reinterpret_cast<const u32*>(indices), entry.IndexCount};
+
+        m_Data.push_back(subMesh);
+        m_SubMeshes.push_back({
+            .FirstIndex    = entry.FirstIndex,
+            .IndexCount    = entry.IndexCount,
+            .BaseVertex    = entry.FirstVertex,
+            .MaterialIndex = entry.MaterialIndex,
+        });
+    }
+    return true;
+}
+
+bool MeshFile::ValidateIndices(const std::filesystem::path& path) const
+{
+    for (size_t i = 0; i < m_Data.size(); i++)
+    {
+        const MeshFileSubMesh& subMesh = m_Data[i];
+        if (subMesh.Indices16.empty() && subMesh.Indices32.empty())
+            continue;
+
+        const u32 maxIndex = m_IndexSize == sizeof(u16) ? MaxIndex(subMesh.Indices16) : MaxIndex(subMesh.Indices32);
+        if (maxIndex >= subMesh.Vertices.size())
+        {
+            MP_ERROR("Mesh file {}'s submesh {} has index {}, but only {} vertices", path.string(), i, maxIndex,
+                     subMesh.Vertices.size());
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,378 @@
+#include "mppch.h"
+
+#include "Render/MeshOptimizer.h"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/component_wise.hpp>
+
+namespace
+{
+    // Forsyth's tuned constants: the cache the scores assume, and the most triangles a vertex is scored for.
+    constexpr u32 ScoreCacheSize  = 32;
+    constexpr u32 MaxScoreValence = 32;
+    constexpr u32 Invalid         = ~0u;
+
+    // The three vertices of the last triangle score the same, so a strip-like order isn't favoured over fans. Older
+    // cache entries score less the older they are. Vertices with few triangles left score more, so they're finished
+    // off rather than left behind as isolated triangles that each cost three misses later.
+    struct ScoreTables
+    {
+        std::array<f32, ScoreCacheSize>  Cache;
+        std::array<f32, MaxScoreValence> Valence;
+
+        ScoreTables()
+        {
+            for (u32 i = 0; i < ScoreCacheSize; i++)
+            {
+                Cache[i] = i < 3
+                               ? 0.75f
+                               : std::pow(1.0f - static_cast<f32>(i - 3) / static_cast<f32>(ScoreCacheSize - 3), 1.5f);
+            }
+            Valence[0] = 0.0f;
+            for (u32 i = 1; i < MaxScoreValence; i++)
+                Valence[i] = 2.0f / std::sqrt(static_cast<f32>(i));
+        }
+
+        NODISCARD f32 Score(const u32 cachePosition, const u32 remaining) const
+        {
+            if (remaining == 0)
+                return -1.0f;
+            return (cachePosition < ScoreCacheSize ? Cache[cachePosition] : 0.0f)
+                   + Valence[std::min(remaining, MaxScoreValence - 1)];
+        }
+    };
+
+    u32 CountUsed(const std::span<const u32> indices, const u32 vertexCount)
+    {
+        std::vector<u8> used(vertexCount, 0);
+        u32             count = 0;
+        for (const u32 index : indices)
+        {
+            count      += used[index] == 0;
+            used[index] = 1;
+        }
+        return count;
+    }
+}
+
+MeshOptimizationStats MeshOptimizer::Optimize(const MeshOptimizerSpecification& spec,
+                                              std::vector<MeshVertex>& vertices, std::vector<u32>& indices,
+                                              std::vector<SubMesh>& subMeshes)
+{
+    MeshOptimizationStats stats;
+    Stopwatch             timer;
+
+    for (SubMesh& subMesh : subMeshes)
+    {
+        MP_CHECK(subMesh.FirstIndex + subMesh.IndexCount <= indices.size(), "Submesh is outside the mesh's indices");
+        for (u32 i = subMesh.FirstIndex; i < subMesh.FirstIndex + subMesh.IndexCount; i++)
+            indices[i] += subMesh.BaseVertex;
+        subMesh.BaseVertex = 0;
+    }
+
+    const u32 vertexCount   = static_cast<u32>(vertices.size());
+    const u32 triangleCount = static_cast<u32>(indices.size() / 3);
+    const u32 usedCount     = std::max(CountUsed(indices, vertexCount), 1u);
+    const f32 triangles     = static_cast<f32>(std::max(triangleCount, 1u));
+    const u32 missesBefore  = AnalyzeVertexCache(indices, vertexCount, spec.AnalysisCacheSize);
+
+    stats.Triangles          = triangleCount;
+    stats.ACMRBefore         = static_cast<f32>(missesBefore) / triangles;
+    stats.ATVRBefore         = static_cast<f32>(missesBefore) / static_cast<f32>(usedCount);
+    stats.FetchedBytesBefore = AnalyzeVertexFetch(indices, vertexCount, sizeof(MeshVertex));
+    stats.VertexBytesBefore  = static_cast<u64>(vertexCount) * sizeof(MeshVertex);
+
+    if (spec.VertexCache)
+    {
+        for (const SubMesh& subMesh : subMeshes)
+            OptimizeVertexCache(std::span(indices).subspan(subMesh.FirstIndex, subMesh.IndexCount), vertexCount);
+    }
+    if (spec.VertexFetch)
+        OptimizeVertexFetch(vertices, indices);
+
+    const u32 missesAfter = AnalyzeVertexCache(indices, static_cast<u32>(vertices.size()), spec.AnalysisCacheSize);
+
+    stats.Vertices          = static_cast<u32>(vertices.size());
+    stats.ACMRAfter         = static_cast<f32>(missesAfter) / triangles;
+    stats.ATVRAfter         = static_cast<f32>(missesAfter) / static_cast<f32>(usedCount);
+    stats.FetchedBytesAfter = AnalyzeVertexFetch(indices, stats.Vertices, sizeof(MeshVertex));
+    stats.VertexBytesAfter  = static_cast<u64>(stats.Vertices) * sizeof(MeshVertex);
+    stats.OptimizeMS        = timer.GetElapsedMilliseconds();
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(const std::span<u32> indices, const u32 vertexCount)
+{
+    static const ScoreTables tables;
+
+    const u32 triangleCount = static_cast<u32>(indices.size() / 3);
+    if (triangleCount < 2)
+        return;
+
+    // Each vertex's triangles, as a range of one array. The first remaining[vertex] of each range are the triangles
+    // not yet emitted.
+    std::vector<u32> remaining(vertexCount, 0);
+    for (const u32 index : indices)
+    {
+        MP_CHECK(index < vertexCount, "Index {} is past the end of the vertices", index);
+        remaining[index]++;
+    }
+    std::vector<u32> offsets(vertexCount + 1, 0);
+    for (u32 vertex = 0; vertex < vertexCount; vertex++)
+        offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+    std::vector<u32> adjacency(triangleCount * 3);
+    {
+        std::vector<u32> cursor(offsets.begin(), offsets.end() - 1);
+        for (u32 i = 0; i < triangleCount * 3; i++)
+            adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    std::vector<u32> cachePosition(vertexCount, Invalid);
+    std::vector<f32> vertexScore(vertexCount);
+    std::vector<f32> triangleScore(triangleCount, 0.0f);
+    std::vector<u8>  emitted(triangleCount, 0);
+    for (u32 vertex = 0; vertex < vertexCount; vertex++)
+        vertexScore[vertex] = tables.Score(Invalid, remaining[vertex]);
+    u32 best = 0;
+    for (u32 triangle = 0; triangle < triangleCount; triangle++)
+    {
+        for (u32 corner = 0; corner < 3; corner++)
+            triangleScore[triangle] += vertexScore[indices[triangle * 3 + corner]];
+        if (triangleScore[triangle] > triangleScore[best])
+            best = triangle;
+    }
+
+    // The triangle's vertices go to the front of the cache; the three that might fall off the end are kept long
+    // enough to take their scores down.
+    std::array<u32, ScoreCacheSize + 3> cache;
+    std::array<u32, ScoreCacheSize + 3> newCache;
+    u32                                 cacheCount = 0;
+    u32                                 scan       = 0;
+    std::vector<u32>                    output;
+    output.reserve(triangleCount * 3);
+    for (u32 emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        // Nothing in the cache has triangles left, so carry on from the next triangle in the original order.
+        if (best == Invalid)
+        {
+            while (emitted[scan])
+                scan++;
+            best = scan;
+        }
+
+        const u32* triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = 1;
+
+        u32 newCount = 0;
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            const u32 vertex = triangle[corner];
+            u32*      list   = &adjacency[offsets[vertex]];
+            for (u32 i = 0; i < remaining[vertex]; i++)
+            {
+                if (list[i] == best)
+                {
+                    std::swap(list[i], list[remaining[vertex] - 1]);
+                    break;
+                }
+            }
+            remaining[vertex]--;
+
+            if (std::find(newCache.begin(), newCache.begin() + newCount, vertex) == newCache.begin() + newCount)
+                newCache[newCount++] = vertex;
+        }
+        for (u32 i = 0; i < cacheCount && newCount < newCache.size(); i++)
+        {
+            if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                newCache[newCount++] = cache[i];
+        }
+
+        // Rescore everything that moved (including what fell off the end), and pick the best triangle that uses
+        // something still in the cache.
+        for (u32 i = 0; i < newCount; i++)
+        {
+            const u32 vertex      = newCache[i];
+            cachePosition[vertex] = i < ScoreCacheSize ? i : Invalid;
+            const f32 score       = tables.Score(cachePosition[vertex], remaining[vertex]);
+            const f32 delta       = score - vertexScore[vertex];
+            vertexScore[vertex]   = score;
+            for (u32 j = 0; j < remaining[vertex]; j++)
+                triangleScore[adjacency[offsets[vertex] + j]] += delta;
+        }
+
+        cacheCount = std::min(newCount, ScoreCacheSize);
+        std::copy_n(newCache.begin(), cacheCount, cache.begin());
+        best          = Invalid;
+        f32 bestScore = -1.0f;
+        for (u32 i = 0; i < cacheCount; i++)
+        {
+            const u32 vertex = cache[i];
+            for (u32 j = 0; j < remaining[vertex]; j++)
+            {
+                const u32 candidate = adjacency[offsets[vertex] + j];
+                if (triangleScore[candidate] > bestScore)
+                {
+                    best      = candidate;
+                    bestScore = triangleScore[candidate];
+                }
+            }
+        }
+    }
+
+    std::ranges::copy(output, indices.begin());
+}
+
+u32 MeshOptimizer::OptimizeVertexFetch(std::vector<MeshVertex>& vertices, const std::span<u32> indices)
+{
+    std::vector<u32>        remap(vertices.size(), Invalid);
+    std::vector<MeshVertex> reordered;
+    reordered.reserve(vertices.size());
+    for (u32& index : indices)
+    {
+        MP_CHECK(index < vertices.size(), "Index {} is past the end of the vertices", index);
+        if (remap[index] == Invalid)
+        {
+            remap[index] = static_cast<u32>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+    return static_cast<u32>(vertices.size());
+}
+
+MeshQuantization MeshOptimizer::Quantize(const std::span<const MeshVertex> vertices,
+                                         std::vector<QuantizedMeshVertex>& quantized, MeshOptimizationStats* stats,
+                                         const std::span<const u32> indices)
+{
+    Stopwatch timer;
+    quantized.resize(vertices.size());
+    if (vertices.empty())
+        return {};
+
+    glm::vec3 min = vertices[0].Position;
+    glm::vec3 max = vertices[0].Position;
+    for (const MeshVertex& vertex : vertices)
+    {
+        min = glm::min(min, vertex.Position);
+        max = glm::max(max, vertex.Position);
+    }
+
+    // A flat axis still needs a scale to divide by; everything on it quantises to 0, which is exact.
+    MeshQuantization quantization;
+    quantization.Offset = min;
+    quantization.Scale  = glm::max(max - min, glm::vec3(std::numeric_limits<f32>::min()));
+
+    f32 positionError = 0.0f;
+    f32 normalError   = 0.0f;
+    f32 uvError       = 0.0f;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const MeshVertex&    vertex = vertices[i];
+        QuantizedMeshVertex& result = quantized[i];
+
+        const glm::vec3 unit = glm::clamp((vertex.Position - min) / quantization.Scale, 0.0f, 1.0f);
+        result.Position      = glm::u16vec4(glm::u16vec3(glm::round(unit * 65535.0f)), 0);
+        result.Normal        = EncodeOctahedral(vertex.Normal);
+        result.UV            = {glm::packHalf1x16(vertex.UV.x), glm::packHalf1x16(vertex.UV.y)};
+        if (!stats)
+            continue;
+
+        // Errors as the shader sees them: through GL's normalised conversions.
+        const glm::vec3 position = min + glm::vec3(glm::vec3(result.Position) / 65535.0f) * quantization.Scale;
+        const glm::vec2 uv       = {glm::unpackHalf1x16(result.UV.x), glm::unpackHalf1x16(result.UV.y)};
+        positionError            = std::max(positionError, glm::compMax(glm::abs(position - vertex.Position)));
+        uvError                  = std::max(uvError, glm::compMax(glm::abs(uv - vertex.UV)));
+        if (glm::dot(vertex.Normal, vertex.Normal) > 0.0f)
+        {
+            const f32 cosine = glm::dot(glm::normalize(vertex.Normal), DecodeOctahedral(result.Normal));
+            normalError      = std::max(normalError, glm::degrees(std::acos(std::clamp(cosine, -1.0f, 1.0f))));
+        }
+    }
+
+    if (stats)
+    {
+        stats->MaxPositionError = positionError;
+        stats->MaxNormalError   = normalError;
+        stats->MaxUVError       = uvError;
+        stats->VertexBytesAfter = quantized.size() * sizeof(QuantizedMeshVertex);
+        if (!indices.empty())
+        {
+            stats->FetchedBytesAfter = AnalyzeVertexFetch(indices, static_cast<u32>(quantized.size()),
+                                                          sizeof(QuantizedMeshVertex));
+        }
+        stats->QuantizeMS = timer.GetElapsedMilliseconds();
+    }
+    return quantization;
+}
+
+u32 MeshOptimizer::AnalyzeVertexCache(const std::span<const u32> indices, const u32 vertexCount, const u32 cacheSize)
+{
+    // A FIFO by timestamps: a vertex is still cached if fewer than cacheSize misses have happened since its own.
+    std::vector<u32> missedAt(vertexCount, 0);
+    u32              time   = cacheSize + 1;
+    u32              misses = 0;
+    for (const u32 index : indices)
+    {
+        MP_CHECK(index < vertexCount, "Index {} is past the end of the vertices", index);
+        if (time - missedAt[index] > cacheSize)
+        {
+            missedAt[index] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+u64 MeshOptimizer::AnalyzeVertexFetch(const std::span<const u32> indices, const u32 vertexCount, const u32 vertexSize)
+{
+    // A FIFO of 64 lines (4KB), like the small vertex fetch caches in front of L2.
+    constexpr u32 lineSize  = 64;
+    constexpr u32 lineCount = 64;
+
+    std::vector<u32> missedAt(static_cast<size_t>(vertexCount) * vertexSize / lineSize + 2, 0);
+    u32              time    = lineCount + 1;
+    u64              fetched = 0;
+    for (const u32 index : indices)
+    {
+        MP_CHECK(index < vertexCount, "Index {} is past the end of the vertices", index);
+        const u64 start = static_cast<u64>(index) * vertexSize;
+        for (u64 line = start / lineSize; line <= (start + vertexSize - 1) / lineSize; line++)
+        {
+            if (time - missedAt[line] > lineCount)
+            {
+                missedAt[line]  = time++;
+                fetched        += lineSize;
+            }
+        }
+    }
+    return fetched;
+}
+
+glm::i16vec2 MeshOptimizer::EncodeOctahedral(const glm::vec3 normal)
+{
+    // Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals onto the square.
+    const f32 length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.0f)
+        return {0, 0};
+
+    glm::vec2 encoded = glm::vec2(normal) / length;
+    if (normal.z < 0.0f)
+    {
+        const glm::vec2 sign = {encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f};
+        encoded              = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * sign;
+    }
+    return glm::i16vec2(glm::round(glm::clamp(encoded, -1.0f, 1.0f) * 32767.0f));
+}
+
+glm::vec3 MeshOptimizer::DecodeOctahedral(const glm::i16vec2 encoded)
+{
+    const glm::vec2 unit   = glm::max(glm::vec2(encoded) / 32767.0f, -1.0f);
+    glm::vec3       normal = {unit, 1.0f - std::abs(unit.x) - std::abs(unit.y)};
+    const f32       fold   = std::max(-normal.z, 0.0f);
+    normal.x               += normal.x >= 0.0f ? -fold : fold;
+    normal.y               += normal.y >= 0.0f ? -fold : fold;
+    return glm::normalize(normal);
+}
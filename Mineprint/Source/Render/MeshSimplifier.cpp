@@ -0,0 +1,705 @@
+#include "mppch.h"
+
+#include "Render/MeshSimplifier.h"
+
+#include "Render/MeshOptimizer.h"
+
+#include <queue>
+
+namespace
+{
+    constexpr u32 Invalid = ~0u;
+
+    bool IndicesInRange(const std::span<const u32> indices, const size_t vertexCount)
+    {
+        return std::ranges::all_of(indices, [vertexCount](const u32 index) { return index < vertexCount; });
+    }
+
+    // The weighted sum of squared distances to a set of planes, as the 10 unique entries of a symmetric 4x4 matrix;
+    // adding two adds their planes. Divided by the total weight, it's the mean squared distance. Kept in doubles, as
+    // evaluating one cancels large terms.
+    struct Quadric
+    {
+        f64 XX     = 0;
+        f64 XY     = 0;
+        f64 XZ     = 0;
+        f64 XW     = 0;
+        f64 YY     = 0;
+        f64 YZ     = 0;
+        f64 YW     = 0;
+        f64 ZZ     = 0;
+        f64 ZW     = 0;
+        f64 WW     = 0;
+        f64 Weight = 0;
+
+        // The plane is the points p with dot(normal, p) + distance = 0; normal must be unit length.
+        void AddPlane(const glm::dvec3& normal, const f64 distance, const f64 weight)
+        {
+            XX     += weight * normal.x * normal.x;
+            XY     += weight * normal.x * normal.y;
+            XZ     += weight * normal.x * normal.z;
+            XW     += weight * normal.x * distance;
+            YY     += weight * normal.y * normal.y;
+            YZ     += weight * normal.y * normal.z;
+            YW     += weight * normal.y * distance;
+            ZZ     += weight * normal.z * normal.z;
+            ZW     += weight * normal.z * distance;
+            WW     += weight * distance * distance;
+            Weight += weight;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            XX     += other.XX;
+            XY     += other.XY;
+            XZ     += other.XZ;
+            XW     += other.XW;
+            YY     += other.YY;
+            YZ     += other.YZ;
+            YW     += other.YW;
+            ZZ     += other.ZZ;
+            ZW     += other.ZW;
+            WW     += other.WW;
+            Weight += other.Weight;
+            return *this;
+        }
+
+        NODISCARD f64 Evaluate(const glm::dvec3& point) const
+        {
+            const f64 x     = point.x;
+            const f64 y     = point.y;
+            const f64 z     = point.z;
+            const f64 error = XX * x * x + YY * y * y + ZZ * z * z + WW
+                              + 2.0 * (XY * x * y + XZ * x * z + YZ * y * z + XW * x + YW * y + ZW * z);
+            return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+        }
+    };
+
+    // The squared distance from a point to the closest point on a triangle (Ericson, "Real-Time Collision Detection").
+    f64 DistanceSquared(const glm::dvec3& point, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c)
+    {
+        const glm::dvec3 ab = b - a;
+        const glm::dvec3 ac = c - a;
+        const glm::dvec3 ap = point - a;
+        const f64        d1 = glm::dot(ab, ap);
+        const f64        d2 = glm::dot(ac, ap);
+        if (d1 <= 0.0 && d2 <= 0.0)
+            return glm::dot(ap, ap);
+
+        const glm::dvec3 bp = point - b;
+        const f64        d3 = glm::dot(ab, bp);
+        const f64        d4 = glm::dot(ac, bp);
+        if (d3 >= 0.0 && d4 <= d3)
+            return glm::dot(bp, bp);
+
+        const glm::dvec3 cp = point - c;
+        const f64        d5 = glm::dot(ab, cp);
+        const f64        d6 = glm::dot(ac, cp);
+        if (d6 >= 0.0 && d5 <= d6)
+            return glm::dot(cp, cp);
+
+        glm::dvec3 closest;
+        const f64  vc = d1 * d4 - d3 * d2;
+        const f64  vb = d5 * d2 - d1 * d6;
+        const f64  va = d3 * d6 - d5 * d4;
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+            closest = a + ab * (d1 / (d1 - d3));
+        else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+            closest = a + ac * (d2 / (d2 - d6));
+        else if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+            closest = b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        else
+            closest = a + ab * (vb / (va + vb + vc)) + ac * (vc / (va + vb + vc));
+        return glm::dot(point - closest, point - closest);
+    }
+
+    void AddUnique(std::vector<u32>& values, const u32 value)
+    {
+        if (std::ranges::find(values, value) == values.end())
+            values.push_back(value);
+    }
+
+    // The simplifier's state for one set of triangles. It's progressive: Collapse() can be called again with smaller
+    // targets, and Write() the triangles left after each, which is how a LOD chain is built in one run.
+    class EdgeCollapser
+    {
+    public:
+        EdgeCollapser(std::span<const MeshVertex> vertices, std::span<const u32> indices, f32 borderWeight);
+
+        // Collapses edges until at most targetIndexCount indices are left, or the quadrics put the next collapse past
+        // maxError.
+        void Collapse(u32 targetIndexCount, f32 maxError);
+        // Writes the triangles left, as indices into the vertices, and returns their error.
+        f32 Write(std::vector<u32>& result);
+
+        NODISCARD u32 GetCollapses() const { return m_Collapses; }
+        NODISCARD u32 GetRejected() const { return m_Rejected; }
+
+    private:
+        // A position's cheapest collapse: moving every vertex there onto a neighbouring position, with the error it
+        // would add. Whenever something changes around a position it's queued again, with a new version, so older
+        // entries are stale.
+        struct Candidate
+        {
+            f64 Cost;
+            u32 From;
+            u32 To;
+            u32 Version;
+
+            bool operator>(const Candidate& other) const { return Cost > other.Cost; }
+        };
+
+        // Collapsing onto an existing position (rather than the quadric's optimum) is what keeps the vertices shared.
+        NODISCARD f64 GetCost(const u32 from, const u32 to) const
+        {
+            Quadric sum  = m_Quadrics[from];
+            sum         += m_Quadrics[to];
+            return sum.Evaluate(m_Positions[to]);
+        }
+
+        NODISCARD f64 GetDistanceSquared(const glm::dvec3& point, const u32 triangle) const
+        {
+            const std::array<u32, 3>& corners = m_Triangles[triangle];
+            return DistanceSquared(point, m_Positions[m_PositionOf[corners[0]]], m_Positions[m_PositionOf[corners[1]]],
+                                   m_Positions[m_PositionOf[corners[2]]]);
+        }
+
+        // With checkValid, queues the cheapest collapse that CanCollapse() allows, rather than just the cheapest.
+        void Queue(u32 position, bool checkValid);
+        bool CanCollapse(u32 from, u32 to);
+        void Apply(u32 from, u32 to);
+        void GetNeighbours(u32 position, u32 except, std::vector<u32>& neighbours) const;
+
+        // Vertices are numbered locally, sorted by position.
+        std::vector<u32>                 m_Used;
+        std::vector<u32>                 m_PositionOf;
+        std::vector<glm::dvec3>          m_Positions;
+        std::vector<Quadric>             m_Quadrics;
+        std::vector<std::array<u32, 3>>  m_Triangles; // Of local vertices.
+        std::vector<std::vector<u32>>    m_Around;    // The triangles around each position (some maybe collapsed).
+        std::vector<u8>                  m_Alive;
+        std::vector<u8>                  m_Removed;
+        std::vector<u32>                 m_Versions;
+        std::vector<u32>                 m_CollapsedInto;
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> m_Queue;
+        u32                              m_LiveTriangles = 0;
+        u32                              m_Collapses     = 0;
+        u32                              m_Rejected      = 0;
+
+        // Scratch space. Wedges are each vertex at From, and the one at To it becomes.
+        std::vector<std::pair<u32, u32>> m_Wedges;
+        std::vector<u32>                 m_Opposite;
+        std::vector<u32>                 m_FromNeighbours;
+        std::vector<u32>                 m_ToNeighbours;
+        std::vector<u32>                 m_Neighbours;
+        std::vector<u32>                 m_Requeue;
+        std::vector<std::pair<f64, u32>> m_Costs;
+    };
+
+    EdgeCollapser::EdgeCollapser(const std::span<const MeshVertex> vertices, const std::span<const u32> indices,
+                                 const f32 borderWeight)
+    {
+        std::vector<u32> local(vertices.size(), Invalid);
+        std::vector<u32> order;
+        for (const u32 index : indices)
+        {
+            MP_ASSERT(index < vertices.size(), "Index is outside the mesh's vertices");
+            if (local[index] == Invalid)
+            {
+                local[index] = 0;
+                order.push_back(index);
+            }
+        }
+
+        // Vertices the same in every attribute are welded into one, however the mesh was built (BlockBench models give
+        // every face its own), and the rest are grouped by position: a collapse moves a position, and every vertex
+        // there with it.
+        auto vertexLess = [&](const u32 a, const u32 b)
+        {
+            const MeshVertex& first  = vertices[a];
+            const MeshVertex& second = vertices[b];
+            if (first.Position != second.Position)
+            {
+                return std::tie(first.Position.x, first.Position.y, first.Position.z)
+                       < std::tie(second.Position.x, second.Position.y, second.Position.z);
+            }
+            return std::memcmp(&first.Normal, &second.Normal, sizeof(MeshVertex) - offsetof(MeshVertex, Normal)) < 0;
+        };
+        std::ranges::sort(order, vertexLess);
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (i == 0 || vertexLess(order[i - 1], order[i]))
+            {
+                const glm::vec3& position = vertices[order[i]].Position;
+                if (i == 0 || position != vertices[order[i - 1]].Position)
+                    m_Positions.emplace_back(position);
+                m_Used.push_back(order[i]);
+                m_PositionOf.push_back(static_cast<u32>(m_Positions.size() - 1));
+            }
+            local[order[i]] = static_cast<u32>(m_Used.size() - 1);
+        }
+
+        // Each triangle's plane goes into the quadrics of its corners, weighted by its area.
+        m_Quadrics.resize(m_Positions.size());
+        m_Around.resize(m_Positions.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const std::array<u32, 3> corners = {local[indices[i]], local[indices[i + 1]], local[indices[i + 2]]};
+            const std::array<u32, 3> at      = {
+                m_PositionOf[corners[0]], m_PositionOf[corners[1]], m_PositionOf[corners[2]]
+            };
+            if (at[0] == at[1] || at[1] == at[2] || at[0] == at[2])
+                continue; // Degenerate; it draws nothing.
+
+            const glm::dvec3 normal = glm::cross(m_Positions[at[1]] - m_Positions[at[0]],
+                                                 m_Positions[at[2]] - m_Positions[at[0]]);
+            const f64 length = glm::length(normal);
+            if (length > 0.0)
+            {
+                Quadric          plane;
+                const glm::dvec3 unit = normal / length;
+                plane.AddPlane(unit, -glm::dot(unit, m_Positions[at[0]]), length * 0.5);
+                for (const u32 position : at)
+                    m_Quadrics[position] += plane;
+            }
+
+            for (const u32 position : at)
+                m_Around[position].push_back(static_cast<u32>(m_Triangles.size()));
+            m_Triangles.push_back(corners);
+        }
+
+        // Edges only one triangle has are boundaries. Planes through them, perpendicular to their triangle, hold them
+        // where they are, both in towards the hole and along the surface.
+        struct Edge
+        {
+            u32 A;
+            u32 B;
+            u32 Triangle;
+
+            auto operator<=>(const Edge& other) const = default;
+        };
+        std::vector<Edge> edges;
+        edges.reserve(m_Triangles.size() * 3);
+        for (u32 triangle = 0; triangle < m_Triangles.size(); triangle++)
+        {
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                const u32 a = m_PositionOf[m_Triangles[triangle][corner]];
+                const u32 b = m_PositionOf[m_Triangles[triangle][(corner + 1) % 3]];
+                edges.push_back({std::min(a, b), std::max(a, b), triangle});
+            }
+        }
+        std::ranges::sort(edges);
+
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t end = i + 1;
+            while (end < edges.size() && edges[end].A == edges[i].A && edges[end].B == edges[i].B)
+                end++;
+
+            const Edge& edge = edges[i];
+            if (end - i == 1)
+            {
+                const std::array<u32, 3>& corners = m_Triangles[edge.Triangle];
+                const glm::dvec3&         first   = m_Positions[m_PositionOf[corners[0]]];
+                const glm::dvec3          normal  = glm::cross(m_Positions[m_PositionOf[corners[1]]] - first,
+                                                               m_Positions[m_PositionOf[corners[2]]] - first);
+                const glm::dvec3          along   = m_Positions[edge.B] - m_Positions[edge.A];
+                const glm::dvec3          outward = glm::cross(along, normal);
+                const f64                 length  = glm::length(outward);
+                if (length > 0.0)
+                {
+                    Quadric          plane;
+                    const glm::dvec3 unit = outward / length;
+                    plane.AddPlane(unit, -glm::dot(unit, m_Positions[edge.A]), glm::dot(along, along) * borderWeight);
+                    m_Quadrics[edge.A] += plane;
+                    m_Quadrics[edge.B] += plane;
+                }
+            }
+
+            i = end;
+        }
+
+        m_Alive         = std::vector<u8>(m_Triangles.size(), 1);
+        m_Removed       = std::vector<u8>(m_Positions.size(), 0);
+        m_Versions      = std::vector<u32>(m_Positions.size(), 0);
+        m_CollapsedInto = std::vector<u32>(m_Positions.size(), Invalid);
+        m_LiveTriangles = static_cast<u32>(m_Triangles.size());
+        for (u32 position = 0; position < m_Positions.size(); position++)
+            Queue(position, false);
+    }
+
+    void EdgeCollapser::Collapse(const u32 targetIndexCount, const f32 maxError)
+    {
+        const f64 maxCost = static_cast<f64>(maxError) * maxError;
+        while (m_LiveTriangles * 3 > targetIndexCount && !m_Queue.empty() && m_Queue.top().Cost <= maxCost)
+        {
+            const Candidate candidate = m_Queue.top();
+            m_Queue.pop();
+            if (m_Removed[candidate.From] || candidate.Version != m_Versions[candidate.From])
+                continue;
+
+            // If its cheapest collapse isn't allowed, its next cheapest that is can still come up in order, as it
+            // costs at least as much.
+            if (CanCollapse(candidate.From, candidate.To))
+                Apply(candidate.From, candidate.To);
+            else
+                Queue(candidate.From, true);
+        }
+    }
+
+    void EdgeCollapser::Queue(const u32 position, const bool checkValid)
+    {
+        m_Versions[position]++;
+        GetNeighbours(position, Invalid, m_Neighbours);
+        m_Costs.clear();
+        for (const u32 neighbour : m_Neighbours)
+            m_Costs.emplace_back(GetCost(position, neighbour), neighbour);
+        std::ranges::sort(m_Costs);
+
+        for (const auto& [cost, neighbour] : m_Costs)
+        {
+            if (!checkValid || CanCollapse(position, neighbour))
+            {
+                m_Queue.push({cost, position, neighbour, m_Versions[position]});
+                return;
+            }
+        }
+    }
+
+    bool EdgeCollapser::CanCollapse(const u32 from, const u32 to)
+    {
+        // Every vertex at From needs exactly one vertex at To that it shares a triangle with, to become; otherwise
+        // the collapse would drag attributes across a seam.
+        m_Wedges.clear();
+        m_Opposite.clear();
+        bool valid = true;
+        for (const u32 triangle : m_Around[from])
+        {
+            if (!m_Alive[triangle])
+                continue;
+
+            u32 fromCorner = Invalid;
+            u32 toCorner   = Invalid;
+            u32 other      = Invalid;
+            for (const u32 corner : m_Triangles[triangle])
+            {
+                const u32 position = m_PositionOf[corner];
+                if (position == from)
+                    fromCorner = corner;
+                else if (position == to)
+                    toCorner = corner;
+                else
+                    other = position;
+            }
+            if (toCorner == Invalid)
+                continue;
+
+            AddUnique(m_Opposite, other);
+            const auto wedge = std::ranges::find(m_Wedges, fromCorner, &std::pair<u32, u32>::first);
+            if (wedge == m_Wedges.end())
+                m_Wedges.emplace_back(fromCorner, toCorner);
+            else
+                valid &= wedge->second == toCorner;
+        }
+        if (m_Opposite.empty())
+            return false; // They're no longer joined.
+
+        // The triangles that move mustn't flip (or turn nearly edge on), and vertices at From must all be mapped.
+        for (const u32 triangle : m_Around[from])
+        {
+            if (!valid)
+                break;
+            if (!m_Alive[triangle])
+                continue;
+
+            const std::array<u32, 3>& corners = m_Triangles[triangle];
+            std::array<glm::dvec3, 3> before;
+            std::array<glm::dvec3, 3> after;
+            bool                      shared = false;
+            for (u32 i = 0; i < 3; i++)
+            {
+                const u32 position = m_PositionOf[corners[i]];
+                shared            |= position == to;
+                before[i]          = m_Positions[position];
+                after[i]           = position == from ? m_Positions[to] : before[i];
+                if (position == from)
+                    valid &= std::ranges::find(m_Wedges, corners[i], &std::pair<u32, u32>::first) != m_Wedges.end();
+            }
+            if (shared)
+                continue;
+
+            const glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::dvec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+            valid &= glm::dot(normalBefore, normalAfter) > 0.2 * glm::length(normalBefore) * glm::length(normalAfter);
+        }
+
+        // The link condition: the only positions joined to both ends are the ones across the triangles that go.
+        // Otherwise the collapse would pinch the surface into a non-manifold edge.
+        if (valid)
+        {
+            GetNeighbours(from, to, m_FromNeighbours);
+            GetNeighbours(to, from, m_ToNeighbours);
+            const size_t common = std::ranges::count_if(m_FromNeighbours, [&](const u32 position)
+            {
+                return std::ranges::find(m_ToNeighbours, position) != m_ToNeighbours.end();
+            });
+            valid = common == m_Opposite.size();
+        }
+
+        m_Rejected += !valid;
+        return valid;
+    }
+
+    void EdgeCollapser::Apply(const u32 from, const u32 to)
+    {
+        for (const u32 triangle : m_Around[from])
+        {
+            if (!m_Alive[triangle])
+                continue;
+
+            std::array<u32, 3>& corners = m_Triangles[triangle];
+            if (std::ranges::any_of(corners, [&](const u32 corner) { return m_PositionOf[corner] == to; }))
+            {
+                m_Alive[triangle] = 0;
+                m_LiveTriangles--;
+                continue;
+            }
+            for (u32& corner : corners)
+            {
+                if (m_PositionOf[corner] == from)
+                    corner = std::ranges::find(m_Wedges, corner, &std::pair<u32, u32>::first)->second;
+            }
+            m_Around[to].push_back(triangle);
+        }
+        std::erase_if(m_Around[to], [&](const u32 triangle) { return !m_Alive[triangle]; });
+        m_Around[from]         = {};
+        m_Quadrics[to]        += m_Quadrics[from];
+        m_Removed[from]        = 1;
+        m_CollapsedInto[from]  = to;
+        m_Collapses++;
+
+        // To's quadric has grown, and its neighbours' collapses onto it cost more.
+        GetNeighbours(to, Invalid, m_Requeue);
+        Queue(to, false);
+        for (const u32 neighbour : m_Requeue)
+            Queue(neighbour, false);
+    }
+
+    void EdgeCollapser::GetNeighbours(const u32 position, const u32 except, std::vector<u32>& neighbours) const
+    {
+        neighbours.clear();
+        for (const u32 triangle : m_Around[position])
+        {
+            if (!m_Alive[triangle])
+                continue;
+            for (const u32 corner : m_Triangles[triangle])
+            {
+                if (m_PositionOf[corner] != position && m_PositionOf[corner] != except)
+                    AddUnique(neighbours, m_PositionOf[corner]);
+            }
+        }
+    }
+
+    f32 EdgeCollapser::Write(std::vector<u32>& result)
+    {
+        // The quadrics only measure the error at the vertices, which misses how far the new triangles cut across
+        // what was there (they'd say a coarse sphere is perfect). The error is measured instead: from each position
+        // collapsed away to the nearest triangle left. That's found by walking from the triangles around the position
+        // it ended up in to whichever triangle sharing a corner is nearer, until none are; it's always nearby.
+        f64 error = 0.0;
+        for (u32 position = 0; position < m_Positions.size(); position++)
+        {
+            if (!m_Removed[position])
+                continue;
+
+            u32 into = m_CollapsedInto[position];
+            while (m_Removed[into])
+                into = m_CollapsedInto[into];
+            m_CollapsedInto[position] = into;
+
+            const glm::dvec3& point   = m_Positions[position];
+            f64               nearest = glm::dot(point - m_Positions[into], point - m_Positions[into]);
+            u32               closest = Invalid;
+            for (const u32 triangle : m_Around[into])
+            {
+                const f64 distance = m_Alive[triangle] ? GetDistanceSquared(point, triangle) : nearest;
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    closest = triangle;
+                }
+            }
+            for (u32 previous = Invalid; closest != previous;)
+            {
+                previous = closest;
+                for (const u32 corner : m_Triangles[previous])
+                {
+                    for (const u32 triangle : m_Around[m_PositionOf[corner]])
+                    {
+                        const f64 distance = m_Alive[triangle] ? GetDistanceSquared(point, triangle) : nearest;
+                        if (distance < nearest)
+                        {
+                            nearest = distance;
+                            closest = triangle;
+                        }
+                    }
+                }
+            }
+            error = std::max(error, nearest);
+        }
+
+        result.clear();
+        result.reserve(static_cast<size_t>(m_LiveTriangles) * 3);
+        for (u32 triangle = 0; triangle < m_Triangles.size(); triangle++)
+        {
+            if (m_Alive[triangle])
+            {
+                for (const u32 corner : m_Triangles[triangle])
+                    result.push_back(m_Used[corner]);
+            }
+        }
+        return static_cast<f32>(std::sqrt(error));
+    }
+}
+
+f32 MeshSimplifier::Simplify(const std::span<const MeshVertex> vertices, const std::span<const u32> indices,
+                             const u32 targetIndexCount, const f32 maxError, const f32 borderWeight,
+                             std::vector<u32>& result, MeshSimplificationStats* stats)
+{
+    result.clear();
+    if (!IndicesInRange(indices, vertices.size()))
+    {
+        MP_ERROR("Can't simplify a mesh with indices outside its {} vertices", vertices.size());
+        return 0.0f;
+    }
+
+    EdgeCollapser collapser(vertices, indices, borderWeight);
+    collapser.Collapse(targetIndexCount, maxError);
+    const f32 error = collapser.Write(result);
+    if (stats)
+    {
+        stats->Collapses += collapser.GetCollapses();
+        stats->Rejected  += collapser.GetRejected();
+    }
+    return error;
+}
+
+std::vector<MeshLOD> MeshSimplifier::BuildLODs(const MeshSimplifierSpecification& spec,
+                                               const std::span<const MeshVertex> vertices, std::vector<u32>& indices,
+                                               const std::span<const SubMesh> subMeshes,
+                                               MeshSimplificationStats* stats)
+{
+    Stopwatch            timer;
+    std::vector<MeshLOD> lods;
+    if (vertices.empty())
+        return lods;
+
+    glm::vec3 boundsMin = vertices[0].Position;
+    glm::vec3 boundsMax = vertices[0].Position;
+    for (const MeshVertex& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.Position);
+        boundsMax = glm::max(boundsMax, vertex.Position);
+    }
+    const f32 maxError = spec.MaxError * glm::distance(boundsMin, boundsMax);
+
+    size_t previousCount = 0;
+    for (const SubMesh& subMesh : subMeshes)
+    {
+        if (static_cast<u64>(subMesh.FirstIndex) + subMesh.IndexCount > indices.size()
+            || subMesh.BaseVertex > vertices.size()
+            || !IndicesInRange(std::span<const u32>(indices).subspan(subMesh.FirstIndex, subMesh.IndexCount),
+                               vertices.size() - subMesh.BaseVertex))
+        {
+            MP_ERROR("Can't build LODs for a submesh outside its mesh ({} indices from {}, base vertex {})",
+                     subMesh.IndexCount, subMesh.FirstIndex, subMesh.BaseVertex);
+            return lods;
+        }
+        previousCount += subMesh.IndexCount;
+    }
+
+    // Each submesh is simplified in one progressive run, with its triangles written out as it passes each LOD's
+    // target. The LODs are then put together a level at a time.
+    std::vector<std::vector<std::vector<u32>>> levels(subMeshes.size());
+    std::vector<std::vector<f32>>              errors(subMeshes.size());
+    for (size_t i = 0; i < subMeshes.size(); i++)
+    {
+        const SubMesh&                    subMesh     = subMeshes[i];
+        const std::span<const MeshVertex> subVertices = vertices.subspan(subMesh.BaseVertex);
+        EdgeCollapser                     collapser(subVertices,
+                                                    std::span<const u32>(indices).subspan(subMesh.FirstIndex,
+                                                                                          subMesh.IndexCount),
+                                                    spec.BorderWeight);
+        levels[i].resize(spec.MaxLODs);
+        for (u32 level = 0; level < spec.MaxLODs; level++)
+        {
+            const f32 ratio  = std::pow(spec.Ratio, static_cast<f32>(level + 1));
+            const u32 target = static_cast<u32>(static_cast<f32>(subMesh.IndexCount / 3) * ratio) * 3;
+            collapser.Collapse(target, maxError);
+            errors[i].push_back(collapser.Write(levels[i][level]));
+            if (spec.OptimizeVertexCache)
+                MeshOptimizer::OptimizeVertexCache(levels[i][level], static_cast<u32>(subVertices.size()));
+        }
+
+        if (stats)
+        {
+            stats->Collapses += collapser.GetCollapses();
+            stats->Rejected  += collapser.GetRejected();
+        }
+    }
+
+    for (u32 level = 0; level < spec.MaxLODs; level++)
+    {
+        MeshLOD lod;
+        size_t  count = 0;
+        for (size_t i = 0; i < subMeshes.size(); i++)
+        {
+            lod.SubMeshes.push_back({
+                .FirstIndex    = static_cast<u32>(indices.size() + count),
+                .IndexCount    = static_cast<u32>(levels[i][level].size()),
+                .BaseVertex    = subMeshes[i].BaseVertex,
+                .MaterialIndex = subMeshes[i].MaterialIndex
+            });
+            lod.Error  = std::max(lod.Error, errors[i][level]);
+            count     += levels[i][level].size();
+        }
+
+        // The quadrics can underestimate, so a LOD can end up past the error allowed even though collapsing stopped.
+        if (count == 0 || static_cast<f32>(count) > static_cast<f32>(previousCount) * spec.MinReduction
+            || lod.Error > maxError)
+            break;
+
+        for (size_t i = 0; i < subMeshes.size(); i++)
+            indices.insert(indices.end(), levels[i][level].begin(), levels[i][level].end());
+        previousCount = count;
+        lods.push_back(std::move(lod));
+    }
+
+    if (stats)
+    {
+        stats->LODs        = static_cast<u32>(lods.size());
+        stats->SimplifyMS += timer.GetElapsedMilliseconds();
+    }
+    return lods;
+}
+
+f32 MeshSimplifier::GetPixelsPerUnit(const glm::mat4& projection, const f32 viewDepth, const f32 viewportHeight)
+{
+    // Clip space Y is projection[1][1] times view space Y, over W: the view depth with a perspective projection, and
+    // 1 with an orthographic one (whose bottom row is 0, 0, 0, 1).
+    const f32 w = projection[3][3] == 1.0f ? 1.0f : std::max(viewDepth, 1e-4f);
+    return projection[1][1] * 0.5f * viewportHeight / w;
+}
+
+u32 MeshSimplifier::SelectLOD(const std::span<const MeshLOD> lods, const f32 pixelsPerUnit, const f32 maxPixelError)
+{
+    u32 selected = 0;
+    for (u32 i = 0; i < lods.size(); i++)
+    {
+        if (lods[i].Error * pixelsPerUnit <= maxPixelError)
+            selected = i + 1;
+    }
+    return selected;
+}
@@ -0,0 +1,226 @@
+#include "mppch.h"
+
+#include "Render/PixelReadback.h"
+
+#include "Render/Framebuffer.h"
+
+// Free pixel buffers kept for reuse. Past this, the oldest are deleted as others are released.
+static constexpr size_t MaxFreeBuffers = 16;
+
+// GL's rows start at the bottom; everything else expects them to start at the top.
+static void FlipRows(std::vector<u8>& pixels, const glm::ivec2& size)
+{
+    const size_t rowSize = static_cast<size_t>(size.x) * 4;
+    std::vector<u8> row(rowSize);
+    for (s32 y = 0; y < size.y / 2; y++)
+    {
+        u8* top    = pixels.data() + static_cast<size_t>(y) * rowSize;
+        u8* bottom = pixels.data() + static_cast<size_t>(size.y - 1 - y) * rowSize;
+        memcpy(row.data(), top, rowSize);
+        memcpy(top, bottom, rowSize);
+        memcpy(bottom, row.data(), rowSize);
+    }
+}
+
+PixelReadback::~PixelReadback()
+{
+    Shutdown();
+}
+
+void PixelReadback::Init(GPUResources& resources)
+{
+    m_Resources = &resources;
+}
+
+void PixelReadback::Shutdown()
+{
+    for (PendingRead& read : m_Pending)
+    {
+        glDeleteSync(read.Fence);
+        m_FreeBuffers.push_back(read.Buffer);
+    }
+    m_Pending.clear();
+
+    for (const PixelBuffer& buffer : m_FreeBuffers)
+        m_Resources->Destroy(buffer.Buffer);
+    m_FreeBuffers.clear();
+
+    std::lock_guard lock(m_CompletedMutex);
+    m_Completed.clear();
+    m_Stats.Pending      = 0;
+    m_Stats.PixelBuffers = 0;
+}
+
+void PixelReadback::Request(const u64 id, const Framebuffer& source)
+{
+    MP_ASSERT(source.IsValid(), "Reading back an invalid framebuffer");
+    MP_ASSERT(source.GetSpecification().ColourFormat == GL_RGBA8, "Only RGBA8 framebuffers can be read back");
+
+    const glm::ivec2 size      = source.GetSize();
+    const u64        byteCount = static_cast<u64>(size.x) * size.y * 4;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source.GetReadFramebuffer());
+
+    if (m_Synchronous)
+    {
+        Stopwatch      timer;
+        ReadbackResult result = {.ID = id, .Size = size};
+        result.Pixels.resize(byteCount);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, result.Pixels.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        FlipRows(result.Pixels, size);
+
+        {
+            std::lock_guard lock(m_CompletedMutex);
+            m_Stats.Requests++;
+            m_Stats.BlockedMS += timer.GetElapsedMilliseconds();
+        }
+        AddCompleted(std::move(result));
+        return;
+    }
+
+    // With a pack buffer bound, glReadPixels just queues a copy into it.
+    PendingRead read = {.ID = id, .Size = size, .Buffer = AcquireBuffer(byteCount)};
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_Resources->Get(read.Buffer.Buffer));
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    read.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_Pending.push_back(read);
+
+    std::lock_guard lock(m_CompletedMutex);
+    m_Stats.Requests++;
+    m_Stats.Pending = GetPendingCount();
+}
+
+u32 PixelReadback::Poll()
+{
+    u32 completed = 0;
+    for (PendingRead& read : m_Pending)
+        read.Polls++;
+
+    // Fences signal in order, so we can stop at the first one that hasn't.
+    while (!m_Pending.empty())
+    {
+        PendingRead& read = m_Pending.front();
+        // Flushing makes sure the fence has actually been submitted; when we're headless, nothing else does.
+        const GLenum status = glClientWaitSync(read.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+            break;
+        if (status == GL_WAIT_FAILED)
+            MP_ERROR("Waiting for readback {} failed", read.ID);
+
+        Complete(read);
+        m_Pending.pop_front();
+        completed++;
+    }
+
+    std::lock_guard lock(m_CompletedMutex);
+    m_Stats.Pending = GetPendingCount();
+    return completed;
+}
+
+void PixelReadback::Flush()
+{
+    if (m_Pending.empty())
+        return;
+
+    Stopwatch timer;
+    for (PendingRead& read : m_Pending)
+    {
+        GLenum status;
+        do
+            status = glClientWaitSync(read.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms at a time.
+        while (status == GL_TIMEOUT_EXPIRED);
+        Complete(read);
+    }
+    m_Pending.clear();
+
+    std::lock_guard lock(m_CompletedMutex);
+    m_Stats.Pending   = 0;
+    m_Stats.BlockedMS += timer.GetElapsedMilliseconds();
+}
+
+std::vector<ReadbackResult> PixelReadback::TakeCompleted()
+{
+    std::lock_guard             lock(m_CompletedMutex);
+    std::vector<ReadbackResult> completed;
+    completed.swap(m_Completed);
+    return completed;
+}
+
+ReadbackStats PixelReadback::GetStats()
+{
+    std::lock_guard lock(m_CompletedMutex);
+    return m_Stats;
+}
+
+PixelReadback::PixelBuffer PixelReadback::AcquireBuffer(const u64 size)
+{
+    // The smallest free buffer that's big enough.
+    auto best = m_FreeBuffers.end();
+    for (auto it = m_FreeBuffers.begin(); it != m_FreeBuffers.end(); ++it)
+    {
+        if (it->Capacity >= size && (best == m_FreeBuffers.end() || it->Capacity < best->Capacity))
+            best = it;
+    }
+
+    if (best != m_FreeBuffers.end())
+    {
+        const PixelBuffer buffer = *best;
+        m_FreeBuffers.erase(best);
+        return buffer;
+    }
+
+    const PixelBuffer buffer = {.Buffer = m_Resources->CreateBuffer(), .Capacity = size};
+    glNamedBufferStorage(m_Resources->Get(buffer.Buffer), static_cast<GLsizeiptr>(size), nullptr, GL_MAP_READ_BIT);
+
+    std::lock_guard lock(m_CompletedMutex);
+    m_Stats.PixelBuffers++;
+    return buffer;
+}
+
+void PixelReadback::Complete(PendingRead& read)
+{
+    const size_t rowSize   = static_cast<size_t>(read.Size.x) * 4;
+    const size_t byteCount = rowSize * read.Size.y;
+
+    ReadbackResult result = {.ID = read.ID, .Size = read.Size, .FramesWaited = read.Polls};
+    result.Pixels.resize(byteCount);
+
+    const GLuint buffer = m_Resources->Get(read.Buffer.Buffer);
+    const auto*  mapped = static_cast<const u8*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(byteCount),
+                                                                       GL_MAP_READ_BIT));
+    if (mapped)
+    {
+        // Flipped as we copy, as GL's rows start at the bottom.
+        for (s32 y = 0; y < read.Size.y; y++)
+            memcpy(result.Pixels.data() + y * rowSize, mapped + (read.Size.y - 1 - y) * rowSize, rowSize);
+        glUnmapNamedBuffer(buffer);
+    }
+    else
+        MP_ERROR("Failed to map the pixel buffer for readback {}", read.ID);
+
+    glDeleteSync(read.Fence);
+    read.Fence = nullptr;
+
+    m_FreeBuffers.push_back(read.Buffer);
+    if (m_FreeBuffers.size() > MaxFreeBuffers)
+    {
+        m_Resources->Destroy(m_FreeBuffers.front().Buffer);
+        m_FreeBuffers.erase(m_FreeBuffers.begin());
+        std::lock_guard lock(m_CompletedMutex);
+        m_Stats.PixelBuffers--;
+    }
+
+    AddCompleted(std::move(result));
+}
+
+void PixelReadback::AddCompleted(ReadbackResult&& result)
+{
+    std::lock_guard lock(m_CompletedMutex);
+    m_Stats.Completed++;
+    m_Stats.AverageWaitFrames += (result.FramesWaited - m_Stats.AverageWaitFrames) /
+                                 static_cast<f64>(m_Stats.Completed);
+    m_Completed.push_back(std::move(result));
+}
@@ -0,0 +1,248 @@
+#include "mppch.h"
+
+#include "Render/RenderQueue.h"
+
+// Below this many packets, std::stable_sort beats clearing and walking the radix histograms.
+static constexpr size_t RadixSortThreshold = 64;
+
+u64 RenderSortKey::Make(RenderPass pass, u16 shader, u16 material, f32 depth)
+{
+    const u64 quantisedDepth = static_cast<u64>(std::clamp(depth, 0.0f, 1.0f) * static_cast<f32>(DepthMax));
+    const u64 passBits       = static_cast<u64>(pass) << 56;
+
+    if (pass == RenderPass::Transparent)
+        return passBits | (DepthMax - quantisedDepth) << 32 | static_cast<u64>(shader) << 16 | material;
+
+    return passBits | static_cast<u64>(shader) << 40 | static_cast<u64>(material) << 24 | quantisedDepth;
+}
+
+RenderQueue& RenderQueue::operator=(const RenderQueue& other)
+{
+    if (this == &other)
+        return *this;
+
+    // assign() reuses our existing capacity.
+    m_Packets.assign(other.m_Packets.begin(), other.m_Packets.end());
+    m_Order.assign(other.m_Order.begin(), other.m_Order.end());
+    m_StreamData.assign(other.m_StreamData.begin(), other.m_StreamData.end());
+    m_Sorted = other.m_Sorted;
+    m_Stats  = other.m_Stats;
+    return *this;
+}
+
+void RenderQueue::Submit(const DrawPacket& packet)
+{
+    MP_ASSERT(packet.TextureCount <= DrawPacket::MaxTextures, "Too many textures ({})", packet.TextureCount);
+    MP_ASSERT(packet.ParamCount <= DrawPacket::MaxParams, "Too many draw params ({})", packet.ParamCount);
+    m_Packets.push_back(packet);
+    m_Sorted = false;
+}
+
+void RenderQueue::Reserve(u32 packetCount)
+{
+    m_Packets.reserve(packetCount);
+}
+
+StreamRange RenderQueue::AllocateStream(u32 size, u32 alignment)
+{
+    MP_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+    MP_ASSERT(alignment <= StreamAlignment, "Stream data can't be aligned to more than {} bytes", StreamAlignment);
+
+    const u32 offset = (static_cast<u32>(m_StreamData.size()) + alignment - 1) & ~(alignment - 1);
+    m_StreamData.resize(offset + size);
+    return {.Offset = offset, .Data = m_StreamData.data() + offset};
+}
+
+u32 RenderQueue::WriteStream(const void* data, u32 size, u32 alignment)
+{
+    const StreamRange range = AllocateStream(size, alignment);
+    memcpy(range.Data, data, size);
+    return range.Offset;
+}
+
+void RenderQueue::Clear()
+{
+    m_Packets.clear();
+    m_Order.clear();
+    m_StreamData.clear();
+    m_Sorted = true;
+}
+
+void RenderQueue::Sort()
+{
+    if (m_Sorted)
+        return;
+
+    m_Entries.resize(m_Packets.size());
+    for (u32 i = 0; i < m_Packets.size(); i++)
+        m_Entries[i] = {m_Packets[i].SortKey, i};
+
+    if (m_Entries.size() < RadixSortThreshold)
+        std::ranges::stable_sort(m_Entries, {}, &SortEntry::Key);
+    else
+        RadixSort(m_Entries, m_Scratch);
+
+    m_Order.resize(m_Entries.size());
+    for (size_t i = 0; i < m_Entries.size(); i++)
+        m_Order[i] = m_Entries[i].Index;
+
+    m_Sorted = true;
+}
+
+void RenderQueue::Execute(GLStateCache& stateCache, const StreamAllocation& stream)
+{
+    Stopwatch timer;
+    m_Stats.Reset();
+    stateCache.ResetStats();
+
+    Sort();
+    m_Stats.SortMS = timer.GetElapsedMilliseconds();
+
+    for (const u32 index : m_Order)
+    {
+        const DrawPacket& packet = m_Packets[index];
+        if (packet.UsesStream() && !stream.IsValid())
+        {
+            m_Stats.SkippedDraws++;
+            continue;
+        }
+
+        stateCache.SetRenderState(packet.State);
+        stateCache.UseProgram(packet.Program);
+        for (u32 unit = 0; unit < packet.TextureCount; unit++)
+            stateCache.BindTexture(unit, packet.Textures[unit]);
+        stateCache.BindVertexArray(packet.VertexArray);
+
+        // Pointing the VAO at this frame's stream data is cheap with DSA, and the VAO stays bound. Its own bindings are
+        // put back after the draw, so packets that share the VAO without streaming still draw from its buffers.
+        const StreamBindings previous = packet.UsesStream() ? SaveStreamBindings(packet) : StreamBindings();
+        if (packet.StreamVertexOffset != DrawPacket::NoStream)
+        {
+            glVertexArrayVertexBuffer(packet.VertexArray, 0, stream.Buffer,
+                                      static_cast<GLintptr>(stream.Offset + packet.StreamVertexOffset),
+                                      static_cast<GLsizei>(packet.StreamVertexStride));
+        }
+
+        u64 indexOffset = 0;
+        if (packet.StreamIndexOffset != DrawPacket::NoStream)
+        {
+            glVertexArrayElementBuffer(packet.VertexArray, stream.Buffer);
+            indexOffset = stream.Offset + packet.StreamIndexOffset;
+        }
+
+        if (packet.ParamCount > 0)
+        {
+            glUniform4fv(0, packet.ParamCount, &packet.Params[0].x);
+            m_Stats.ParamUploads++;
+        }
+
+        Draw(packet, indexOffset);
+        m_Stats.DrawCalls++;
+
+        if (packet.UsesStream())
+            RestoreStreamBindings(packet, previous);
+    }
+
+    m_Stats.Packets     = GetPacketCount();
+    m_Stats.StreamBytes = static_cast<u32>(m_StreamData.size());
+    m_Stats.State       = stateCache.GetStats();
+    m_Stats.ExecuteMS   = timer.GetElapsedMilliseconds();
+}
+
+void RenderQueue::RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+    constexpr u32 digitCount = sizeof(u64);
+    const size_t  count      = entries.size();
+    if (count == 0)
+        return;
+    scratch.resize(count);
+
+    // One read of the keys builds the histograms for every digit.
+    std::array<std::array<u32, 256>, digitCount> histograms = {};
+    for (const SortEntry& entry : entries)
+    {
+        for (u32 digit = 0; digit < digitCount; digit++)
+            histograms[digit][(entry.Key >> (digit * 8)) & 0xFF]++;
+    }
+
+    SortEntry* source      = entries.data();
+    SortEntry* destination = scratch.data();
+    for (u32 digit = 0; digit < digitCount; digit++)
+    {
+        std::array<u32, 256>& histogram = histograms[digit];
+
+        // Every key has the same value for this digit, so this pass wouldn't move anything.
+        if (histogram[(source[0].Key >> (digit * 8)) & 0xFF] == count)
+            continue;
+
+        // Counts to offsets.
+        u32 offset = 0;
+        for (u32& bucket : histogram)
+        {
+            const u32 bucketCount = bucket;
+            bucket                = offset;
+            offset                += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const u32 bucket                 = (source[i].Key >> (digit * 8)) & 0xFF;
+            destination[histogram[bucket]++] = source[i];
+        }
+
+        std::swap(source, destination);
+    }
+
+    // An odd number of passes leaves the result in the scratch buffer.
+    if (source != entries.data())
+        entries.swap(scratch);
+}
+
+RenderQueue::StreamBindings RenderQueue::SaveStreamBindings(const DrawPacket& packet)
+{
+    StreamBindings bindings;
+    if (packet.StreamVertexOffset != DrawPacket::NoStream)
+    {
+        GLint buffer = 0;
+        glGetVertexArrayIndexediv(packet.VertexArray, 0, GL_VERTEX_BINDING_BUFFER, &buffer);
+        glGetVertexArrayIndexed64iv(packet.VertexArray, 0, GL_VERTEX_BINDING_OFFSET, &bindings.VertexOffset);
+        glGetVertexArrayIndexediv(packet.VertexArray, 0, GL_VERTEX_BINDING_STRIDE, &bindings.VertexStride);
+        bindings.VertexBuffer = static_cast<GLuint>(buffer);
+    }
+    if (packet.StreamIndexOffset != DrawPacket::NoStream)
+    {
+        GLint buffer = 0;
+        glGetVertexArrayiv(packet.VertexArray, GL_ELEMENT_ARRAY_BUFFER_BINDING, &buffer);
+        bindings.ElementBuffer = static_cast<GLuint>(buffer);
+    }
+    return bindings;
+}
+
+void RenderQueue::RestoreStreamBindings(const DrawPacket& packet, const StreamBindings& bindings)
+{
+    if (packet.StreamVertexOffset != DrawPacket::NoStream)
+    {
+        glVertexArrayVertexBuffer(packet.VertexArray, 0, bindings.VertexBuffer,
+                                  static_cast<GLintptr>(bindings.VertexOffset), bindings.VertexStride);
+    }
+    if (packet.StreamIndexOffset != DrawPacket::NoStream)
+        glVertexArrayElementBuffer(packet.VertexArray, bindings.ElementBuffer);
+}
+
+void RenderQueue::Draw(const DrawPacket& packet, u64 indexOffset)
+{
+    if (packet.IndexType == GL_NONE)
+    {
+        glDrawArraysInstancedBaseInstance(packet.Primitive, static_cast<GLint>(packet.First),
+                                          static_cast<GLsizei>(packet.Count),
+                                          static_cast<GLsizei>(packet.InstanceCount), packet.BaseInstance);
+        return;
+    }
+
+    const size_t indexSize = packet.IndexType == GL_UNSIGNED_INT ? 4 : packet.IndexType == GL_UNSIGNED_SHORT ? 2 : 1;
+    glDrawElementsInstancedBaseVertexBaseInstance(packet.Primitive, static_cast<GLsizei>(packet.Count),
+                                                  packet.IndexType,
+                                                  reinterpret_cast<const void*>(indexOffset + packet.First * indexSize),
+                                                  static_cast<GLsizei>(packet.InstanceCount), packet.BaseVertex,
+                                                  packet.BaseInstance);
+}
@@ -0,0 +1,234 @@
+#include "mppch.h"
+
+#include "Render/RenderThread.h"
+#include "Render/Renderer.h"
+#include "Render/Window.h"
+
+#include <backends/imgui_impl_opengl3.h>
+
+// Weight of the newest sample in the stats' moving averages.
+static constexpr f64 StatsSmoothing = 0.05;
+
+static void UpdateAverage(f64& average, f64 sample, u64 sampleCount)
+{
+    average = sampleCount == 0 ? sample : average + (sample - average) * StatsSmoothing;
+}
+
+template <typename T>
+static void CopyImVector(ImVector<T>& destination, const ImVector<T>& source)
+{
+    // ImVector's copy assignment frees and reallocates; resize() keeps the existing capacity.
+    destination.resize(source.Size);
+    if (source.Size > 0)
+        memcpy(destination.Data, source.Data, source.size_in_bytes());
+}
+
+RenderThread::Frame::~Frame()
+{
+    for (ImDrawList* drawList : DrawLists)
+        IM_DELETE(drawList);
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+bool RenderThread::Start(const RenderThreadSpecification& spec)
+{
+    MP_ASSERT(!IsRunning(), "Render thread already running");
+    MP_ASSERT(spec.TargetWindow && spec.TargetRenderer, "Render thread needs a window and a renderer");
+
+    m_Spec = spec;
+
+    const u32 slotCount = std::max(m_Spec.MaxFramesInFlight, 1u);
+    m_Frames.clear();
+    for (u32 i = 0; i < slotCount; i++)
+        m_Frames.push_back(CreateScope<Frame>());
+
+    m_ReadIndex     = 0;
+    m_WriteIndex    = 0;
+    m_QueuedFrames  = 0;
+    m_FramesDone    = 0;
+    m_StopRequested = false;
+    m_Stats.Reset();
+
+    // A GL context can only be current on one thread at a time.
+    m_Spec.TargetWindow->ReleaseGLContext();
+    m_Thread = std::thread(&RenderThread::RenderLoop, this);
+
+    MP_INFO("Started render thread ({} frames in flight)", slotCount);
+    return true;
+}
+
+void RenderThread::Stop()
+{
+    if (!IsRunning())
+        return;
+
+    {
+        std::lock_guard lock(m_QueueMutex);
+        m_StopRequested = true;
+    }
+    m_FrameQueued.notify_all();
+
+    // The render thread finishes everything that's queued, then releases the context.
+    m_Thread.join();
+    m_Spec.TargetWindow->SetGLContextCurrent();
+
+    m_Frames.clear();
+    MP_INFO("Stopped render thread after {} frames", m_Stats.FramesPresented);
+}
+
+void RenderThread::Submit(const ImDrawData* drawData, const RenderQueue& queue, const glm::ivec2& viewportSize,
+                          u64 frameStartNS)
+{
+    MP_ASSERT(IsRunning(), "Render thread isn't running");
+
+    const u64 waitStart = SDL_GetTicksNS();
+    Frame*    frame     = nullptr;
+    {
+        std::unique_lock lock(m_QueueMutex);
+        m_FrameFinished.wait(lock, [this] { return m_QueuedFrames < m_Frames.size(); });
+        frame = m_Frames[m_WriteIndex].get();
+    }
+    const f64 waitMS = static_cast<f64>(SDL_GetTicksNS() - waitStart) / static_cast<f64>(SDL_NS_PER_MS);
+
+    // The write slot isn't visible to the render thread until it's queued, so we can fill it without the lock.
+    const bool synchronous = HasPendingTextureUpdates(drawData);
+    CopyDrawData(*frame, drawData, synchronous);
+    frame->Queue        = queue; // Plain data, and the slot's vectors keep their capacity.
+    frame->ViewportSize = viewportSize;
+    frame->StartNS      = frameStartNS;
+
+    u64 ticket = 0;
+    {
+        std::lock_guard lock(m_QueueMutex);
+        UpdateAverage(m_Stats.AverageSubmitWaitMS, waitMS, m_FramesDone + m_QueuedFrames);
+        m_WriteIndex = (m_WriteIndex + 1) % static_cast<u32>(m_Frames.size());
+        m_QueuedFrames++;
+        ticket = m_FramesDone + m_QueuedFrames;
+        if (synchronous)
+            m_Stats.SynchronousFrames++;
+    }
+    m_FrameQueued.notify_one();
+
+    if (synchronous)
+    {
+        // The backend updates ImGui's textures while rendering, so the main thread can't start the next frame
+        // (which may touch them) until it's done.
+        std::unique_lock lock(m_QueueMutex);
+        m_FrameFinished.wait(lock, [this, ticket] { return m_FramesDone >= ticket; });
+    }
+}
+
+void RenderThread::Flush()
+{
+    if (!IsRunning())
+        return;
+
+    std::unique_lock lock(m_QueueMutex);
+    m_FrameFinished.wait(lock, [this] { return m_QueuedFrames == 0; });
+}
+
+RenderThreadStats RenderThread::GetStats()
+{
+    std::lock_guard lock(m_QueueMutex);
+    return m_Stats;
+}
+
+u32 RenderThread::GetQueuedFrameCount()
+{
+    std::lock_guard lock(m_QueueMutex);
+    return m_QueuedFrames;
+}
+
+void RenderThread::RenderLoop()
+{
+    m_Spec.TargetWindow->SetGLContextCurrent();
+
+    while (true)
+    {
+        Frame* frame = nullptr;
+        {
+            std::unique_lock lock(m_QueueMutex);
+            m_FrameQueued.wait(lock, [this] { return m_QueuedFrames > 0 || m_StopRequested; });
+            if (m_QueuedFrames == 0)
+                break; // Stop requested, and everything's been rendered.
+            frame = m_Frames[m_ReadIndex].get();
+        }
+
+        const u64 renderStart = SDL_GetTicksNS();
+        m_Spec.TargetRenderer->Render(frame->ViewportSize, frame->Queue);
+        ImGui_ImplOpenGL3_RenderDrawData(&frame->DrawData);
+        const u64 renderEnd = SDL_GetTicksNS();
+
+        m_Spec.TargetRenderer->Present();
+        const u64 presentEnd = SDL_GetTicksNS();
+
+        {
+            std::lock_guard lock(m_QueueMutex);
+            const f64 renderMS  = static_cast<f64>(renderEnd - renderStart) / static_cast<f64>(SDL_NS_PER_MS);
+            const f64 latencyMS = static_cast<f64>(presentEnd - frame->StartNS) / static_cast<f64>(SDL_NS_PER_MS);
+            UpdateAverage(m_Stats.AverageRenderMS, renderMS, m_Stats.FramesPresented);
+            UpdateAverage(m_Stats.AverageLatencyMS, latencyMS, m_Stats.FramesPresented);
+            m_Stats.MaxLatencyMS = std::max(m_Stats.MaxLatencyMS, latencyMS);
+            m_Stats.FramesPresented++;
+
+            m_ReadIndex = (m_ReadIndex + 1) % static_cast<u32>(m_Frames.size());
+            m_QueuedFrames--;
+            m_FramesDone++;
+        }
+        m_FrameFinished.notify_all();
+    }
+
+    m_Spec.TargetWindow->ReleaseGLContext();
+}
+
+void RenderThread::CopyDrawData(Frame& frame, const ImDrawData* drawData, bool withTextures)
+{
+    // Copied field by field rather than with ImDrawData's copy assignment, so CmdLists keeps its allocation.
+    ImDrawData& copy      = frame.DrawData;
+    copy.Valid            = drawData->Valid;
+    copy.CmdListsCount    = drawData->CmdListsCount;
+    copy.TotalIdxCount    = drawData->TotalIdxCount;
+    copy.TotalVtxCount    = drawData->TotalVtxCount;
+    copy.DisplayPos       = drawData->DisplayPos;
+    copy.DisplaySize      = drawData->DisplaySize;
+    copy.FramebufferScale = drawData->FramebufferScale;
+    copy.OwnerViewport    = drawData->OwnerViewport;
+    // The backend only looks at the texture list to upload changes; leave it out unless there are some, so the render
+    // thread never reads it while the main thread is modifying it.
+    copy.Textures = withTextures ? drawData->Textures : nullptr;
+
+    copy.CmdLists.resize(drawData->CmdListsCount);
+    for (s32 i = 0; i < drawData->CmdListsCount; i++)
+    {
+        if (i >= static_cast<s32>(frame.DrawLists.size()))
+            frame.DrawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+        // Only the output buffers are needed for rendering - the same things ImDrawList::CloneOutput() copies.
+        ImDrawList*       destination = frame.DrawLists[i];
+        const ImDrawList* source      = drawData->CmdLists[i];
+        CopyImVector(destination->CmdBuffer, source->CmdBuffer);
+        CopyImVector(destination->IdxBuffer, source->IdxBuffer);
+        CopyImVector(destination->VtxBuffer, source->VtxBuffer);
+        destination->Flags = source->Flags;
+
+        copy.CmdLists[i] = destination;
+    }
+}
+
+bool RenderThread::HasPendingTextureUpdates(const ImDrawData* drawData)
+{
+    if (!drawData->Textures)
+        return false;
+
+    for (const ImTextureData* texture : *drawData->Textures)
+    {
+        if (texture->Status != ImTextureStatus_OK)
+            return true;
+    }
+
+    return false;
+}
@@ -1,6 +1,7 @@
 ﻿#include "mppch.h"
 
 #include "Core/Application.h"
+#include "Core/EmbeddedContent/EmbeddedContent.h"
 #include "Render/Renderer.h"
 
 #ifndef MP_NO_IMGUI
@@ -20,19 +21,217 @@ bool Renderer::Init(const RendererSpecification& spec)
     m_Window = &m_Spec.App->GetWindow();
     MP_ASSERT(m_Window, "Window must be created before initializing the renderer");
 
-    InitOpenGL();
-
-    m_Spec.App->GetWindow().OnWindowResize.BindStatic(&Renderer::OnWindowResize);
+    // Logs why it failed.
+    if (!InitOpenGL())
+        return false;
 
     // m_Spec.App->OnDrawIMGui.BindMethod(this, &Renderer::OnDrawIMGui);
 
     return true;
 }
 
-void Renderer::Render()
+bool Renderer::InitHeadless(const RendererSpecification& spec)
+{
+    STARTUP_SCOPE("Renderer::InitHeadless");
+
+    m_Spec = spec;
+    MP_ASSERT(m_Spec.App != nullptr, "Application must be set");
+
+    // Both log why they failed.
+    if (!m_Headless.Init() || !LoadOpenGL(&HeadlessContext::GetProcAddress))
+        return false;
+    return InitResources();
+}
+
+void Renderer::BeginFrame()
+{
+    m_Queue.Clear();
+}
+
+void Renderer::Render(const glm::ivec2& viewportSize, RenderQueue& queue)
 {
+    // ImGui (and its platform windows, which have their own contexts) changed state since we last drew, so start
+    // from nothing each frame. The cache only needs to be right within a frame to be worth it.
+    m_StateCache.Invalidate();
+    m_Resources.BeginFrame();
+    UpdateShaders();
+
+    m_StreamBuffer.BeginFrame();
+    DrawOffscreenRequests();
+
+    // Set here rather than on window resize events, as the events arrive on the main thread, which doesn't own the
+    // GL context while rendering is pipelined.
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, viewportSize.x, viewportSize.y);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+
+    queue.Execute(m_StateCache, UploadStream(queue));
+    m_StreamBuffer.EndFrame();
+    m_Resources.EndFrame();
+    CollectReadbacks();
+
+    std::lock_guard lock(m_StatsMutex);
+    m_LastFrameStats    = queue.GetStats();
+    m_StreamBufferStats = m_StreamBuffer.GetStats();
+    m_ResourceStats     = m_Resources.GetStats();
+}
+
+void Renderer::RenderOffscreen()
+{
+    m_StateCache.Invalidate();
+    m_Resources.BeginFrame();
+    UpdateShaders();
+
+    m_StreamBuffer.BeginFrame();
+    DrawOffscreenRequests();
+    m_StreamBuffer.EndFrame();
+    m_Resources.EndFrame();
+    CollectReadbacks();
+
+    std::lock_guard lock(m_StatsMutex);
+    m_StreamBufferStats = m_StreamBuffer.GetStats();
+    m_ResourceStats     = m_Resources.GetStats();
+}
+
+void Renderer::SubmitOffscreen(OffscreenRequest request)
+{
+    {
+        std::lock_guard lock(m_OffscreenMutex);
+        m_OffscreenRequests.push_back(std::move(request));
+    }
+    if (m_Spec.App)
+        m_Spec.App->RequestRedraw();
+}
+
+std::vector<ReadbackResult> Renderer::TakeReadbacks()
+{
+    return m_Readback.TakeCompleted();
+}
+
+ReadbackStats Renderer::GetReadbackStats()
+{
+    return m_Readback.GetStats();
+}
+
+StreamAllocation Renderer::UploadStream(const RenderQueue& queue)
+{
+    const std::vector<u8>& streamData = queue.GetStreamData();
+    if (streamData.empty())
+        return {};
+
+    const StreamAllocation stream = m_StreamBuffer.Allocate(streamData.size(), RenderQueue::StreamAlignment);
+    if (stream.IsValid())
+        memcpy(stream.Data, streamData.data(), streamData.size());
+    else
+        MP_WARN("Render queue streamed {} KB, more than the stream buffer has left of its {} KB per frame",
+                streamData.size() / 1024, m_Spec.Stream.FrameSize / 1024);
+    return stream;
+}
+
+void Renderer::DrawOffscreenRequests()
+{
+    {
+        std::lock_guard lock(m_OffscreenMutex);
+        m_OffscreenWork.swap(m_OffscreenRequests);
+    }
+    if (m_OffscreenWork.empty())
+        return;
+
+    m_OffscreenFrame++;
+    for (OffscreenRequest& request : m_OffscreenWork)
+    {
+        Framebuffer* target = AcquireOffscreenTarget(request.Target);
+        if (!target)
+            continue; // The framebuffer logged why.
+
+        target->Bind();
+        // Clears respect the depth mask, which the last draw may have left off.
+        m_StateCache.SetRenderState({.DepthWrite = true});
+        glClearColor(request.ClearColour.r, request.ClearColour.g, request.ClearColour.b, request.ClearColour.a);
+        glClear(GL_COLOR_BUFFER_BIT | (target->GetSpecification().DepthStencil
+                                           ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT
+                                           : 0));
+
+        request.Queue.Execute(m_StateCache, UploadStream(request.Queue));
+        target->Resolve();
+        // Later requests can reuse the target straight away: the copy is queued ahead of anything drawn after it.
+        m_Readback.Request(request.ID, *target);
+    }
+    m_OffscreenWork.clear();
+}
+
+Framebuffer* Renderer::AcquireOffscreenTarget(const FramebufferSpecification& spec)
+{
+    OffscreenTarget* leastRecent = nullptr;
+    for (OffscreenTarget& target : m_OffscreenTargets)
+    {
+        if (target.Requested == spec)
+        {
+            target.LastUsedFrame = m_OffscreenFrame;
+            return target.Target.get();
+        }
+        if (!leastRecent || target.LastUsedFrame < leastRecent->LastUsedFrame)
+            leastRecent = &target;
+    }
+
+    if (m_OffscreenTargets.size() < MaxOffscreenTargets)
+        leastRecent = &m_OffscreenTargets.emplace_back(std::make_unique<Framebuffer>());
+    else
+        leastRecent->Target->Shutdown(); // Deferred, as it may still be being read back.
+
+    leastRecent->Requested     = spec;
+    leastRecent->LastUsedFrame = m_OffscreenFrame;
+    return leastRecent->Target->Init(m_Resources, spec) ? leastRecent->Target.get() : nullptr;
+}
+
+void Renderer::CollectReadbacks()
+{
+    const u32 completed = m_Readback.Poll();
+    if (!m_Spec.App)
+        return;
+
+    // Whoever asked for the pixels probably wants to show them.
+    if (completed > 0)
+        m_Spec.App->InvalidateUI();
+    // Nothing else may be asking for frames while we wait on the GPU.
+    if (m_Readback.GetPendingCount() > 0)
+        m_Spec.App->RequestRedraw();
+}
+
+void Renderer::UpdateShaders()
+{
+    if (!m_ShaderCompiler.IsRunning())
+        return;
+
+    const u32 finished = m_ShaderCompiler.Update();
+    if (!m_Spec.App)
+        return;
+
+    // Queues kept from earlier frames (see IdleFrameMode) still draw with the fallback, so rebuild them.
+    if (finished > 0)
+        m_Spec.App->InvalidateUI();
+    // The compiler can't ask for frames itself, and we only swap programs in during one.
+    if (m_ShaderCompiler.GetPendingCount() > 0)
+        m_Spec.App->RequestRedraw();
+}
+
+RenderQueueStats Renderer::GetLastFrameStats()
+{
+    std::lock_guard lock(m_StatsMutex);
+    return m_LastFrameStats;
+}
+
+StreamBufferStats Renderer::GetStreamBufferStats()
+{
+    std::lock_guard lock(m_StatsMutex);
+    return m_StreamBufferStats;
+}
+
+GPUResourceStats Renderer::GetGPUResourceStats()
+{
+    std::lock_guard lock(m_StatsMutex);
+    return m_ResourceStats;
 }
 
 void Renderer::Present()
@@ -43,10 +242,27 @@ void Renderer::Present()
 
 void Renderer::Shutdown()
 {
+    m_Readback.Shutdown();
+    m_OffscreenTargets.clear();
+    {
+        std::lock_guard lock(m_OffscreenMutex);
+        m_OffscreenRequests.clear();
+    }
+    // The canvas cancels its pending shaders, so before the compiler.
+    m_Canvas.Shutdown();
+    ShutdownShaderCompiler();
+    m_ShaderCache.Shutdown();
+    m_StreamBuffer.Shutdown();
+    // After everything that destroys objects through it, so it can wait for the GPU and delete them.
+    m_Resources.Shutdown();
+    // Last, as everything above needs it current.
+    m_Headless.Shutdown();
 }
 
 bool Renderer::InitOpenGL()
 {
+    STARTUP_SCOPE("Renderer::InitOpenGL");
+
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
@@ -62,11 +278,22 @@ bool Renderer::InitOpenGL()
     MP_CHECK(m_Window, "Window must be set");
     m_Context = m_Window->GetGLContext();
 
+    if (!LoadOpenGL(SDL_GL_GetProcAddress))
+        return false;
+    return InitResources();
+}
+
+bool Renderer::LoadOpenGL(const GLADloadfunc loader)
+{
     static bool glInitialised = false;
     if (!glInitialised)
     {
-        s32 version = gladLoadGL(SDL_GL_GetProcAddress);
-        MP_CHECK(version != 0, "Failed to load OpenGL with GLAD2.");
+        s32 version = gladLoadGL(loader);
+        if (version == 0)
+        {
+            MP_ERROR("Failed to load OpenGL with GLAD2.");
+            return false;
+        }
         glInitialised = true;
 
         MP_INFO("Initialised OpenGL v{}.{}", GLAD_VERSION_MAJOR(version), GLAD_VERSION_MINOR(version));
@@ -74,6 +301,11 @@ bool Renderer::InitOpenGL()
         MP_INFO("   OpenGL Renderer: {}", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
     }
 
+    return true;
+}
+
+bool Renderer::InitResources()
+{
     // Setup error callback
 #ifdef MP_GL_DEBUG
     glEnable(GL_DEBUG_OUTPUT);
@@ -81,17 +313,96 @@ bool Renderer::InitOpenGL()
     glDebugMessageCallback(GLErrorCallback, nullptr);
 #endif
 
+    // First, as everything below creates its GL objects through it.
+    m_Resources.Init();
+    m_Readback.Init(m_Resources);
+    if (!m_StreamBuffer.Init(m_Resources, m_Spec.Stream))
+    {
+        MP_ERROR("Failed to create the stream buffer");
+        return false;
+    }
+
+    // Not fatal: shaders are compiled every time instead.
+    if (!m_Spec.ShaderCacheDirectory.empty() && !m_ShaderCache.Init(m_Spec.ShaderCacheDirectory))
+        MP_WARN("Shader cache disabled");
+
+    {
+        STARTUP_SCOPE("Load shaders");
+        ShaderCompiler* compiler = InitShaderCompiler() ? &m_ShaderCompiler : nullptr;
+        // Not fatal: without it, canvas draws are just dropped.
+        if (!m_Canvas.Init(m_Resources, &m_ShaderCache, compiler, &m_FallbackShader))
+            MP_ERROR("Failed to initialise the canvas renderer");
+    }
+
+    const ShaderCacheStats shaderStats = m_ShaderCache.GetStats();
+    MP_INFO("Shaders: {} from the cache ({:.2f}ms), {} compiled ({:.2f}ms), {} building in the background",
+            shaderStats.Hits, shaderStats.LoadMS, shaderStats.Compiled, shaderStats.CompileMS,
+            m_ShaderCompiler.GetPendingCount());
+
     MP_INFO("Initialised renderer");
 
     return true;
 }
 
-bool Renderer::OnWindowResize(const glm::ivec2& newSize)
+bool Renderer::InitShaderCompiler()
 {
-    glViewport(0, 0, newSize.x, newSize.y);
+    // Tiny, and needed before anything can draw with it, so never built in the background.
+    const std::span<const u8> vertexSource   = EmbeddedContent::Get("Shaders/Fallback.vert");
+    const std::span<const u8> fragmentSource = EmbeddedContent::Get("Shaders/Fallback.frag");
+    // Not fatal: shaders that aren't ready yet just don't draw.
+    if (!m_FallbackShader.Init(m_Resources, {
+        .Name           = "Fallback",
+        .VertexSource   = {reinterpret_cast<const char*>(vertexSource.data()), vertexSource.size()},
+        .FragmentSource = {reinterpret_cast<const char*>(fragmentSource.data()), fragmentSource.size()},
+        .Cache          = &m_ShaderCache
+    }))
+        MP_ERROR("Failed to build the fallback shader");
+
+    if (!m_Spec.AsyncShaders)
+        return false;
+
+    ShaderCompilerSpecification compilerSpec;
+    if (IsHeadless())
+    {
+        if (!m_CompilerHeadless.InitShared(m_Headless))
+            return false;
+        compilerSpec.MakeContextCurrent = [this] { return m_CompilerHeadless.MakeCurrent(); };
+        compilerSpec.ReleaseContext     = [this] { m_CompilerHeadless.Release(); };
+    }
+    else
+    {
+        // Made current against the window, but never drawn to it with.
+        m_CompilerContext = m_Window->CreateSharedGLContext();
+        if (!m_CompilerContext)
+            return false;
+        SDL_Window* window              = m_Window->GetSDLWindow();
+        compilerSpec.MakeContextCurrent = [window, context = m_CompilerContext]
+        {
+            return SDL_GL_MakeCurrent(window, context);
+        };
+        compilerSpec.ReleaseContext = [window] { SDL_GL_MakeCurrent(window, nullptr); };
+    }
+
+    if (!m_ShaderCompiler.Init(compilerSpec))
+    {
+        MP_WARN("Building shaders synchronously");
+        ShutdownShaderCompiler();
+        return false;
+    }
     return true;
 }
 
+void Renderer::ShutdownShaderCompiler()
+{
+    m_ShaderCompiler.Shutdown();
+    // The worker has released its context by now.
+    if (m_CompilerContext)
+        SDL_GL_DestroyContext(m_CompilerContext);
+    m_CompilerContext = nullptr;
+    m_CompilerHeadless.Shutdown();
+    m_FallbackShader.Shutdown();
+}
+
 void Renderer::GLErrorCallback(GLenum        source, GLenum       type, GLuint id, GLenum severity, GLsizei length,
                                const GLchar* message, const void* userParam)
 {
@@ -0,0 +1,211 @@
+#include "mppch.h"
+
+#include "Render/Shader.h"
+
+#include "Render/ShaderCache.h"
+#include "Render/ShaderCompiler.h"
+
+Shader::~Shader()
+{
+    Shutdown();
+}
+
+bool Shader::Init(GPUResources& resources, const ShaderSpecification& spec)
+{
+    MP_CHECK(!IsValid() && !IsPending(), "Shader '{}' already initialised", m_Name);
+    if (spec.VertexSource.empty() || spec.FragmentSource.empty())
+    {
+        MP_ERROR("Shader '{}' is missing a stage", spec.Name);
+        return false;
+    }
+
+    m_Name      = spec.Name;
+    m_Resources = &resources;
+
+    ShaderBuild build;
+    BeginBuild(spec, build);
+    Adopt(FinishBuild(spec, build));
+    return IsValid();
+}
+
+bool Shader::InitAsync(GPUResources& resources, const ShaderSpecification& spec, ShaderCompiler& compiler,
+                       const Shader* fallback)
+{
+    MP_CHECK(!IsValid() && !IsPending(), "Shader '{}' already initialised", m_Name);
+    if (spec.VertexSource.empty() || spec.FragmentSource.empty())
+    {
+        MP_ERROR("Shader '{}' is missing a stage", spec.Name);
+        return false;
+    }
+
+    m_Name      = spec.Name;
+    m_Resources = &resources;
+    m_Fallback  = fallback;
+    m_Compiler  = &compiler;
+    // Set last, as the main thread reads the fallback once it sees this.
+    m_Pending = true;
+    m_JobID   = compiler.Submit(*this, spec);
+    return true;
+}
+
+void Shader::Shutdown()
+{
+    if (m_Pending)
+    {
+        m_Compiler->Cancel(m_JobID);
+        m_Pending = false;
+    }
+    m_Compiler = nullptr;
+    m_Fallback = nullptr;
+
+    if (!IsValid())
+        return;
+
+    m_Resources->Destroy(m_Handle);
+    m_Handle  = {};
+    m_Program = 0;
+}
+
+void Shader::Adopt(const GLuint program)
+{
+    if (program == 0)
+        return;
+
+    m_Handle  = m_Resources->Add<GPUResourceType::Program>(program);
+    m_Program = program;
+}
+
+void Shader::BeginBuild(const ShaderSpecification& spec, ShaderBuild& build)
+{
+    build.Timer.Restart();
+    if (spec.Cache && spec.Cache->IsEnabled())
+    {
+        build.CacheKey = spec.Cache->GetKey(spec);
+        build.Program  = spec.Cache->Load(build.CacheKey, spec.Name);
+        if (build.Program)
+        {
+            build.FromCache = true;
+            return;
+        }
+    }
+
+    std::string defines;
+    for (const std::string& define : spec.Defines)
+        defines += fmt::format("#define {}\n", define);
+
+    // Nothing here waits for the driver: statuses aren't checked until FinishBuild(), so a driver that compiles in
+    // parallel can get on with it.
+    build.Vertex   = CompileStage(GL_VERTEX_SHADER, spec.VertexSource, defines);
+    build.Fragment = CompileStage(GL_FRAGMENT_SHADER, spec.FragmentSource, defines);
+    build.Program  = glCreateProgram();
+    if (spec.Cache && spec.Cache->IsEnabled())
+        glProgramParameteri(build.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(build.Program, build.Vertex);
+    glAttachShader(build.Program, build.Fragment);
+    glLinkProgram(build.Program);
+}
+
+bool Shader::IsBuildComplete(const ShaderBuild& build)
+{
+    if (build.FromCache || (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile))
+        return true;
+
+    GLint complete = GL_FALSE;
+    glGetProgramiv(build.Program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+GLuint Shader::FinishBuild(const ShaderSpecification& spec, ShaderBuild& build)
+{
+    if (build.FromCache)
+        return std::exchange(build.Program, 0);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(build.Program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        // A stage that didn't compile is the more useful error; the link log would just say that it didn't.
+        if (CheckStage(build.Vertex, GL_VERTEX_SHADER, spec.Name) &&
+            CheckStage(build.Fragment, GL_FRAGMENT_SHADER, spec.Name))
+        {
+            GLint logLength = 0;
+            glGetProgramiv(build.Program, GL_INFO_LOG_LENGTH, &logLength);
+            std::string log(std::max(logLength, 1), '\0');
+            glGetProgramInfoLog(build.Program, logLength, nullptr, log.data());
+            MP_ERROR("Failed to link shader '{}':\n{}", spec.Name, log.c_str());
+        }
+        AbandonBuild(build);
+        return 0;
+    }
+
+    // The linked program doesn't need the stages any more.
+    const GLuint program = std::exchange(build.Program, 0);
+    glDetachShader(program, build.Vertex);
+    glDetachShader(program, build.Fragment);
+    AbandonBuild(build);
+
+    if (spec.Cache)
+    {
+        spec.Cache->RecordCompile(build.Timer.GetElapsedMilliseconds());
+        spec.Cache->Store(build.CacheKey, program);
+    }
+    return program;
+}
+
+void Shader::AbandonBuild(ShaderBuild& build)
+{
+    // Deleting 0 is ignored.
+    glDeleteShader(build.Vertex);
+    glDeleteShader(build.Fragment);
+    glDeleteProgram(build.Program);
+    build.Vertex   = 0;
+    build.Fragment = 0;
+    build.Program  = 0;
+}
+
+GLuint Shader::CompileStage(const GLenum stage, const std::string_view source, const std::string& defines)
+{
+    const GLuint shader = glCreateShader(stage);
+    if (defines.empty())
+    {
+        const GLchar* text   = source.data();
+        const GLint   length = static_cast<GLint>(source.size());
+        glShaderSource(shader, 1, &text, &length);
+    }
+    else
+    {
+        // The defines have to come after #version, which has to come first. #line keeps the driver's line numbers
+        // matching the file's.
+        const size_t           versionEnd = source.starts_with("#version") ? source.find('\n') + 1 : 0;
+        const std::string      lineReset  = fmt::format("#line {}\n", versionEnd > 0 ? 2 : 1);
+        const std::string_view parts[]    = {source.substr(0, versionEnd), defines, lineReset,
+                                             source.substr(versionEnd)};
+
+        std::array<const GLchar*, 4> texts;
+        std::array<GLint, 4>         lengths;
+        for (size_t i = 0; i < texts.size(); i++)
+        {
+            texts[i]   = parts[i].data();
+            lengths[i] = static_cast<GLint>(parts[i].size());
+        }
+        glShaderSource(shader, static_cast<GLsizei>(texts.size()), texts.data(), lengths.data());
+    }
+    glCompileShader(shader);
+    return shader;
+}
+
+bool Shader::CheckStage(const GLuint stage, const GLenum type, const std::string& name)
+{
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(stage, GL_COMPILE_STATUS, &compiled);
+    if (compiled)
+        return true;
+
+    GLint logLength = 0;
+    glGetShaderiv(stage, GL_INFO_LOG_LENGTH, &logLength);
+    std::string log(std::max(logLength, 1), '\0');
+    glGetShaderInfoLog(stage, logLength, nullptr, log.data());
+    MP_ERROR("Failed to compile {} shader for '{}':\n{}", type == GL_VERTEX_SHADER ? "vertex" : "fragment", name,
+             log.c_str());
+    return false;
+}
@@ -0,0 +1,236 @@
+#include "mppch.h"
+
+#include "Render/ShaderCache.h"
+
+#include <fstream>
+
+#include "Core/Utility/Hash.h"
+#include "Render/Shader.h"
+
+static std::string_view GetGLString(const GLenum name)
+{
+    const auto* string = reinterpret_cast<const char*>(glGetString(name));
+    return string ? string : "";
+}
+
+bool ShaderCache::Init(const std::filesystem::path& directory)
+{
+    MP_CHECK(!IsEnabled(), "Shader cache already initialised");
+
+    // Mesa only has binary formats while its own disk cache is enabled.
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0)
+    {
+        MP_WARN("The driver doesn't support program binaries, so shaders can't be cached");
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        MP_WARN("Failed to create the shader cache directory {}: {}", directory.string(), error.message());
+        return false;
+    }
+
+    m_DriverHash = Hash::Offset;
+    m_DriverHash = Hash::Field(m_DriverHash, GetGLString(GL_VENDOR));
+    m_DriverHash = Hash::Field(m_DriverHash, GetGLString(GL_RENDERER));
+    m_DriverHash = Hash::Field(m_DriverHash, GetGLString(GL_VERSION));
+    m_Directory  = directory;
+
+    MP_INFO("Shader cache: {}", m_Directory.string());
+    return true;
+}
+
+void ShaderCache::Prefetch(const std::filesystem::path& directory)
+{
+    std::unordered_map<u64, std::vector<u8>> entries;
+    u64                                      totalSize = 0;
+    std::error_code                          error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() != ".glbin")
+            continue;
+
+        // Stale entries are never cleaned up by themselves, so don't let a directory full of them fill memory.
+        const u64 size = entry.file_size(error);
+        if (error || size < sizeof(EntryHeader) || totalSize + size > PrefetchLimit)
+            continue;
+
+        std::vector<u8> bytes;
+        if (!ReadEntry(entry.path(), bytes))
+            continue;
+
+        EntryHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        totalSize += bytes.size();
+        entries.insert_or_assign(header.Key, std::move(bytes));
+    }
+
+    std::lock_guard lock(m_PrefetchMutex);
+    m_Prefetched = std::move(entries);
+}
+
+void ShaderCache::Shutdown()
+{
+    m_Directory.clear();
+    m_DriverHash = 0;
+
+    std::lock_guard lock(m_PrefetchMutex);
+    m_Prefetched.clear();
+}
+
+void ShaderCache::Clear()
+{
+    if (!IsEnabled())
+        return;
+
+    {
+        std::lock_guard lock(m_PrefetchMutex);
+        m_Prefetched.clear();
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(m_Directory, error))
+    {
+        if (entry.path().extension() == ".glbin")
+            std::filesystem::remove(entry.path(), error);
+    }
+}
+
+u64 ShaderCache::GetKey(const ShaderSpecification& spec) const
+{
+    u64 hash = m_DriverHash ^ Version;
+    hash     = Hash::Field(hash, spec.VertexSource);
+    hash     = Hash::Field(hash, spec.FragmentSource);
+    for (const std::string& define : spec.Defines)
+        hash = Hash::Field(hash, define);
+    return hash;
+}
+
+GLuint ShaderCache::Load(const u64 key, const std::string& name)
+{
+    if (!IsEnabled())
+        return 0;
+
+    Stopwatch timer;
+    auto      miss = [this](const bool rejected)
+    {
+        std::lock_guard lock(m_StatsMutex);
+        m_Stats.Misses++;
+        m_Stats.Rejected += rejected ? 1 : 0;
+        return 0u;
+    };
+
+    // Prefetched entries are only used once; the program made from one is what callers keep.
+    const std::filesystem::path path = GetEntryPath(key);
+    std::vector<u8>             entry;
+    {
+        std::lock_guard lock(m_PrefetchMutex);
+        if (const auto it = m_Prefetched.find(key); it != m_Prefetched.end())
+        {
+            entry = std::move(it->second);
+            m_Prefetched.erase(it);
+        }
+    }
+    if (entry.empty() && !ReadEntry(path, entry))
+        return miss(false);
+
+    // An entry is exactly its header and binary, so a size that disagrees with the file's is corruption.
+    EntryHeader header = {};
+    if (entry.size() >= sizeof(header))
+        memcpy(&header, entry.data(), sizeof(header));
+    if (header.Magic != Magic || header.Version != Version || header.Key != key || header.Size == 0
+        || header.Size != entry.size() - sizeof(header))
+    {
+        MP_WARN("Ignoring corrupt shader cache entry for '{}'", name);
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return miss(true);
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.Format, entry.data() + sizeof(header), static_cast<GLsizei>(header.Size));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        // Usually a driver update that kept the version string. Compiling will replace the entry.
+        MP_INFO("The driver rejected the cached binary for shader '{}'; recompiling", name);
+        glDeleteProgram(program);
+        return miss(true);
+    }
+
+    std::lock_guard lock(m_StatsMutex);
+    m_Stats.Hits++;
+    m_Stats.LoadMS += timer.GetElapsedMilliseconds();
+    return program;
+}
+
+void ShaderCache::Store(const u64 key, const GLuint program)
+{
+    if (!IsEnabled())
+        return;
+
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return;
+
+    std::vector<u8> binary(size);
+    GLenum          format = GL_NONE;
+    glGetProgramBinary(program, size, &size, &format, binary.data());
+
+    const EntryHeader header = {
+        .Magic   = Magic,
+        .Version = Version,
+        .Key     = key,
+        .Format  = format,
+        .Size    = static_cast<u32>(size)
+    };
+
+    const bool stored = FileUtil::WriteFileAtomically(GetEntryPath(key), [&](std::ofstream& file)
+    {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(binary.data()), size);
+    });
+    if (!stored)
+        return;
+
+    std::lock_guard lock(m_StatsMutex);
+    m_Stats.Stored++;
+}
+
+void ShaderCache::RecordCompile(const f64 milliseconds)
+{
+    std::lock_guard lock(m_StatsMutex);
+    m_Stats.Compiled++;
+    m_Stats.CompileMS += milliseconds;
+}
+
+ShaderCacheStats ShaderCache::GetStats()
+{
+    std::lock_guard lock(m_StatsMutex);
+    return m_Stats;
+}
+
+bool ShaderCache::ReadEntry(const std::filesystem::path& path, std::vector<u8>& bytes)
+{
+    std::error_code error;
+    const u64       size = std::filesystem::file_size(path, error);
+    std::ifstream   file(path, std::ios::binary);
+    if (error || !file.is_open())
+        return false;
+
+    bytes.resize(size);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
+    return static_cast<u64>(file.gcount()) == size;
+}
+
+std::filesystem::path ShaderCache::GetEntryPath(const u64 key) const
+{
+    return m_Directory / fmt::format("{:016X}.glbin", key);
+}
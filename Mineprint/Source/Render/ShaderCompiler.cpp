@@ -0,0 +1,230 @@
+#include "mppch.h"
+
+#include "Render/ShaderCompiler.h"
+
+ShaderCompiler::~ShaderCompiler()
+{
+    Shutdown();
+}
+
+bool ShaderCompiler::Init(const ShaderCompilerSpecification& spec)
+{
+    MP_CHECK(!IsRunning(), "Shader compiler already running");
+    MP_ASSERT(spec.MakeContextCurrent && spec.ReleaseContext, "Shader compiler needs a context");
+
+    m_Spec          = spec;
+    m_Parallel      = GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+    m_StopRequested = false;
+    m_Stats.Reset();
+    m_Stats.Parallel = m_Parallel;
+
+    // Wait to hear whether the worker got its context, so the caller can fall back to compiling synchronously.
+    std::promise<bool> started;
+    std::future<bool>  startedResult = started.get_future();
+    m_Thread                         = std::thread(&ShaderCompiler::WorkerLoop, this, std::move(started));
+    if (!startedResult.get())
+    {
+        m_Thread.join();
+        return false;
+    }
+
+    MP_INFO("Started shader compiler thread ({})",
+            m_Parallel ? "the driver compiles in parallel" : "no parallel compile support");
+    return true;
+}
+
+void ShaderCompiler::Shutdown()
+{
+    if (!IsRunning())
+        return;
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_StopRequested = true;
+    }
+    m_WorkQueued.notify_all();
+    // The worker abandons whatever it was building, then releases its context.
+    m_Thread.join();
+
+    std::lock_guard lock(m_Mutex);
+    for (const Result& result : m_Results)
+    {
+        glDeleteSync(result.Fence);
+        glDeleteProgram(result.Program);
+    }
+    m_Results.clear();
+    m_Queue.clear();
+
+    // Whatever's left will never get a program, so stop it drawing with the fallback.
+    for (const auto& [id, shader] : m_Targets)
+        shader->m_Pending = false;
+    m_Targets.clear();
+    m_Stats.Pending = 0;
+}
+
+u32 ShaderCompiler::Update()
+{
+    u32             finished = 0;
+    std::lock_guard lock(m_Mutex);
+    std::erase_if(m_Results, [this, &finished](const Result& result)
+    {
+        if (result.Fence)
+        {
+            // The worker flushed the fence, so it will signal without us flushing anything.
+            if (glClientWaitSync(result.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                return false;
+            glDeleteSync(result.Fence);
+        }
+
+        const auto target = m_Targets.find(result.ID);
+        if (target == m_Targets.end())
+        {
+            // Cancelled while it was being built.
+            glDeleteProgram(result.Program);
+            return true;
+        }
+
+        Shader& shader = *target->second;
+        shader.Adopt(result.Program);
+        shader.m_Pending = false;
+        m_Targets.erase(target);
+
+        m_Stats.Completed++;
+        m_Stats.Pending--;
+        finished++;
+        return true;
+    });
+    return finished;
+}
+
+void ShaderCompiler::WaitIdle()
+{
+    while (IsRunning() && !m_Targets.empty())
+    {
+        if (Update() > 0)
+            continue;
+
+        // Fences aren't something we can wait on alongside the results, so check again soon either way.
+        std::unique_lock lock(m_Mutex);
+        m_ResultReady.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+ShaderCompilerStats ShaderCompiler::GetStats()
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Stats;
+}
+
+u64 ShaderCompiler::Submit(Shader& shader, const ShaderSpecification& spec)
+{
+    MP_CHECK(IsRunning(), "Shader '{}' submitted to a shader compiler that isn't running", spec.Name);
+
+    // The specification's sources may not outlive this call, so the job keeps its own copies.
+    Scope<Job> job           = CreateScope<Job>();
+    job->ID                  = m_NextID++;
+    job->VertexSource        = spec.VertexSource;
+    job->FragmentSource      = spec.FragmentSource;
+    job->Spec                = spec;
+    job->Spec.VertexSource   = job->VertexSource;
+    job->Spec.FragmentSource = job->FragmentSource;
+
+    const u64 id  = job->ID;
+    m_Targets[id] = &shader;
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Queue.push_back(std::move(job));
+        m_Stats.Submitted++;
+        m_Stats.Pending++;
+    }
+    m_WorkQueued.notify_one();
+    return id;
+}
+
+void ShaderCompiler::Cancel(const u64 id)
+{
+    if (m_Targets.erase(id) == 0)
+        return;
+
+    // If the worker has already taken it, Update() deletes the program when it turns up.
+    std::lock_guard lock(m_Mutex);
+    std::erase_if(m_Queue, [id](const Scope<Job>& job) { return job->ID == id; });
+    m_Stats.Pending--;
+}
+
+void ShaderCompiler::WorkerLoop(std::promise<bool> started)
+{
+    if (!m_Spec.MakeContextCurrent())
+    {
+        MP_ERROR("Failed to make the shader compiler's context current");
+        started.set_value(false);
+        return;
+    }
+    started.set_value(true);
+
+    // Let the driver use as many threads as it likes.
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+
+    std::vector<Scope<Job>> incoming;
+    std::vector<Scope<Job>> building;
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_Mutex);
+            // With builds in flight, just pick up anything new; otherwise sleep until there's something to do.
+            if (building.empty())
+                m_WorkQueued.wait(lock, [this] { return m_StopRequested || !m_Queue.empty(); });
+            if (m_StopRequested)
+                break;
+
+            for (Scope<Job>& job : m_Queue)
+                incoming.push_back(std::move(job));
+            m_Queue.clear();
+        }
+
+        // Start everything before finishing anything, so a parallel driver has the whole batch to work on.
+        for (Scope<Job>& job : incoming)
+        {
+            Shader::BeginBuild(job->Spec, job->Build);
+            building.push_back(std::move(job));
+        }
+        incoming.clear();
+
+        std::erase_if(building, [this](const Scope<Job>& job)
+        {
+            if (!Shader::IsBuildComplete(job->Build))
+                return false;
+            Finish(*job, Shader::FinishBuild(job->Spec, job->Build));
+            return true;
+        });
+
+        // The rest are building on the driver's threads. Polling is cheap, so check back soon.
+        if (!building.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (const Scope<Job>& job : building)
+        Shader::AbandonBuild(job->Build);
+    // So the deletes have happened by the time anything else looks at the shared objects.
+    glFlush();
+    m_Spec.ReleaseContext();
+}
+
+void ShaderCompiler::Finish(Job& job, const GLuint program)
+{
+    // The program isn't safe to use from another context until the commands that built it have completed, which
+    // this tells the renderer's context.
+    const GLsync fence = program ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    glFlush();
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Results.push_back({.ID = job.ID, .Program = program, .Fence = fence});
+        m_Stats.BuildMS += job.Build.Timer.GetElapsedMilliseconds();
+        m_Stats.Failed += program ? 0 : 1;
+    }
+    m_ResultReady.notify_all();
+}
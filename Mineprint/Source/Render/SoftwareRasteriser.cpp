@@ -0,0 +1,503 @@
+#include "mppch.h"
+
+#include "Render/SoftwareRasteriser.h"
+
+#include <stb_image_write.h>
+
+#include "Core/SIMD.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Render/BlockBenchModel.h"
+#include "Render/TextureAtlas.h"
+
+namespace
+{
+    // Fewer triangles than this aren't worth a job of their own to set up.
+    constexpr u32 MinBatchTriangles = 256;
+
+    // Mesh.frag's light.
+    const glm::vec3 LightDirection = glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f));
+
+    // Twice the signed area of the triangle abp.
+    FORCEINLINE f32 Edge(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p)
+    {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    // How far inside one of the frustum's planes a clip space position is: -w <= x, x <= w, then y, then z.
+    FORCEINLINE f32 PlaneDistance(const glm::vec4& position, const u32 plane)
+    {
+        const f32 value = position[static_cast<s32>(plane / 2)];
+        return plane % 2 == 0 ? position.w + value : position.w - value;
+    }
+
+    // A bit for each plane a clip space position is outside of.
+    FORCEINLINE u32 GetOutcode(const glm::vec4& position)
+    {
+        u32 outcode = 0;
+        for (u32 plane = 0; plane < 6; plane++)
+            outcode |= static_cast<u32>(PlaneDistance(position, plane) < 0.0f) << plane;
+        return outcode;
+    }
+}
+
+void SoftwareRasteriser::Begin(const SoftwareRasteriserSpecification& spec)
+{
+    MP_CHECK(spec.Width > 0 && spec.Height > 0, "Software rasteriser's target can't be empty");
+    MP_CHECK(spec.TileSize > 0 && spec.TileSize % 4 == 0, "Software rasteriser's tiles must be a multiple of 4 wide");
+
+    m_Spec        = spec;
+    m_TilesX      = (spec.Width + spec.TileSize - 1) / spec.TileSize;
+    m_TilesY      = (spec.Height + spec.TileSize - 1) / spec.TileSize;
+    m_DepthStride = (spec.Width + 3) & ~3u;
+
+    const size_t pixels = static_cast<size_t>(spec.Width) * spec.Height;
+    m_Colours.resize(pixels * 4);
+    for (size_t i = 0; i < pixels; i++)
+        std::memcpy(&m_Colours[i * 4], &spec.ClearColour, 4);
+    m_Depths.assign(static_cast<size_t>(m_DepthStride) * spec.Height, 1.0f);
+
+    m_Draws.clear();
+    m_Stats.Reset();
+}
+
+void SoftwareRasteriser::Draw(const std::span<const MeshVertex> vertices, const std::span<const u32> indices,
+                              const std::span<const SubMesh> subMeshes, const glm::mat4& objectToClip,
+                              const TextureAtlas* atlas)
+{
+    MP_CHECK(!m_Colours.empty(), "Software rasteriser must be begun before drawing");
+
+    m_Draws.push_back({vertices, indices, subMeshes, objectToClip, atlas, 0});
+    m_Stats.Draws++;
+    for (const SubMesh& subMesh : subMeshes)
+        m_Stats.Triangles += subMesh.IndexCount / 3;
+}
+
+void SoftwareRasteriser::Draw(const BlockBenchModel& model, const glm::mat4& objectToClip, const u32 lod)
+{
+    Draw(model.GetVertices(), model.GetIndices(), model.GetLODSubMeshes(lod), objectToClip, &model.GetAtlas());
+}
+
+void SoftwareRasteriser::Render(JobSystem& jobs)
+{
+    if (m_Draws.empty())
+        return;
+
+    // Every draw's vertices into clip space, with their light.
+    Stopwatch timer;
+    u32       vertexCount = 0;
+    for (DrawCall& draw : m_Draws)
+    {
+        draw.FirstVertex  = vertexCount;
+        vertexCount      += static_cast<u32>(draw.Vertices.size());
+    }
+    m_ClipVertices.resize(vertexCount);
+    for (const DrawCall& draw : m_Draws)
+    {
+        jobs.ParallelFor(0, static_cast<u32>(draw.Vertices.size()), [&](const u32 begin, const u32 end)
+        {
+            for (u32 i = begin; i < end; i++)
+            {
+                const MeshVertex& vertex = draw.Vertices[i];
+                const f32         facing = glm::dot(glm::normalize(vertex.Normal), LightDirection);
+                ClipVertex&       clip   = m_ClipVertices[draw.FirstVertex + i];
+                clip.Position            = draw.ObjectToClip * glm::vec4(vertex.Position, 1.0f);
+                clip.UV                  = vertex.UV;
+                clip.Light               = 0.6f + 0.4f * std::max(facing, 0.0f);
+            }
+        }, 1024);
+    }
+    m_Stats.VertexMS += timer.GetElapsedMilliseconds();
+
+    // Number the triangles of every submesh, in draw order, so batches can split them evenly.
+    timer.Restart();
+    m_Runs.clear();
+    m_TriangleCount = 0;
+    for (u32 i = 0; i < m_Draws.size(); i++)
+    {
+        const DrawCall&           draw   = m_Draws[i];
+        const std::span<const u8> pixels = draw.Atlas ? draw.Atlas->GetPixels(0) : std::span<const u8>();
+        for (const SubMesh& subMesh : draw.SubMeshes)
+        {
+            const u32 triangles = subMesh.IndexCount / 3;
+            if (triangles == 0)
+                continue;
+
+            // Checked here, once, so setting up triangles never reads outside the draw's indices or vertices.
+            auto inRange = [&]
+            {
+                if (static_cast<u64>(subMesh.FirstIndex) + subMesh.IndexCount > draw.Indices.size()
+                    || subMesh.BaseVertex > draw.Vertices.size())
+                    return false;
+                const size_t vertexCount = draw.Vertices.size() - subMesh.BaseVertex;
+                return std::ranges::all_of(draw.Indices.subspan(subMesh.FirstIndex, triangles * 3),
+                                           [vertexCount](const u32 index) { return index < vertexCount; });
+            };
+            if (!inRange())
+            {
+                MP_ERROR("Skipping a submesh outside its mesh ({} indices from {}, base vertex {})",
+                         subMesh.IndexCount, subMesh.FirstIndex, subMesh.BaseVertex);
+                continue;
+            }
+
+            Run run = {
+                .Draw          = i,
+                .FirstIndex    = subMesh.FirstIndex,
+                .BaseVertex    = draw.FirstVertex + subMesh.BaseVertex,
+                .FirstTriangle = m_TriangleCount,
+                .TriangleCount = triangles,
+                .Texels        = nullptr,
+                .TextureSize   = 0
+            };
+            if (!pixels.empty() && subMesh.MaterialIndex < draw.Atlas->GetLayerCount())
+            {
+                const size_t size = draw.Atlas->GetPageSize();
+                run.Texels        = pixels.data() + size * size * 4 * subMesh.MaterialIndex;
+                run.TextureSize   = static_cast<u32>(size);
+            }
+            m_Runs.push_back(run);
+            m_TriangleCount += triangles;
+        }
+    }
+
+    // A few batches a thread, so a batch of big triangles near the camera doesn't hold up the rest.
+    const u32 tileCount  = m_TilesX * m_TilesY;
+    const u32 batchCount = std::clamp((m_TriangleCount + MinBatchTriangles - 1) / MinBatchTriangles, 1u,
+                                      jobs.GetThreadCount() * 4);
+    m_Batches.resize(batchCount);
+    for (u32 i = 0; i < batchCount; i++)
+    {
+        Batch& batch        = m_Batches[i];
+        batch.FirstTriangle = static_cast<u32>(static_cast<u64>(m_TriangleCount) * i / batchCount);
+        batch.TriangleCount = static_cast<u32>(static_cast<u64>(m_TriangleCount) * (i + 1) / batchCount)
+                              - batch.FirstTriangle;
+        batch.Triangles.clear();
+        batch.Bins.resize(tileCount);
+        for (std::vector<u32>& bin : batch.Bins)
+            bin.clear();
+        batch.Binned = 0;
+    }
+    jobs.ParallelFor(0, batchCount, [&](const u32 begin, const u32 end)
+    {
+        for (u32 i = begin; i < end; i++)
+            SetUpBatch(m_Batches[i]);
+    });
+    for (const Batch& batch : m_Batches)
+    {
+        m_Stats.SetUp  += static_cast<u32>(batch.Triangles.size());
+        m_Stats.Binned += batch.Binned;
+    }
+    m_Stats.SetupMS += timer.GetElapsedMilliseconds();
+
+    timer.Restart();
+    std::atomic<u32> pixels    = 0;
+    std::atomic<u32> discarded = 0;
+    jobs.ParallelFor(0, tileCount, [&](const u32 begin, const u32 end)
+    {
+        u32 tilePixels    = 0;
+        u32 tileDiscarded = 0;
+        for (u32 tile = begin; tile < end; tile++)
+            RasteriseTile(tile, tilePixels, tileDiscarded);
+        pixels.fetch_add(tilePixels, std::memory_order_relaxed);
+        discarded.fetch_add(tileDiscarded, std::memory_order_relaxed);
+    });
+    m_Stats.Pixels    += pixels.load();
+    m_Stats.Discarded += discarded.load();
+    m_Stats.RasterMS  += timer.GetElapsedMilliseconds();
+
+    m_Draws.clear();
+}
+
+std::vector<u8> SoftwareRasteriser::EncodePNG() const
+{
+    std::vector<u8> png;
+    if (m_Colours.empty())
+        return png;
+
+    auto write = [](void* context, void* data, const int size)
+    {
+        std::vector<u8>& out   = *static_cast<std::vector<u8>*>(context);
+        const u8*        bytes = static_cast<const u8*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    };
+    const s32 width  = static_cast<s32>(m_Spec.Width);
+    const s32 height = static_cast<s32>(m_Spec.Height);
+    if (!stbi_write_png_to_func(write, &png, width, height, 4, m_Colours.data(), width * 4))
+        png.clear();
+    return png;
+}
+
+bool SoftwareRasteriser::SavePNG(const std::filesystem::path& path) const
+{
+    const std::vector<u8> png = EncodePNG();
+    if (png.empty())
+    {
+        MP_ERROR("Failed to encode a PNG for {}", path.string());
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    if (!file)
+    {
+        MP_ERROR("Failed to write {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+void SoftwareRasteriser::SetUpBatch(Batch& batch) const
+{
+    if (batch.TriangleCount == 0)
+        return;
+
+    // The run holding the batch's first triangle; the rest follow it.
+    auto run = std::ranges::upper_bound(m_Runs, batch.FirstTriangle, {}, &Run::FirstTriangle) - 1;
+    for (u32 triangle = batch.FirstTriangle; triangle < batch.FirstTriangle + batch.TriangleCount; triangle++)
+    {
+        while (triangle >= run->FirstTriangle + run->TriangleCount)
+            ++run;
+
+        const DrawCall& draw  = m_Draws[run->Draw];
+        const u32       first = run->FirstIndex + (triangle - run->FirstTriangle) * 3;
+        const u32       end   = draw.FirstVertex + static_cast<u32>(draw.Vertices.size());
+        const u32       a     = run->BaseVertex + draw.Indices[first];
+        const u32       b     = run->BaseVertex + draw.Indices[first + 1];
+        const u32       c     = run->BaseVertex + draw.Indices[first + 2];
+        MP_ASSERT(a < end && b < end && c < end, "Mesh index out of range"); // Render() skips submeshes that aren't.
+        ClipAndSetUp(batch, *run, m_ClipVertices[a], m_ClipVertices[b], m_ClipVertices[c]);
+    }
+}
+
+void SoftwareRasteriser::ClipAndSetUp(Batch& batch, const Run& run, const ClipVertex& a, const ClipVertex& b,
+                                      const ClipVertex& c) const
+{
+    const u32 outcodeA = GetOutcode(a.Position);
+    const u32 outcodeB = GetOutcode(b.Position);
+    const u32 outcodeC = GetOutcode(c.Position);
+    if (outcodeA & outcodeB & outcodeC)
+        return; // Entirely outside one plane.
+
+    // Most triangles are entirely inside, and skip clipping. The rest are clipped against each plane they cross, one
+    // at a time, which adds at most a vertex a plane.
+    std::array<ClipVertex, 9> polygon = {a, b, c};
+    std::array<ClipVertex, 9> clipped;
+    u32                       count   = 3;
+    const u32                 crossed = outcodeA | outcodeB | outcodeC;
+    for (u32 plane = 0; plane < 6 && count >= 3; plane++)
+    {
+        if (!(crossed & (1u << plane)))
+            continue;
+
+        u32 clippedCount = 0;
+        for (u32 i = 0; i < count; i++)
+        {
+            const ClipVertex& current      = polygon[i];
+            const ClipVertex& next         = polygon[(i + 1) % count];
+            const f32         distance     = PlaneDistance(current.Position, plane);
+            const f32         nextDistance = PlaneDistance(next.Position, plane);
+            if (distance >= 0.0f)
+                clipped[clippedCount++] = current;
+            if ((distance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                const f32   t      = distance / (distance - nextDistance);
+                ClipVertex& vertex = clipped[clippedCount++];
+                vertex.Position    = glm::mix(current.Position, next.Position, t);
+                vertex.UV          = glm::mix(current.UV, next.UV, t);
+                vertex.Light       = glm::mix(current.Light, next.Light, t);
+            }
+        }
+        polygon = clipped;
+        count   = clippedCount;
+    }
+    if (count < 3)
+        return;
+
+    // To pixels, top row first as the image is stored, so y is flipped.
+    std::array<glm::vec4, 9> screen;
+    const glm::vec2          size = glm::vec2(m_Spec.Width, m_Spec.Height);
+    for (u32 i = 0; i < count; i++)
+    {
+        const glm::vec4& position = polygon[i].Position;
+        const f32        inverseW = 1.0f / position.w;
+        const glm::vec3  ndc      = glm::vec3(position) * inverseW;
+        screen[i] = {(ndc.x + 1.0f) * 0.5f * size.x, (1.0f - ndc.y) * 0.5f * size.y, ndc.z * 0.5f + 0.5f, inverseW};
+    }
+    for (u32 i = 2; i < count; i++)
+        SetUp(batch, run, {screen[0], screen[i - 1], screen[i]}, {&polygon[0], &polygon[i - 1], &polygon[i]});
+}
+
+void SoftwareRasteriser::SetUp(Batch& batch, const Run& run, const std::array<glm::vec4, 3>& screen,
+                               const std::array<const ClipVertex*, 3>& vertices) const
+{
+    const glm::vec2 p0   = screen[0];
+    const glm::vec2 p1   = screen[1];
+    const glm::vec2 p2   = screen[2];
+    const f32       area = Edge(p0, p1, p2);
+    if (area == 0.0f)
+        return;
+
+    // The pixels whose centres could be inside.
+    const glm::vec2  low  = glm::min(p0, glm::min(p1, p2)) - 0.5f;
+    const glm::vec2  high = glm::max(p0, glm::max(p1, p2)) - 0.5f;
+    const glm::vec2  last = glm::vec2(m_Spec.Width - 1, m_Spec.Height - 1);
+    const glm::ivec2 min  = glm::ivec2(glm::ceil(glm::clamp(low, glm::vec2(0.0f), last + 1.0f)));
+    const glm::ivec2 max  = glm::ivec2(glm::floor(glm::clamp(high, glm::vec2(-1.0f), last)));
+    if (min.x > max.x || min.y > max.y)
+        return;
+
+    Triangle result;
+    result.Rect        = {min.x, min.y, max.x, max.y};
+    result.Texels      = run.Texels;
+    result.TextureSize = run.TextureSize;
+
+    // Each edge function weighs the vertex opposite it. Any attribute is those weights over the area, so its plane is
+    // the edges' planes weighted by its values.
+    const glm::vec2                centre = glm::vec2(0.5f);
+    const std::array<glm::vec2, 3> points = {p0, p1, p2};
+    for (u32 i = 0; i < 3; i++)
+    {
+        const glm::vec2& from = points[(i + 1) % 3];
+        const glm::vec2& to   = points[(i + 2) % 3];
+        result.Edges[i]       = {Edge(from, to, centre), -(to.y - from.y), to.x - from.x};
+    }
+    auto interpolate = [&](const f32 a, const f32 b, const f32 c)
+    {
+        const std::array<Plane, 3>& edges = result.Edges;
+        return Plane{(edges[0].Value * a + edges[1].Value * b + edges[2].Value * c) / area,
+                     (edges[0].X * a + edges[1].X * b + edges[2].X * c) / area,
+                     (edges[0].Y * a + edges[1].Y * b + edges[2].Y * c) / area};
+    };
+    const std::array<f32, 3> w = {screen[0].w, screen[1].w, screen[2].w};
+    result.Depth    = interpolate(screen[0].z, screen[1].z, screen[2].z);
+    result.InverseW = interpolate(w[0], w[1], w[2]);
+    result.U        = interpolate(vertices[0]->UV.x * w[0], vertices[1]->UV.x * w[1], vertices[2]->UV.x * w[2]);
+    result.V        = interpolate(vertices[0]->UV.y * w[0], vertices[1]->UV.y * w[1], vertices[2]->UV.y * w[2]);
+    result.Light    = interpolate(vertices[0]->Light * w[0], vertices[1]->Light * w[1], vertices[2]->Light * w[2]);
+
+    // Either winding is drawn: flip the edges of one so the inside is positive for both.
+    if (area < 0.0f)
+    {
+        for (Plane& edge : result.Edges)
+            edge = {-edge.Value, -edge.X, -edge.Y};
+    }
+
+    // Into the bins of the tiles its bounds touch, less those where one edge has every pixel centre outside it (the
+    // corner of the tile furthest along the edge's normal is tested).
+    const u32 index    = static_cast<u32>(batch.Triangles.size());
+    const s32 tileSize = static_cast<s32>(m_Spec.TileSize);
+    bool      binned   = false;
+    for (s32 tileY = min.y / tileSize; tileY <= max.y / tileSize; tileY++)
+    {
+        const s32 y0 = std::max(tileY * tileSize, min.y);
+        const s32 y1 = std::min(tileY * tileSize + tileSize - 1, max.y);
+        for (s32 tileX = min.x / tileSize; tileX <= max.x / tileSize; tileX++)
+        {
+            const s32 x0      = std::max(tileX * tileSize, min.x);
+            const s32 x1      = std::min(tileX * tileSize + tileSize - 1, max.x);
+            bool      outside = false;
+            for (const Plane& edge : result.Edges)
+            {
+                const f32 x = static_cast<f32>(edge.X > 0.0f ? x1 : x0);
+                const f32 y = static_cast<f32>(edge.Y > 0.0f ? y1 : y0);
+                outside     = outside || edge.Value + edge.X * x + edge.Y * y < 0.0f;
+            }
+            if (outside)
+                continue;
+
+            batch.Bins[static_cast<u32>(tileY) * m_TilesX + static_cast<u32>(tileX)].push_back(index);
+            batch.Binned++;
+            binned = true;
+        }
+    }
+    if (binned)
+        batch.Triangles.push_back(result);
+}
+
+void SoftwareRasteriser::RasteriseTile(const u32 tile, u32& pixels, u32& discarded)
+{
+    const s32 tileSize = static_cast<s32>(m_Spec.TileSize);
+    const s32 tileX    = static_cast<s32>(tile % m_TilesX) * tileSize;
+    const s32 tileY    = static_cast<s32>(tile / m_TilesX) * tileSize;
+    const s32 width    = static_cast<s32>(m_Spec.Width);
+
+    const Float4 lanes  = Float4::Set(0.0f, 1.0f, 2.0f, 3.0f);
+    const Float4 zero   = Float4::Splat(0.0f);
+    const Float4 one    = Float4::Splat(1.0f);
+    const Float4 widthF = Float4::Splat(static_cast<f32>(width));
+
+    auto evaluate = [](const Plane& plane, const Float4 x, const f32 y)
+    {
+        return Float4::Splat(plane.Value + plane.Y * y) + Float4::Splat(plane.X) * x;
+    };
+
+    alignas(16) std::array<f32, 4> depths, us, vs, lights;
+    for (const Batch& batch : m_Batches)
+    {
+        for (const u32 index : batch.Bins[tile])
+        {
+            const Triangle& triangle = batch.Triangles[index];
+            // Tiles start on a multiple of four, so whole groups of four stay inside the tile.
+            const s32 x0 = std::max(triangle.Rect.x, tileX) & ~3;
+            const s32 x1 = std::min(triangle.Rect.z, tileX + tileSize - 1);
+            const s32 y0 = std::max(triangle.Rect.y, tileY);
+            const s32 y1 = std::min(triangle.Rect.w, tileY + tileSize - 1);
+            for (s32 y = y0; y <= y1; y++)
+            {
+                const f32 fy       = static_cast<f32>(y);
+                f32*      depthRow = &m_Depths[static_cast<size_t>(y) * m_DepthStride];
+                u8*       colourRow = &m_Colours[static_cast<size_t>(y) * width * 4];
+                for (s32 x = x0; x <= x1; x += 4)
+                {
+                    const Float4 xs     = Float4::Splat(static_cast<f32>(x)) + lanes;
+                    const Float4 inside = (evaluate(triangle.Edges[0], xs, fy) >= zero)
+                                          & (evaluate(triangle.Edges[1], xs, fy) >= zero)
+                                          & (evaluate(triangle.Edges[2], xs, fy) >= zero) & (xs < widthF);
+                    if (inside.MoveMask() == 0)
+                        continue;
+
+                    // Depth first, so hidden pixels never sample the texture.
+                    const Float4 depth = evaluate(triangle.Depth, xs, fy);
+                    u32          mask  = (inside & (depth < Float4::Load(depthRow + x))).MoveMask();
+                    if (mask == 0)
+                        continue;
+
+                    const Float4 w = one / evaluate(triangle.InverseW, xs, fy);
+                    depth.Store(depths.data());
+                    (evaluate(triangle.U, xs, fy) * w).Store(us.data());
+                    (evaluate(triangle.V, xs, fy) * w).Store(vs.data());
+                    (evaluate(triangle.Light, xs, fy) * w).Store(lights.data());
+                    for (; mask != 0; mask &= mask - 1)
+                    {
+                        const u32 lane     = static_cast<u32>(std::countr_zero(mask));
+                        u8        texel[4] = {255, 255, 255, 255};
+                        if (triangle.Texels)
+                        {
+                            // Nearest: the texel the UV falls in, clamped to the layer.
+                            const f32    size   = static_cast<f32>(triangle.TextureSize);
+                            const s32    last   = static_cast<s32>(triangle.TextureSize) - 1;
+                            const s32    u      = std::clamp(static_cast<s32>(us[lane] * size), 0, last);
+                            const s32    v      = std::clamp(static_cast<s32>(vs[lane] * size), 0, last);
+                            const size_t offset = (static_cast<size_t>(v) * triangle.TextureSize + u) * 4;
+                            std::memcpy(texel, triangle.Texels + offset, 4);
+                            if (texel[3] < 128)
+                            {
+                                discarded++;
+                                continue;
+                            }
+                        }
+
+                        const s32 pixel = x + static_cast<s32>(lane);
+                        const f32 light = std::clamp(lights[lane], 0.0f, 1.0f);
+                        u8*       out   = colourRow + pixel * 4;
+                        out[0]          = static_cast<u8>(static_cast<f32>(texel[0]) * light + 0.5f);
+                        out[1]          = static_cast<u8>(static_cast<f32>(texel[1]) * light + 0.5f);
+                        out[2]          = static_cast<u8>(static_cast<f32>(texel[2]) * light + 0.5f);
+                        out[3]          = 255;
+                        depthRow[pixel] = depths[lane];
+                        pixels++;
+                    }
+                }
+            }
+        }
+    }
+}
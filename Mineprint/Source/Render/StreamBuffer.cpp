@@ -0,0 +1,144 @@
+#include "mppch.h"
+
+#include "Render/StreamBuffer.h"
+
+StreamBuffer::~StreamBuffer()
+{
+    Shutdown();
+}
+
+bool StreamBuffer::Init(GPUResources& resources, const StreamBufferSpecification& spec)
+{
+    MP_CHECK(!IsValid(), "Stream buffer already initialised");
+    if (spec.FrameCount == 0 || spec.FrameSize == 0)
+    {
+        MP_ERROR("Stream buffer must have at least one non-empty frame");
+        return false;
+    }
+    if (!GLAD_GL_VERSION_4_4 && !GLAD_GL_ARB_buffer_storage)
+    {
+        MP_ERROR("Stream buffer needs GL 4.4 or ARB_buffer_storage for persistent mapping");
+        return false;
+    }
+
+    m_Spec      = spec;
+    m_Resources = &resources;
+    m_Buffer    = resources.CreateBuffer();
+
+    const GLbitfield flags  = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const u64        size   = m_Spec.FrameSize * m_Spec.FrameCount;
+    const GLuint     buffer = resources.Get(m_Buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(size), nullptr, flags);
+    m_Mapped = static_cast<u8*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(size), flags));
+    if (!m_Mapped)
+    {
+        MP_ERROR("Failed to persistently map a {} KB stream buffer", size / 1024);
+        resources.Destroy(m_Buffer);
+        m_Buffer = {};
+        return false;
+    }
+
+    m_Fences.assign(m_Spec.FrameCount, nullptr);
+    m_Segment     = m_Spec.FrameCount - 1; // So the first BeginFrame() starts at segment 0.
+    m_FrameOffset = 0;
+    m_Stats.Reset();
+
+    MP_INFO("Created stream buffer: {} frames of {} KB", m_Spec.FrameCount, m_Spec.FrameSize / 1024);
+    return true;
+}
+
+void StreamBuffer::Shutdown()
+{
+    if (!IsValid())
+        return;
+
+    for (GLsync& fence : m_Fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    glUnmapNamedBuffer(GetBuffer());
+    m_Resources->Destroy(m_Buffer);
+    m_Buffer  = {};
+    m_Mapped  = nullptr;
+    m_InFrame = false;
+}
+
+void StreamBuffer::BeginFrame()
+{
+    MP_ASSERT(IsValid(), "Stream buffer isn't initialised");
+    MP_ASSERT(!m_InFrame, "BeginFrame() called twice without EndFrame()");
+
+    m_Segment     = (m_Segment + 1) % m_Spec.FrameCount;
+    m_FrameOffset = 0;
+    m_InFrame     = true;
+    m_Stats.Frames++;
+    m_Stats.BytesThisFrame = 0;
+
+    GLsync& fence = m_Fences[m_Segment];
+    if (!fence)
+        return;
+
+    // Check without waiting first, so we only count it as a stall if we actually had to wait.
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        Stopwatch timer;
+        m_Stats.Stalls++;
+        // The first wait flushes, in case the fence's commands haven't even been submitted yet.
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do
+        {
+            result = glClientWaitSync(fence, flags, 1000000); // 1ms at a time.
+            flags  = 0;
+        }
+        while (result == GL_TIMEOUT_EXPIRED);
+        m_Stats.StallMS += timer.GetElapsedMilliseconds();
+    }
+
+    if (result == GL_WAIT_FAILED)
+        MP_ERROR("Waiting for stream buffer fence failed");
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+    MP_ASSERT(m_InFrame, "EndFrame() called without BeginFrame()");
+    m_InFrame = false;
+
+    // Nothing to protect if the frame didn't use its segment.
+    if (m_FrameOffset == 0)
+        return;
+
+    m_Fences[m_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamAllocation StreamBuffer::Allocate(u64 size, u64 alignment)
+{
+    MP_ASSERT(m_InFrame, "Stream buffer allocations must be made between BeginFrame() and EndFrame()");
+    MP_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    const u64 offset = (m_FrameOffset + alignment - 1) & ~(alignment - 1);
+    if (offset + size > m_Spec.FrameSize)
+    {
+        m_Stats.FailedAllocations++;
+        return {};
+    }
+
+    m_FrameOffset = offset + size;
+    m_Stats.Allocations++;
+    m_Stats.BytesThisFrame = m_FrameOffset;
+    m_Stats.PeakFrameBytes = std::max(m_Stats.PeakFrameBytes, m_FrameOffset);
+
+    const u64 bufferOffset = static_cast<u64>(m_Segment) * m_Spec.FrameSize + offset;
+    return {
+        .Data   = m_Mapped + bufferOffset,
+        .Buffer = GetBuffer(),
+        .Offset = bufferOffset,
+        .Size   = size
+    };
+}
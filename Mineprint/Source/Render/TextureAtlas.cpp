@@ -0,0 +1,667 @@
+#include "mppch.h"
+
+#include "Render/TextureAtlas.h"
+
+#include <fstream>
+
+#include <stb_image.h>
+
+#include "Core/Jobs/JobSystem.h"
+#include "Core/Utility/Hash.h"
+#include "Core/Utility/SkylinePacker.h"
+
+static u32 RoundUp(const u32 value, const u32 multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Copies a frame's edge pixels outwards to fill the rest of its cell. Everything is in pixels at the level being
+// filled, and the frame's own pixels must already be there.
+static void ExtrudeFrame(u32* layer, const u32 size, const glm::uvec2& cellMin, const glm::uvec2& cellMax,
+                         const glm::uvec2& frameMin, const glm::uvec2& frameMax)
+{
+    for (u32 y = cellMin.y; y < cellMax.y; y++)
+    {
+        const u32  sourceY = std::clamp(y, frameMin.y, frameMax.y - 1);
+        u32*       row     = layer + static_cast<size_t>(y) * size;
+        const u32* source  = layer + static_cast<size_t>(sourceY) * size;
+        if (y != sourceY)
+            std::copy(source + frameMin.x, source + frameMax.x, row + frameMin.x);
+        std::fill(row + cellMin.x, row + frameMin.x, source[frameMin.x]);
+        std::fill(row + frameMax.x, row + cellMax.x, source[frameMax.x - 1]);
+    }
+}
+
+// Averages a 2x2 block of RGBA8 pixels. Colours are weighted by alpha, so transparent pixels (whose colour is
+// usually junk) don't darken or tint the edges of cutout sprites like leaves.
+static u32 BoxFilter(const u32 a, const u32 b, const u32 c, const u32 d)
+{
+    // Equal alphas (almost always: opaque, or fully transparent) weight nothing, so average all four channels at
+    // once, two to a 32-bit add. Four bytes plus rounding fit in each 16-bit lane.
+    if (((a ^ b) | (a ^ c) | (a ^ d)) >> 24 == 0)
+    {
+        constexpr u32 mask  = 0x00FF00FF;
+        const u32     even  = ((a & mask) + (b & mask) + (c & mask) + (d & mask) + 0x00020002) >> 2 & mask;
+        const u32     odd   = ((a >> 8 & mask) + (b >> 8 & mask) + (c >> 8 & mask) + (d >> 8 & mask) + 0x00020002) >> 2
+                              & mask;
+        return even | odd << 8;
+    }
+
+    const u32 alphas[4] = {a >> 24, b >> 24, c >> 24, d >> 24};
+    const u32 pixels[4] = {a, b, c, d};
+    const u32 alpha     = alphas[0] + alphas[1] + alphas[2] + alphas[3];
+
+    u32 result = ((alpha + 2) / 4) << 24;
+    for (u32 shift = 0; shift < 24; shift += 8)
+    {
+        u32 sum = 0;
+        if (alpha > 0)
+        {
+            for (u32 i = 0; i < 4; i++)
+                sum += ((pixels[i] >> shift) & 0xFF) * alphas[i];
+            sum = (sum + alpha / 2) / alpha;
+        }
+        else
+        {
+            for (u32 i = 0; i < 4; i++)
+                sum += (pixels[i] >> shift) & 0xFF;
+            sum = (sum + 2) / 4;
+        }
+        result |= sum << shift;
+    }
+    return result;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    Shutdown();
+}
+
+bool TextureAtlas::Build(const TextureAtlasSpecification& spec, const std::span<const AtlasImage> images,
+                         JobSystem& jobs)
+{
+    Clear();
+
+    if (spec.MaxPageSize == 0 || (spec.MaxPageSize & (spec.MaxPageSize - 1)) != 0
+        || spec.MaxPageSize >> spec.MipLevels == 0)
+    {
+        MP_ERROR("Texture atlas pages must be a power of two, and at least 2^MipLevels ({} levels, {} pixels)",
+                 spec.MipLevels, spec.MaxPageSize);
+        return false;
+    }
+
+    Stopwatch              timer;
+    std::vector<Placement> placements;
+    if (!Pack(spec, images, placements))
+    {
+        Clear();
+        return false;
+    }
+    m_Stats.PackMS = timer.GetElapsedMilliseconds();
+
+    // Each frame owns its cell, so they can all be copied in at once.
+    timer.Restart();
+    m_LevelCount = spec.MipLevels + 1;
+    m_Levels.resize(m_LevelCount);
+    m_Levels[0].assign(GetLayerBytes(0) * m_LayerCount, 0);
+    jobs.ParallelFor(0, static_cast<u32>(placements.size()), [&](const u32 begin, const u32 end)
+    {
+        for (u32 i = begin; i < end; i++)
+        {
+            const Placement&  placement = placements[i];
+            const AtlasImage& image     = images[placement.Image];
+            const glm::uvec2  size      = placement.FrameMax - placement.FrameMin;
+            u8*               pixels    = m_Levels[0].data() + GetLayerBytes(0) * placement.Layer;
+            u32*              layer     = reinterpret_cast<u32*>(pixels);
+
+            const u32* source = reinterpret_cast<const u32*>(image.Pixels.data())
+                                + static_cast<size_t>(placement.Frame) * size.y * image.Width;
+            for (u32 y = 0; y < size.y; y++)
+            {
+                std::copy_n(source + static_cast<size_t>(y) * image.Width, size.x,
+                            layer + static_cast<size_t>(placement.FrameMin.y + y) * m_PageSize + placement.FrameMin.x);
+            }
+            ExtrudeFrame(layer, m_PageSize, placement.CellMin, placement.CellMax, placement.FrameMin,
+                         placement.FrameMax);
+        }
+    }, 16);
+    m_Stats.CopyMS = timer.GetElapsedMilliseconds();
+
+    timer.Restart();
+    GenerateMips(placements, jobs);
+    m_Stats.MipMS = timer.GetElapsedMilliseconds();
+
+    MP_INFO("Built a {}x{}x{} texture atlas: {} sprites, {} frames, {:.0f}% occupied, {} skipped ({:.2f}ms)",
+            m_PageSize, m_PageSize, m_LayerCount, m_Stats.Sprites, m_Stats.Frames, m_Stats.Occupancy * 100.0f,
+            m_Stats.Skipped, m_Stats.PackMS + m_Stats.CopyMS + m_Stats.MipMS);
+    return true;
+}
+
+bool TextureAtlas::BuildFromResourcePack(const TextureAtlasSpecification& spec, const std::filesystem::path& root,
+                                         JobSystem& jobs)
+{
+    struct SourceFile
+    {
+        std::string           Location;
+        std::filesystem::path Path;
+        u64                   Size;
+        s64                   Modified;
+    };
+
+    const std::filesystem::path assets = root / "assets";
+    std::error_code             error;
+    if (!std::filesystem::is_directory(assets, error))
+    {
+        MP_ERROR("{} isn't a resource pack (there's no assets folder)", root.string());
+        return false;
+    }
+
+    // assets/<namespace>/textures/<folder>/<name>.png is <namespace>:<folder>/<name>.
+    std::vector<SourceFile> files;
+    for (const auto& space : std::filesystem::directory_iterator(assets, error))
+    {
+        const std::filesystem::path textures = space.path() / "textures";
+        if (!std::filesystem::is_directory(textures, error))
+            continue;
+
+        const std::string prefix = space.path().filename().string() + ":";
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(textures, error))
+        {
+            if (!entry.is_regular_file(error) || entry.path().extension() != ".png")
+                continue;
+
+            std::filesystem::path relative = entry.path().lexically_relative(textures);
+            const std::string     folder   = relative.begin()->string();
+            if (!spec.Folders.empty() && std::ranges::find(spec.Folders, folder) == spec.Folders.end())
+                continue;
+
+            relative.replace_extension();
+            files.push_back({
+                prefix + relative.generic_string(), entry.path(), entry.file_size(error),
+                static_cast<s64>(entry.last_write_time(error).time_since_epoch().count())
+            });
+        }
+    }
+    std::ranges::sort(files, {}, &SourceFile::Location);
+
+    if (files.empty())
+    {
+        MP_ERROR("Found no textures to pack in {}", root.string());
+        return false;
+    }
+
+    u64 key = Hash::Offset ^ Version;
+    key     = Hash::Bytes(key, &spec.MinPageSize, sizeof(spec.MinPageSize));
+    key     = Hash::Bytes(key, &spec.MaxPageSize, sizeof(spec.MaxPageSize));
+    key     = Hash::Bytes(key, &spec.MipLevels, sizeof(spec.MipLevels));
+    key     = Hash::Bytes(key, &spec.Padding, sizeof(spec.Padding));
+    for (const std::string& folder : spec.Folders)
+        key = Hash::Field(key, folder);
+    for (const SourceFile& file : files)
+    {
+        key = Hash::Field(key, file.Location);
+        key = Hash::Bytes(key, &file.Size, sizeof(file.Size));
+        key = Hash::Bytes(key, &file.Modified, sizeof(file.Modified));
+    }
+
+    const std::filesystem::path cachePath = spec.CacheDirectory.empty()
+                                                ? std::filesystem::path()
+                                                : spec.CacheDirectory / fmt::format("{:016X}.atlas", key);
+    Stopwatch timer;
+    if (!cachePath.empty() && Load(cachePath, key))
+    {
+        m_Stats.CacheMS = timer.GetElapsedMilliseconds();
+        MP_INFO("Loaded the texture atlas for {} from the cache: {} sprites ({:.2f}ms)", root.string(),
+                m_Stats.Sprites, m_Stats.CacheMS);
+        return true;
+    }
+
+    timer.Restart();
+    std::vector<AtlasImage> images(files.size());
+    jobs.ParallelFor(0, static_cast<u32>(files.size()), [&](const u32 begin, const u32 end)
+    {
+        for (u32 i = begin; i < end; i++)
+        {
+            Buffer file = FileUtil::ReadBinaryFileToBuffer(files[i].Path);
+            s32    width, height, channels;
+            u8*    pixels = file.Data
+                                ? stbi_load_from_memory(file.Data, static_cast<s32>(file.Size), &width, &height,
+                                                        &channels, 4)
+                                : nullptr;
+            file.Release();
+
+            // Left empty, so Build() skips (and counts) it.
+            images[i].Location = files[i].Location;
+            if (!pixels)
+            {
+                MP_WARN("Failed to decode {}: {}", files[i].Path.string(), stbi_failure_reason());
+                continue;
+            }
+            images[i].Width  = static_cast<u32>(width);
+            images[i].Height = static_cast<u32>(height);
+            images[i].Pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pixels);
+        }
+    }, 8);
+    const f64 decodeMS = timer.GetElapsedMilliseconds();
+
+    if (!Build(spec, images, jobs))
+        return false;
+    m_Stats.DecodeMS = decodeMS;
+
+    if (!cachePath.empty())
+    {
+        timer.Restart();
+        std::filesystem::create_directories(spec.CacheDirectory, error);
+        if (!error && Save(cachePath, key))
+            m_Stats.CacheMS = timer.GetElapsedMilliseconds();
+    }
+    return true;
+}
+
+bool TextureAtlas::Save(const std::filesystem::path& path, const u64 key) const
+{
+    if (!IsBuilt() || m_Levels.empty())
+    {
+        MP_ERROR("Can't save a texture atlas that hasn't been built");
+        return false;
+    }
+
+    std::string locations;
+    for (const std::string& location : m_Locations)
+    {
+        locations += location;
+        locations += '\0';
+    }
+
+    const CacheHeader header = {
+        .Magic         = Magic,
+        .Version       = Version,
+        .Key           = key,
+        .PageSize      = m_PageSize,
+        .LayerCount    = m_LayerCount,
+        .LevelCount    = m_LevelCount,
+        .SpriteCount   = static_cast<u32>(m_Sprites.size()),
+        .FrameCount    = static_cast<u32>(m_Regions.size()),
+        .LocationBytes = static_cast<u32>(locations.size()),
+        .Occupancy     = m_Stats.Occupancy,
+        .Skipped       = m_Stats.Skipped
+    };
+
+    return FileUtil::WriteFileAtomically(path, [&](std::ofstream& file)
+    {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_Sprites.data()), m_Sprites.size() * sizeof(AtlasSprite));
+        file.write(reinterpret_cast<const char*>(m_Regions.data()), m_Regions.size() * sizeof(AtlasRegion));
+        file.write(locations.data(), static_cast<std::streamsize>(locations.size()));
+        for (const std::vector<u8>& level : m_Levels)
+            file.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+    });
+}
+
+bool TextureAtlas::Load(const std::filesystem::path& path, const u64 key)
+{
+    Clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    auto read = [&file](void* data, const size_t size)
+    {
+        file.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        return file && static_cast<size_t>(file.gcount()) == size;
+    };
+
+    CacheHeader header = {};
+    if (!read(&header, sizeof(header)) || header.Magic != Magic || header.Version != Version || header.Key != key)
+        return false;
+
+    // Sizes from the file are checked before anything's allocated for them. Nothing we build comes near these, and a
+    // layer can't be bigger than GL allows a texture to be anyway.
+    constexpr u32 maxCount      = 1u << 24;
+    constexpr u32 maxPageSize   = 1u << 14;
+    constexpr u32 maxLayers     = 2048;
+    constexpr u64 maxPixelBytes = 1ull << 31;
+
+    const bool pagesSane  = header.PageSize > 0 && header.PageSize <= maxPageSize
+                            && (header.PageSize & (header.PageSize - 1)) == 0 && header.LayerCount > 0
+                            && header.LayerCount <= maxLayers
+                            && static_cast<u64>(header.PageSize) * header.PageSize * 4 * header.LayerCount
+                                   <= maxPixelBytes;
+    const bool levelsSane = header.LevelCount > 0 && header.LevelCount <= 15
+                            && header.PageSize >> (header.LevelCount - 1) > 0;
+    const bool countsSane = header.SpriteCount > 0 && header.SpriteCount < maxCount
+                            && header.FrameCount >= header.SpriteCount && header.FrameCount < maxCount
+                            && header.LocationBytes < maxCount;
+    if (!pagesSane || !levelsSane || !countsSane)
+    {
+        MP_WARN("Ignoring corrupt texture atlas {}", path.string());
+        return false;
+    }
+
+    m_PageSize   = header.PageSize;
+    m_LayerCount = header.LayerCount;
+    m_LevelCount = header.LevelCount;
+    m_Sprites.resize(header.SpriteCount);
+    m_Regions.resize(header.FrameCount);
+    std::string locations(header.LocationBytes, '\0');
+    m_Levels.resize(m_LevelCount);
+    for (u32 level = 0; level < m_LevelCount; level++)
+        m_Levels[level].resize(GetLayerBytes(level) * m_LayerCount);
+
+    bool valid = read(m_Sprites.data(), m_Sprites.size() * sizeof(AtlasSprite))
+                 && read(m_Regions.data(), m_Regions.size() * sizeof(AtlasRegion))
+                 && read(locations.data(), locations.size());
+    for (std::vector<u8>& level : m_Levels)
+        valid = valid && read(level.data(), level.size());
+
+    for (size_t start = 0; valid && start < locations.size();)
+    {
+        const size_t end = locations.find('\0', start);
+        if (end == std::string::npos)
+            break;
+        m_SpriteIndices[std::string(locations, start, end - start)] = static_cast<u32>(m_Locations.size());
+        m_Locations.emplace_back(locations, start, end - start);
+        start = end + 1;
+    }
+    valid = valid && m_Locations.size() == m_Sprites.size() && m_SpriteIndices.size() == m_Sprites.size()
+            && std::ranges::all_of(m_Sprites, [&](const AtlasSprite& sprite)
+            {
+                return sprite.FrameCount > 0
+                       && static_cast<u64>(sprite.FirstFrame) + sprite.FrameCount <= m_Regions.size();
+            })
+            && std::ranges::all_of(m_Regions, [&](const AtlasRegion& region) { return region.Layer < m_LayerCount; });
+
+    if (!valid)
+    {
+        MP_WARN("Ignoring corrupt texture atlas {}", path.string());
+        Clear();
+        return false;
+    }
+
+    m_Stats.Sprites   = header.SpriteCount;
+    m_Stats.Frames    = header.FrameCount;
+    m_Stats.Skipped   = header.Skipped;
+    m_Stats.Layers    = m_LayerCount;
+    m_Stats.PageSize  = m_PageSize;
+    m_Stats.Occupancy = header.Occupancy;
+    m_Stats.FromCache = true;
+    return true;
+}
+
+bool TextureAtlas::Upload(GPUResources& resources)
+{
+    if (!IsBuilt() || m_Levels.empty())
+    {
+        MP_ERROR("Can't upload a texture atlas that hasn't been built (or whose pixels have been released)");
+        return false;
+    }
+
+    GLint maxSize = 0, maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (m_PageSize > static_cast<u32>(maxSize) || m_LayerCount > static_cast<u32>(maxLayers))
+    {
+        MP_ERROR("The texture atlas ({}x{}, {} layers) is bigger than the driver allows ({}x{}, {} layers)",
+                 m_PageSize, m_PageSize, m_LayerCount, maxSize, maxSize, maxLayers);
+        return false;
+    }
+
+    // The old texture may still be drawn with by frames in flight, so this only queues it for deletion.
+    if (IsUploaded())
+        m_Resources->Destroy(m_Texture);
+    m_Resources = &resources;
+    m_Texture   = resources.CreateTexture(GL_TEXTURE_2D_ARRAY);
+
+    const GLuint  texture = resources.Get(m_Texture);
+    const GLsizei size    = static_cast<GLsizei>(m_PageSize);
+    glTextureStorage3D(texture, static_cast<GLsizei>(m_LevelCount), GL_RGBA8, size, size,
+                       static_cast<GLsizei>(m_LayerCount));
+    for (u32 level = 0; level < m_LevelCount; level++)
+    {
+        glTextureSubImage3D(texture, static_cast<GLint>(level), 0, 0, 0, size >> level, size >> level,
+                            static_cast<GLsizei>(m_LayerCount), GL_RGBA, GL_UNSIGNED_BYTE, m_Levels[level].data());
+    }
+
+    // Pixel art: sharp up close, and blended between our own mip levels further away.
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_LevelCount - 1));
+    return true;
+}
+
+void TextureAtlas::ReleasePixels()
+{
+    m_Levels.clear();
+    m_Levels.shrink_to_fit();
+}
+
+void TextureAtlas::Shutdown()
+{
+    if (IsUploaded())
+        m_Resources->Destroy(m_Texture);
+    m_Resources = nullptr;
+    m_Texture   = {};
+    Clear();
+}
+
+const AtlasSprite* TextureAtlas::Find(const std::string& location) const
+{
+    const auto it = m_SpriteIndices.find(location);
+    return it != m_SpriteIndices.end() ? &m_Sprites[it->second] : nullptr;
+}
+
+bool TextureAtlas::Pack(const TextureAtlasSpecification& spec, const std::span<const AtlasImage> images,
+                        std::vector<Placement>& placements)
+{
+    // Everything is packed in cells of alignment x alignment pixels, so frames land on multiples of it.
+    const u32 alignment = 1u << spec.MipLevels;
+    const u32 padding   = RoundUp(spec.Padding, alignment);
+
+    struct Item
+    {
+        u32        Image;
+        u32        Frame;
+        u32        Region;
+        glm::uvec2 Size; // Of a frame, in pixels.
+        glm::uvec2 Cells;
+    };
+
+    std::vector<Item> items;
+    for (u32 i = 0; i < static_cast<u32>(images.size()); i++)
+    {
+        const AtlasImage& image = images[i];
+        if (image.Width == 0 || image.Height == 0
+            || image.Pixels.size() != static_cast<size_t>(image.Width) * image.Height * 4)
+        {
+            m_Stats.Skipped++;
+            continue;
+        }
+
+        const bool       strip  = image.SplitFrames && image.Height > image.Width && image.Height % image.Width == 0;
+        const u32        frames = strip ? image.Height / image.Width : 1;
+        const u32        height = image.Height / frames;
+        const glm::uvec2 cells  = {
+            (RoundUp(image.Width, alignment) + padding * 2) / alignment,
+            (RoundUp(height, alignment) + padding * 2) / alignment
+        };
+        if (cells.x * alignment > spec.MaxPageSize || cells.y * alignment > spec.MaxPageSize
+            || image.Width > UINT16_MAX || height > UINT16_MAX || frames > UINT16_MAX)
+        {
+            MP_WARN("Texture '{}' ({}x{}) is too big for the atlas", image.Location, image.Width, image.Height);
+            m_Stats.Skipped++;
+            continue;
+        }
+        if (m_SpriteIndices.contains(image.Location))
+        {
+            MP_WARN("Texture '{}' is in the atlas twice; using the first", image.Location);
+            m_Stats.Skipped++;
+            continue;
+        }
+
+        m_SpriteIndices[image.Location] = static_cast<u32>(m_Sprites.size());
+        m_Locations.push_back(image.Location);
+        m_Sprites.push_back({
+            .FirstFrame = static_cast<u32>(m_Regions.size()),
+            .FrameCount = static_cast<u16>(frames),
+            .Width      = static_cast<u16>(image.Width),
+            .Height     = static_cast<u16>(height)
+        });
+        for (u32 frame = 0; frame < frames; frame++)
+        {
+            items.push_back({i, frame, static_cast<u32>(m_Regions.size()), {image.Width, height}, cells});
+            m_Regions.emplace_back();
+        }
+    }
+
+    if (items.empty())
+    {
+        MP_ERROR("None of the {} textures could be packed", images.size());
+        return false;
+    }
+
+    // Tallest first keeps the skyline flat, which is most of what makes it pack well.
+    std::ranges::stable_sort(items, [](const Item& a, const Item& b)
+    {
+        return a.Cells.y != b.Cells.y ? a.Cells.y > b.Cells.y : a.Cells.x > b.Cells.x;
+    });
+
+    // Start with the smallest page that could hold everything, and the biggest item on its own, and double it until it
+    // does (or we hit the largest).
+    u64 cellArea     = 0;
+    u32 largestCells = 0;
+    for (const Item& item : items)
+    {
+        cellArea     += static_cast<u64>(item.Cells.x) * item.Cells.y;
+        largestCells  = std::max({largestCells, item.Cells.x, item.Cells.y});
+    }
+    u32 pageSize = std::clamp(spec.MinPageSize, alignment, spec.MaxPageSize);
+    while (pageSize < spec.MaxPageSize
+           && (pageSize / alignment < largestCells
+               || static_cast<u64>(pageSize / alignment) * (pageSize / alignment) < cellArea))
+        pageSize *= 2;
+
+    std::vector<SkylinePacker> pages;
+    while (true)
+    {
+        placements.clear();
+        pages.clear();
+        bool fits = true;
+        for (const Item& item : items)
+        {
+            glm::uvec2 position;
+            u32        layer = 0;
+            while (layer < pages.size() && !pages[layer].Pack(item.Cells.x, item.Cells.y, position))
+                layer++;
+            // If it doesn't fit on a page of its own, the pages are too small for it.
+            if (layer == pages.size())
+            {
+                pages.emplace_back(pageSize / alignment, pageSize / alignment);
+                if (!pages.back().Pack(item.Cells.x, item.Cells.y, position))
+                {
+                    fits = false;
+                    break;
+                }
+            }
+
+            const glm::uvec2 cellMin  = position * alignment;
+            const glm::uvec2 frameMin = cellMin + padding;
+            placements.push_back({
+                .Image    = item.Image,
+                .Frame    = item.Frame,
+                .Region   = item.Region,
+                .Layer    = layer,
+                .CellMin  = cellMin,
+                .CellMax  = cellMin + item.Cells * alignment,
+                .FrameMin = frameMin,
+                .FrameMax = frameMin + item.Size
+            });
+        }
+
+        if (fits && (pages.size() == 1 || pageSize >= spec.MaxPageSize))
+            break;
+        if (pageSize >= spec.MaxPageSize)
+        {
+            MP_ERROR("Textures don't fit on {}x{} atlas pages", spec.MaxPageSize, spec.MaxPageSize);
+            return false;
+        }
+        pageSize *= 2;
+    }
+
+    m_PageSize   = pageSize;
+    m_LayerCount = static_cast<u32>(pages.size());
+    for (const Placement& placement : placements)
+    {
+        m_Regions[placement.Region] = {
+            .UVMin = glm::vec2(placement.FrameMin) / static_cast<f32>(pageSize),
+            .UVMax = glm::vec2(placement.FrameMax) / static_cast<f32>(pageSize),
+            .Layer = placement.Layer
+        };
+    }
+
+    f32 occupancy = 0;
+    for (const SkylinePacker& page : pages)
+        occupancy += page.GetOccupancy();
+    m_Stats.Sprites   = static_cast<u32>(m_Sprites.size());
+    m_Stats.Frames    = static_cast<u32>(m_Regions.size());
+    m_Stats.Layers    = m_LayerCount;
+    m_Stats.PageSize  = m_PageSize;
+    m_Stats.Occupancy = occupancy / static_cast<f32>(pages.size());
+    return true;
+}
+
+void TextureAtlas::GenerateMips(const std::span<const Placement> placements, JobSystem& jobs)
+{
+    for (u32 level = 1; level < m_LevelCount; level++)
+    {
+        const u32 size       = m_PageSize >> level;
+        const u32 sourceSize = size * 2;
+        m_Levels[level].resize(GetLayerBytes(level) * m_LayerCount);
+
+        // Cells are aligned to every level, so filtering whole rows never mixes two frames.
+        const u32* source      = reinterpret_cast<const u32*>(m_Levels[level - 1].data());
+        u32*       destination = reinterpret_cast<u32*>(m_Levels[level].data());
+        jobs.ParallelFor(0, size * m_LayerCount, [&](const u32 begin, const u32 end)
+        {
+            for (u32 row = begin; row < end; row++)
+            {
+                const u32* top    = source + static_cast<size_t>(row) * 2 * sourceSize;
+                const u32* bottom = top + sourceSize;
+                u32*       out    = destination + static_cast<size_t>(row) * size;
+                for (u32 x = 0; x < size; x++)
+                    out[x] = BoxFilter(top[x * 2], top[x * 2 + 1], bottom[x * 2], bottom[x * 2 + 1]);
+            }
+        }, 16);
+
+        // Filtering blends the edge of a frame whose size isn't a multiple of 2^level with its padding, and shrinks the
+        // padding, so put it back from this level's edge pixels.
+        jobs.ParallelFor(0, static_cast<u32>(placements.size()), [&](const u32 begin, const u32 end)
+        {
+            for (u32 i = begin; i < end; i++)
+            {
+                const Placement& placement = placements[i];
+                const u32        scale     = 1u << level;
+                const glm::uvec2 frameMin  = placement.FrameMin / scale;
+                const glm::uvec2 frameMax  = frameMin + (placement.FrameMax - placement.FrameMin + scale - 1u) / scale;
+                ExtrudeFrame(destination + static_cast<size_t>(placement.Layer) * size * size, size,
+                             placement.CellMin / scale, placement.CellMax / scale, frameMin, frameMax);
+            }
+        }, 16);
+    }
+}
+
+void TextureAtlas::Clear()
+{
+    m_Sprites.clear();
+    m_Regions.clear();
+    m_Locations.clear();
+    m_SpriteIndices.clear();
+    m_Levels.clear();
+    m_PageSize   = 0;
+    m_LayerCount = 0;
+    m_LevelCount = 0;
+    m_Stats.Reset();
+}
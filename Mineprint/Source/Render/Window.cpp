@@ -10,6 +10,8 @@ Window::Window(WindowSpecification spec)
 
 bool Window::Create()
 {
+    STARTUP_SCOPE("Window::Create");
+
     MP_CHECK(!m_Specification.Title.empty(), "Window title cannot be empty");
     MP_CHECK(m_Specification.Size.x > 0 && m_Specification.Size.y > 0, "Window size must be greater than 0");
 
@@ -48,66 +50,86 @@ bool Window::Create()
     return true;
 }
 
-void Window::PollEvents()
+u32 Window::PollEvents()
 {
     // TODO(mware): This should be refactored out to the Application - we store the Window pointer as an SDL property,
     // so we can still execute window delegates. If pointer stability is an issue, we can use some sort of handle.
     // TODO(mware): Update window close to have a CascadingDelegate to check if the close should actually happen
 
     SDL_Event windowEvent;
+    u32       eventCount = 0;
 
     while (SDL_PollEvent(&windowEvent))
     {
-        OnSDLEvent.Execute(windowEvent);
+        DispatchEvent(windowEvent);
+        eventCount++;
+    }
+
+    return eventCount;
+}
+
+u32 Window::WaitEvents(s32 timeoutMS)
+{
+    // Block until the first event arrives (or we time out), then drain anything else that's queued up behind it.
+    SDL_Event windowEvent;
+    if (!SDL_WaitEventTimeout(&windowEvent, timeoutMS))
+        return 0;
+
+    DispatchEvent(windowEvent);
+    return 1 + PollEvents();
+}
 
-        switch (windowEvent.type)
+void Window::DispatchEvent(const SDL_Event& windowEvent)
+{
+    OnSDLEvent.Execute(windowEvent);
+
+    switch (windowEvent.type)
+    {
+    case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
         {
-        case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
-            {
-                if (windowEvent.window.windowID != SDL_GetWindowID(m_Window))
-                    break;
-                OnWindowClose.Execute();
+            if (windowEvent.window.windowID != SDL_GetWindowID(m_Window))
                 break;
-            }
-        case SDL_EVENT_WINDOW_RESIZED:
-            {
-                glm::ivec2 newSize   = {windowEvent.window.data1, windowEvent.window.data2};
-                m_Specification.Size = newSize;
-                OnWindowResize.Execute(newSize);
-                break;
-            }
-        case SDL_EVENT_WINDOW_MOVED:
-            {
-                glm::ivec2 newPos        = {windowEvent.window.data1, windowEvent.window.data2};
-                m_Specification.Position = newPos;
-                OnWindowMove.Execute(newPos);
-                break;
-            }
-        case SDL_EVENT_KEY_UP:
-        case SDL_EVENT_KEY_DOWN:
-            {
-                OnKeyboardEvent.Execute(windowEvent.key);
-                break;
-            }
-        case SDL_EVENT_MOUSE_BUTTON_UP:
-        case SDL_EVENT_MOUSE_BUTTON_DOWN:
-            {
-                OnMouseButtonEvent.Execute(windowEvent.button);
-                break;
-            }
-        case SDL_EVENT_MOUSE_MOTION:
-            {
-                OnMouseMotionEvent.Execute(windowEvent.motion);
-                break;
-            }
-        case SDL_EVENT_MOUSE_WHEEL:
-            {
-                OnMouseWheelEvent.Execute(windowEvent.wheel);
-                break;
-            }
-        default:
+            OnWindowClose.Execute();
+            break;
+        }
+    case SDL_EVENT_WINDOW_RESIZED:
+        {
+            glm::ivec2 newSize   = {windowEvent.window.data1, windowEvent.window.data2};
+            m_Specification.Size = newSize;
+            OnWindowResize.Execute(newSize);
+            break;
+        }
+    case SDL_EVENT_WINDOW_MOVED:
+        {
+            glm::ivec2 newPos        = {windowEvent.window.data1, windowEvent.window.data2};
+            m_Specification.Position = newPos;
+            OnWindowMove.Execute(newPos);
+            break;
+        }
+    case SDL_EVENT_KEY_UP:
+    case SDL_EVENT_KEY_DOWN:
+        {
+            OnKeyboardEvent.Execute(windowEvent.key);
+            break;
+        }
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        {
+            OnMouseButtonEvent.Execute(windowEvent.button);
+            break;
+        }
+    case SDL_EVENT_MOUSE_MOTION:
+        {
+            OnMouseMotionEvent.Execute(windowEvent.motion);
             break;
         }
+    case SDL_EVENT_MOUSE_WHEEL:
+        {
+            OnMouseWheelEvent.Execute(windowEvent.wheel);
+            break;
+        }
+    default:
+        break;
     }
 }
 
@@ -156,6 +178,25 @@ void Window::SetGLContextCurrent() const
     SDL_GL_MakeCurrent(m_Window, m_GLContext);
 }
 
+void Window::ReleaseGLContext() const
+{
+    SDL_GL_MakeCurrent(m_Window, nullptr);
+}
+
+SDL_GLContext Window::CreateSharedGLContext() const
+{
+    // SDL shares with whichever context is current, and makes the new one current.
+    SetGLContextCurrent();
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext context = SDL_GL_CreateContext(m_Window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    if (!context)
+        MP_ERROR("Failed to create a shared OpenGL context: {}", SDL_GetError());
+
+    SetGLContextCurrent();
+    return context;
+}
+
 void Window::LockCursor() const
 {
     SDL_SetWindowRelativeMouseMode(m_Window, true);
@@ -0,0 +1,375 @@
+#include "mppch.h"
+
+#include "Render/WireGeometry.h"
+
+#include "Core/SIMD.h"
+
+#include <bit>
+
+namespace
+{
+    // Wang's formula gives the segment count that keeps a cubic within the tolerance of its tessellation:
+    // sqrt(3/4 * max(|P0 - 2P1 + P2|, |P1 - 2P2 + P3|) / tolerance). This rounds it up to the LOD we actually use.
+    u32 QuantiseSegments(const f32 segments)
+    {
+        const f32 count = std::clamp(std::ceil(segments), 1.0f, static_cast<f32>(WireBatch::MaxSegments));
+        return std::bit_ceil(static_cast<u32>(count));
+    }
+}
+
+WireCurve WireCurve::MakeLink(const glm::vec2& from, const glm::vec2& to)
+{
+    const f32 tangent = std::max(std::abs(to.x - from.x) * 0.5f, 40.0f);
+    return {from, from + glm::vec2(tangent, 0.0f), to - glm::vec2(tangent, 0.0f), to};
+}
+
+std::span<const WirePoint> WireCache::Find(const u64 id, const WireCurve& curve, const u32 segments)
+{
+    const auto it = m_Entries.find(id);
+    if (it == m_Entries.end())
+        return {};
+
+    Entry& entry = it->second;
+    if (entry.Points.size() != segments + 1 || entry.Curve != curve)
+        return {};
+
+    entry.LastUsedFrame = m_Frame;
+    return entry.Points;
+}
+
+void WireCache::Store(const u64 id, const WireCurve& curve, const std::span<const WirePoint> points)
+{
+    Entry& entry        = m_Entries[id];
+    entry.Curve         = curve;
+    entry.LastUsedFrame = m_Frame;
+    // Reuses the entry's allocation when an existing wire moves.
+    entry.Points.assign(points.begin(), points.end());
+}
+
+void WireCache::Trim(const u32 maxUnusedFrames)
+{
+    m_Frame++;
+    std::erase_if(m_Entries, [&](const auto& pair) { return m_Frame - pair.second.LastUsedFrame > maxUnusedFrames; });
+}
+
+void WireCache::Clear()
+{
+    m_Entries.clear();
+}
+
+void WireBatch::Begin(const FRect& view, const glm::vec2& viewportSize)
+{
+    MP_ASSERT(view.Size.x > 0 && view.Size.y > 0, "Wire view must have a positive size");
+
+    m_View          = view;
+    m_PixelsPerUnit = viewportSize.x / view.Size.x;
+
+    for (u32 point = 0; point < 4; point++)
+    {
+        m_X[point].clear();
+        m_Y[point].clear();
+    }
+    m_HalfWidths.clear();
+    m_Colours.clear();
+    m_IDs.clear();
+    m_WireCount = 0;
+    m_Stats.Reset();
+}
+
+void WireBatch::AddWire(const WireCurve& curve, const u32 colour, const f32 thickness, const u64 id)
+{
+    const std::array<glm::vec2, 4> points = {curve.P0, curve.P1, curve.P2, curve.P3};
+    for (u32 point = 0; point < 4; point++)
+    {
+        m_X[point].push_back(points[point].x);
+        m_Y[point].push_back(points[point].y);
+    }
+    m_HalfWidths.push_back(thickness * 0.5f);
+    m_Colours.push_back(colour);
+    m_IDs.push_back(id);
+    m_WireCount++;
+}
+
+void WireBatch::Build(WireCache* cache)
+{
+    Stopwatch timer;
+
+    // Padding lets the SIMD loops always load four wires; the padding wires are never used.
+    const u32 paddedCount = (m_WireCount + 3) & ~3u;
+    for (u32 point = 0; point < 4; point++)
+    {
+        m_X[point].resize(paddedCount, 0.0f);
+        m_Y[point].resize(paddedCount, 0.0f);
+    }
+    m_HalfWidths.resize(paddedCount, 0.0f);
+
+    m_Segments.resize(m_WireCount);
+    m_PointOffsets.resize(m_WireCount);
+    m_Paths.assign(m_WireCount, {});
+    ComputeSegmentCounts();
+
+    auto getCurve = [this](const u32 wire) -> WireCurve
+    {
+        return {
+            {m_X[0][wire], m_Y[0][wire]},
+            {m_X[1][wire], m_Y[1][wire]},
+            {m_X[2][wire], m_Y[2][wire]},
+            {m_X[3][wire], m_Y[3][wire]}
+        };
+    };
+
+    m_TessellateOrder.clear();
+    for (u32 wire = 0; wire < m_WireCount; wire++)
+    {
+        if (m_Segments[wire] == 0)
+        {
+            m_Stats.CulledWires++;
+            continue;
+        }
+
+        if (cache && m_IDs[wire] != 0)
+        {
+            m_Paths[wire] = cache->Find(m_IDs[wire], getCurve(wire), m_Segments[wire]);
+            if (!m_Paths[wire].empty())
+            {
+                m_Stats.CacheHits++;
+                continue;
+            }
+        }
+
+        m_TessellateOrder.push_back(wire);
+    }
+
+    Tessellate();
+    Expand();
+
+    // Only once everything's expanded: storing can reallocate an entry that another wire with the same ID hit.
+    if (cache)
+    {
+        for (const u32 wire : m_TessellateOrder)
+        {
+            if (m_IDs[wire] != 0)
+                cache->Store(m_IDs[wire], getCurve(wire), m_Paths[wire]);
+        }
+    }
+
+    for (u32 point = 0; point < 4; point++)
+    {
+        m_X[point].resize(m_WireCount);
+        m_Y[point].resize(m_WireCount);
+    }
+    m_HalfWidths.resize(m_WireCount);
+
+    m_Stats.Wires       = m_WireCount;
+    m_Stats.Tessellated = static_cast<u32>(m_TessellateOrder.size());
+    m_Stats.Points      = static_cast<u32>(m_Points.size());
+    m_Stats.Vertices    = static_cast<u32>(m_Vertices.size());
+    m_Stats.Indices     = static_cast<u32>(m_Indices.size());
+    m_Stats.BuildMS     = timer.GetElapsedMilliseconds();
+}
+
+u32 WireBatch::GetSegmentCount(const WireCurve& curve, const f32 pixelsPerUnit)
+{
+    const glm::vec2 a = curve.P0 - 2.0f * curve.P1 + curve.P2;
+    const glm::vec2 b = curve.P1 - 2.0f * curve.P2 + curve.P3;
+    const f32       m = std::sqrt(std::max(glm::dot(a, a), glm::dot(b, b))) * pixelsPerUnit;
+    return QuantiseSegments(std::sqrt(m * (0.75f / Tolerance)));
+}
+
+void WireBatch::ComputeSegmentCounts()
+{
+    const f32    pixel    = 1.0f / m_PixelsPerUnit;
+    const Float4 viewMinX = Float4::Splat(m_View.Position.x);
+    const Float4 viewMinY = Float4::Splat(m_View.Position.y);
+    const Float4 viewMaxX = Float4::Splat(m_View.Position.x + m_View.Size.x);
+    const Float4 viewMaxY = Float4::Splat(m_View.Position.y + m_View.Size.y);
+    const Float4 two      = Float4::Splat(2.0f);
+    // Wang's formula, with the second differences converted to pixels.
+    const Float4 scale = Float4::Splat(m_PixelsPerUnit * (0.75f / Tolerance));
+
+    alignas(16) f32 segments[4];
+    for (u32 first = 0; first < m_WireCount; first += 4)
+    {
+        const Float4 x0 = Float4::Load(&m_X[0][first]), y0 = Float4::Load(&m_Y[0][first]);
+        const Float4 x1 = Float4::Load(&m_X[1][first]), y1 = Float4::Load(&m_Y[1][first]);
+        const Float4 x2 = Float4::Load(&m_X[2][first]), y2 = Float4::Load(&m_Y[2][first]);
+        const Float4 x3 = Float4::Load(&m_X[3][first]), y3 = Float4::Load(&m_Y[3][first]);
+        // The curve lies inside its control points' bounds, so that's what we cull; grown by the line's width and
+        // the antialiasing pixel.
+        const Float4 pad = Float4::Load(&m_HalfWidths[first]) + Float4::Splat(pixel);
+
+        const Float4 minX    = Min(Min(x0, x1), Min(x2, x3)) - pad;
+        const Float4 maxX    = Max(Max(x0, x1), Max(x2, x3)) + pad;
+        const Float4 minY    = Min(Min(y0, y1), Min(y2, y3)) - pad;
+        const Float4 maxY    = Max(Max(y0, y1), Max(y2, y3)) + pad;
+        const Float4 overlap = (minX < viewMaxX) & (maxX > viewMinX) & (minY < viewMaxY) & (maxY > viewMinY);
+        const u32    visible = overlap.MoveMask();
+
+        const Float4 ax       = x0 - two * x1 + x2;
+        const Float4 ay       = y0 - two * y1 + y2;
+        const Float4 bx       = x1 - two * x2 + x3;
+        const Float4 by       = y1 - two * y2 + y3;
+        const Float4 distance = Sqrt(Max(ax * ax + ay * ay, bx * bx + by * by));
+        Sqrt(distance * scale).Store(segments);
+
+        const u32 laneCount = std::min(4u, m_WireCount - first);
+        for (u32 lane = 0; lane < laneCount; lane++)
+            m_Segments[first + lane] = visible & (1u << lane) ? QuantiseSegments(segments[lane]) : 0;
+    }
+}
+
+void WireBatch::Tessellate()
+{
+    // Group the wires by segment count (counting sort, as there are only a few LODs), so each group of four has
+    // the same count and no lanes idle while the others finish.
+    constexpr u32                   levelCount  = std::countr_zero(MaxSegments) + 1;
+    std::array<u32, levelCount + 1> levelStarts = {};
+    for (const u32 wire : m_TessellateOrder)
+        levelStarts[std::countr_zero(m_Segments[wire]) + 1]++;
+    for (u32 level = 1; level <= levelCount; level++)
+        levelStarts[level] += levelStarts[level - 1];
+
+    m_SortScratch.resize(m_TessellateOrder.size());
+    for (const u32 wire : m_TessellateOrder)
+        m_SortScratch[levelStarts[std::countr_zero(m_Segments[wire])]++] = wire;
+    m_TessellateOrder.swap(m_SortScratch);
+
+    // Each wire's points are contiguous, in the order we tessellate them.
+    u32 pointCount = 0;
+    for (const u32 wire : m_TessellateOrder)
+    {
+        m_PointOffsets[wire] = pointCount;
+        pointCount           += m_Segments[wire] + 1;
+    }
+    m_Points.resize(pointCount);
+
+    const Float4 one   = Float4::Splat(1.0f);
+    const Float4 two   = Float4::Splat(2.0f);
+    const Float4 three = Float4::Splat(3.0f);
+    // Below this, the derivative has vanished (a control point sits on its end point) and the chord is used instead.
+    const Float4 epsilon = Float4::Splat(1e-12f);
+
+    alignas(16) f32 positionsX[4], positionsY[4], normalsX[4], normalsY[4];
+    const u32       wireCount = static_cast<u32>(m_TessellateOrder.size());
+    for (u32 first = 0; first < wireCount; first += 4)
+    {
+        // Missing lanes in the last group just repeat the first wire, and are never stored.
+        const u32 laneCount = std::min(4u, wireCount - first);
+        u32       wires[4];
+        for (u32 lane = 0; lane < 4; lane++)
+            wires[lane] = m_TessellateOrder[first + (lane < laneCount ? lane : 0)];
+
+        auto gather = [&](const std::vector<f32>& values)
+        {
+            return Float4::Set(values[wires[0]], values[wires[1]], values[wires[2]], values[wires[3]]);
+        };
+        const Float4 x0 = gather(m_X[0]), y0 = gather(m_Y[0]);
+        const Float4 x1 = gather(m_X[1]), y1 = gather(m_Y[1]);
+        const Float4 x2 = gather(m_X[2]), y2 = gather(m_Y[2]);
+        const Float4 x3 = gather(m_X[3]), y3 = gather(m_Y[3]);
+
+        // Differences of the control points, for the derivative.
+        const Float4 dx01 = x1 - x0, dy01 = y1 - y0;
+        const Float4 dx12 = x2 - x1, dy12 = y2 - y1;
+        const Float4 dx23 = x3 - x2, dy23 = y3 - y2;
+        const Float4 chordX = x3 - x0, chordY = y3 - y0;
+
+        u32 maxSegments = 0;
+        f32 segmentCounts[4];
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            segmentCounts[lane] = static_cast<f32>(m_Segments[wires[lane]]);
+            maxSegments         = std::max(maxSegments, m_Segments[wires[lane]]);
+        }
+        const Float4 step = one / Float4::Load(segmentCounts);
+
+        for (u32 segment = 0; segment <= maxSegments; segment++)
+        {
+            const Float4 t  = Min(Float4::Splat(static_cast<f32>(segment)) * step, one);
+            const Float4 u  = one - t;
+            const Float4 uu = u * u;
+            const Float4 tt = t * t;
+
+            // Bernstein form.
+            const Float4 b0 = uu * u;
+            const Float4 b1 = three * uu * t;
+            const Float4 b2 = three * u * tt;
+            const Float4 b3 = tt * t;
+            (b0 * x0 + b1 * x1 + b2 * x2 + b3 * x3).Store(positionsX);
+            (b0 * y0 + b1 * y1 + b2 * y2 + b3 * y3).Store(positionsY);
+
+            // The derivative, less its constant factor of 3, as it's normalised anyway.
+            const Float4 d1         = two * u * t;
+            Float4       tangentX   = uu * dx01 + d1 * dx12 + tt * dx23;
+            Float4       tangentY   = uu * dy01 + d1 * dy12 + tt * dy23;
+            const Float4 degenerate = tangentX * tangentX + tangentY * tangentY < epsilon;
+            tangentX                = Select(degenerate, chordX, tangentX);
+            tangentY                = Select(degenerate, chordY, tangentY);
+
+            const Float4 inverseLength = one / Sqrt(Max(tangentX * tangentX + tangentY * tangentY, epsilon));
+            (Float4::Splat(0.0f) - tangentY * inverseLength).Store(normalsX);
+            (tangentX * inverseLength).Store(normalsY);
+
+            for (u32 lane = 0; lane < laneCount; lane++)
+            {
+                if (segment > m_Segments[wires[lane]])
+                    continue;
+
+                m_Points[m_PointOffsets[wires[lane]] + segment] = {
+                    {positionsX[lane], positionsY[lane]},
+                    {normalsX[lane], normalsY[lane]}
+                };
+            }
+        }
+    }
+
+    for (const u32 wire : m_TessellateOrder)
+        m_Paths[wire] = std::span<const WirePoint>(&m_Points[m_PointOffsets[wire]], m_Segments[wire] + 1);
+}
+
+void WireBatch::Expand()
+{
+    const f32 pixel = 1.0f / m_PixelsPerUnit;
+
+    // Sized up front and written through pointers: push_back's capacity checks cost more than the maths here.
+    u32 segmentCount = 0;
+    u32 pointCount   = 0;
+    for (u32 wire = 0; wire < m_WireCount; wire++)
+    {
+        segmentCount += m_Segments[wire];
+        pointCount   += m_Segments[wire] ? m_Segments[wire] + 1 : 0;
+    }
+    m_Vertices.resize(pointCount * 2);
+    m_Indices.resize(segmentCount * 6);
+
+    WireVertex* vertex = m_Vertices.data();
+    u32*        index  = m_Indices.data();
+    for (u32 wire = 0; wire < m_WireCount; wire++)
+    {
+        if (m_Segments[wire] == 0)
+            continue;
+
+        // At least a pixel wide, plus a pixel either side for the antialiased edge to fade out in.
+        const f32 halfWidth = std::max(m_HalfWidths[wire], pixel * 0.5f) + pixel;
+        const u32 colour    = m_Colours[wire];
+        const u32 base      = static_cast<u32>(vertex - m_Vertices.data());
+        for (const WirePoint& point : m_Paths[wire])
+        {
+            const glm::vec2 offset = point.Normal * halfWidth;
+            *vertex++              = {point.Position + offset, colour, 1.0f};
+            *vertex++              = {point.Position - offset, colour, -1.0f};
+        }
+
+        for (u32 segment = 0; segment < m_Segments[wire]; segment++)
+        {
+            const u32 first = base + segment * 2;
+            index[0]        = first;
+            index[1]        = first + 1;
+            index[2]        = first + 2;
+            index[3]        = first + 1;
+            index[4]        = first + 3;
+            index[5]        = first + 2;
+            index           += 6;
+        }
+    }
+}
@@ -0,0 +1,401 @@
+#include "mppch.h"
+
+#include "Scene/BVH.h"
+
+#include "Core/SIMD.h"
+#include "Scene/OcclusionBuffer.h"
+
+#include <bit>
+
+namespace
+{
+    constexpr u32 AllPlanes = (1u << 6) - 1;
+
+    struct Bin
+    {
+        AABB Bounds;
+        u32  Count = 0;
+    };
+}
+
+void BVH::Build(const BVHSpecification& spec, const std::span<const AABB> bounds)
+{
+    MP_CHECK(spec.MaxLeafSize > 0 && spec.Bins > 1, "BVH needs leaves with room for an item, and at least two bins");
+
+    Stopwatch timer;
+    Clear();
+    if (bounds.empty())
+        return;
+
+    const u32              count = static_cast<u32>(bounds.size());
+    std::vector<glm::vec3> centers(count);
+    for (u32 i = 0; i < count; i++)
+        centers[i] = bounds[i].GetCenter();
+    m_Order.resize(count);
+    std::iota(m_Order.begin(), m_Order.end(), 0u);
+
+    m_Nodes.reserve(count / spec.MaxLeafSize * 2 + 1);
+    m_Nodes.push_back({.First = 0, .Count = count});
+    m_Parents.push_back(0);
+    m_BuildStack.push_back({0, 0});
+    while (!m_BuildStack.empty())
+    {
+        const BuildTask task = m_BuildStack.back();
+        m_BuildStack.pop_back();
+
+        Node& node = m_Nodes[task.Node];
+        for (u32 slot = node.First; slot < node.First + node.Count; slot++)
+            node.Bounds.Grow(bounds[m_Order[slot]]);
+        m_Stats.Depth = std::max(m_Stats.Depth, task.Depth);
+        if (node.Count <= spec.MaxLeafSize || task.Depth + 1 >= MaxDepth)
+            continue;
+
+        // Children go at the end, so they always come after their parents.
+        const u32 leftCount = Partition(spec, node, bounds, centers);
+        const u32 left      = static_cast<u32>(m_Nodes.size());
+        node.Left           = left;
+        const Node split    = node;
+        m_Nodes.push_back({.First = split.First, .Count = leftCount});
+        m_Nodes.push_back({.First = split.First + leftCount, .Count = split.Count - leftCount});
+        m_Parents.insert(m_Parents.end(), {task.Node, task.Node});
+        m_BuildStack.push_back({left + 1, task.Depth + 1});
+        m_BuildStack.push_back({left, task.Depth + 1});
+    }
+
+    // The item bounds in leaf order, padded so a leaf can load four from any slot, even one of the last.
+    const u32 padded = count + 3;
+    m_SlotOf.resize(count);
+    m_LeafOf.resize(count);
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        m_Min[axis].assign(padded, 0.0f);
+        m_Max[axis].assign(padded, 0.0f);
+    }
+    for (u32 slot = 0; slot < count; slot++)
+    {
+        const AABB& box         = bounds[m_Order[slot]];
+        m_SlotOf[m_Order[slot]] = slot;
+        for (u32 axis = 0; axis < 3; axis++)
+        {
+            m_Min[axis][slot] = box.Min[axis];
+            m_Max[axis][slot] = box.Max[axis];
+        }
+    }
+
+    m_Cost = 0.0;
+    for (u32 i = 0; i < m_Nodes.size(); i++)
+    {
+        const Node& node = m_Nodes[i];
+        if (IsLeaf(node))
+        {
+            std::fill_n(m_LeafOf.begin() + node.First, node.Count, i);
+            m_Cost += static_cast<f64>(node.Bounds.GetHalfArea()) * node.Count;
+            m_Stats.Leaves++;
+        }
+        else
+        {
+            m_Cost += node.Bounds.GetHalfArea();
+        }
+    }
+    m_Dirty.assign(m_Nodes.size(), 0);
+    m_BuildCost = GetCost();
+
+    m_Stats.Items   = count;
+    m_Stats.Nodes   = static_cast<u32>(m_Nodes.size());
+    m_Stats.BuildMS = timer.GetElapsedMilliseconds();
+}
+
+u32 BVH::Partition(const BVHSpecification& spec, const Node& node, const std::span<const AABB> bounds,
+                   const std::span<const glm::vec3> centers)
+{
+    const auto first = m_Order.begin() + node.First;
+    const auto last  = first + node.Count;
+
+    AABB centerBounds;
+    for (auto it = first; it != last; ++it)
+        centerBounds.Grow(centers[*it]);
+
+    // Items are binned by their centres along each axis in turn, and each split between bins costs the area of the
+    // items' bounds on either side, by how many items are there.
+    const glm::vec3  extent    = centerBounds.Max - centerBounds.Min;
+    f32              bestCost  = std::numeric_limits<f32>::max();
+    u32              bestAxis  = 0;
+    u32              bestSplit = 0;
+    std::vector<Bin> bins(spec.Bins);
+    std::vector<f32> rightCosts(spec.Bins);
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        if (extent[axis] <= 0.0f)
+            continue;
+
+        std::ranges::fill(bins, Bin());
+        const f32 scale = static_cast<f32>(spec.Bins) / extent[axis];
+        for (auto it = first; it != last; ++it)
+        {
+            const u32 bin = std::min(static_cast<u32>((centers[*it][axis] - centerBounds.Min[axis]) * scale),
+                                     spec.Bins - 1);
+            bins[bin].Count++;
+            bins[bin].Bounds.Grow(bounds[*it]);
+        }
+
+        AABB right;
+        u32  rightCount = 0;
+        for (u32 split = spec.Bins - 1; split > 0; split--)
+        {
+            right.Grow(bins[split].Bounds);
+            rightCount        += bins[split].Count;
+            rightCosts[split]  = right.GetHalfArea() * static_cast<f32>(rightCount);
+        }
+
+        AABB left;
+        u32  leftCount = 0;
+        for (u32 split = 1; split < spec.Bins; split++)
+        {
+            left.Grow(bins[split - 1].Bounds);
+            leftCount += bins[split - 1].Count;
+            const f32 cost = left.GetHalfArea() * static_cast<f32>(leftCount) + rightCosts[split];
+            if (leftCount > 0 && leftCount < node.Count && cost < bestCost)
+            {
+                bestCost  = cost;
+                bestAxis  = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    // All the centres in one place (or one bin): any split is as good as another, so halve them.
+    if (bestSplit == 0)
+        return node.Count / 2;
+
+    const f32  scale  = static_cast<f32>(spec.Bins) / extent[bestAxis];
+    const auto middle = std::partition(first, last, [&](const u32 item)
+    {
+        const f32 offset = (centers[item][bestAxis] - centerBounds.Min[bestAxis]) * scale;
+        return std::min(static_cast<u32>(offset), spec.Bins - 1) < bestSplit;
+    });
+    return static_cast<u32>(middle - first);
+}
+
+void BVH::Clear()
+{
+    m_Nodes.clear();
+    m_Parents.clear();
+    m_Order.clear();
+    m_SlotOf.clear();
+    m_LeafOf.clear();
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        m_Min[axis].clear();
+        m_Max[axis].clear();
+    }
+    m_DirtyNodes.clear();
+    m_Dirty.clear();
+    m_Cost      = 0.0;
+    m_BuildCost = 0.0f;
+    m_Stats.Reset();
+}
+
+void BVH::SetBounds(const u32 item, const AABB& bounds)
+{
+    MP_CHECK(item < m_SlotOf.size(), "BVH item out of range");
+    const u32 slot = m_SlotOf[item];
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        m_Min[axis][slot] = bounds.Min[axis];
+        m_Max[axis][slot] = bounds.Max[axis];
+    }
+
+    const u32 leaf = m_LeafOf[slot];
+    if (!m_Dirty[leaf])
+    {
+        m_Dirty[leaf] = 1;
+        m_DirtyNodes.push_back(leaf);
+    }
+}
+
+void BVH::Refit()
+{
+    if (m_DirtyNodes.empty())
+        return;
+
+    Stopwatch timer;
+    // Mark everything above the moved leaves, then update from the bottom up: children always come after their
+    // parents, so that's in reverse order.
+    const size_t leaves = m_DirtyNodes.size();
+    for (size_t i = 0; i < leaves; i++)
+    {
+        u32 node = m_DirtyNodes[i];
+        while (node != 0)
+        {
+            node = m_Parents[node];
+            if (m_Dirty[node])
+                break;
+            m_Dirty[node] = 1;
+            m_DirtyNodes.push_back(node);
+        }
+    }
+    std::ranges::sort(m_DirtyNodes, std::greater());
+
+    for (const u32 index : m_DirtyNodes)
+    {
+        Node&     node    = m_Nodes[index];
+        const f32 oldArea = node.Bounds.GetHalfArea();
+        if (IsLeaf(node))
+        {
+            node.Bounds = AABB();
+            for (u32 slot = node.First; slot < node.First + node.Count; slot++)
+                node.Bounds.Grow(GetItemBounds(slot));
+            m_Cost += static_cast<f64>(node.Bounds.GetHalfArea() - oldArea) * node.Count;
+        }
+        else
+        {
+            node.Bounds = m_Nodes[node.Left].Bounds;
+            node.Bounds.Grow(m_Nodes[node.Left + 1].Bounds);
+            m_Cost += node.Bounds.GetHalfArea() - oldArea;
+        }
+        m_Dirty[index] = 0;
+    }
+
+    m_Stats.RefittedNodes = static_cast<u32>(m_DirtyNodes.size());
+    m_Stats.RefitMS       = timer.GetElapsedMilliseconds();
+    m_DirtyNodes.clear();
+}
+
+void BVH::Cull(const Frustum& frustum, std::vector<u32>& visible, CullStats& stats,
+               const OcclusionBuffer* occlusion) const
+{
+    if (!IsBuilt())
+        return;
+
+    Stopwatch timer;
+    stats.Items += static_cast<u32>(m_Order.size());
+
+    // Depth first; the stack never holds more than a node's ancestors' siblings.
+    struct Entry
+    {
+        u32 Node;
+        u32 PlaneMask; // The planes the node's parent straddled.
+    };
+    std::array<Entry, MaxDepth + 1> stack;
+    u32                             size = 0;
+    stack[size++]                        = {0, AllPlanes};
+    while (size > 0)
+    {
+        const Entry entry = stack[--size];
+        const Node& node  = m_Nodes[entry.Node];
+        stats.NodesVisited++;
+
+        u32             planeMask = entry.PlaneMask;
+        bool            outside   = false;
+        const glm::vec3 center    = node.Bounds.GetCenter();
+        const glm::vec3 extent    = node.Bounds.GetExtent();
+        for (u32 mask = planeMask; mask != 0 && !outside; mask &= mask - 1)
+        {
+            const u32        plane    = std::countr_zero(mask);
+            const glm::vec4& equation = frustum.Planes[plane];
+            const f32        distance = glm::dot(glm::vec3(equation), center) + equation.w;
+            const f32        radius   = glm::dot(glm::abs(glm::vec3(equation)), extent);
+            outside                   = distance < -radius;
+            if (distance >= radius)
+                planeMask &= ~(1u << plane);
+        }
+
+        if (outside)
+        {
+            stats.FrustumCulled += node.Count;
+            continue;
+        }
+        if (occlusion && occlusion->IsOccluded(node.Bounds))
+        {
+            stats.OcclusionCulled += node.Count;
+            continue;
+        }
+        if (planeMask == 0 && !occlusion)
+        {
+            visible.insert(visible.end(), m_Order.begin() + node.First, m_Order.begin() + node.First + node.Count);
+            stats.Visible += node.Count;
+            continue;
+        }
+
+        if (IsLeaf(node))
+        {
+            CullLeaf(frustum, node, planeMask, visible, stats, occlusion);
+            continue;
+        }
+        stack[size++] = {node.Left + 1, planeMask};
+        stack[size++] = {node.Left, planeMask};
+    }
+
+    stats.CullMS += timer.GetElapsedMilliseconds();
+}
+
+void BVH::CullFlat(const Frustum& frustum, std::vector<u32>& visible, CullStats& stats) const
+{
+    if (!IsBuilt())
+        return;
+
+    Stopwatch timer;
+    stats.Items += static_cast<u32>(m_Order.size());
+    CullLeaf(frustum, {.First = 0, .Count = static_cast<u32>(m_Order.size())}, AllPlanes, visible, stats, nullptr);
+    stats.CullMS += timer.GetElapsedMilliseconds();
+}
+
+f32 BVH::GetCost() const
+{
+    const f32 rootArea = IsBuilt() ? m_Nodes[0].Bounds.GetHalfArea() : 0.0f;
+    return rootArea > 0.0f ? static_cast<f32>(m_Cost / rootArea) : 0.0f;
+}
+
+AABB BVH::GetItemBounds(const u32 slot) const
+{
+    return {
+        {m_Min[0][slot], m_Min[1][slot], m_Min[2][slot]},
+        {m_Max[0][slot], m_Max[1][slot], m_Max[2][slot]}
+    };
+}
+
+void BVH::CullLeaf(const Frustum& frustum, const Node& node, const u32 planeMask, std::vector<u32>& visible,
+                   CullStats& stats, const OcclusionBuffer* occlusion) const
+{
+    // Against each plane, only the box's corner furthest along the plane's normal matters: if that's behind it, the
+    // whole box is. The normal's signs pick the corner, the same for all four lanes.
+    const Float4 zero = Float4::Splat(0.0f);
+    const u32    end  = node.First + node.Count;
+    for (u32 slot = node.First; slot < end; slot += 4)
+    {
+        const u32 lanes  = std::min(end - slot, 4u);
+        u32       inside = (1u << lanes) - 1;
+        if (planeMask != 0)
+        {
+            const Float4 minX = Float4::Load(&m_Min[0][slot]), maxX = Float4::Load(&m_Max[0][slot]);
+            const Float4 minY = Float4::Load(&m_Min[1][slot]), maxY = Float4::Load(&m_Max[1][slot]);
+            const Float4 minZ = Float4::Load(&m_Min[2][slot]), maxZ = Float4::Load(&m_Max[2][slot]);
+
+            Float4 outside = zero;
+            for (u32 mask = planeMask; mask != 0; mask &= mask - 1)
+            {
+                const glm::vec4& plane    = frustum.Planes[std::countr_zero(mask)];
+                const Float4     distance = Float4::Splat(plane.x) * (plane.x > 0.0f ? maxX : minX)
+                                            + Float4::Splat(plane.y) * (plane.y > 0.0f ? maxY : minY)
+                                            + Float4::Splat(plane.z) * (plane.z > 0.0f ? maxZ : minZ)
+                                            + Float4::Splat(plane.w);
+                outside = outside | (distance < zero);
+            }
+            inside              &= ~outside.MoveMask();
+            stats.ItemsTested   += lanes;
+            stats.FrustumCulled += lanes - static_cast<u32>(std::popcount(inside));
+        }
+
+        for (; inside != 0; inside &= inside - 1)
+        {
+            const u32 itemSlot = slot + std::countr_zero(inside);
+            if (occlusion && occlusion->IsOccluded(GetItemBounds(itemSlot)))
+            {
+                stats.OcclusionCulled++;
+                continue;
+            }
+            visible.push_back(m_Order[itemSlot]);
+            stats.Visible++;
+        }
+    }
+}
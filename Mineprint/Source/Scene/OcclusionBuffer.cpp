@@ -0,0 +1,264 @@
+#include "mppch.h"
+
+#include "Scene/OcclusionBuffer.h"
+
+namespace
+{
+    // A box's corners, numbered by their bits (1 for +X, 2 for +Y, 4 for +Z), as outward-facing triangles.
+    constexpr std::array<u32, 36> BoxIndices = {
+        0, 4, 6, 0, 6, 2, // -X
+        1, 3, 7, 1, 7, 5, // +X
+        0, 1, 5, 0, 5, 4, // -Y
+        2, 6, 7, 2, 7, 3, // +Y
+        0, 2, 3, 0, 3, 1, // -Z
+        4, 5, 7, 4, 7, 6, // +Z
+    };
+
+    // Twice the signed area of the triangle abp: positive when p is to the left of a to b.
+    FORCEINLINE f32 Edge(const glm::vec3& a, const glm::vec3& b, const f32 x, const f32 y)
+    {
+        return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+    }
+}
+
+void OcclusionBuffer::Begin(const OcclusionBufferSpecification& spec, const glm::mat4& viewProjection)
+{
+    MP_CHECK(spec.Width > 0 && spec.Height > 0, "Occlusion buffer can't be empty");
+
+    m_ViewProjection = viewProjection;
+    m_Width          = spec.Width;
+    m_Height         = spec.Height;
+    m_Stats.Reset();
+
+    // Each level halves the one before, rounding up, down to a single texel.
+    m_Levels.clear();
+    u32 width  = m_Width;
+    u32 height = m_Height;
+    while (true)
+    {
+        Level& level = m_Levels.emplace_back();
+        level.Width  = width;
+        level.Height = height;
+        level.Depths.assign(static_cast<size_t>(width) * height, 1.0f);
+        if (width == 1 && height == 1)
+            break;
+        width  = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+}
+
+void OcclusionBuffer::AddOccluder(const std::span<const glm::vec3> positions, const std::span<const u32> indices,
+                                  const glm::mat4& transform)
+{
+    MP_CHECK(!m_Levels.empty(), "Occlusion buffer must be begun before adding occluders");
+
+    Stopwatch       timer;
+    const glm::mat4 objectToClip = m_ViewProjection * transform;
+    m_Transformed.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        m_Transformed[i] = objectToClip * glm::vec4(positions[i], 1.0f);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        if (indices[i] >= positions.size() || indices[i + 1] >= positions.size() || indices[i + 2] >= positions.size())
+        {
+            MP_ERROR("Skipping an occluder triangle with an index outside its {} positions", positions.size());
+            continue;
+        }
+        ClipAndRasterise(m_Transformed[indices[i]], m_Transformed[indices[i + 1]], m_Transformed[indices[i + 2]]);
+    }
+
+    m_Stats.Occluders++;
+    m_Stats.RenderMS += timer.GetElapsedMilliseconds();
+}
+
+void OcclusionBuffer::AddOccluder(const AABB& box)
+{
+    std::array<glm::vec3, 8> corners;
+    for (u32 i = 0; i < 8; i++)
+    {
+        corners[i] = {i & 1 ? box.Max.x : box.Min.x, i & 2 ? box.Max.y : box.Min.y, i & 4 ? box.Max.z : box.Min.z};
+    }
+    AddOccluder(corners, BoxIndices);
+}
+
+void OcclusionBuffer::Finish()
+{
+    Stopwatch timer;
+    for (size_t i = 1; i < m_Levels.size(); i++)
+    {
+        const Level& source = m_Levels[i - 1];
+        Level&       level  = m_Levels[i];
+        for (u32 y = 0; y < level.Height; y++)
+        {
+            // Odd sizes have a last row or column with nothing after it, which only covers itself.
+            const u32 y0 = y * 2;
+            const u32 y1 = std::min(y0 + 1, source.Height - 1);
+            for (u32 x = 0; x < level.Width; x++)
+            {
+                const u32 x0 = x * 2;
+                const u32 x1 = std::min(x0 + 1, source.Width - 1);
+                level.Depths[y * level.Width + x] =
+                    std::max(std::max(source.Depths[y0 * source.Width + x0], source.Depths[y0 * source.Width + x1]),
+                             std::max(source.Depths[y1 * source.Width + x0], source.Depths[y1 * source.Width + x1]));
+            }
+        }
+    }
+    m_Stats.RenderMS += timer.GetElapsedMilliseconds();
+}
+
+bool OcclusionBuffer::IsOccluded(const AABB& box) const
+{
+    if (m_Levels.empty() || box.IsEmpty())
+        return false;
+
+    // The corners in clip space, from one corner and the box's edges.
+    const glm::vec3 size   = box.Max - box.Min;
+    const glm::vec4 origin = m_ViewProjection * glm::vec4(box.Min, 1.0f);
+    const glm::vec4 edgeX  = m_ViewProjection[0] * size.x;
+    const glm::vec4 edgeY  = m_ViewProjection[1] * size.y;
+    const glm::vec4 edgeZ  = m_ViewProjection[2] * size.z;
+
+    glm::vec2 rectMin  = glm::vec2(std::numeric_limits<f32>::max());
+    glm::vec2 rectMax  = glm::vec2(-std::numeric_limits<f32>::max());
+    f32       minDepth = 1.0f;
+    for (u32 i = 0; i < 8; i++)
+    {
+        const glm::vec4 corner = origin + (i & 1 ? edgeX : glm::vec4(0.0f)) + (i & 2 ? edgeY : glm::vec4(0.0f))
+                                 + (i & 4 ? edgeZ : glm::vec4(0.0f));
+        if (corner.w <= 0.0f || corner.z < -corner.w)
+            return false; // Crosses the near plane, so it's right in front of the camera.
+
+        const glm::vec3 ndc   = glm::vec3(corner) / corner.w;
+        const glm::vec2 pixel = (glm::vec2(ndc) * 0.5f + 0.5f) * glm::vec2(m_Width, m_Height);
+        rectMin               = glm::min(rectMin, pixel);
+        rectMax               = glm::max(rectMax, pixel);
+        minDepth              = std::min(minDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    // Off screen is the frustum's business, not ours.
+    if (rectMax.x < 0.0f || rectMax.y < 0.0f || rectMin.x >= static_cast<f32>(m_Width)
+        || rectMin.y >= static_cast<f32>(m_Height))
+        return false;
+
+    const u32 x0 = static_cast<u32>(std::max(rectMin.x, 0.0f));
+    const u32 y0 = static_cast<u32>(std::max(rectMin.y, 0.0f));
+    const u32 x1 = std::min(static_cast<u32>(rectMax.x), m_Width - 1);
+    const u32 y1 = std::min(static_cast<u32>(rectMax.y), m_Height - 1);
+
+    // The level where the rectangle spans at most four texels each way.
+    const u32 span  = std::max(x1 - x0, y1 - y0);
+    u32       shift = 0;
+    while ((span >> shift) > 2 && shift + 1 < m_Levels.size())
+        shift++;
+
+    const Level& level = m_Levels[shift];
+    for (u32 y = y0 >> shift; y <= y1 >> shift; y++)
+    {
+        for (u32 x = x0 >> shift; x <= x1 >> shift; x++)
+        {
+            if (level.Depths[y * level.Width + x] >= minDepth)
+                return false;
+        }
+    }
+    return true;
+}
+
+void OcclusionBuffer::ClipAndRasterise(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+    // Entirely outside one of the side planes, or the far plane: nothing to draw.
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        if ((a[axis] > a.w && b[axis] > b.w && c[axis] > c.w)
+            || (axis < 2 && a[axis] < -a.w && b[axis] < -b.w && c[axis] < -c.w))
+            return;
+    }
+
+    // Clipped to the near plane (z >= -w), a triangle becomes at most a quad.
+    const std::array<glm::vec4, 3> input = {a, b, c};
+    std::array<glm::vec4, 4>       polygon;
+    u32                            count = 0;
+    for (u32 i = 0; i < 3; i++)
+    {
+        const glm::vec4& current      = input[i];
+        const glm::vec4& next         = input[(i + 1) % 3];
+        const f32        distance     = current.z + current.w;
+        const f32        nextDistance = next.z + next.w;
+        if (distance >= 0.0f)
+            polygon[count++] = current;
+        if ((distance >= 0.0f) != (nextDistance >= 0.0f))
+            polygon[count++] = glm::mix(current, next, distance / (distance - nextDistance));
+    }
+    if (count < 3)
+        return;
+
+    std::array<glm::vec3, 4> projected;
+    const glm::vec2          scale = glm::vec2(m_Width, m_Height) * 0.5f;
+    for (u32 i = 0; i < count; i++)
+    {
+        const glm::vec3 ndc = glm::vec3(polygon[i]) / std::max(polygon[i].w, 1e-6f);
+        projected[i]        = {(ndc.x + 1.0f) * scale.x, (ndc.y + 1.0f) * scale.y, ndc.z * 0.5f + 0.5f};
+    }
+    for (u32 i = 2; i < count; i++)
+        Rasterise(projected[0], projected[i - 1], projected[i]);
+}
+
+void OcclusionBuffer::Rasterise(const glm::vec3& a, glm::vec3 b, glm::vec3 c)
+{
+    f32 area = Edge(a, b, c.x, c.y);
+    if (area == 0.0f)
+        return;
+    // Either winding will do; occluders hide things from both sides.
+    if (area < 0.0f)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+    m_Stats.Triangles++;
+
+    // The pixels whose centres could be inside, clamped to the buffer before converting (vertices near the near plane
+    // can be far off screen).
+    const glm::vec2  low  = glm::min(glm::vec2(a), glm::min(glm::vec2(b), glm::vec2(c))) - 0.5f;
+    const glm::vec2  high = glm::max(glm::vec2(a), glm::max(glm::vec2(b), glm::vec2(c))) - 0.5f;
+    const glm::vec2  size = glm::vec2(m_Width, m_Height);
+    const glm::ivec2 min  = glm::ivec2(glm::ceil(glm::clamp(low, glm::vec2(0.0f), size)));
+    const glm::ivec2 max  = glm::ivec2(glm::floor(glm::clamp(high, glm::vec2(-1.0f), size - 1.0f)));
+    if (min.x > max.x || min.y > max.y)
+        return;
+
+    // The edge functions and depth are linear in x and y, so step along rows and columns.
+    const f32 startX = static_cast<f32>(min.x) + 0.5f;
+    const f32 startY = static_cast<f32>(min.y) + 0.5f;
+    const f32 w0     = Edge(b, c, startX, startY);
+    const f32 w1     = Edge(c, a, startX, startY);
+    const f32 w2     = Edge(a, b, startX, startY);
+    const f32 w0X    = -(c.y - b.y), w0Y = c.x - b.x;
+    const f32 w1X    = -(a.y - c.y), w1Y = a.x - c.x;
+    const f32 w2X    = -(b.y - a.y), w2Y = b.x - a.x;
+    const f32 depth  = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+    const f32 depthX = (w0X * a.z + w1X * b.z + w2X * c.z) / area;
+    const f32 depthY = (w0Y * a.z + w1Y * b.z + w2Y * c.z) / area;
+
+    std::vector<f32>& depths = m_Levels[0].Depths;
+    for (s32 y = min.y; y <= max.y; y++)
+    {
+        const f32 rows = static_cast<f32>(y - min.y);
+        f32       e0   = w0 + w0Y * rows;
+        f32       e1   = w1 + w1Y * rows;
+        f32       e2   = w2 + w2Y * rows;
+        f32       z    = depth + depthY * rows;
+        f32*      row  = &depths[static_cast<size_t>(y) * m_Width];
+        for (s32 x = min.x; x <= max.x; x++)
+        {
+            if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+            {
+                row[x] = std::min(row[x], std::max(z, 0.0f));
+                m_Stats.Pixels++;
+            }
+            e0 += w0X;
+            e1 += w1X;
+            e2 += w2X;
+            z  += depthX;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include "mppch.h"
+
+#include "Scene/Scene.h"
+
+Scene::Scene(const SceneSpecification& spec)
+    : m_Spec(spec)
+{
+}
+
+SceneObjectHandle Scene::Add(const AABB& bounds, const u32 userData)
+{
+    const SceneObjectHandle handle = m_Handles.Add(static_cast<u32>(m_Bounds.size()));
+    m_Bounds.push_back(bounds);
+    m_UserData.push_back(userData);
+    m_HandleOf.push_back(handle);
+    m_NeedsRebuild = true;
+    return handle;
+}
+
+void Scene::Remove(const SceneObjectHandle handle)
+{
+    const std::optional<u32> removed = m_Handles.Remove(handle);
+    if (!removed)
+        return;
+
+    const u32 index = *removed;
+    const u32 last  = static_cast<u32>(m_Bounds.size() - 1);
+    if (index != last)
+    {
+        m_Bounds[index]                   = m_Bounds[last];
+        m_UserData[index]                 = m_UserData[last];
+        m_HandleOf[index]                 = m_HandleOf[last];
+        *m_Handles.Get(m_HandleOf[index]) = index;
+    }
+    m_Bounds.pop_back();
+    m_UserData.pop_back();
+    m_HandleOf.pop_back();
+    m_NeedsRebuild = true;
+}
+
+void Scene::SetBounds(const SceneObjectHandle handle, const AABB& bounds)
+{
+    const u32* index = m_Handles.Get(handle);
+    if (!index)
+        return;
+
+    m_Bounds[*index] = bounds;
+    m_Moved++;
+    // A rebuild is coming anyway, and will pick the new bounds up.
+    if (!m_NeedsRebuild)
+        m_BVH.SetBounds(*index, bounds);
+}
+
+void Scene::Clear()
+{
+    m_Handles.Clear();
+    m_Bounds.clear();
+    m_UserData.clear();
+    m_HandleOf.clear();
+    m_BVH.Clear();
+    m_NeedsRebuild = false;
+    m_Moved        = 0;
+    m_Rebuilt      = false;
+    m_UpdateMS     = 0;
+    m_Stats.Reset();
+}
+
+const AABB* Scene::GetBounds(const SceneObjectHandle handle) const
+{
+    const u32* index = m_Handles.Get(handle);
+    return index ? &m_Bounds[*index] : nullptr;
+}
+
+void Scene::Update()
+{
+    if (!m_NeedsRebuild && !m_BVH.NeedsRefit())
+        return;
+
+    Stopwatch timer;
+    if (!m_NeedsRebuild)
+    {
+        m_BVH.Refit();
+        m_NeedsRebuild = m_BVH.GetCost() > m_BVH.GetBuildCost() * m_Spec.RebuildCost;
+    }
+    if (m_NeedsRebuild)
+    {
+        m_BVH.Build(m_Spec.BVH, m_Bounds);
+        m_NeedsRebuild = false;
+        m_Rebuilt      = true;
+    }
+    m_UpdateMS += timer.GetElapsedMilliseconds();
+}
+
+void Scene::Cull(const glm::mat4& viewProjection, std::vector<u32>& visible, const OcclusionBuffer* occlusion)
+{
+    Update();
+    m_Stats.Reset();
+    m_Stats.Objects  = GetObjectCount();
+    m_Stats.Moved    = m_Moved;
+    m_Stats.Rebuilt  = m_Rebuilt;
+    m_Stats.UpdateMS = m_UpdateMS;
+    m_Moved          = 0;
+    m_Rebuilt        = false;
+    m_UpdateMS       = 0;
+
+    // The BVH gives back object indices, which are swapped for the caller's values in place.
+    visible.clear();
+    m_BVH.Cull(Frustum::FromMatrix(viewProjection), visible, m_Stats.Cull, occlusion);
+    for (u32& object : visible)
+        object = m_UserData[object];
+}
@@ -0,0 +1,9 @@
+#include "mppch.h"
+
+// stb_image decodes resource pack PNGs for the texture atlas, and its zlib decoder unpacks embedded content.
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// stb_image_write encodes the software rasteriser's thumbnails.
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
@@ -0,0 +1,55 @@
+#include "mppch.h"
+
+#include "World/BlockVolume.h"
+
+void BlockVolume::SetBlock(const glm::ivec3& position, const BlockID block)
+{
+    const glm::ivec3 section = GetSectionPosition(position);
+    if (block == AirBlock && !GetSection(section))
+        return;
+
+    GetOrCreateSection(section).Set(position.x & 15, position.y & 15, position.z & 15, block);
+}
+
+BlockID BlockVolume::GetBlock(const glm::ivec3& position) const
+{
+    const ChunkSection* section = GetSection(GetSectionPosition(position));
+    return section ? section->Get(position.x & 15, position.y & 15, position.z & 15) : AirBlock;
+}
+
+const ChunkSection* BlockVolume::GetSection(const glm::ivec3& section) const
+{
+    const auto it = m_Sections.find(GetKey(section));
+    return it != m_Sections.end() ? it->second.get() : nullptr;
+}
+
+ChunkSection& BlockVolume::GetOrCreateSection(const glm::ivec3& section)
+{
+    Scope<ChunkSection>& entry = m_Sections[GetKey(section)];
+    if (!entry)
+        entry = CreateScope<ChunkSection>();
+    return *entry;
+}
+
+std::vector<glm::ivec3> BlockVolume::GetSectionPositions() const
+{
+    // Back from the key, sign-extending each 21-bit field.
+    auto unpack = [](const u64 key, const u32 shift)
+    {
+        return static_cast<s32>(static_cast<s64>(key >> shift << 43) >> 43);
+    };
+
+    std::vector<glm::ivec3> positions;
+    positions.reserve(m_Sections.size());
+    for (const auto& [key, section] : m_Sections)
+    {
+        if (!section->IsEmpty())
+            positions.emplace_back(unpack(key, 0), unpack(key, 42), unpack(key, 21));
+    }
+
+    std::ranges::sort(positions, [](const glm::ivec3& a, const glm::ivec3& b)
+    {
+        return std::tie(a.y, a.z, a.x) < std::tie(b.y, b.z, b.x);
+    });
+    return positions;
+}
@@ -0,0 +1,181 @@
+using System.IO.Compression;
+using System.Text;
+
+namespace Preprocessor;
+
+/// <summary>
+/// Packs the embedded content directory into a single blob that's linked into the executable (see
+/// Mineprint/Source/Core/EmbeddedContent/EmbeddedContent.cpp, which reads it back).
+///
+/// Layout (little-endian, offsets from the start of the blob):
+///     Header  { u32 Magic; u16 Version; u16 Flags; u32 EntryCount; u32 NamesOffset; u32 NamesSize; u32 DataOffset; }
+///     Entry[] { u64 NameHash; u32 NameOffset; u32 NameLength; u32 DataOffset; u32 StoredSize; u32 Size; u32 Compression; }
+///     Names   (UTF-8, not null terminated)
+///     Data    (each file aligned to 16 bytes, zlib compressed unless that doesn't save anything)
+/// Entries are sorted by the FNV-1a hash of their path, so the runtime can binary search them.
+/// </summary>
+internal static class EmbeddedContentPacker
+{
+    private const uint Magic = 0x4345504D; // "MPEC"
+    private const ushort Version = 1;
+    private const int HeaderSize = 24;
+    private const int EntrySize = 32;
+    private const int DataAlignment = 16;
+
+    private const uint CompressionNone = 0;
+    private const uint CompressionZlib = 1;
+
+    // Only bother compressing if it saves at least this fraction; uncompressed files can be used in place.
+    private const double MinCompressionSaving = 0.1;
+
+    private struct PackedFile
+    {
+        public string Path;
+        public ulong NameHash;
+        public byte[] StoredData;
+        public uint Size;
+        public uint Compression;
+    }
+
+    public static void Run()
+    {
+        string sourceSetting = Program.PreprocessorSettings.GetProcessorSetting("EmbeddedContentSource");
+        string outputSetting = Program.PreprocessorSettings.GetProcessorSetting("EmbeddedContentOutput");
+        if (string.IsNullOrEmpty(sourceSetting) || string.IsNullOrEmpty(outputSetting))
+            return;
+
+        string sourceDir = Path.GetFullPath(Path.Join(Program.ContentDir, sourceSetting));
+        string outputDir = Path.GetFullPath(Path.Join(Program.ContentDir, outputSetting));
+        if (!Directory.Exists(sourceDir))
+        {
+            Log.Warning($"Embedded content directory {sourceDir} does not exist; skipping packing.");
+            return;
+        }
+
+        Directory.CreateDirectory(outputDir);
+
+        try
+        {
+            Pack(sourceDir, Path.Join(outputDir, "EmbeddedContent.pack"),
+                Path.Join(outputDir, "EmbeddedContentPack.h"));
+        }
+        catch (Exception e)
+        {
+            Log.Error($"Failed to pack embedded content from {sourceDir}: {e.Message}");
+        }
+    }
+
+    private static void Pack(string sourceDir, string packFile, string headerFile)
+    {
+        List<PackedFile> files = [];
+        foreach (var file in Directory.GetFiles(sourceDir, "*", SearchOption.AllDirectories))
+        {
+            string path = Path.GetRelativePath(sourceDir, file).Replace('\\', '/');
+            byte[] data = File.ReadAllBytes(file);
+            byte[] compressed = Compress(data);
+
+            bool useCompressed = compressed.Length < data.Length * (1.0 - MinCompressionSaving);
+            files.Add(new PackedFile
+            {
+                Path = path,
+                NameHash = HashPath(path),
+                StoredData = useCompressed ? compressed : data,
+                Size = (uint)data.Length,
+                Compression = useCompressed ? CompressionZlib : CompressionNone
+            });
+
+            Log.Trace($"{path}: {data.Length} -> {(useCompressed ? compressed.Length : data.Length)} bytes");
+        }
+
+        files.Sort((a, b) => a.NameHash.CompareTo(b.NameHash));
+        for (int i = 1; i < files.Count; i++)
+        {
+            if (files[i].NameHash == files[i - 1].NameHash)
+                throw new Exception($"Embedded content paths {files[i - 1].Path} and {files[i].Path} have the same hash");
+        }
+
+        byte[] names = Encoding.UTF8.GetBytes(string.Concat(files.Select(f => f.Path)));
+        uint namesOffset = (uint)(HeaderSize + files.Count * EntrySize);
+        uint dataOffset = Align((uint)(namesOffset + names.Length));
+
+        using var stream = new MemoryStream();
+        using (var writer = new BinaryWriter(stream, Encoding.UTF8, true))
+        {
+            writer.Write(Magic);
+            writer.Write(Version);
+            writer.Write((ushort)0);
+            writer.Write((uint)files.Count);
+            writer.Write(namesOffset);
+            writer.Write((uint)names.Length);
+            writer.Write(dataOffset);
+
+            uint nameOffset = namesOffset;
+            uint fileOffset = dataOffset;
+            foreach (var file in files)
+            {
+                uint nameLength = (uint)Encoding.UTF8.GetByteCount(file.Path);
+                writer.Write(file.NameHash);
+                writer.Write(nameOffset);
+                writer.Write(nameLength);
+                writer.Write(fileOffset);
+                writer.Write((uint)file.StoredData.Length);
+                writer.Write(file.Size);
+                writer.Write(file.Compression);
+
+                nameOffset += nameLength;
+                fileOffset = Align(fileOffset + (uint)file.StoredData.Length);
+            }
+
+            writer.Write(names);
+            foreach (var file in files)
+            {
+                writer.Write(new byte[Align((uint)stream.Position) - stream.Position]);
+                writer.Write(file.StoredData);
+            }
+        }
+
+        byte[] pack = stream.ToArray();
+        ulong packHash = Fnv1a(pack);
+
+        // Only touch the outputs if the pack changed; the generated header is what makes the build relink the blob.
+        if (!File.Exists(packFile) || !File.ReadAllBytes(packFile).AsSpan().SequenceEqual(pack))
+            File.WriteAllBytes(packFile, pack);
+
+        string header =
+            "// Generated by the preprocessor (EmbeddedContentPacker.cs). Do not edit.\n" +
+            "#pragma once\n\n" +
+            "#define MP_EMBEDDED_CONTENT_AVAILABLE 1\n" +
+            $"#define MP_EMBEDDED_CONTENT_HASH 0x{packHash:X16}ull\n" +
+            $"#define MP_EMBEDDED_CONTENT_SIZE {pack.Length}\n";
+        if (!File.Exists(headerFile) || File.ReadAllText(headerFile) != header)
+            File.WriteAllText(headerFile, header);
+
+        long totalSize = files.Sum(f => (long)f.Size);
+        Log.Info($"Packed {files.Count} embedded files: {totalSize / 1024} KB -> {pack.Length / 1024} KB");
+    }
+
+    private static byte[] Compress(byte[] data)
+    {
+        using var output = new MemoryStream();
+        using (var zlib = new ZLibStream(output, CompressionLevel.SmallestSize, true))
+            zlib.Write(data);
+        return output.ToArray();
+    }
+
+    private static uint Align(uint offset) => (offset + DataAlignment - 1) & ~(uint)(DataAlignment - 1);
+
+    // Must match EmbeddedContent::HashPath().
+    private static ulong HashPath(string path) => Fnv1a(Encoding.UTF8.GetBytes(path));
+
+    private static ulong Fnv1a(ReadOnlySpan<byte> data)
+    {
+        ulong hash = 0xCBF29CE484222325;
+        foreach (byte b in data)
+        {
+            hash ^= b;
+            hash *= 0x100000001B3;
+        }
+
+        return hash;
+    }
+}
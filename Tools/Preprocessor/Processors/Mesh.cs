@@ -13,7 +13,7 @@ public struct MeshVertex
 public class SubMesh(uint numVertices, uint numIndices)
 {
     public MeshVertex[] Vertices = new MeshVertex[numVertices];
-    public ushort[] Indices = new ushort[numIndices];
+    public uint[] Indices = new uint[numIndices];
     public uint MaterialIndex;
     public uint NumVerts = numVertices, NumIndices = numIndices;
 }
@@ -22,32 +22,71 @@ public class Mesh
 {
     public List<SubMesh> Submeshes = new();
 
+    // Version 2 of the format, read by MeshFile on the engine side:
+    //   Header:   uint "PAWS", uint 0xFFFFFFFF (where version 1 had its submesh count), ushort version,
+    //             ushort index size (2 or 4), uint submesh count, uint vertex count, uint index count, ulong file size.
+    //   Submeshes: uint first vertex, uint vertex count, uint first index, uint index count, uint material, uint 0.
+    //   Then every submesh's vertices, from the next 16-byte boundary, then every submesh's indices.
+    // Indices are relative to their submesh's first vertex, so they're only 32-bit when a submesh needs them to be.
+    public const ushort Version = 2;
+
     public void Export(string filename)
     {
+        bool wideIndices = Submeshes.Any(submesh => submesh.NumVerts > ushort.MaxValue + 1);
+        ushort indexSize = (ushort)(wideIndices ? sizeof(uint) : sizeof(ushort));
+        uint totalVertices = (uint)Submeshes.Sum(submesh => (long)submesh.NumVerts);
+        uint totalIndices = (uint)Submeshes.Sum(submesh => (long)submesh.NumIndices);
+
+        int vertexSize = Marshal.SizeOf<MeshVertex>();
+        long vertexOffset = (32 + Submeshes.Count * 24 + 15) & ~15L;
+        long fileSize = vertexOffset + (long)totalVertices * vertexSize + (long)totalIndices * indexSize;
+
         FileStream fileStream = new(filename, FileMode.Create);
         using BinaryWriter writer = new(fileStream);
 
         writer.Write(0x53574150); // Magic number "PAWS"
-        writer.Write(Submeshes.Count);
+        writer.Write(0xFFFFFFFF);
+        writer.Write(Version);
+        writer.Write(indexSize);
+        writer.Write((uint)Submeshes.Count);
+        writer.Write(totalVertices);
+        writer.Write(totalIndices);
+        writer.Write((ulong)fileSize);
 
+        uint firstVertex = 0, firstIndex = 0;
         foreach (var submesh in Submeshes)
         {
+            writer.Write(firstVertex);
             writer.Write(submesh.NumVerts);
+            writer.Write(firstIndex);
             writer.Write(submesh.NumIndices);
             writer.Write(submesh.MaterialIndex);
+            writer.Write(0u);
+            firstVertex += submesh.NumVerts;
+            firstIndex += submesh.NumIndices;
+        }
+
+        while (writer.BaseStream.Position < vertexOffset)
+            writer.Write((byte)0);
 
-            int vertexSize = Marshal.SizeOf<MeshVertex>();
+        foreach (var submesh in Submeshes)
+        {
             byte[] vertexData = new byte[submesh.NumVerts * vertexSize];
             GCHandle handle = GCHandle.Alloc(submesh.Vertices, GCHandleType.Pinned);
             Marshal.Copy(handle.AddrOfPinnedObject(), vertexData, 0, vertexData.Length);
             handle.Free();
             writer.Write(vertexData);
+        }
 
-            byte[] indexData = new byte[submesh.NumIndices * sizeof(ushort)];
-            handle = GCHandle.Alloc(submesh.Indices, GCHandleType.Pinned);
-            Marshal.Copy(handle.AddrOfPinnedObject(), indexData, 0, indexData.Length);
-            handle.Free();
-            writer.Write(indexData);
+        foreach (var submesh in Submeshes)
+        {
+            foreach (uint index in submesh.Indices)
+            {
+                if (wideIndices)
+                    writer.Write(index);
+                else
+                    writer.Write((ushort)index);
+            }
         }
     }
 }
\ No newline at end of file
@@ -83,7 +83,7 @@ internal class MeshProcessor : IProcessor
                     var face = assimpMesh->MFaces[faceIndex];
                     for (int index = 0; index < face.MNumIndices; index++)
                     {
-                        subMesh.Indices[indexOffset + index] = (ushort)face.MIndices[index];
+                        subMesh.Indices[indexOffset + index] = face.MIndices[index];
                     }
 
                     indexOffset += face.MNumIndices;
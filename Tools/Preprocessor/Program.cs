@@ -127,6 +127,7 @@ internal static class Program
         LoadProcessors();
         DoLibCopies();
         DoAssetProcessing();
+        EmbeddedContentPacker.Run();
         SaveLastProcessedTimes();
 
         Log.ResetLog();
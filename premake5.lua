@@ -40,7 +40,7 @@ project "Mineprint"
 	files { 
 		"Mineprint/Include/**.h", "Mineprint/Include/**.hpp", 
 		"Mineprint/Source/**.cpp", "Mineprint/Source/**.c",
-		"Content/**",
+		"Content/**", "Mineprint/EmbeddedContent/**",
 		"TODO.md", "README.md",
 	}
 
@@ -53,9 +53,19 @@ project "Mineprint"
 		"%{IncludeDir.glad}",
 		"%{IncludeDir.stb}",
 
-		"Mineprint/Include"
+		"Mineprint/Include",
+		"Build/EmbeddedContent" -- Generated by the preprocessor.
 	}
 
+	-- The embedded content pack is linked in as a resource on Windows, and with .incbin on Linux
+	-- (see EmbeddedContent.cpp).
+	filter "system:windows"
+		files { "Mineprint/Source/**.rc" }
+		resincludedirs { "Build/EmbeddedContent" }
+
+	filter "system:linux"
+		buildoptions { "-Wa,-I%{wks.location}/Build/EmbeddedContent" }
+
 	filter "system:windows"
 		libdirs 
 		{